@@ -2,7 +2,7 @@ QT       += core gui widgets
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
-CONFIG += c++11
+CONFIG += c++17
 
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
@@ -19,7 +19,19 @@ SOURCES += \
     src/hashtable.cpp \
     src/hashfunction.cpp \
     src/collision.cpp \
-    src/file_handler.cpp
+    src/file_handler.cpp \
+    src/group_probe.cpp \
+    src/string_arena.cpp \
+    src/record_store.cpp \
+    src/phone_directory.cpp \
+    src/concurrent_hashtable.cpp \
+    src/epoch.cpp \
+    src/sharded_directory.cpp \
+    src/mapped_file.cpp \
+    src/snapshot.cpp \
+    src/write_ahead_log.cpp \
+    src/atomic_file.cpp \
+    src/bloom_filter.cpp
 
 HEADERS += \
     include/record.h \
@@ -27,6 +39,21 @@ HEADERS += \
     include/hashfunction.h \
     include/collision.h \
     include/file_handler.h \
+    include/group_probe.h \
+    include/basic_hashtable.h \
+    include/cuckoo_hashtable.h \
+    include/chained_hashtable.h \
+    include/string_arena.h \
+    include/record_store.h \
+    include/phone_directory.h \
+    include/concurrent_hashtable.h \
+    include/epoch.h \
+    include/sharded_directory.h \
+    include/mapped_file.h \
+    include/snapshot.h \
+    include/write_ahead_log.h \
+    include/atomic_file.h \
+    include/bloom_filter.h \
     src/MainWindow.h
 
 FORMS += \
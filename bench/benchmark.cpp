@@ -0,0 +1,1332 @@
+#include "../include/hashtable.h"
+#include "../include/phone_directory.h"
+#include "../include/concurrent_hashtable.h"
+#include "../include/sharded_directory.h"
+#include "../include/hashfunction.h"
+#include "../include/file_handler.h"
+#include "../include/group_probe.h"
+#include "../include/collision.h"
+#include "../include/mapped_file.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <atomic>
+#include <thread>
+
+/**
+ * @file benchmark.cpp
+ * @brief Performance benchmarks for the hash table implementation
+ *
+ * Build: g++ -O2 -std=c++17 -Iinclude src/hashtable.cpp src/hashfunction.cpp
+ *        src/collision.cpp src/file_handler.cpp src/group_probe.cpp src/string_arena.cpp
+ *        bench/benchmark.cpp -o benchmark
+ * Run:   ./benchmark [name ...] [--keys=N]   (no names runs every benchmark)
+ */
+
+// Live heap bytes, tracked by the replacement operator new/delete below
+static size_t heapLiveBytes = 0;
+
+// Block size is kept in a header in front of each allocation
+static const size_t HEAP_HEADER = sizeof(std::max_align_t);
+
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void* operator new(std::size_t bytes) {
+    char* block = static_cast<char*>(std::malloc(bytes + HEAP_HEADER));
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    std::memcpy(block, &bytes, sizeof(bytes));
+    heapLiveBytes += bytes;
+    return block + HEAP_HEADER;
+}
+
+BENCH_NOINLINE void operator delete(void* memory) noexcept {
+    if (memory) {
+        char* block = static_cast<char*>(memory) - HEAP_HEADER;
+        size_t bytes;
+        std::memcpy(&bytes, block, sizeof(bytes));
+        heapLiveBytes -= bytes;
+        std::free(block);
+    }
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    operator delete(memory);
+}
+
+namespace {
+
+// Results are accumulated here so the optimizer keeps the measured work
+volatile uint64_t benchSink = 0;
+
+// Number of keys for table benchmarks, set with --keys=N
+int benchKeys = 1000000;
+
+/**
+ * @brief Wall-clock timer
+ */
+class Timer {
+public:
+    Timer() : start(std::chrono::steady_clock::now()) {}
+
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+/**
+ * @brief Sequential phone numbers like data/records.txt ("555-0114")
+ */
+std::vector<std::string> phoneKeys(int n) {
+    std::vector<std::string> keys;
+    keys.reserve(n);
+    for (int i = 0; i < n; i++) {
+        std::string digits = std::to_string(i);
+        keys.push_back("555-" + std::string(digits.size() < 7 ? 7 - digits.size() : 0, '0') + digits);
+    }
+    return keys;
+}
+
+/**
+ * @brief Usernames built from the sample data plus a numeric suffix
+ * Names are rotated so anagram-like keys are common
+ */
+std::vector<std::string> usernameKeys(int n) {
+    std::vector<std::string> names;
+    for (const Record& rec : FileHandler::readRecordsFromFile("data/records.txt")) {
+        names.push_back(rec.username);
+    }
+    if (names.empty()) {
+        names = {"Alice", "Bob", "Charlie", "David", "Noah", "Grace", "Zoe", "Liam"};
+    }
+
+    std::vector<std::string> keys;
+    keys.reserve(n);
+    for (int i = 0; i < n; i++) {
+        std::string name = names[i % names.size()];
+        int suffix = i / static_cast<int>(names.size());
+        std::rotate(name.begin(), name.begin() + suffix % name.size(), name.end());
+        keys.push_back(name + std::to_string(suffix));
+    }
+    return keys;
+}
+
+/**
+ * @brief Percentile of a sample set (sorts the samples)
+ */
+double percentile(std::vector<double>& samples, double p) {
+    std::sort(samples.begin(), samples.end());
+    size_t rank = static_cast<size_t>(p * (samples.size() - 1));
+    return samples[rank];
+}
+
+const HashAlgorithm ALL_ALGORITHMS[] = {
+    HashAlgorithm::Sum, HashAlgorithm::Polynomial,
+    HashAlgorithm::WyHash, HashAlgorithm::XXHash64
+};
+
+/**
+ * @brief Chi-square statistic of bucket counts divided by degrees of freedom
+ * Values near 1.0 mean uniform distribution; large values mean clustering
+ */
+double chiSquareRatio(const std::vector<std::string>& keys, int buckets, HashAlgorithm algorithm) {
+    std::vector<int> counts(buckets, 0);
+    for (const std::string& key : keys) {
+        counts[HashFunction::index(key, buckets, algorithm)]++;
+    }
+
+    double expected = static_cast<double>(keys.size()) / buckets;
+    double chi = 0.0;
+    for (int c : counts) {
+        chi += (c - expected) * (c - expected) / expected;
+    }
+    return chi / (buckets - 1);
+}
+
+// ---------------------------------------------------------------------------
+
+void benchHashers() {
+    std::cout << "== hashers: throughput and chi-square distribution ==\n";
+
+    // Throughput over pre-built keys of each length, 16 MB of key bytes per run
+    std::cout << std::left << std::setw(12) << "hasher"
+              << std::right << std::setw(14) << "8B keys GB/s"
+              << std::setw(16) << "64B keys GB/s" << std::setw(16) << "4KB keys GB/s" << "\n";
+
+    const size_t lengths[] = {8, 64, 4096};
+    std::vector<std::vector<std::string>> keySets;
+    for (size_t length : lengths) {
+        std::vector<std::string> keys((16 << 20) / length);
+        for (size_t k = 0; k < keys.size(); k++) {
+            keys[k].resize(length);
+            for (size_t c = 0; c < length; c++) {
+                keys[k][c] = static_cast<char>('a' + (k * 31 + c * 7) % 26);
+            }
+        }
+        keySets.push_back(std::move(keys));
+    }
+
+    for (HashAlgorithm algorithm : ALL_ALGORITHMS) {
+        std::cout << std::left << std::setw(12) << HashFunction::name(algorithm) << std::right;
+        for (size_t set = 0; set < keySets.size(); set++) {
+            uint64_t sink = 0;
+            Timer timer;
+            for (int rep = 0; rep < 4; rep++) {
+                for (const std::string& key : keySets[set]) {
+                    sink += static_cast<uint64_t>(HashFunction::index(key, 1000003, algorithm));
+                }
+            }
+            double gbps = 4.0 * keySets[set].size() * lengths[set] / timer.seconds() / 1e9;
+            benchSink = benchSink + sink;
+            std::cout << std::setw(set == 0 ? 14 : 16) << std::fixed << std::setprecision(2) << gbps;
+        }
+        std::cout << "\n";
+    }
+
+    std::cout << "\nchi-square / dof (1.00 = uniform), 20 keys per bucket\n";
+    std::cout << std::left << std::setw(12) << "hasher" << std::right
+              << std::setw(14) << "phone m=1009" << std::setw(14) << "phone m=1024"
+              << std::setw(14) << "user m=1009" << std::setw(14) << "user m=1024" << "\n";
+
+    std::vector<std::string> phones = phoneKeys(20 * 1024);
+    std::vector<std::string> users = usernameKeys(20 * 1024);
+    for (HashAlgorithm algorithm : ALL_ALGORITHMS) {
+        std::cout << std::left << std::setw(12) << HashFunction::name(algorithm) << std::right
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(14) << chiSquareRatio(phones, 1009, algorithm)
+                  << std::setw(14) << chiSquareRatio(phones, 1024, algorithm)
+                  << std::setw(14) << chiSquareRatio(users, 1009, algorithm)
+                  << std::setw(14) << chiSquareRatio(users, 1024, algorithm) << "\n";
+    }
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Phone numbers in an array of Record slots, probed one slot at a
+ * time with linearProbe as HashTable::findIndex did before control bytes
+ * Baseline row of the probe benchmark; keys are compared in place.
+ */
+class SlotArrayTable {
+public:
+    SlotArrayTable(int size, HashAlgorithm algorithm) : slots(size), algorithm(algorithm) {}
+
+    void insert(const Record& record) {
+        int size = static_cast<int>(slots.size());
+        int hashIndex = HashFunction::index(record.phoneNumber, size, algorithm);
+        int index = hashIndex;
+        for (int attempt = 1; !slots[index].isEmpty; attempt++) {
+            index = CollisionResolution::linearProbe(hashIndex, attempt, size);
+        }
+        slots[index] = record;
+    }
+
+    int getSearchLength(const std::string& key) const {
+        int size = static_cast<int>(slots.size());
+        int hashIndex = HashFunction::index(key, size, algorithm);
+        int index = hashIndex;
+        for (int attempt = 0; attempt < size;) {
+            if (slots[index].isEmpty && !slots[index].isDeleted) {
+                return -1;
+            }
+            if (!slots[index].isDeleted && slots[index].phoneNumber == key) {
+                return attempt + 1;
+            }
+            attempt++;
+            index = CollisionResolution::linearProbe(hashIndex, attempt, size);
+        }
+        return -1;
+    }
+
+private:
+    std::vector<Record> slots;
+    HashAlgorithm algorithm;
+};
+
+/**
+ * @brief Print p50 and p99 lookup latency of hits and misses on one row
+ */
+template <typename Table>
+void probeRow(const char* name, const Table& table, const std::vector<std::string>& hits,
+              const std::vector<std::string>& misses) {
+    std::cout << std::left << std::setw(10) << name << std::right;
+    for (const std::vector<std::string>* set : {&hits, &misses}) {
+        std::vector<double> samples;
+        samples.reserve(set->size());
+        uint64_t sink = 0;
+        for (const std::string& key : *set) {
+            auto start = std::chrono::steady_clock::now();
+            sink += static_cast<uint64_t>(table.getSearchLength(key));
+            auto stop = std::chrono::steady_clock::now();
+            samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+        }
+        benchSink = benchSink + sink;
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(14) << percentile(samples, 0.50)
+                  << std::setw(14) << percentile(samples, 0.99);
+    }
+    std::cout << "\n";
+}
+
+void benchProbe() {
+    std::cout << "== probe: lookup latency by group probe engine, 87% load, "
+              << benchKeys << " keys ==\n";
+
+    // Sized so no resize happens and the final load factor is 0.87
+    HashTable ht(static_cast<int>(benchKeys / 0.87) | 1, "phone", 0.9);
+    std::vector<std::string> keys = phoneKeys(benchKeys);
+    for (const std::string& key : keys) {
+        ht.insert(Record("", key, ""));
+    }
+    std::cout << "load factor " << std::fixed << std::setprecision(3) << ht.getLoadFactor() << "\n";
+
+    const int lookups = 200000;
+    std::mt19937 rng(42);
+    std::vector<std::string> hits, misses;
+    for (int i = 0; i < lookups; i++) {
+        hits.push_back(keys[rng() % keys.size()]);
+        misses.push_back("556-" + std::to_string(rng()));
+    }
+
+    std::cout << std::left << std::setw(10) << "engine" << std::right
+              << std::setw(14) << "hit p50 ns" << std::setw(14) << "hit p99 ns"
+              << std::setw(14) << "miss p50 ns" << std::setw(14) << "miss p99 ns" << "\n";
+
+    {
+        // Same size, hasher and keys, one Record slot per probe
+        SlotArrayTable baseline(ht.getSize(), ht.getHashAlgorithm());
+        for (const std::string& key : keys) {
+            baseline.insert(Record("", key, ""));
+        }
+        probeRow("baseline", baseline, hits, misses);
+    }
+
+    const GroupProbe::Engine engines[] = {
+        GroupProbe::Engine::Scalar, GroupProbe::Engine::SSE2, GroupProbe::Engine::AVX2
+    };
+    GroupProbe::Engine original = GroupProbe::active();
+    for (GroupProbe::Engine engine : engines) {
+        if (GroupProbe::select(engine)) {
+            probeRow(GroupProbe::name(engine), ht, hits, misses);
+        }
+    }
+    GroupProbe::select(original);
+    std::cout << std::endl;
+}
+
+void benchStrategies() {
+    std::cout << "== strategies: probe distance after churn, max load 0.9 (quadratic 0.5), "
+              << benchKeys << " keys ==\n";
+
+    const ProbeStrategy strategies[] = {
+        ProbeStrategy::Linear, ProbeStrategy::Quadratic,
+        ProbeStrategy::DoubleHashing, ProbeStrategy::RobinHood
+    };
+
+    std::vector<std::string> phones = phoneKeys(benchKeys * 2);
+    std::vector<std::string> users = usernameKeys(benchKeys * 2);
+
+    std::cout << std::left << std::setw(16) << "strategy" << std::setw(10) << "keys" << std::right
+              << std::setw(8) << "load" << std::setw(11) << "mean dist" << std::setw(10) << "max dist"
+              << std::setw(12) << "insert ns" << std::setw(12) << "hit ns" << "\n";
+
+    for (ProbeStrategy strategy : strategies) {
+        for (const std::vector<std::string>* keys : {&phones, &users}) {
+            // Pre-sized to end at 85% load; quadratic probing grows past its 0.5 cap
+            HashTable ht(static_cast<int>(benchKeys / 0.85), "phone", 0.9, HashAlgorithm::WyHash, strategy);
+
+            Timer insertTimer;
+            for (int i = 0; i < benchKeys; i++) {
+                ht.insert(Record("", (*keys)[i], ""));
+            }
+            double insertNs = insertTimer.seconds() * 1e9 / benchKeys;
+
+            // Five rounds replacing 10% of the keys
+            int next = benchKeys;
+            for (int round = 0; round < 5; round++) {
+                for (int i = round * benchKeys / 10; i < (round + 1) * benchKeys / 10; i++) {
+                    ht.remove((*keys)[i]);
+                    ht.insert(Record("", (*keys)[next++], ""));
+                }
+            }
+
+            Timer hitTimer;
+            uint64_t sink = 0;
+            for (int i = benchKeys / 2; i < next; i++) {
+                sink += ht.search((*keys)[i]).has_value();
+            }
+            double hitNs = hitTimer.seconds() * 1e9 / (next - benchKeys / 2);
+
+            benchSink = benchSink + sink;
+
+            std::cout << std::left << std::setw(16) << CollisionResolution::name(strategy)
+                      << std::setw(10) << (keys == &phones ? "phone" : "username") << std::right
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(8) << ht.getLoadFactor()
+                      << std::setw(11) << ht.getMeanProbeDistance()
+                      << std::setw(10) << ht.getMaxProbeDistance()
+                      << std::setprecision(0)
+                      << std::setw(12) << insertNs << std::setw(12) << hitNs << "\n";
+        }
+    }
+    std::cout << std::endl;
+}
+
+void benchMemory() {
+    std::cout << "== memory: heap bytes per record of a directory indexed by username and phone, "
+              << benchKeys << " records ==\n";
+
+    std::vector<std::string> users = usernameKeys(benchKeys);
+    std::vector<std::string> phones = phoneKeys(benchKeys);
+    const char* streets[] = {"Oak Drive", "Cedar Court", "Birch Drive, Floor 4", "Maple Avenue"};
+
+    size_t before = heapLiveBytes;
+    Timer loadTimer;
+    {
+        PhoneDirectory directory(static_cast<int>(benchKeys / 0.7));
+        for (int i = 0; i < benchKeys; i++) {
+            directory.insert(Record(users[i], phones[i], std::to_string(100 + i % 9000) + " " + streets[i % 4]));
+        }
+        double loadSeconds = loadTimer.seconds();
+        size_t directoryBytes = heapLiveBytes - before;
+
+        std::cout << std::left << std::setw(14) << "records" << std::setw(16) << "directory MB"
+                  << std::setw(16) << "bytes/record" << std::setw(16) << "string bytes" << "load s\n"
+                  << std::setw(14) << directory.getCount()
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(16) << directoryBytes / 1048576.0
+                  << std::setw(16) << static_cast<double>(directoryBytes) / directory.getCount()
+                  << std::setw(16) << static_cast<double>(directory.getUsernameTable().getStringBytes()) / directory.getCount()
+                  << std::setprecision(2) << loadSeconds << "\n";
+
+        Timer checkTimer;
+        bool consistent = directory.checkConsistency().isConsistent();
+        std::cout << "consistency check: " << std::setprecision(1) << checkTimer.seconds() * 1e3 << " ms, "
+                  << (consistent ? "consistent" : "INCONSISTENT") << "\n";
+
+        Timer clearTimer;
+        directory.clear();
+        std::cout << "clear: " << std::setprecision(1) << clearTimer.seconds() * 1e3 << " ms\n";
+    }
+    std::cout << std::endl;
+}
+
+void benchConcurrent() {
+    std::cout << "== concurrent: 95% search / 5% insert+remove over " << benchKeys
+              << " phone keys, hardware threads: " << std::thread::hardware_concurrency() << " ==\n";
+
+    std::vector<std::string> phones = phoneKeys(benchKeys);
+    const double seconds = 0.5;
+
+    // One operation of the mix; every 20th is a write that inserts a thread's
+    // own key on odd rounds and removes it on even ones, keeping the size fixed
+    auto runMix = [&](auto& table, int thread, std::atomic<bool>& stop, uint64_t& reads, uint64_t& writes) {
+        uint64_t sink = 0;
+        uint64_t position = static_cast<uint64_t>(thread) * 7919;
+        int written = 0;
+        for (uint64_t op = 0; !stop.load(std::memory_order_relaxed); op++) {
+            if (op % 20 == 19) {
+                std::string phone = "777-" + std::to_string(thread) + "-" + std::to_string(written / 2);
+                if (written % 2 == 0) {
+                    table.insert(Record("", phone, ""));
+                } else {
+                    table.remove(phone);
+                }
+                written++;
+                writes++;
+            } else {
+                position = (position + 104729) % phones.size();
+                sink += table.search(phones[position]).has_value();
+                reads++;
+            }
+        }
+        benchSink = benchSink + sink;
+    };
+
+    std::cout << std::left << std::setw(22) << "table" << std::right << std::setw(8) << "threads"
+              << std::setw(14) << "reads M/s" << std::setw(14) << "writes M/s" << std::setw(10) << "scaling" << "\n";
+
+    // Single-threaded HashTable for reference
+    {
+        HashTable table(static_cast<int>(benchKeys / 0.7), "phone");
+        for (const std::string& phone : phones) {
+            table.insert(Record("", phone, ""));
+        }
+        std::atomic<bool> stop(false);
+        uint64_t reads = 0;
+        uint64_t writes = 0;
+        std::thread timer([&]() {
+            std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+            stop = true;
+        });
+        runMix(table, 0, stop, reads, writes);
+        timer.join();
+        std::cout << std::left << std::setw(22) << "HashTable" << std::right << std::setw(8) << 1
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(14) << reads / seconds / 1e6 << std::setw(14) << writes / seconds / 1e6 << "\n";
+    }
+
+    ConcurrentHashTable table(static_cast<int>(benchKeys / 0.7), "phone");
+    for (const std::string& phone : phones) {
+        table.insert(Record("", phone, ""));
+    }
+
+    double singleThreadReads = 0;
+    for (int threads = 1; threads <= 64; threads *= 2) {
+        std::atomic<bool> stop(false);
+        std::vector<uint64_t> reads(threads, 0);
+        std::vector<uint64_t> writes(threads, 0);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() { runMix(table, t, stop, reads[t], writes[t]); });
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        stop = true;
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        table.reclaim();  // No operations are running between rounds
+
+        uint64_t totalReads = 0;
+        uint64_t totalWrites = 0;
+        for (int t = 0; t < threads; t++) {
+            totalReads += reads[t];
+            totalWrites += writes[t];
+        }
+        double readRate = totalReads / seconds / 1e6;
+        if (threads == 1) {
+            singleThreadReads = readRate;
+        }
+        std::cout << std::left << std::setw(22) << "ConcurrentHashTable" << std::right << std::setw(8) << threads
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(14) << readRate << std::setw(14) << totalWrites / seconds / 1e6
+                  << std::setw(9) << readRate / singleThreadReads << "x\n";
+    }
+    std::cout << std::endl;
+}
+
+void benchShards() {
+    std::cout << "== shards: 95% search / 5% insert+remove, two clients per shard, " << benchKeys
+              << " records, hardware threads: " << std::thread::hardware_concurrency() << " ==\n";
+
+    std::vector<std::string> phones = phoneKeys(benchKeys);
+    std::vector<std::string> users = usernameKeys(benchKeys);
+    const double seconds = 0.5;
+    const std::string logFile = "bench_shards.wal";
+
+    std::cout << std::left << std::setw(8) << "shards" << std::right << std::setw(10) << "clients"
+              << std::setw(12) << "log" << std::setw(12) << "ops M/s" << std::setw(10) << "scaling" << "\n";
+
+    // Unlogged, then with the write-ahead log open as in the program's sharded mode
+    for (bool logged : {false, true}) {
+        double singleShardRate = 0;
+        for (int shardCount = 1; shardCount <= 16; shardCount *= 2) {
+            ShardedDirectory directory(shardCount, static_cast<int>(benchKeys / 0.7 / shardCount));
+            for (int i = 0; i < benchKeys; i++) {
+                directory.insert(Record(users[i], phones[i], ""));
+            }
+            if (logged) {
+                // Group commit as configured by default; the run stays below the checkpoint size
+                std::remove(logFile.c_str());
+                directory.openLog(logFile, 0, [](const std::vector<Record>&, uint64_t) { return true; });
+            }
+
+            int clients = shardCount * 2;
+            std::atomic<bool> stop(false);
+            std::vector<uint64_t> ops(clients, 0);
+            std::vector<std::thread> workers;
+            for (int c = 0; c < clients; c++) {
+                workers.emplace_back([&, c]() {
+                    uint64_t sink = 0;
+                    uint64_t position = static_cast<uint64_t>(c) * 7919;
+                    int written = 0;
+                    for (uint64_t op = 0; !stop.load(std::memory_order_relaxed); op++) {
+                        if (op % 20 == 19) {
+                            std::string suffix = std::to_string(c) + "-" + std::to_string(written / 2);
+                            if (written % 2 == 0) {
+                                directory.insert(Record("client" + suffix, "777-" + suffix, ""));
+                            } else {
+                                directory.removeByPhone("777-" + suffix);
+                            }
+                            written++;
+                        } else {
+                            position = (position + 104729) % phones.size();
+                            sink += directory.searchByPhone(phones[position]).has_value();
+                        }
+                        ops[c]++;
+                    }
+                    benchSink = benchSink + sink;
+                });
+            }
+            std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+            stop = true;
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+
+            uint64_t total = 0;
+            for (uint64_t clientOps : ops) {
+                total += clientOps;
+            }
+            double rate = total / seconds / 1e6;
+            if (shardCount == 1) {
+                singleShardRate = rate;
+            }
+            std::cout << std::left << std::setw(8) << shardCount << std::right << std::setw(10) << clients
+                      << std::setw(12) << (logged ? "group 2ms" : "off")
+                      << std::fixed << std::setprecision(3) << std::setw(12) << rate
+                      << std::setprecision(2) << std::setw(9) << rate / singleShardRate << "x\n";
+
+            if (shardCount == 4 && !logged) {
+                // Per-shard phone index statistics, totalled the way displayStatistics shows one table
+                std::vector<TableStats> phoneShards;
+                for (const ShardStats& stats : directory.getShardStats()) {
+                    phoneShards.push_back(stats.phone);
+                }
+                std::cout << "    " << std::left << std::setw(8) << "shard" << std::right << std::setw(10) << "size"
+                          << std::setw(10) << "count" << std::setw(8) << "load" << std::setw(12) << "avg probes\n";
+                for (size_t i = 0; i <= phoneShards.size(); i++) {
+                    TableStats stats = i < phoneShards.size() ? phoneShards[i] : ShardedDirectory::combine(phoneShards);
+                    std::cout << "    " << std::left << std::setw(8) << (i < phoneShards.size() ? std::to_string(i) : "total")
+                              << std::right << std::setw(10) << stats.size << std::setw(10) << stats.count
+                              << std::setprecision(2) << std::setw(8) << stats.loadFactor
+                              << std::setw(11) << stats.averageSearchLength << "\n";
+                }
+            }
+        }
+    }
+    std::remove(logFile.c_str());
+    std::cout << std::endl;
+}
+
+void benchBatch() {
+    std::cout << "== batch: lookups per second, search loop vs searchBatch of 64, "
+              << benchKeys << " keys ==\n";
+
+    // A table of many keys spills out of the last level cache, so lookups miss
+    std::vector<std::string> phones = phoneKeys(benchKeys);
+    HashTable table(static_cast<int>(benchKeys / 0.7) | 1, "phone");
+    for (const std::string& phone : phones) {
+        table.insert(Record("", phone, ""));
+    }
+
+    const int lookups = 2000000;
+    const int batchSize = 64;
+    std::mt19937 rng(7);
+    std::vector<std::string_view> keys;
+    keys.reserve(lookups);
+    for (int i = 0; i < lookups; i++) {
+        keys.push_back(phones[rng() % phones.size()]);
+    }
+
+    uint64_t sink = 0;
+    Timer loopTimer;
+    for (std::string_view key : keys) {
+        sink += table.search(key).has_value();
+    }
+    double loopSeconds = loopTimer.seconds();
+
+    std::vector<std::optional<RecordView>> results(batchSize);
+    Timer batchTimer;
+    for (int start = 0; start + batchSize <= lookups; start += batchSize) {
+        table.searchBatch(keys.data() + start, batchSize, results.data());
+        for (const std::optional<RecordView>& result : results) {
+            sink += result.has_value();
+        }
+    }
+    double batchSeconds = batchTimer.seconds();
+    benchSink = benchSink + sink;
+
+    std::cout << std::left << std::setw(10) << "method" << std::right << std::setw(14) << "M lookups/s" << "\n"
+              << std::fixed << std::setprecision(2)
+              << std::left << std::setw(10) << "search" << std::right << std::setw(14) << lookups / loopSeconds / 1e6 << "\n"
+              << std::left << std::setw(10) << "batch" << std::right << std::setw(14) << lookups / batchSeconds / 1e6
+              << "   (" << loopSeconds / batchSeconds << "x)\n" << std::endl;
+}
+
+void benchLoad() {
+    std::cout << "== load: directory startup from a file, per-record insert vs bulkInsert, "
+              << benchKeys << " lines, hardware threads: " << std::thread::hardware_concurrency() << " ==\n";
+
+    std::vector<std::string> users = usernameKeys(benchKeys);
+    std::vector<std::string> phones = phoneKeys(benchKeys);
+    std::vector<Record> generated;
+    generated.reserve(benchKeys);
+    for (int i = 0; i < benchKeys; i++) {
+        generated.push_back(Record(users[i], phones[i], std::to_string(100 + i % 9000) + " Oak Drive"));
+    }
+    const std::string filename = "bench_load.txt";
+    FileHandler::writeRecordsToFile(generated, filename);
+    generated = std::vector<Record>();
+
+    Timer parseTimer;
+    std::vector<Record> records = FileHandler::readRecordsFromFile(filename);
+    double parseSeconds = parseTimer.seconds();
+    std::remove(filename.c_str());
+
+    // Same starting size as the console application
+    PhoneDirectory looped(101);
+    Timer loopTimer;
+    for (const Record& record : records) {
+        looped.insert(record);
+    }
+    double loopSeconds = loopTimer.seconds();
+
+    PhoneDirectory bulk(101);
+    Timer bulkTimer;
+    int loaded = bulk.bulkInsert(records);
+    double bulkSeconds = bulkTimer.seconds();
+
+    std::cout << std::left << std::setw(10) << "step" << std::right << std::setw(12) << "seconds" << "\n"
+              << std::fixed << std::setprecision(3)
+              << std::left << std::setw(10) << "parse" << std::right << std::setw(12) << parseSeconds << "\n"
+              << std::left << std::setw(10) << "insert" << std::right << std::setw(12) << loopSeconds << "\n"
+              << std::left << std::setw(10) << "bulk" << std::right << std::setw(12) << bulkSeconds
+              << "   (" << std::setprecision(2) << loopSeconds / bulkSeconds << "x, "
+              << loaded << " records, consistent: "
+              << (bulk.checkConsistency().isConsistent() ? "yes" : "NO") << ")\n" << std::endl;
+}
+
+void benchParse() {
+    std::cout << "== parse: file parsing throughput, getline loop vs memory-mapped parser, "
+              << benchKeys << " lines ==\n";
+
+    // Written in large blocks; every tenth address is quoted and holds a comma
+    const std::string filename = "bench_parse.txt";
+    {
+        std::ofstream file(filename, std::ios::binary);
+        std::string block;
+        for (int i = 0; i < benchKeys; i++) {
+            block += "user" + std::to_string(i) + ",555-" + std::to_string(1000000 + i) + ",";
+            block += (i % 10 == 0) ? "\"" + std::to_string(i % 9000) + " Oak Drive, Apt 2\"\r\n"
+                                   : std::to_string(i % 9000) + " Oak Drive\r\n";
+            if (block.size() > (1 << 20)) {
+                file << block;
+                block.clear();
+            }
+        }
+        file << block;
+    }
+
+    // The previous FileHandler loop: getline, a stringstream and six erases per line
+    Timer getlineTimer;
+    uint64_t getlineRecords = 0;
+    uint64_t bytes = 0;
+    {
+        std::ifstream file(filename);
+        std::string line;
+        while (std::getline(file, line)) {
+            bytes += line.size() + 1;
+            if (line.empty()) continue;
+            std::stringstream ss(line);
+            std::string username, phone, address;
+            std::getline(ss, username, ',');
+            std::getline(ss, phone, ',');
+            std::getline(ss, address);
+            username.erase(0, username.find_first_not_of(" \t\r\n"));
+            username.erase(username.find_last_not_of(" \t\r\n") + 1);
+            phone.erase(0, phone.find_first_not_of(" \t\r\n"));
+            phone.erase(phone.find_last_not_of(" \t\r\n") + 1);
+            address.erase(0, address.find_first_not_of(" \t\r\n"));
+            address.erase(address.find_last_not_of(" \t\r\n") + 1);
+            if (!username.empty() && !phone.empty()) {
+                Record record(username, phone, address);
+                benchSink = benchSink + record.address.size();
+                getlineRecords++;
+            }
+        }
+    }
+    double getlineSeconds = getlineTimer.seconds();
+
+    // Parsed in slices of whole lines so the views of a multi-GB file need not all be held
+    Timer mappedTimer;
+    uint64_t mappedRecords = 0;
+    {
+        MappedFile file;
+        file.open(filename);
+        std::string_view text = file.text();
+        std::vector<RecordView> records;
+        std::deque<std::string> unescaped;
+        const size_t SLICE = 64 << 20;
+        while (!text.empty()) {
+            size_t cut = text.size() <= SLICE ? text.size() : text.find('\n', SLICE) + 1;
+            if (cut == 0) {
+                cut = text.size();
+            }
+            records.clear();
+            FileHandler::parseRecords(text.substr(0, cut), records, unescaped);
+            mappedRecords += records.size();
+            for (const RecordView& record : records) {
+                benchSink = benchSink + record.address.size();
+            }
+            text.remove_prefix(cut);
+        }
+    }
+    double mappedSeconds = mappedTimer.seconds();
+    std::remove(filename.c_str());
+
+    double megabytes = bytes / 1e6;
+    std::cout << std::left << std::setw(10) << "parser" << std::right << std::setw(10) << "MB/s"
+              << std::setw(12) << "records" << "\n" << std::fixed << std::setprecision(1)
+              << std::left << std::setw(10) << "getline" << std::right << std::setw(10) << megabytes / getlineSeconds
+              << std::setw(12) << getlineRecords << "\n"
+              << std::left << std::setw(10) << "mapped" << std::right << std::setw(10) << megabytes / mappedSeconds
+              << std::setw(12) << mappedRecords << "   (" << std::setprecision(2)
+              << getlineSeconds / mappedSeconds << "x, " << std::setprecision(0) << megabytes << " MB)\n" << std::endl;
+}
+
+void benchSnapshot() {
+    std::cout << "== snapshot: cold start of a directory from CSV vs binary snapshot, "
+              << benchKeys << " records ==\n";
+
+    const std::string csvFile = "bench_snapshot.txt";
+    const std::string snapshotFile = "bench_snapshot.bin";
+    {
+        std::vector<std::string> users = usernameKeys(benchKeys);
+        std::vector<std::string> phones = phoneKeys(benchKeys);
+        std::vector<Record> records;
+        records.reserve(benchKeys);
+        for (int i = 0; i < benchKeys; i++) {
+            records.push_back(Record(users[i], phones[i], std::to_string(100 + i % 9000) + " Oak Drive"));
+        }
+        FileHandler::writeRecordsToFile(records, csvFile);
+
+        PhoneDirectory directory(101);
+        directory.bulkInsert(records);
+        directory.saveSnapshot(snapshotFile);
+    }
+
+    double csvSeconds;
+    {
+        PhoneDirectory directory(101);
+        Timer timer;
+        directory.loadFromFile(csvFile);
+        csvSeconds = timer.seconds();
+    }
+    double snapshotSeconds;
+    bool consistent;
+    {
+        PhoneDirectory directory(101);
+        Timer timer;
+        directory.loadSnapshot(snapshotFile);
+        snapshotSeconds = timer.seconds();
+        consistent = directory.getCount() == benchKeys && directory.searchByPhone(phoneKeys(1)[0]).has_value();
+    }
+
+    std::ifstream csvSize(csvFile, std::ios::binary | std::ios::ate);
+    std::ifstream snapshotSize(snapshotFile, std::ios::binary | std::ios::ate);
+    double csvMegabytes = static_cast<double>(csvSize.tellg()) / 1e6;
+    double snapshotMegabytes = static_cast<double>(snapshotSize.tellg()) / 1e6;
+    csvSize.close();
+    snapshotSize.close();
+    std::remove(csvFile.c_str());
+    std::remove(snapshotFile.c_str());
+
+    std::cout << std::left << std::setw(10) << "format" << std::right << std::setw(10) << "MB"
+              << std::setw(12) << "load ms" << "\n" << std::fixed << std::setprecision(1)
+              << std::left << std::setw(10) << "csv" << std::right << std::setw(10) << csvMegabytes
+              << std::setw(12) << csvSeconds * 1000 << "\n"
+              << std::left << std::setw(10) << "snapshot" << std::right << std::setw(10) << snapshotMegabytes
+              << std::setw(12) << snapshotSeconds * 1000 << "   (" << std::setprecision(1)
+              << csvSeconds / snapshotSeconds << "x, lookups after load: " << (consistent ? "ok" : "FAILED")
+              << ")\n" << std::endl;
+}
+
+void benchLog() {
+    const int syncedOps = std::min(benchKeys, 20000);  // One fsync each: keep the run short
+    std::cout << "== log: sustained inserts with a write-ahead log, " << benchKeys << " records ("
+              << syncedOps << " with an fsync per change) ==\n";
+
+    const std::string logFile = "bench_log.wal";
+    const std::string snapshotFile = "bench_log.snapshot";
+    std::vector<std::string> users = usernameKeys(benchKeys);
+    std::vector<std::string> phones = phoneKeys(benchKeys);
+
+    struct Mode {
+        const char* name;
+        int ops;
+        bool logged;
+        std::chrono::microseconds commitDelay;
+    };
+    const Mode modes[] = {
+        {"no log", benchKeys, false, std::chrono::microseconds(0)},
+        {"fsync each", syncedOps, true, std::chrono::microseconds(0)},
+        {"group 2ms", benchKeys, true, std::chrono::microseconds(2000)},
+        {"group 10ms", benchKeys, true, std::chrono::microseconds(10000)},
+    };
+
+    std::cout << std::left << std::setw(12) << "mode" << std::right << std::setw(12) << "ops/s"
+              << std::setw(10) << "fsyncs" << std::setw(14) << "ops/fsync" << "\n";
+    for (const Mode& mode : modes) {
+        std::remove(logFile.c_str());
+        std::remove(snapshotFile.c_str());
+        PhoneDirectory directory(101);
+        LogOptions options;
+        options.commitDelay = mode.commitDelay;
+        options.checkpointBytes = UINT64_MAX;  // Measure appends only
+        if (mode.logged) {
+            directory.openLog(logFile, snapshotFile, options);
+        }
+
+        Timer timer;
+        for (int i = 0; i < mode.ops; i++) {
+            directory.insert(Record(users[i], phones[i], "12 Oak Drive"));
+        }
+        uint64_t syncs = 0;
+        if (directory.getLog()) {
+            directory.getLog()->sync();
+            syncs = directory.getLog()->getSyncCount();
+        }
+        double seconds = timer.seconds();
+
+        std::cout << std::left << std::setw(12) << mode.name << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(12) << mode.ops / seconds << std::setw(10) << syncs << std::setw(14)
+                  << (syncs > 0 ? static_cast<double>(mode.ops) / syncs : 0.0) << "\n";
+    }
+    std::remove(logFile.c_str());
+    std::remove(snapshotFile.c_str());
+    std::cout << std::endl;
+}
+
+void benchSave() {
+    std::cout << "== save: writing " << benchKeys << " records to CSV ==\n";
+
+    const std::string filename = "bench_save.txt";
+    PhoneDirectory directory(101);
+    {
+        std::vector<std::string> users = usernameKeys(benchKeys);
+        std::vector<std::string> phones = phoneKeys(benchKeys);
+        std::vector<Record> records;
+        records.reserve(benchKeys);
+        for (int i = 0; i < benchKeys; i++) {
+            records.push_back(Record(users[i], phones[i], std::to_string(100 + i % 9000) + " Oak Drive"));
+        }
+        directory.bulkInsert(records);
+    }
+    const HashTable& table = directory.getUsernameTable();
+
+    // The previous saveToFile: truncate in place and flush every line with std::endl
+    Timer endlTimer;
+    {
+        std::ofstream file(filename);
+        for (int i = 0; i < table.getSlotCount(); i++) {
+            uint32_t id = table.getIdAt(i);
+            if (id != RecordStore::NO_RECORD) {
+                RecordView rec = table.getStore().view(id);
+                file << rec.username << "," << rec.phoneNumber << "," << rec.address << std::endl;
+            }
+        }
+    }
+    double endlSeconds = endlTimer.seconds();
+
+    std::cout.setstate(std::ios::failbit);
+    Timer atomicTimer;
+    table.saveToFile(filename);
+    double atomicSeconds = atomicTimer.seconds();
+    Timer unchangedTimer;
+    table.saveIfModified(filename);
+    double unchangedSeconds = unchangedTimer.seconds();
+    std::cout.clear();
+    std::remove(filename.c_str());
+
+    std::cout << std::left << std::setw(34) << "method" << std::right << std::setw(12) << "ms" << "\n"
+              << std::fixed << std::setprecision(1)
+              << std::left << std::setw(34) << "ofstream + endl per line" << std::right << std::setw(12)
+              << endlSeconds * 1000 << "\n"
+              << std::left << std::setw(34) << "1 MB blocks, fsync, rename" << std::right << std::setw(12)
+              << atomicSeconds * 1000 << "   (" << endlSeconds / atomicSeconds << "x)\n"
+              << std::left << std::setw(34) << "saveIfModified, nothing changed" << std::right << std::setw(12)
+              << unchangedSeconds * 1000 << "\n" << std::endl;
+}
+
+void benchRecordFile() {
+    std::cout << "== files: persisting " << benchKeys << " records as two files vs one ==\n";
+
+    const std::string usernameFile = "bench_records_username.txt";
+    const std::string phoneFile = "bench_records_phone.txt";
+    const std::string recordFile = "bench_records.txt";
+    std::cout.setstate(std::ios::failbit);
+    double twoSaveSeconds;
+    double oneSaveSeconds;
+    {
+        std::vector<std::string> users = usernameKeys(benchKeys);
+        std::vector<std::string> phones = phoneKeys(benchKeys);
+        std::vector<Record> records;
+        records.reserve(benchKeys);
+        for (int i = 0; i < benchKeys; i++) {
+            records.push_back(Record(users[i], phones[i], std::to_string(100 + i % 9000) + " Oak Drive"));
+        }
+        PhoneDirectory directory(101);
+        directory.bulkInsert(records);
+
+        Timer twoTimer;
+        directory.getUsernameTable().saveToFile(usernameFile);
+        directory.getPhoneTable().saveToFile(phoneFile);
+        twoSaveSeconds = twoTimer.seconds();
+        Timer oneTimer;
+        directory.getUsernameTable().saveToFile(recordFile);
+        oneSaveSeconds = oneTimer.seconds();
+    }
+
+    double twoLoadSeconds;
+    DriftReport drift;
+    {
+        PhoneDirectory directory(101);
+        Timer timer;
+        directory.loadLegacyFiles(usernameFile, phoneFile, drift);
+        twoLoadSeconds = timer.seconds();
+    }
+    double oneLoadSeconds;
+    {
+        PhoneDirectory directory(101);
+        Timer timer;
+        directory.loadFromFile(recordFile);
+        oneLoadSeconds = timer.seconds();
+    }
+    std::cout.clear();
+    std::remove(usernameFile.c_str());
+    std::remove(phoneFile.c_str());
+    std::remove(recordFile.c_str());
+
+    std::cout << std::left << std::setw(26) << "layout" << std::right << std::setw(12) << "save ms"
+              << std::setw(12) << "load ms" << "\n" << std::fixed << std::setprecision(1)
+              << std::left << std::setw(26) << "two files + drift check" << std::right << std::setw(12)
+              << twoSaveSeconds * 1000 << std::setw(12) << twoLoadSeconds * 1000 << "\n"
+              << std::left << std::setw(26) << "one record file" << std::right << std::setw(12)
+              << oneSaveSeconds * 1000 << std::setw(12) << oneLoadSeconds * 1000 << "   (drift: "
+              << (drift.hasDrift() ? "FOUND" : "none") << ")\n" << std::endl;
+}
+
+void benchStats() {
+    std::cout << "== stats: statistics of both indexes over " << benchKeys << " records ==\n";
+
+    PhoneDirectory directory(101);
+    {
+        std::vector<std::string> users = usernameKeys(benchKeys);
+        std::vector<std::string> phones = phoneKeys(benchKeys);
+        std::vector<Record> records;
+        records.reserve(benchKeys);
+        for (int i = 0; i < benchKeys; i++) {
+            records.push_back(Record(users[i], phones[i], ""));
+        }
+        directory.bulkInsert(records);
+        for (int i = 0; i < benchKeys; i += 10) {
+            directory.removeByUsername(users[i]);
+        }
+    }
+
+    // The previous statistics: look up every key of both tables
+    Timer probeTimer;
+    double probed = 0.0;
+    for (const HashTable* table : {&directory.getUsernameTable(), &directory.getPhoneTable()}) {
+        long long total = 0;
+        for (int i = 0; i < table->getSlotCount(); i++) {
+            uint32_t id = table->getIdAt(i);
+            if (id != RecordStore::NO_RECORD) {
+                RecordView rec = table->getStore().view(id);
+                total += table->getSearchLength(table == &directory.getUsernameTable() ? rec.username
+                                                                                        : rec.phoneNumber);
+            }
+        }
+        probed += static_cast<double>(total) / table->getCount();
+    }
+    double probeSeconds = probeTimer.seconds();
+
+    Timer statsTimer;
+    TableStats username = directory.getUsernameTable().getStats();
+    TableStats phone = directory.getPhoneTable().getStats();
+    double statsSeconds = statsTimer.seconds();
+
+    std::cout << std::left << std::setw(30) << "method" << std::right << std::setw(14) << "ms"
+              << std::setw(16) << "avg search" << "\n" << std::fixed << std::setprecision(3)
+              << std::left << std::setw(30) << "probe every key" << std::right << std::setw(14)
+              << probeSeconds * 1000 << std::setw(16) << probed / 2 << "\n"
+              << std::left << std::setw(30) << "maintained (getStats)" << std::right << std::setw(14)
+              << statsSeconds * 1000 << std::setw(16)
+              << (username.averageSearchLength + phone.averageSearchLength) / 2 << "\n" << std::endl;
+}
+
+void benchChurn() {
+    const int ROUNDS = 30;
+    std::cout << "== churn: " << benchKeys << " keys, " << ROUNDS << " rounds replacing 10% of them, linear probing ==\n";
+
+    std::vector<std::string> phones = phoneKeys(benchKeys * 5);
+    std::vector<std::string> misses(phones.end() - benchKeys / 10, phones.end());  // Never inserted
+
+    std::cout << std::left << std::setw(20) << "compaction" << std::right << std::setw(12) << "churn ns"
+              << std::setw(12) << "miss ns" << std::setw(13) << "miss probes" << std::setw(12) << "tombstones"
+              << std::setw(13) << "compactions" << "\n";
+    for (double ratio : {1.0, 0.5, 0.25}) {
+        HashTable ht(101, "phone", 0.75);
+        ht.setMaxTombstoneRatio(ratio);
+        for (int i = 0; i < benchKeys; i++) {
+            ht.insert(Record("", phones[i], ""));
+        }
+
+        double freshMiss = ht.getMissSearchLength();
+        int next = benchKeys;
+        int batch = benchKeys / 10;
+        Timer churnTimer;
+        for (int round = 0; round < ROUNDS; round++) {
+            for (int i = next - benchKeys; i < next - benchKeys + batch; i++) {
+                ht.remove(phones[i]);
+            }
+            for (int i = 0; i < batch; i++, next++) {
+                ht.insert(Record("", phones[next], ""));
+            }
+        }
+        double churnNs = churnTimer.seconds() * 1e9 / (2.0 * ROUNDS * batch);
+
+        Timer missTimer;
+        uint64_t found = 0;
+        for (const std::string& key : misses) {
+            found += ht.contains(key);
+        }
+        double missNs = missTimer.seconds() * 1e9 / misses.size();
+
+        TableStats stats = ht.getStats();
+        SampledStats sampled = ht.getSampledStats();
+        std::cout << std::left << std::setw(20) << (ratio < 1.0 ? "at " + std::to_string(static_cast<int>(ratio * 100)) + "% of free" : "off") << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(12) << churnNs << std::setw(12) << missNs
+                  << std::setw(13) << sampled.missSearchLength << std::setw(12) << stats.tombstones
+                  << std::setw(13) << stats.compactions << "   (fresh table: " << freshMiss << " probes"
+                  << (found ? ", unexpected hit" : "") << ")\n";
+    }
+    std::cout << std::endl;
+}
+
+void benchFilter() {
+    const int LOOKUPS = 2000000;
+    std::cout << "== filter: " << benchKeys << " phone keys at load 0.9, linear probing, "
+              << LOOKUPS << " lookups of which 90% miss ==\n";
+
+    std::vector<std::string> phones = phoneKeys(benchKeys * 2);
+    std::mt19937 rng(7);
+    std::vector<const std::string*> lookups(LOOKUPS);
+    for (const std::string*& key : lookups) {
+        bool hit = rng() % 10 == 0;
+        key = &phones[(hit ? 0 : benchKeys) + rng() % benchKeys];  // Second half is never inserted
+    }
+
+    std::cout << std::left << std::setw(12) << "filter" << std::right << std::setw(12) << "FP rate"
+              << std::setw(14) << "bytes/record" << std::setw(12) << "lookup ns" << std::setw(13)
+              << "miss probes" << "\n";
+    for (int bits : {0, 8, 12, 16}) {
+        HashTable ht(static_cast<int>(benchKeys / 0.9) + 2, "phone", 0.9);
+        ht.setFilterBits(bits);
+        for (int i = 0; i < benchKeys; i++) {
+            ht.insert(Record("", phones[i], ""));
+        }
+
+        Timer timer;
+        uint64_t found = 0;
+        for (const std::string* key : lookups) {
+            found += ht.contains(*key);
+        }
+        double lookupNs = timer.seconds() * 1e9 / LOOKUPS;
+        benchSink = benchSink + found;
+
+        TableStats stats = ht.getStats();
+        SampledStats sampled = ht.getSampledStats();
+        std::cout << std::left << std::setw(12) << (bits > 0 ? std::to_string(bits) + " bits" : "off")
+                  << std::right << std::fixed << std::setprecision(2) << std::setw(11)
+                  << sampled.filterFalsePositiveRate * 100 << "%" << std::setw(14)
+                  << static_cast<double>(stats.filterBytes) / stats.count << std::setprecision(1)
+                  << std::setw(12) << lookupNs << std::setw(13) << sampled.missSearchLength
+                  << "   (load " << std::setprecision(2) << stats.loadFactor << ")\n";
+    }
+    std::cout << std::endl;
+}
+
+void benchCuckoo() {
+    const int LOOKUPS = 200000;
+    std::cout << "== cuckoo: lookup latency percentiles, linear probing vs cuckoo, "
+              << benchKeys << " phone keys ==\n";
+
+    std::vector<std::string> keys = phoneKeys(benchKeys * 2);  // Second half is never inserted
+    std::mt19937 rng(42);
+    std::vector<const std::string*> hits, misses;
+    for (int i = 0; i < LOOKUPS; i++) {
+        hits.push_back(&keys[rng() % benchKeys]);
+        misses.push_back(&keys[benchKeys + rng() % benchKeys]);
+    }
+
+    std::cout << std::left << std::setw(8) << "load" << std::setw(10) << "engine" << std::right
+              << std::setw(10) << "insert ns" << std::setw(10) << "hit p50" << std::setw(10) << "hit p99"
+              << std::setw(11) << "hit p99.9" << std::setw(10) << "miss p50" << std::setw(10) << "miss p99"
+              << std::setw(12) << "miss p99.9" << std::setw(12) << "max probes" << "\n";  // Longest hit
+    for (double load : {0.5, 0.75, 0.85, 0.9, 0.95}) {
+        for (ProbeStrategy strategy : {ProbeStrategy::Linear, ProbeStrategy::Cuckoo}) {
+            // Sized so the keys end at the target load without growing
+            HashTable ht(static_cast<int>(benchKeys / load) + 1, "phone", 0.95, HashAlgorithm::WyHash, strategy);
+            Timer insertTimer;
+            for (int i = 0; i < benchKeys; i++) {
+                ht.insert(Record("", keys[i], ""));
+            }
+            double insertNs = insertTimer.seconds() * 1e9 / benchKeys;
+
+            std::cout << std::left << std::fixed << std::setprecision(2) << std::setw(8) << ht.getLoadFactor()
+                      << std::setw(10) << CollisionResolution::name(strategy) << std::right
+                      << std::setprecision(0) << std::setw(10) << insertNs;
+            for (const std::vector<const std::string*>* set : {&hits, &misses}) {
+                std::vector<double> samples;
+                samples.reserve(set->size());
+                uint64_t found = 0;
+                for (const std::string* key : *set) {
+                    auto start = std::chrono::steady_clock::now();
+                    found += ht.contains(*key);
+                    auto stop = std::chrono::steady_clock::now();
+                    samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+                }
+                benchSink = benchSink + found;
+                std::cout << std::setw(10) << percentile(samples, 0.50) << std::setw(10)
+                          << percentile(samples, 0.99) << std::setw(set == &hits ? 11 : 12)
+                          << percentile(samples, 0.999);
+            }
+            std::cout << std::setw(12) << ht.getMaxProbeDistance() + 1 << "\n";
+        }
+    }
+    std::cout << std::endl;
+}
+
+void benchChaining() {
+    const int LOOKUPS = 1000000;
+    std::cout << "== chaining: open addressing vs separate chaining with pooled nodes, "
+              << benchKeys << " phone keys ==\n";
+
+    std::vector<std::string> keys = phoneKeys(benchKeys * 2);  // Second half is never inserted
+    std::mt19937 rng(42);
+    std::vector<const std::string*> hits, misses;
+    for (int i = 0; i < LOOKUPS; i++) {
+        hits.push_back(&keys[rng() % benchKeys]);
+        misses.push_back(&keys[benchKeys + rng() % benchKeys]);
+    }
+
+    struct Run {
+        ProbeStrategy strategy;
+        double load;
+    };
+    // Open addressing stops at 0.95; chaining also runs the burst loads above 1
+    const Run RUNS[] = {
+        {ProbeStrategy::Linear, 0.5}, {ProbeStrategy::RobinHood, 0.5}, {ProbeStrategy::Chaining, 0.5},
+        {ProbeStrategy::Linear, 0.9}, {ProbeStrategy::RobinHood, 0.9}, {ProbeStrategy::Chaining, 0.9},
+        {ProbeStrategy::Chaining, 1.5}, {ProbeStrategy::Chaining, 3.0},
+    };
+
+    std::cout << std::left << std::setw(8) << "load" << std::setw(12) << "engine" << std::right
+              << std::setw(11) << "insert ns" << std::setw(9) << "hit ns" << std::setw(9) << "miss ns"
+              << std::setw(12) << "hit probes" << std::setw(13) << "miss probes"
+              << std::setw(12) << "B/record" << "\n";  // Heap bytes, records included
+    for (const Run& run : RUNS) {
+        size_t before = heapLiveBytes;
+        // Sized so the keys end at the target load without growing
+        HashTable ht(static_cast<int>(benchKeys / run.load) + 1, "phone", std::max(run.load, 0.95),
+                     HashAlgorithm::WyHash, run.strategy);
+        Timer insertTimer;
+        for (int i = 0; i < benchKeys; i++) {
+            ht.insert(Record("", keys[i], ""));
+        }
+        double insertNs = insertTimer.seconds() * 1e9 / benchKeys;
+        double bytesPerRecord = static_cast<double>(heapLiveBytes - before) / benchKeys;
+
+        std::cout << std::left << std::fixed << std::setprecision(2) << std::setw(8) << ht.getLoadFactor()
+                  << std::setw(12) << CollisionResolution::name(run.strategy) << std::right
+                  << std::setprecision(0) << std::setw(11) << insertNs;
+        for (const std::vector<const std::string*>* set : {&hits, &misses}) {
+            uint64_t found = 0;
+            Timer timer;
+            for (const std::string* key : *set) {
+                found += ht.contains(*key);
+            }
+            benchSink = benchSink + found;
+            std::cout << std::setw(9) << timer.seconds() * 1e9 / set->size();
+        }
+        TableStats stats = ht.getStats();
+        std::cout << std::setprecision(2) << std::setw(12) << stats.averageSearchLength << std::setw(13)
+                  << ht.getMissSearchLength() << std::setprecision(1) << std::setw(12) << bytesPerRecord << "\n";
+    }
+    std::cout << std::endl;
+}
+
+struct Benchmark {
+    const char* name;
+    void (*run)();
+};
+
+const Benchmark BENCHMARKS[] = {
+    {"hashers", benchHashers},
+    {"probe", benchProbe},
+    {"strategies", benchStrategies},
+    {"memory", benchMemory},
+    {"concurrent", benchConcurrent},
+    {"shards", benchShards},
+    {"batch", benchBatch},
+    {"load", benchLoad},
+    {"parse", benchParse},
+    {"snapshot", benchSnapshot},
+    {"log", benchLog},
+    {"save", benchSave},
+    {"files", benchRecordFile},
+    {"stats", benchStats},
+    {"churn", benchChurn},
+    {"filter", benchFilter},
+    {"cuckoo", benchCuckoo},
+    {"chaining", benchChaining},
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<const char*> names;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--keys=", 7) == 0) {
+            benchKeys = std::atoi(argv[i] + 7);
+        } else {
+            names.push_back(argv[i]);
+        }
+    }
+
+    bool ranAny = false;
+    for (const Benchmark& bench : BENCHMARKS) {
+        bool selected = names.empty();
+        for (const char* name : names) {
+            if (std::strcmp(name, bench.name) == 0) {
+                selected = true;
+            }
+        }
+        if (selected) {
+            bench.run();
+            ranAny = true;
+        }
+    }
+
+    if (!ranAny) {
+        std::cerr << "Unknown benchmark. Available:";
+        for (const Benchmark& bench : BENCHMARKS) {
+            std::cerr << " " << bench.name;
+        }
+        std::cerr << std::endl;
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef ATOMIC_FILE_H
+#define ATOMIC_FILE_H
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief File rewritten through a temporary that replaces it on commit
+ * Writes go to "<filename>.tmp", gathered into WRITE_BLOCK byte blocks.
+ * commit() syncs the temporary and renames it over the target, so a crash
+ * or failed save at any point leaves the old file intact. If the object
+ * is destroyed without a successful commit, the temporary is deleted.
+ */
+class AtomicFile {
+public:
+    static const size_t WRITE_BLOCK = 1 << 20;
+
+    /**
+     * @brief Create the temporary next to the target
+     * @param filename Target file path
+     */
+    explicit AtomicFile(const std::string& filename);
+
+    /**
+     * @brief Destructor - deletes the temporary unless committed
+     */
+    ~AtomicFile();
+
+    AtomicFile(const AtomicFile&) = delete;
+    AtomicFile& operator=(const AtomicFile&) = delete;
+
+    bool isOpen() const { return file.is_open(); }
+
+    /**
+     * @brief Append bytes, written out once a whole block is gathered
+     */
+    void write(std::string_view bytes) {
+        block.append(bytes.data(), bytes.size());
+        if (block.size() >= WRITE_BLOCK) {
+            flushBlock();
+        }
+    }
+
+    /**
+     * @brief Get the stream, for writers that seek (gathered bytes are written first)
+     */
+    std::ofstream& stream();
+
+    /**
+     * @brief Write everything, sync it and replace the target
+     * @return false if any step failed; the target is then unchanged
+     */
+    bool commit();
+
+private:
+    std::string target;
+    std::string temporary;
+    std::ofstream file;
+    std::string block;        // Bytes not yet written to file
+    bool committed = false;
+
+    void flushBlock();
+};
+
+#endif // ATOMIC_FILE_H
\ No newline at end of file
@@ -0,0 +1,1544 @@
+#ifndef BASIC_HASHTABLE_H
+#define BASIC_HASHTABLE_H
+
+#include "hashfunction.h"
+#include "collision.h"
+#include "group_probe.h"
+#include "bloom_filter.h"
+#include "snapshot.h"
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <utility>
+#include <type_traits>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Detects a policy declaring is_transparent (heterogeneous lookup)
+ */
+template <class T, class = void>
+struct IsTransparent : std::false_type {};
+
+template <class T>
+struct IsTransparent<T, std::void_t<typename T::is_transparent>> : std::true_type {};
+
+/**
+ * @brief Detects a KeyOf policy with prefetch(value), which starts loading
+ * the key of a value that is stored elsewhere (batch lookups)
+ */
+template <class KeyOf, class Value, class = void>
+struct HasKeyPrefetch : std::false_type {};
+
+template <class KeyOf, class Value>
+struct HasKeyPrefetch<KeyOf, Value,
+                      std::void_t<decltype(std::declval<const KeyOf&>().prefetch(std::declval<const Value&>()))>>
+    : std::true_type {};
+
+/**
+ * @brief Generic open addressing hash table engine
+ *
+ * Stores values of type Value; the key of a value is extracted at compile
+ * time by the KeyOf policy (a functor returning the key of a value), so a
+ * table indexed by username and one indexed by phone number are separate
+ * instantiations with no runtime key selection. Hash must return a 64-bit
+ * hash of a key and Equal compares two keys.
+ *
+ * The table grows automatically once the load factor exceeds
+ * maxLoadFactor. Growth is incremental: the previous table is kept
+ * alongside the new one and a bounded number of its slots are
+ * migrated on every insert/search, so no single operation pays for
+ * a full rehash.
+ *
+ * Slots are stored as a structure of arrays: a dense control byte per
+ * slot (empty, deleted, or full plus 7 bits of the key's hash) and a
+ * parallel array of values. Probing scans control bytes only and reads
+ * a value's key when its fingerprint matches. Control bytes are compared
+ * a group at a time by GroupProbe (SSE2/AVX2 when available); the first
+ * GroupProbe::MAX_WIDTH - 1 bytes are mirrored past the end of the array
+ * so a group load starting near the end wraps around without a branch.
+ *
+ * The probe sequence is chosen per table (ProbeStrategy): linear,
+ * quadratic, double hashing, or Robin Hood. Robin Hood keeps entries
+ * ordered by displacement and deletes by shifting followers back, so it
+ * never leaves tombstones; the other strategies use lazy deletion. Their
+ * tombstones lengthen every unsuccessful lookup, so once they make up
+ * maxTombstoneRatio of the slots not holding a value, the next insert
+ * first rehashes the table in place (compact), turning them back into
+ * empty slots without allocating.
+ *
+ * When both Hash and Equal declare is_transparent, search, contains,
+ * remove, findIndex and getSearchLength also accept any key type they
+ * support (e.g. std::string_view or const char* for std::string keys),
+ * so the lookup path builds no temporary Key and never allocates.
+ *
+ * An optional Bloom filter (setFilterBits) records the hash of every key
+ * placed in the table. Lookups consult it before probing, so most keys
+ * that are absent are rejected after one cache line instead of a walk to
+ * the first empty slot. It is consulted only while no resize is in
+ * progress: growth starts an empty filter sized for the new table, which
+ * fills as values migrate. Compaction rebuilds it, dropping the bits of
+ * removed keys; so does an insert once the filter has taken half again
+ * the keys it was sized for, which bounds the stale bits left by
+ * removals in tables that never compact.
+ *
+ * findBatch looks up many keys at once, interleaving their memory
+ * accesses: all keys are hashed and their home slots prefetched before
+ * any is probed, so the cache misses of a batch overlap.
+ *
+ * Bulk loads pair reserve with insertHashed: the table is sized once,
+ * key hashes may be computed up front (hashOf is safe to call from
+ * several threads), and each value is placed by a single probe that
+ * also detects duplicates.
+ *
+ * saveSlots and loadSlots copy the slot arrays to and from a snapshot as
+ * raw bytes, so a saved table is restored without rehashing any key.
+ *
+ * Every placement, move and removal updates a histogram of probe
+ * distances (slots a value sits past its home along its probe sequence),
+ * so the average search length, the largest distance and the tombstone
+ * count are read in O(1) instead of by probing every key.
+ *
+ * Slot indices in [0, getSize()) refer to the current table and indices
+ * in [getSize(), getSlotCount()) to the table being migrated.
+ */
+template <class Key, class Value, class KeyOf,
+          class Hash = DefaultHash<Key>,
+          class Equal = std::equal_to<Key>,
+          class Allocator = std::allocator<Value>>
+class BasicHashTable {
+public:
+    typedef Key KeyType;
+    typedef Value ValueType;
+
+    // Enables the lookup overloads taking a key of type K other than Key
+    template <class K>
+    using EnableLookup = typename std::enable_if<
+        !std::is_same<K, Key>::value && IsTransparent<Hash>::value && IsTransparent<Equal>::value,
+        int>::type;
+
+private:
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<uint8_t> CtrlAllocator;
+
+    // Control byte values; full slots hold a 7-bit fingerprint (high bit clear)
+    enum : uint8_t {
+        CTRL_EMPTY = 0x80,    // Never used
+        CTRL_DELETED = 0xFE   // Tombstone left by remove or migration
+    };
+
+    /**
+     * @brief Slot storage of one table generation
+     */
+    struct SlotArray {
+        std::vector<uint8_t, CtrlAllocator> ctrl;  // Control byte per slot, then cloned head bytes
+        std::vector<Value, Allocator> values;      // Value per slot, parallel to ctrl
+        int tombstones = 0;                        // Slots whose control byte is CTRL_DELETED
+
+        explicit SlotArray(const Allocator& allocator)
+            : ctrl(CtrlAllocator(allocator)), values(allocator) {}
+
+        /**
+         * @brief Reset to slotCount empty slots
+         */
+        void assign(int slotCount) {
+            ctrl.assign(slotCount + GroupProbe::MAX_WIDTH - 1, CTRL_EMPTY);
+            values.assign(slotCount, Value());
+            tombstones = 0;
+        }
+
+        /**
+         * @brief Free slot storage
+         */
+        void release() {
+            std::vector<uint8_t, CtrlAllocator>(ctrl.get_allocator()).swap(ctrl);
+            std::vector<Value, Allocator>(values.get_allocator()).swap(values);
+            tombstones = 0;
+        }
+
+        /**
+         * @brief Set a control byte and its mirrored copies past the end
+         */
+        void setCtrl(int index, uint8_t value) {
+            int slotCount = static_cast<int>(values.size());
+            tombstones += (value == CTRL_DELETED) - (ctrl[index] == CTRL_DELETED);
+            ctrl[index] = value;
+            for (int i = index; i < GroupProbe::MAX_WIDTH - 1; i += slotCount) {
+                ctrl[slotCount + i] = value;
+            }
+        }
+    };
+
+    /**
+     * @brief Home slot and fingerprint of a key
+     */
+    struct KeyHash {
+        uint64_t hash;
+        int home;
+        int step;             // Double hashing step, 1 otherwise
+        uint8_t fingerprint;
+    };
+
+    Hash hasher;                   // Hash policy
+    KeyOf keyOf;                   // Key extraction policy
+    Equal equal;                   // Key comparison policy
+
+    SlotArray table;               // Hash table storage
+    int size;                      // Table size
+    int count;                     // Number of active values (both tables)
+    double maxLoadFactor;          // Growth threshold for count / size
+    double maxTombstoneRatio;      // Compaction threshold for tombstones / (size - count)
+    int compactions;               // In-place rehashes run so far
+    BloomFilter filter;            // Hashes of placed keys; empty when disabled
+    int filterKeys;                // Hashes added since the filter was last emptied
+    ProbeStrategy strategy;        // Probe sequence and deletion policy
+
+    SlotArray oldTable;            // Previous table while a resize is in progress
+    int oldSize;                   // Size of oldTable (0 when not resizing)
+    int migrateIndex;              // Next oldTable slot to migrate
+
+    static const int MIGRATION_BATCH = 8;  // Old slots migrated per operation
+    static const int BATCH_WINDOW = 16;    // Keys whose cache misses findBatch overlaps
+    static const int MISS_SAMPLES = 4096;  // Hashes sampled by the miss and filter estimates
+
+public:
+    static const int DISTANCE_BUCKETS = 32;  // Histogram buckets; the last holds every larger distance
+
+    typedef std::array<int, DISTANCE_BUCKETS> DistanceHistogram;
+
+private:
+    // Probe distance bookkeeping of the values in both tables, each
+    // measured within its own table
+    DistanceHistogram distanceCounts;  // Values per probe distance
+    long long totalDistance;           // Sum of every value's distance
+    mutable int maxDistance;           // Largest distance, -1 until recounted
+
+    static bool isFull(uint8_t ctrl) { return (ctrl & 0x80) == 0; }
+
+public:
+    /**
+     * @brief Constructor
+     * @param tableSize Initial number of slots
+     * @param maxLoad Load factor that triggers growth
+     * @param probeStrategy Probe sequence and deletion policy
+     * @param hash Hash policy instance
+     * @param keyOfValue Key extraction policy instance
+     * @param keyEqual Key comparison policy instance
+     * @param allocator Allocator for slot storage
+     */
+    explicit BasicHashTable(int tableSize = 16, double maxLoad = 0.75,
+                            ProbeStrategy probeStrategy = ProbeStrategy::Linear,
+                            const Hash& hash = Hash(), const KeyOf& keyOfValue = KeyOf(),
+                            const Equal& keyEqual = Equal(), const Allocator& allocator = Allocator())
+        : hasher(hash), keyOf(keyOfValue), equal(keyEqual), table(allocator),
+          size(tableSize > 0 ? tableSize : 1), count(0), maxLoadFactor(0.75),
+          maxTombstoneRatio(0.5), compactions(0), filterKeys(0), strategy(probeStrategy),
+          oldTable(allocator), oldSize(0), migrateIndex(0),
+          distanceCounts(), totalDistance(0), maxDistance(0) {
+        setMaxLoadFactor(maxLoad);
+
+        // Quadratic probing and double hashing only reach every slot they need
+        // when the table size is prime
+        if (strategy == ProbeStrategy::Quadratic || strategy == ProbeStrategy::DoubleHashing) {
+            size = nextPrime(size);
+        }
+        table.assign(size);  // Initialize with empty slots
+    }
+
+    /**
+     * @brief Insert a value
+     * @param value Value to insert
+     * @return true if inserted, false if its key is already present
+     */
+    bool insert(const Value& value) {
+        return insert(Value(value));
+    }
+
+    bool insert(Value&& value) {
+        if (!prepareKey(keyOf(value))) {
+            return false;
+        }
+        commitInsert(std::move(value));
+        return true;
+    }
+
+    /**
+     * @brief First phase of a two-phase insert
+     * Checks that the key is absent and grows the table if one more value
+     * would pass the load threshold, so the matching commitInsert neither
+     * allocates nor fails. No slot is written, so abandoning the insert
+     * after this call leaves nothing to undo.
+     * @param key Key of the value to insert
+     * @return true if the key is absent and room for it is reserved
+     */
+    bool prepareInsert(const Key& key) { return prepareKey(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    bool prepareInsert(const K& key) { return prepareKey(key); }
+
+    /**
+     * @brief Second phase of a two-phase insert
+     * The table must not be modified between prepareInsert and this call.
+     * @param value Value whose key was passed to prepareInsert
+     */
+    void commitInsert(Value&& value) {
+        place(std::move(value));
+        count++;
+    }
+
+    /**
+     * @brief Hash a key with the table's hash policy
+     * Does not touch the table; may run on several threads at once.
+     * @param key Key to hash
+     * @return Hash for insertHashed
+     */
+    uint64_t hashOf(const Key& key) const { return hasher(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    uint64_t hashOf(const K& key) const { return hasher(key); }
+
+    /**
+     * @brief Grow once so that valueCount values fit without a resize
+     * Finishes any in-progress migration, then rehashes straight into a
+     * table large enough for valueCount values at the load threshold.
+     * @param valueCount Total number of values the table should hold
+     */
+    void reserve(int valueCount) {
+        finishResize();
+        if (valueCount > maxLoadFactor * size) {
+            beginResize(nextPrime(static_cast<int>(valueCount / maxLoadFactor) + 1));
+            finishResize();
+        }
+    }
+
+    /**
+     * @brief Insert a value whose key hash is already known, in one probe
+     * The walk that finds the value's slot compares every fingerprint it
+     * passes, so a duplicate is detected without a separate lookup. Grows
+     * with a full rehash instead of incrementally; call reserve first.
+     * @param hash hashOf(key of value)
+     * @param value Value to insert
+     * @return Slot index of the inserted value, -1 if its key is present
+     */
+    int insertHashed(uint64_t hash, Value&& value) {
+        finishResize();
+        if (needsCompaction()) {
+            compact();
+        }
+        if (filterIsStale()) {
+            rebuildFilter(filter.getBitsPerKey());
+        }
+        if (count + 1 > maxLoadFactor * size) {
+            beginResize(nextPrime(size * 2 + 1));
+            finishResize();
+        }
+
+        KeyHash h = splitHash(hash, size);
+        decltype(auto) key = keyOf(value);
+        int index = h.home;
+        bool filtered = filter.isEnabled() && !filter.mayContain(hash);  // Key certainly absent
+
+        if (strategy == ProbeStrategy::RobinHood) {
+            // Entries are ordered by displacement: the key cannot sit past
+            // the first entry closer to its home than the key would be
+            int distance = 0;
+            while (isFull(table.ctrl[index]) && displacement(index) >= distance) {
+                if (!filtered && table.ctrl[index] == h.fingerprint && equal(keyOf(table.values[index]), key)) {
+                    return -1;
+                }
+                index = CollisionResolution::nextProbe(index, size);
+                distance++;
+            }
+            addToFilter(hash);
+            placeRobinHood(std::move(value), h.fingerprint, index, distance);
+            count++;
+            return index;
+        }
+
+        // Walk to the end of the chain; reuse its first tombstone
+        int target = -1;
+        int targetDistance = 0;
+        for (int attempt = 1; attempt <= size; attempt++) {
+            uint8_t ctrl = table.ctrl[index];
+            if (ctrl == CTRL_EMPTY || ctrl == CTRL_DELETED) {
+                if (target == -1) {
+                    target = index;
+                    targetDistance = attempt - 1;
+                }
+                if (ctrl == CTRL_EMPTY) {
+                    break;
+                }
+            } else if (filtered) {
+                // No duplicate to find; stop at the first free slot
+            } else if (ctrl == h.fingerprint && equal(keyOf(table.values[index]), key)) {
+                return -1;
+            }
+            if (filtered && target != -1) {
+                break;
+            }
+            index = probeIndex(h, attempt, size);
+        }
+
+        table.setCtrl(target, h.fingerprint);
+        table.values[target] = std::move(value);
+        addDistance(targetDistance);
+        addToFilter(hash);
+        count++;
+        return target;
+    }
+
+    /**
+     * @brief Search for a value by key
+     * Also advances an in-progress migration
+     * @param key Search key
+     * @return Pointer to value if found, nullptr otherwise
+     */
+    Value* search(const Key& key) { return searchKey(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    Value* search(const K& key) { return searchKey(key); }
+
+    const Value* search(const Key& key) const { return searchKey(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    const Value* search(const K& key) const { return searchKey(key); }
+
+    /**
+     * @brief Check whether a key is present
+     * Does not advance migration
+     * @param key Search key
+     * @return true if found
+     */
+    bool contains(const Key& key) const { return containsKey(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    bool contains(const K& key) const { return containsKey(key); }
+
+    /**
+     * @brief Delete a value by key
+     * Lazy deletion, or backward shift for Robin Hood
+     * @param key Key to delete
+     * @return true if deleted, false if not found
+     */
+    bool remove(const Key& key) { return removeKey(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    bool remove(const K& key) { return removeKey(key); }
+
+    /**
+     * @brief Remove the value at a slot index returned by findIndex
+     * @param index Slot index of an occupied slot
+     */
+    void erase(int index) {
+        eraseAt(index);
+        count--;
+    }
+
+    /**
+     * @brief Find slot index of a key
+     * @param key Search key
+     * @param searchLength Output parameter for probe count
+     * @return Slot index if found, -1 otherwise
+     */
+    int findIndex(const Key& key, int& searchLength) const { return findKey(key, searchLength); }
+
+    template <class K, EnableLookup<K> = 0>
+    int findIndex(const K& key, int& searchLength) const { return findKey(key, searchLength); }
+
+    /**
+     * @brief Find the slot indexes of many keys, overlapping their cache misses
+     * Works through the keys in windows of BATCH_WINDOW: hashes every key
+     * and prefetches its home control bytes and values, then checks each
+     * home group for a fingerprint match and prefetches the matching
+     * value's key, then probes each key. Does not advance migration.
+     * @param keys Keys to look up
+     * @param keyCount Number of keys
+     * @param indices Output: slot index per key, -1 if not found
+     */
+    void findBatch(const Key* keys, int keyCount, int* indices) const { findKeys(keys, keyCount, indices); }
+
+    template <class K, EnableLookup<K> = 0>
+    void findBatch(const K* keys, int keyCount, int* indices) const { findKeys(keys, keyCount, indices); }
+
+    /**
+     * @brief Get search length (number of probes) for a key
+     * @param key Search key
+     * @return Number of probes, -1 if not found
+     */
+    int getSearchLength(const Key& key) const { return searchLengthOf(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    int getSearchLength(const K& key) const { return searchLengthOf(key); }
+
+    /**
+     * @brief Calculate average search length
+     * A value found in its own table takes its probe distance plus one
+     * probes; values still waiting in the old table of a resize cost a
+     * miss in the new table on top of that, which is not counted.
+     * @return Average number of probes across all values
+     */
+    double getAverageSearchLength() const {
+        return (count > 0) ? getMeanProbeDistance() + 1.0 : 0.0;
+    }
+
+    /**
+     * @brief Get the largest probe distance of any value
+     * Maintained on every change, except after the farthest of several
+     * values beyond the histogram's last bucket is removed; the next call
+     * then recounts it from the slots.
+     * @return Probes beyond the home slot (0 = at home)
+     */
+    int getMaxProbeDistance() const {
+        if (maxDistance < 0) {
+            maxDistance = 0;
+            for (int i = 0; i < getSlotCount(); i++) {
+                if (isOccupied(i) && distanceAt(i) > maxDistance) {
+                    maxDistance = distanceAt(i);
+                }
+            }
+        }
+        return maxDistance;
+    }
+
+    /**
+     * @brief Get the mean probe distance across all values
+     * @return Average probes beyond the home slot
+     */
+    double getMeanProbeDistance() const {
+        return (count > 0) ? static_cast<double>(totalDistance) / count : 0.0;
+    }
+
+    /**
+     * @brief Get the number of values at each probe distance
+     * @return Bucket i counts values i slots past their home; the last
+     *         bucket also counts every value farther away
+     */
+    const DistanceHistogram& getDistanceHistogram() const { return distanceCounts; }
+
+    /**
+     * @brief Get the number of tombstones in both tables
+     */
+    int getTombstoneCount() const { return table.tombstones + oldTable.tombstones; }
+
+    /**
+     * @brief Estimate the probes taken by an unsuccessful lookup
+     * Walks the probe sequences of up to MISS_SAMPLES absent keys (missHash)
+     * to their first empty slot, counting it, through both tables while
+     * resizing. Tombstones do not end a walk, so their build-up shows here
+     * long before it shows in successful lookups. Keys the lookup filter
+     * rejects take no probes.
+     * @return Mean probes per miss
+     */
+    double getMissSearchLength() const {
+        long long probes = 0;
+        int samples = 0;
+        for (int sample = 0; sample < MISS_SAMPLES; sample++) {
+            uint64_t hash = 0;
+            if (!missHash(sample, hash)) {
+                continue;
+            }
+            samples++;
+            if (oldSize == 0 && filter.isEnabled() && !filter.mayContain(hash)) {
+                continue;
+            }
+            probes += missLength(table, size, splitHash(hash, size));
+            if (oldSize > 0) {
+                probes += missLength(oldTable, oldSize, splitHash(hash, oldSize));
+            }
+        }
+        return (samples > 0) ? static_cast<double>(probes) / samples : 0.0;
+    }
+
+    /**
+     * @brief Estimate the share of absent keys the lookup filter lets through
+     * Uses the same absent keys as getMissSearchLength, hashed by the
+     * table's own hasher, so a hasher whose outputs crowd into part of the
+     * filter shows up here.
+     * @return Fraction of samples the filter accepts, 0 without a filter
+     */
+    double getFilterFalsePositiveRate() const {
+        if (!filter.isEnabled()) {
+            return 0.0;
+        }
+        int accepted = 0;
+        int samples = 0;
+        for (int sample = 0; sample < MISS_SAMPLES; sample++) {
+            uint64_t hash = 0;
+            if (missHash(sample, hash)) {
+                accepted += filter.mayContain(hash);
+                samples++;
+            }
+        }
+        return (samples > 0) ? static_cast<double>(accepted) / samples : 0.0;
+    }
+
+    /**
+     * @brief Rehash the current table in place, dropping its tombstones
+     * Finishes any migration first. Values are re-placed within the same
+     * slot array: each is moved to the first slot of its probe sequence
+     * that no re-placed value holds yet, swapping with a value still
+     * waiting there, so no second array is needed. Slot indices from
+     * before the call are invalidated. Robin Hood tables have no
+     * tombstones and are left as they are.
+     */
+    void compact() {
+        finishResize();
+        if (strategy == ProbeStrategy::RobinHood || table.tombstones == 0) {
+            return;
+        }
+
+        // Tombstones become empty; values are marked as waiting to be placed
+        for (int i = 0; i < size; i++) {
+            uint8_t ctrl = table.ctrl[i];
+            if (ctrl == CTRL_DELETED) {
+                table.setCtrl(i, CTRL_EMPTY);
+            } else if (isFull(ctrl)) {
+                table.setCtrl(i, CTRL_DELETED);
+            }
+        }
+        distanceCounts.fill(0);
+        totalDistance = 0;
+        maxDistance = 0;
+        resetFilter();
+
+        for (int i = 0; i < size; i++) {
+            while (table.ctrl[i] == CTRL_DELETED) {
+                KeyHash h = hashKey(keyOf(table.values[i]), size);
+                int target = h.home;
+                int attempt = 0;
+                while (isFull(table.ctrl[target])) {
+                    target = probeIndex(h, ++attempt, size);
+                }
+                addDistance(attempt);
+                addToFilter(h.hash);
+
+                if (target == i) {
+                    table.setCtrl(i, h.fingerprint);
+                } else if (table.ctrl[target] == CTRL_EMPTY) {
+                    table.values[target] = std::move(table.values[i]);
+                    table.values[i] = Value();
+                    table.setCtrl(target, h.fingerprint);
+                    table.setCtrl(i, CTRL_EMPTY);
+                } else {
+                    // Take the target; its waiting value comes back to slot i
+                    std::swap(table.values[i], table.values[target]);
+                    table.setCtrl(target, h.fingerprint);
+                }
+            }
+        }
+        compactions++;
+    }
+
+    /**
+     * @brief Get the number of in-place rehashes run so far
+     */
+    int getCompactionCount() const { return compactions; }
+
+    /**
+     * @brief Enable, resize or disable the lookup filter
+     * Finishes any migration, then builds the filter from every value,
+     * sized for the values the table holds before it next grows.
+     * @param bitsPerValue Filter bits per value; 0 disables the filter
+     */
+    void setFilterBits(int bitsPerValue) {
+        finishResize();
+        if (bitsPerValue <= 0) {
+            filter.release();
+            return;
+        }
+        rebuildFilter(bitsPerValue);
+    }
+
+    /**
+     * @brief Get the lookup filter's bits per value, 0 when disabled
+     */
+    int getFilterBits() const { return filter.getBitsPerKey(); }
+
+    /**
+     * @brief Get the memory taken by the lookup filter
+     */
+    size_t getFilterBytes() const { return filter.getBytes(); }
+
+    double getMaxTombstoneRatio() const { return maxTombstoneRatio; }
+
+    /**
+     * @brief Set the share of non-value slots tombstones may take before
+     * an insert compacts the table
+     * @param ratio Value clamped to [0.05, 1.0]; 1.0 never compacts
+     */
+    void setMaxTombstoneRatio(double ratio) {
+        if (ratio < 0.05) ratio = 0.05;
+        if (ratio > 1.0) ratio = 1.0;
+        maxTombstoneRatio = ratio;
+    }
+
+    /**
+     * @brief Remove every value, keeping the current size
+     */
+    void clear() {
+        table.assign(size);
+        oldTable.release();
+        oldSize = 0;
+        migrateIndex = 0;
+        count = 0;
+        distanceCounts.fill(0);
+        totalDistance = 0;
+        maxDistance = 0;
+        resetFilter();
+    }
+
+    /**
+     * @brief Check whether a slot holds a value
+     * @param index Slot index in [0, getSlotCount())
+     */
+    bool isOccupied(int index) const { return isFull(ctrlAt(index)); }
+
+    /**
+     * @brief Check whether a slot holds a tombstone
+     * @param index Slot index in [0, getSlotCount())
+     */
+    bool isTombstone(int index) const { return ctrlAt(index) == CTRL_DELETED; }
+
+    /**
+     * @brief Access the value stored in a slot
+     * @param index Slot index in [0, getSlotCount())
+     */
+    Value& valueAt(int index) {
+        return (index < size) ? table.values[index] : oldTable.values[index - size];
+    }
+
+    const Value& valueAt(int index) const {
+        return (index < size) ? table.values[index] : oldTable.values[index - size];
+    }
+
+    int getCount() const { return count; }
+    int getSize() const { return size; }
+    int getSlotCount() const { return size + oldSize; }
+    ProbeStrategy getProbeStrategy() const { return strategy; }
+    const Hash& getHash() const { return hasher; }
+    const KeyOf& getKeyOf() const { return keyOf; }
+
+    /**
+     * @brief Get current load factor
+     * @return Load factor (count / size)
+     */
+    double getLoadFactor() const {
+        return (size > 0) ? (static_cast<double>(count) / size) : 0.0;
+    }
+
+    double getMaxLoadFactor() const { return maxLoadFactor; }
+
+    /**
+     * @brief Set load factor threshold that triggers growth
+     * Quadratic probing is capped at 0.5, where a prime table size
+     * guarantees the sequence reaches a free slot
+     * @param maxLoad Value clamped to [0.1, 0.95]
+     */
+    void setMaxLoadFactor(double maxLoad) {
+        if (maxLoad < 0.1) maxLoad = 0.1;
+        if (maxLoad > 0.95) maxLoad = 0.95;
+        if (strategy == ProbeStrategy::Quadratic && maxLoad > 0.5) maxLoad = 0.5;
+        maxLoadFactor = maxLoad;
+    }
+
+    bool isResizing() const { return oldSize > 0; }
+
+    /**
+     * @brief Get progress of the current incremental resize
+     * @return Fraction of old slots migrated, 1.0 when not resizing
+     */
+    double getMigrationProgress() const {
+        return (oldSize > 0) ? (static_cast<double>(migrateIndex) / oldSize) : 1.0;
+    }
+
+    /**
+     * @brief Write the slot arrays exactly as laid out in memory
+     * Both tables of an in-progress resize are written with the migration
+     * position, so a loaded table resumes the resize where it stopped.
+     * Values are copied as bytes and must be trivially copyable.
+     */
+    void saveSlots(SnapshotWriter& writer) const {
+        static_assert(std::is_trivially_copyable<Value>::value, "slots are saved as raw bytes");
+        writer.writeValue(static_cast<int32_t>(strategy));
+        writer.writeValue(maxLoadFactor);
+        writer.writeValue(static_cast<int32_t>(size));
+        writer.writeValue(static_cast<int32_t>(count));
+        writer.writeValue(static_cast<int32_t>(oldSize));
+        writer.writeValue(static_cast<int32_t>(migrateIndex));
+        writer.writeValue(distanceCounts);
+        writer.writeValue(totalDistance);
+        writer.writeValue(static_cast<int32_t>(maxDistance));
+        writer.writeValue(static_cast<int32_t>(filter.getBitsPerKey()));
+        writer.writeValue(static_cast<int32_t>(filterKeys));
+        writer.writeArray(filter.getBlocks());
+        writer.writeArray(table.ctrl);
+        writer.writeArray(table.values);
+        if (oldSize > 0) {
+            writer.writeArray(oldTable.ctrl);
+            writer.writeArray(oldTable.values);
+        }
+    }
+
+    /**
+     * @brief Replace the contents with slot arrays written by saveSlots
+     * The hash and key policies are this table's own; the caller checks
+     * that the snapshot was written with the same ones.
+     * @param isValid Check every stored value must pass before its key is
+     *        read, such as a record ID naming a live record
+     * @return false, leaving the table unchanged, if the data is malformed or
+     *         was written with another probe strategy
+     */
+    template <class Check>
+    bool loadSlots(SnapshotReader& reader, const Check& isValid) {
+        int32_t loadedStrategy = 0, loadedSize = 0, loadedCount = 0, loadedOldSize = 0, loadedMigrate = 0;
+        int32_t loadedMaxDistance = 0, loadedFilterBits = 0, loadedFilterKeys = 0;
+        std::vector<BloomFilter::Block> loadedBlocks;
+        double loadedMaxLoad = 0.0;
+        DistanceHistogram loadedCounts;
+        long long loadedTotal = 0;
+        if (!reader.readValue(loadedStrategy) || !reader.readValue(loadedMaxLoad) ||
+            !reader.readValue(loadedSize) || !reader.readValue(loadedCount) ||
+            !reader.readValue(loadedOldSize) || !reader.readValue(loadedMigrate) ||
+            !reader.readValue(loadedCounts) || !reader.readValue(loadedTotal) ||
+            !reader.readValue(loadedMaxDistance) || !reader.readValue(loadedFilterBits) ||
+            !reader.readValue(loadedFilterKeys) ||
+            !reader.readArray(loadedBlocks, static_cast<uint64_t>(INT32_MAX))) {
+            return false;
+        }
+        long long histogramCount = 0;
+        for (int bucketCount : loadedCounts) {
+            histogramCount += bucketCount;
+        }
+        if (loadedStrategy != static_cast<int32_t>(strategy) || loadedSize < 1 || loadedCount < 0 ||
+            loadedOldSize < 0 || loadedMigrate < 0 || loadedMigrate > loadedOldSize ||
+            histogramCount != loadedCount || loadedTotal < 0 || loadedMaxDistance < -1 ||
+            loadedFilterKeys < 0) {
+            return false;
+        }
+
+        SlotArray loaded(table.values.get_allocator());
+        SlotArray loadedOld(table.values.get_allocator());
+        BloomFilter loadedFilter;
+        if (!readSlots(reader, loaded, loadedSize) || !allValid(loaded, loadedSize, isValid) ||
+            (loadedOldSize > 0 && (!readSlots(reader, loadedOld, loadedOldSize) ||
+                                   !allValid(loadedOld, loadedOldSize, isValid))) ||
+            !loadedFilter.adopt(std::move(loadedBlocks), loadedFilterBits)) {
+            return false;
+        }
+
+        std::swap(table, loaded);
+        std::swap(oldTable, loadedOld);
+        std::swap(filter, loadedFilter);
+        filterKeys = loadedFilterKeys;
+        size = loadedSize;
+        count = loadedCount;
+        oldSize = loadedOldSize;
+        migrateIndex = loadedMigrate;
+        maxLoadFactor = loadedMaxLoad;
+        distanceCounts = loadedCounts;
+        totalDistance = loadedTotal;
+        maxDistance = loadedMaxDistance;
+        return true;
+    }
+
+    /**
+     * @brief Smallest prime >= n
+     */
+    static int nextPrime(int n) {
+        if (n <= 2) {
+            return 2;
+        }
+        if (n % 2 == 0) {
+            n++;
+        }
+        for (;; n += 2) {
+            bool prime = true;
+            for (int d = 3; d * d <= n; d += 2) {
+                if (n % d == 0) {
+                    prime = false;
+                    break;
+                }
+            }
+            if (prime) {
+                return n;
+            }
+        }
+    }
+
+private:
+    template <class K>
+    Value* searchKey(const K& key) {
+        migrateStep(MIGRATION_BATCH);
+
+        int searchLength = 0;
+        int index = findKey(key, searchLength);
+        return (index != -1) ? &valueAt(index) : nullptr;
+    }
+
+    template <class K>
+    const Value* searchKey(const K& key) const {
+        int searchLength = 0;
+        int index = findKey(key, searchLength);
+        return (index != -1) ? &valueAt(index) : nullptr;
+    }
+
+    template <class K>
+    bool prepareKey(const K& key) {
+        migrateStep(MIGRATION_BATCH);
+
+        // Check for duplicate
+        int dummyLength = 0;
+        if (findKey(key, dummyLength) != -1) {
+            return false;
+        }
+
+        if (oldSize == 0 && needsCompaction()) {
+            compact();
+        }
+        if (oldSize == 0 && filterIsStale()) {
+            rebuildFilter(filter.getBitsPerKey());
+        }
+
+        // Grow before the load factor would pass the threshold
+        if (count + 1 > maxLoadFactor * size) {
+            if (oldSize > 0) {
+                finishResize();
+            }
+            if (count + 1 > maxLoadFactor * size) {
+                beginResize(nextPrime(size * 2 + 1));
+                migrateStep(MIGRATION_BATCH);
+            }
+        }
+        return true;
+    }
+
+    template <class K>
+    bool containsKey(const K& key) const {
+        int searchLength = 0;
+        return findKey(key, searchLength) != -1;
+    }
+
+    template <class K>
+    bool removeKey(const K& key) {
+        int searchLength = 0;
+        int index = findKey(key, searchLength);
+
+        if (index != -1) {
+            erase(index);
+            return true;
+        }
+
+        return false;
+    }
+
+    template <class K>
+    int searchLengthOf(const K& key) const {
+        int searchLength = 0;
+        int index = findKey(key, searchLength);
+        return (index != -1) ? searchLength : -1;
+    }
+
+    /**
+     * @brief Find slot index of a key in the combined index space
+     */
+    template <class K>
+    int findKey(const K& key, int& searchLength) const {
+        searchLength = 0;
+        uint64_t hash = hasher(key);
+        if (oldSize == 0 && filter.isEnabled() && !filter.mayContain(hash)) {
+            return -1;  // Certainly absent; no slot probed
+        }
+
+        int index = probeHashed(table, size, splitHash(hash, size), key, searchLength);
+        if (index != -1 || oldSize == 0) {
+            return index;
+        }
+
+        // Not yet migrated values still live in the old table
+        index = probeHashed(oldTable, oldSize, splitHash(hash, oldSize), key, searchLength);
+        return (index != -1) ? size + index : -1;
+    }
+
+    /**
+     * @brief Values the table holds before it next grows, as the filter is sized
+     */
+    int filterCapacity(int slotCount) const {
+        return static_cast<int>(maxLoadFactor * slotCount) + 1;
+    }
+
+    void addToFilter(uint64_t hash) {
+        if (filter.isEnabled()) {
+            filter.add(hash);
+            filterKeys++;
+        }
+    }
+
+    /**
+     * @brief Empty the lookup filter, sized for the current table
+     */
+    void resetFilter() {
+        if (filter.isEnabled()) {
+            filter.reset(filterCapacity(size), filter.getBitsPerKey());
+        }
+        filterKeys = 0;
+    }
+
+    /**
+     * @brief Refill the lookup filter from the current table's values
+     * No resize may be in progress.
+     */
+    void rebuildFilter(int bitsPerValue) {
+        filter.reset(filterCapacity(size), bitsPerValue);
+        filterKeys = 0;
+        for (int i = 0; i < size; i++) {
+            if (isFull(table.ctrl[i])) {
+                addToFilter(hasher(keyOf(table.values[i])));
+            }
+        }
+    }
+
+    /**
+     * @brief Check whether removed keys' bits may be crowding the filter
+     */
+    bool filterIsStale() const {
+        return filter.isEnabled() && filterKeys > filterCapacity(size) + filterCapacity(size) / 2;
+    }
+
+    /**
+     * @brief Check whether tombstones passed maxTombstoneRatio of the free slots
+     */
+    bool needsCompaction() const {
+        return maxTombstoneRatio < 1.0 && table.tombstones > maxTombstoneRatio * (size - count);
+    }
+
+    /**
+     * @brief Golden ratio step for the miss estimates
+     * Steps cover the 64-bit range evenly.
+     */
+    static uint64_t missSample(int sample) {
+        return (static_cast<uint64_t>(sample) + 1) * 0x9E3779B97F4A7C15ull;
+    }
+
+    /**
+     * @brief Hash of a sample key for the miss estimates
+     * Integer keys are golden ratio steps and string keys short decimal
+     * numbers, hashed by the table's hasher so samples land where real
+     * misses do. Other key types fall back to the step itself as the hash.
+     * @param hash Output: hash of the sample key
+     * @return false if the sample key is stored in the table
+     */
+    bool missHash(int sample, uint64_t& hash) const {
+        uint64_t step = missSample(sample);
+        if constexpr (std::is_integral<Key>::value) {
+            Key key = static_cast<Key>(step);
+            hash = hasher(key);
+            return !containsKey(key);
+        } else if constexpr (std::is_constructible<Key, const std::string&>::value) {
+            std::string text = std::to_string(step >> 40);
+            Key key(text);
+            hash = hasher(key);
+            return !containsKey(key);
+        } else {
+            hash = step;
+            return true;
+        }
+    }
+
+    /**
+     * @brief Probes a lookup missing in one table takes, up to and including
+     * the first empty slot
+     */
+    int missLength(const SlotArray& slots, int slotCount, const KeyHash& h) const {
+        for (int attempt = 0; attempt < slotCount; attempt++) {
+            if (slots.ctrl[probeIndex(h, attempt, slotCount)] == CTRL_EMPTY) {
+                return attempt + 1;
+            }
+        }
+        return slotCount;
+    }
+
+    uint8_t ctrlAt(int index) const {
+        return (index < size) ? table.ctrl[index] : oldTable.ctrl[index - size];
+    }
+
+    void setCtrlAt(int index, uint8_t value) {
+        if (index < size) {
+            table.setCtrl(index, value);
+        } else {
+            oldTable.setCtrl(index - size, value);
+        }
+    }
+
+    /**
+     * @brief Read one table generation written by saveSlots
+     */
+    static bool readSlots(SnapshotReader& reader, SlotArray& slots, int slotCount) {
+        uint64_t ctrlCount = static_cast<uint64_t>(slotCount) + GroupProbe::MAX_WIDTH - 1;
+        if (!reader.readArray(slots.ctrl, ctrlCount) || slots.ctrl.size() != ctrlCount ||
+            !reader.readArray(slots.values, static_cast<uint64_t>(slotCount)) ||
+            slots.values.size() != static_cast<size_t>(slotCount)) {
+            return false;
+        }
+        slots.tombstones = static_cast<int>(
+            std::count(slots.ctrl.begin(), slots.ctrl.begin() + slotCount, uint8_t(CTRL_DELETED)));
+        return true;
+    }
+
+    /**
+     * @brief Check every value of occupied slots read by readSlots
+     */
+    template <class Check>
+    static bool allValid(const SlotArray& slots, int slotCount, const Check& isValid) {
+        for (int i = 0; i < slotCount; i++) {
+            if (isFull(slots.ctrl[i]) && !isValid(slots.values[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Look up a batch of keys in prefetching windows
+     */
+    template <class K>
+    void findKeys(const K* keys, int keyCount, int* indices) const {
+        if (oldSize > 0) {
+            // Keys may sit in either table while resizing; look them up one by one
+            for (int i = 0; i < keyCount; i++) {
+                int searchLength = 0;
+                indices[i] = findKey(keys[i], searchLength);
+            }
+            return;
+        }
+
+        KeyHash hashes[BATCH_WINDOW];
+        int candidates[BATCH_WINDOW];
+        bool absent[BATCH_WINDOW];  // Rejected by the filter
+        const bool grouped = (strategy == ProbeStrategy::Linear || strategy == ProbeStrategy::RobinHood);
+        GroupProbe::MatchFunction match = GroupProbe::matcher();
+        const int span = (size < GroupProbe::width()) ? size : GroupProbe::width();
+        const uint32_t spanMask = (span >= 32) ? 0xFFFFFFFFu : ((1u << span) - 1);
+
+        for (int start = 0; start < keyCount; start += BATCH_WINDOW) {
+            int window = (keyCount - start < BATCH_WINDOW) ? keyCount - start : BATCH_WINDOW;
+
+            // Stage 1: hash every key and start loading its filter block, or
+            // its home slot when there is no filter
+            for (int i = 0; i < window; i++) {
+                hashes[i] = hashKey(keys[start + i], size);
+                if (filter.isEnabled()) {
+                    filter.prefetch(hashes[i].hash);
+                } else {
+                    GroupProbe::prefetch(&table.ctrl[hashes[i].home]);
+                    GroupProbe::prefetch(&table.values[hashes[i].home]);
+                }
+            }
+
+            // Stage 1b: drop keys the filter rejects; start loading the others' home slots
+            for (int i = 0; i < window; i++) {
+                absent[i] = filter.isEnabled() && !filter.mayContain(hashes[i].hash);
+                if (filter.isEnabled() && !absent[i]) {
+                    GroupProbe::prefetch(&table.ctrl[hashes[i].home]);
+                    GroupProbe::prefetch(&table.values[hashes[i].home]);
+                }
+            }
+
+            // Stage 2: find the first fingerprint match at home and start loading its key
+            for (int i = 0; i < window; i++) {
+                const KeyHash& h = hashes[i];
+                candidates[i] = -1;
+                if (absent[i]) {
+                    continue;
+                }
+                if (grouped) {
+                    GroupMatch group = match(&table.ctrl[h.home], h.fingerprint);
+                    uint32_t found = group.match & spanMask;
+                    uint32_t empty = group.empty & spanMask;
+                    if (empty != 0) {
+                        found &= (empty & (0u - empty)) - 1;
+                    }
+                    if (found != 0) {
+                        int slot = h.home + GroupProbe::lowestBit(found);
+                        candidates[i] = (slot >= size) ? slot - size : slot;
+                    }
+                } else if (table.ctrl[h.home] == h.fingerprint) {
+                    candidates[i] = h.home;
+                }
+                if constexpr (HasKeyPrefetch<KeyOf, Value>::value) {
+                    if (candidates[i] != -1) {
+                        keyOf.prefetch(table.values[candidates[i]]);
+                    }
+                }
+            }
+
+            // Stage 3: start loading the bytes of keys stored out of line
+            if constexpr (std::is_convertible<decltype(keyOf(std::declval<const Value&>())),
+                                              std::string_view>::value) {
+                for (int i = 0; i < window; i++) {
+                    if (candidates[i] != -1) {
+                        std::string_view candidateKey = keyOf(table.values[candidates[i]]);
+                        GroupProbe::prefetch(candidateKey.data());
+                    }
+                }
+            }
+
+            // Stage 4: probe; the lines touched by the common cases are in cache
+            for (int i = 0; i < window; i++) {
+                int searchLength = 0;
+                indices[start + i] =
+                    absent[i] ? -1 : probeHashed(table, size, hashes[i], keys[start + i], searchLength);
+            }
+        }
+    }
+
+    /**
+     * @brief Compute home slot and fingerprint of a key
+     */
+    template <class K>
+    KeyHash hashKey(const K& key, int slotCount) const {
+        return splitHash(hasher(key), slotCount);
+    }
+
+    /**
+     * @brief Derive home slot and fingerprint from a key's hash
+     */
+    KeyHash splitHash(uint64_t h, int slotCount) const {
+        KeyHash result;
+        result.hash = h;
+        result.home = static_cast<int>(h % static_cast<uint64_t>(slotCount));
+        result.step = (strategy == ProbeStrategy::DoubleHashing)
+                          ? CollisionResolution::doubleHashStep(h, slotCount)
+                          : 1;
+        result.fingerprint = static_cast<uint8_t>((h ^ (h >> 57)) & 0x7F);
+        return result;
+    }
+
+    /**
+     * @brief Probe a single table for a key whose hash is already computed
+     * @return Index within that table if found, -1 otherwise
+     */
+    template <class K>
+    int probeHashed(const SlotArray& slots, int slotCount, const KeyHash& h,
+                    const K& key, int& searchLength) const {
+        if (strategy == ProbeStrategy::Linear || strategy == ProbeStrategy::RobinHood) {
+            return probeGroups(slots, slotCount, h, key, searchLength);
+        }
+        return probeSequence(slots, slotCount, h, key, searchLength);
+    }
+
+    /**
+     * @brief Probe contiguous slots a group of control bytes at a time
+     * Compares a group of control bytes per step and reads a value's key
+     * only for fingerprint matches before the first empty slot. The probe
+     * count is the same as visiting slots one by one.
+     */
+    template <class K>
+    int probeGroups(const SlotArray& slots, int slotCount, const KeyHash& h,
+                    const K& key, int& searchLength) const {
+        const uint8_t* ctrl = slots.ctrl.data();
+        GroupProbe::MatchFunction match = GroupProbe::matcher();
+        const int width = GroupProbe::width();
+        int index = h.home;
+        int examined = 0;
+
+        // Linear probing, one group of control bytes at a time
+        while (examined < slotCount) {
+            GroupMatch group = match(ctrl + index, h.fingerprint);
+
+            int remaining = slotCount - examined;
+            int span = (remaining < width) ? remaining : width;
+            uint32_t spanMask = (span >= 32) ? 0xFFFFFFFFu : ((1u << span) - 1);
+            uint32_t empty = group.empty & spanMask;
+            uint32_t candidates = group.match & spanMask;
+
+            // Only matches before the first empty slot belong to this key's chain
+            if (empty != 0) {
+                candidates &= (empty & (0u - empty)) - 1;
+            }
+
+            while (candidates != 0) {
+                int offset = GroupProbe::lowestBit(candidates);
+                int slot = index + offset;  // Less than 2 * slotCount
+                if (slot >= slotCount) {
+                    slot -= slotCount;
+                }
+                if (equal(keyOf(slots.values[slot]), key)) {
+                    searchLength += examined + offset + 1;
+                    return slot;  // Found
+                }
+                candidates &= candidates - 1;
+            }
+
+            if (empty != 0) {
+                searchLength += examined + GroupProbe::lowestBit(empty) + 1;
+                return -1;  // Reached a never used slot
+            }
+
+            examined += span;
+            index += span;
+            if (index >= slotCount) {
+                index -= slotCount;
+            }
+        }
+
+        searchLength += slotCount;
+        return -1;  // Not found after full cycle
+    }
+
+    /**
+     * @brief Probe slot by slot along a quadratic or double hashing sequence
+     */
+    template <class K>
+    int probeSequence(const SlotArray& slots, int slotCount, const KeyHash& h,
+                      const K& key, int& searchLength) const {
+        for (int attempt = 0; attempt < slotCount; attempt++) {
+            int index = probeIndex(h, attempt, slotCount);
+            searchLength++;
+
+            uint8_t ctrl = slots.ctrl[index];
+            if (ctrl == CTRL_EMPTY) {
+                return -1;  // Key not found
+            }
+            if (ctrl == h.fingerprint && equal(keyOf(slots.values[index]), key)) {
+                return index;  // Found
+            }
+        }
+
+        return -1;  // Not found after full cycle
+    }
+
+    /**
+     * @brief Slot visited by the given probe attempt
+     */
+    int probeIndex(const KeyHash& h, int attempt, int slotCount) const {
+        switch (strategy) {
+            case ProbeStrategy::Quadratic:
+                return CollisionResolution::quadraticProbe(h.home, attempt, slotCount);
+            case ProbeStrategy::DoubleHashing:
+                return CollisionResolution::doubleHashProbe(h.home, h.step, attempt, slotCount);
+            default:
+                return CollisionResolution::linearProbe(h.home, attempt, slotCount);
+        }
+    }
+
+    /**
+     * @brief Place a value in the first available slot of the current table
+     * Caller guarantees the key is not already present.
+     */
+    void place(Value&& value) {
+        placeHashed(std::move(value), hashKey(keyOf(value), size));
+    }
+
+    /**
+     * @brief Place a value whose home in the current table is known
+     */
+    void placeHashed(Value&& value, const KeyHash& h) {
+        addToFilter(h.hash);
+        if (strategy == ProbeStrategy::RobinHood) {
+            placeRobinHood(std::move(value), h.fingerprint, h.home, 0);
+            return;
+        }
+
+        // Find first available slot; growth keeps at least one reachable
+        int index = h.home;
+        int attempt = 1;
+        for (; isFull(table.ctrl[index]); attempt++) {
+            index = probeIndex(h, attempt, size);
+        }
+
+        table.setCtrl(index, h.fingerprint);
+        table.values[index] = std::move(value);
+        addDistance(attempt - 1);
+    }
+
+    /**
+     * @brief Robin Hood placement
+     * Walks the linear sequence and swaps the carried value into any slot
+     * whose entry sits closer to its home, then carries the evicted entry on.
+     * @param fingerprint Control byte of value
+     * @param index Slot to start at, on value's chain
+     * @param distance Displacement of index from value's home
+     */
+    void placeRobinHood(Value&& value, uint8_t fingerprint, int index, int distance) {
+
+        while (isFull(table.ctrl[index])) {
+            int existing = displacement(index);
+            if (existing < distance) {
+                std::swap(value, table.values[index]);
+                uint8_t evicted = table.ctrl[index];
+                table.setCtrl(index, fingerprint);
+                addDistance(distance);
+                dropDistance(existing);  // The evicted entry is carried on
+                fingerprint = evicted;
+                distance = existing;
+            }
+            index = CollisionResolution::nextProbe(index, size);
+            distance++;
+        }
+
+        table.setCtrl(index, fingerprint);
+        table.values[index] = std::move(value);
+        addDistance(distance);
+    }
+
+    /**
+     * @brief Distance of a current table slot from its entry's home slot
+     */
+    int displacement(int index) const {
+        int home = hashKey(keyOf(table.values[index]), size).home;
+        return (index >= home) ? index - home : index + size - home;
+    }
+
+    /**
+     * @brief Probe distance of the value in a slot of either table
+     */
+    int distanceAt(int index) const {
+        if (index < size) {
+            return distanceOf(hashKey(keyOf(table.values[index]), size), index, size);
+        }
+        return distanceOf(hashKey(keyOf(oldTable.values[index - size]), oldSize), index - size, oldSize);
+    }
+
+    /**
+     * @brief Probe attempt at which a key's sequence reaches a slot
+     * Linear sequences subtract; quadratic and double hashing retrace the
+     * sequence, taking as many steps as the value's own lookup does.
+     */
+    int distanceOf(const KeyHash& h, int slot, int slotCount) const {
+        if (strategy == ProbeStrategy::Linear || strategy == ProbeStrategy::RobinHood) {
+            return (slot >= h.home) ? slot - h.home : slot + slotCount - h.home;
+        }
+        int attempt = 0;
+        while (attempt < slotCount && probeIndex(h, attempt, slotCount) != slot) {
+            attempt++;
+        }
+        return attempt;
+    }
+
+    static int bucketOf(int distance) {
+        return (distance < DISTANCE_BUCKETS - 1) ? distance : DISTANCE_BUCKETS - 1;
+    }
+
+    /**
+     * @brief Count a value placed at a probe distance
+     */
+    void addDistance(int distance) {
+        distanceCounts[bucketOf(distance)]++;
+        totalDistance += distance;
+        if (maxDistance >= 0 && distance > maxDistance) {
+            maxDistance = distance;
+        }
+    }
+
+    /**
+     * @brief Uncount a value leaving a probe distance
+     * When the farthest value leaves, the largest distance drops to the
+     * highest bucket still in use. Past the last bucket distances are not
+     * told apart, so it is recounted on demand instead.
+     */
+    void dropDistance(int distance) {
+        int bucket = bucketOf(distance);
+        distanceCounts[bucket]--;
+        totalDistance -= distance;
+        if (distance != maxDistance) {
+            return;
+        }
+        if (distanceCounts[bucket] > 0) {
+            if (bucket == DISTANCE_BUCKETS - 1) {
+                maxDistance = -1;
+            }
+            return;
+        }
+        while (bucket > 0 && distanceCounts[bucket] == 0) {
+            bucket--;
+        }
+        maxDistance = bucket;
+    }
+
+    /**
+     * @brief Remove the value at a slot
+     * Robin Hood shifts the following entries back by one until an empty slot
+     * or an entry at its home, so no tombstone is left. Slots of the table
+     * being migrated always use tombstones: shifting there could move an
+     * entry behind migrateIndex.
+     */
+    void eraseAt(int index) {
+        dropDistance(distanceAt(index));
+        if (strategy != ProbeStrategy::RobinHood || index >= size) {
+            setCtrlAt(index, CTRL_DELETED);
+            valueAt(index) = Value();
+            return;
+        }
+
+        int hole = index;
+        int next = CollisionResolution::nextProbe(hole, size);
+        int shifted = 0;
+        while (isFull(table.ctrl[next]) && (shifted = displacement(next)) > 0) {
+            table.values[hole] = std::move(table.values[next]);
+            table.setCtrl(hole, table.ctrl[next]);
+            addDistance(shifted - 1);
+            dropDistance(shifted);
+            hole = next;
+            next = CollisionResolution::nextProbe(hole, size);
+        }
+
+        table.setCtrl(hole, CTRL_EMPTY);
+        table.values[hole] = Value();
+    }
+
+    /**
+     * @brief Start an incremental resize
+     * The current table becomes the old table and is drained by migrateStep.
+     */
+    void beginResize(int newSize) {
+        if (oldSize > 0) {
+            finishResize();
+        }
+
+        std::swap(oldTable, table);
+        oldSize = size;
+        migrateIndex = 0;
+
+        size = newSize;
+        table.assign(size);
+        resetFilter();  // Filled by the migration
+    }
+
+    /**
+     * @brief Migrate up to maxSlots slots from the old table
+     * Migrated slots are left as tombstones so that probe chains of keys
+     * still waiting in the old table stay intact.
+     */
+    void migrateStep(int maxSlots) {
+        if (oldSize == 0) {
+            return;
+        }
+
+        for (int moved = 0; moved < maxSlots && migrateIndex < oldSize; moved++, migrateIndex++) {
+            if (isFull(oldTable.ctrl[migrateIndex])) {
+                uint64_t hash = hasher(keyOf(oldTable.values[migrateIndex]));
+                dropDistance(distanceOf(splitHash(hash, oldSize), migrateIndex, oldSize));
+                placeHashed(std::move(oldTable.values[migrateIndex]), splitHash(hash, size));
+                oldTable.values[migrateIndex] = Value();
+                oldTable.setCtrl(migrateIndex, CTRL_DELETED);
+            }
+        }
+
+        if (migrateIndex >= oldSize) {
+            oldTable.release();
+            oldSize = 0;
+            migrateIndex = 0;
+        }
+    }
+
+    /**
+     * @brief Migrate every remaining slot and release the old table
+     */
+    void finishResize() {
+        migrateStep(oldSize);
+    }
+};
+
+#endif // BASIC_HASHTABLE_H
\ No newline at end of file
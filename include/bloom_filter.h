@@ -0,0 +1,128 @@
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include "group_probe.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Split block Bloom filter over 64-bit key hashes
+ * The filter is an array of 32-byte blocks of eight 32-bit words. Hashes
+ * are first mixed by a golden ratio multiply, since the legacy hashers
+ * leave the high bits of short keys clear. A key picks one block with the
+ * high half of the mixed hash and sets one bit in each of the block's
+ * words, chosen by multiplying the low half by a different odd constant
+ * per word. A lookup therefore touches a single cache line
+ * and tests its eight bits in one branch-free pass laid out like a
+ * 256-bit vector, which compilers turn into AVX2 multiplies, variable
+ * shifts and a single test when AVX2 is enabled.
+ *
+ * Bits are never cleared: keys removed from the owning table stay false
+ * positives until the owner rebuilds the filter.
+ */
+class BloomFilter {
+public:
+    static const int BLOCK_WORDS = 8;
+    static const int DEFAULT_BITS_PER_KEY = 12;  // Under 1% false positives
+
+    /**
+     * @brief One cache-line-aligned group of bits
+     */
+    struct alignas(32) Block {
+        uint32_t words[BLOCK_WORDS];
+    };
+
+    /**
+     * @brief Empty the filter and size it for a number of keys
+     * @param capacity Keys expected before the next reset
+     * @param bitsPerKey Filter bits per expected key (at least 1)
+     */
+    void reset(int capacity, int bitsPerKey);
+
+    /**
+     * @brief Free the blocks, disabling the filter
+     */
+    void release();
+
+    /**
+     * @brief Replace the contents with a filter read from a snapshot
+     * @return false if the block count does not suit bitsPerKey
+     */
+    bool adopt(std::vector<Block>&& loadedBlocks, int loadedBitsPerKey);
+
+    /**
+     * @brief Record a key hash
+     */
+    void add(uint64_t hash) {
+        hash = mix(hash);
+        Block& block = blocks[blockOf(hash)];
+        uint32_t masks[BLOCK_WORDS];
+        maskOf(hash, masks);
+        for (int i = 0; i < BLOCK_WORDS; i++) {
+            block.words[i] |= masks[i];
+        }
+    }
+
+    /**
+     * @brief Check whether a key hash may have been recorded
+     * @return false only if it certainly was not
+     */
+    bool mayContain(uint64_t hash) const {
+        hash = mix(hash);
+        const Block& block = blocks[blockOf(hash)];
+        uint32_t masks[BLOCK_WORDS];
+        maskOf(hash, masks);
+        uint32_t missing = 0;
+        for (int i = 0; i < BLOCK_WORDS; i++) {
+            missing |= masks[i] & ~block.words[i];
+        }
+        return missing == 0;
+    }
+
+    /**
+     * @brief Start loading the block of a key hash
+     */
+    void prefetch(uint64_t hash) const { GroupProbe::prefetch(&blocks[blockOf(mix(hash))]); }
+
+    bool isEnabled() const { return !blocks.empty(); }
+    int getBitsPerKey() const { return bitsPerKey; }
+    const std::vector<Block>& getBlocks() const { return blocks; }
+
+    /**
+     * @brief Get the memory taken by the blocks
+     */
+    size_t getBytes() const { return blocks.size() * sizeof(Block); }
+
+private:
+    std::vector<Block> blocks;
+    int bitsPerKey = 0;
+
+    /**
+     * @brief Spread a key hash over all 64 bits
+     */
+    static uint64_t mix(uint64_t hash) { return hash * 0x9E3779B97F4A7C15ull; }
+
+    /**
+     * @brief Block of a mixed hash: the high half scaled to the block count
+     */
+    size_t blockOf(uint64_t hash) const {
+        return static_cast<size_t>(((hash >> 32) * blocks.size()) >> 32);
+    }
+
+    /**
+     * @brief One bit per word, picked by the top 5 bits of a salted product
+     */
+    static void maskOf(uint64_t hash, uint32_t* masks) {
+        static const uint32_t SALT[BLOCK_WORDS] = {
+            0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+            0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+        };
+        uint32_t key = static_cast<uint32_t>(hash);
+        for (int i = 0; i < BLOCK_WORDS; i++) {
+            masks[i] = 1u << ((key * SALT[i]) >> 27);
+        }
+    }
+};
+
+#endif // BLOOM_FILTER_H
\ No newline at end of file
@@ -0,0 +1,785 @@
+#ifndef CHAINED_HASHTABLE_H
+#define CHAINED_HASHTABLE_H
+
+#include "basic_hashtable.h"
+#include "collision.h"
+#include "group_probe.h"
+#include "snapshot.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <utility>
+#include <type_traits>
+#include <cstdint>
+
+/**
+ * @brief Separate chaining hash table engine with pooled nodes
+ *
+ * A drop-in alternative to BasicHashTable (ProbeStrategy::Chaining) with
+ * the same KeyOf, Hash and Equal policies and the same interface. Values
+ * live in nodes linked into per-bucket chains; the bucket array holds
+ * only the 32-bit index of each chain's first node, so it stays dense.
+ *
+ * Nodes come from a pool of NODES_PER_CHUNK node chunks that are never
+ * moved or freed while the table lives: removed nodes go on a free list
+ * and are reused by later inserts, and only a new chunk allocates. Each
+ * node keeps a 32-bit tag mixed from its key's hash, which picks its
+ * bucket and is compared before the key, so growing relinks nodes without hashing
+ * any key or moving any value. A value's address, and its slot index
+ * (the node index), therefore stay valid across inserts and growth until
+ * the value itself is removed.
+ *
+ * Chains tolerate load factors above 1, so maxLoadFactor may be raised
+ * past 1 to let bursts fill the table before it grows. New values are
+ * appended to their chain. The probe distance statistics count the nodes
+ * before a value in its chain, so a successful lookup examines distance
+ * plus one nodes; there are no tombstones.
+ *
+ * Slot indices in [0, getSlotCount()) are node indices of the pool.
+ */
+template <class Key, class Value, class KeyOf,
+          class Hash = DefaultHash<Key>,
+          class Equal = std::equal_to<Key>,
+          class Allocator = std::allocator<Value>>
+class ChainedHashTable {
+public:
+    typedef Key KeyType;
+    typedef Value ValueType;
+
+    // Enables the lookup overloads taking a key of type K other than Key
+    template <class K>
+    using EnableLookup = typename std::enable_if<
+        !std::is_same<K, Key>::value && IsTransparent<Hash>::value && IsTransparent<Equal>::value,
+        int>::type;
+
+    static const int NODES_PER_CHUNK = 1024;  // Nodes allocated together by the pool
+    static const int DISTANCE_BUCKETS = 32;   // Histogram buckets; the last holds every larger distance
+
+    typedef std::array<int, DISTANCE_BUCKETS> DistanceHistogram;
+
+private:
+    static constexpr uint32_t NIL = 0x7FFFFFFFu;       // End of a chain
+    static constexpr uint32_t FREE_BIT = 0x80000000u;  // Set in the link of a free node
+    static const int BATCH_WINDOW = 16;             // Keys whose cache misses findBatch overlaps
+    static const int MISS_SAMPLES = 4096;           // Hashes sampled by getMissSearchLength
+
+    /**
+     * @brief Pooled chain node
+     */
+    struct Node {
+        Value value;
+        uint32_t tag;    // tagOf the key's hash
+        uint32_t next;   // Next node of the chain, NIL; FREE_BIT | next free node when free
+    };
+
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<Node> NodeAllocator;
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<uint32_t> HeadAllocator;
+    typedef std::vector<Node, NodeAllocator> Chunk;  // Never resized, so nodes never move
+
+    Hash hasher;                   // Hash policy
+    KeyOf keyOf;                   // Key extraction policy
+    Equal equal;                   // Key comparison policy
+
+    std::vector<uint32_t, HeadAllocator> heads;  // First node per bucket, NIL if empty
+    std::vector<Chunk> chunks;     // Node pool
+    uint32_t freeHead;             // First free node, NIL if the pool is full
+    int bucketCount;
+    int count;                     // Values in the chains
+    double maxLoadFactor;          // Growth threshold for count / buckets
+    double maxTombstoneRatio;      // Kept for the common interface; there are no tombstones
+
+    DistanceHistogram distanceCounts;  // Values per position in their chain
+    long long totalDistance;           // Sum of every value's position
+    mutable int maxDistance;           // Largest position, -1 until recounted
+
+public:
+    /**
+     * @brief Constructor
+     * @param tableSize Initial number of buckets
+     * @param maxLoad Load factor that triggers growth
+     * @param hash Hash policy instance
+     * @param keyOfValue Key extraction policy instance
+     * @param keyEqual Key comparison policy instance
+     * @param allocator Allocator for buckets and nodes
+     */
+    explicit ChainedHashTable(int tableSize = 16, double maxLoad = 0.75,
+                              const Hash& hash = Hash(), const KeyOf& keyOfValue = KeyOf(),
+                              const Equal& keyEqual = Equal(), const Allocator& allocator = Allocator())
+        : hasher(hash), keyOf(keyOfValue), equal(keyEqual), heads(HeadAllocator(allocator)),
+          freeHead(NIL), bucketCount(tableSize > 0 ? tableSize : 1), count(0), maxLoadFactor(0.75),
+          maxTombstoneRatio(1.0), distanceCounts(), totalDistance(0), maxDistance(0) {
+        setMaxLoadFactor(maxLoad);
+        heads.assign(bucketCount, NIL);
+    }
+
+    /**
+     * @brief Insert a value
+     * @param value Value to insert
+     * @return true if inserted, false if its key is already present
+     */
+    bool insert(const Value& value) {
+        return insert(Value(value));
+    }
+
+    bool insert(Value&& value) {
+        if (!prepareKey(keyOf(value))) {
+            return false;
+        }
+        commitInsert(std::move(value));
+        return true;
+    }
+
+    /**
+     * @brief First phase of a two-phase insert
+     * Checks that the key is absent, grows the bucket array if one more
+     * value would pass the load threshold and makes sure a free node is
+     * pooled, so the matching commitInsert neither allocates nor fails.
+     * @param key Key of the value to insert
+     * @return true if the key is absent and room for it is reserved
+     */
+    bool prepareInsert(const Key& key) { return prepareKey(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    bool prepareInsert(const K& key) { return prepareKey(key); }
+
+    /**
+     * @brief Second phase of a two-phase insert
+     * The table must not be modified between prepareInsert and this call.
+     * @param value Value whose key was passed to prepareInsert
+     */
+    void commitInsert(Value&& value) {
+        uint64_t hash = hasher(keyOf(value));
+        append(std::move(value), tagOf(hash));
+    }
+
+    /**
+     * @brief Hash a key with the table's hash policy
+     * @param key Key to hash
+     * @return Hash for insertHashed
+     */
+    uint64_t hashOf(const Key& key) const { return hasher(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    uint64_t hashOf(const K& key) const { return hasher(key); }
+
+    /**
+     * @brief Size the buckets and the pool for valueCount values at once
+     * @param valueCount Total number of values the table should hold
+     */
+    void reserve(int valueCount) {
+        if (valueCount > maxLoadFactor * bucketCount) {
+            relink(static_cast<int>(valueCount / maxLoadFactor) + 1);
+        }
+        while (getSlotCount() < valueCount) {
+            addChunk();
+        }
+    }
+
+    /**
+     * @brief Insert a value whose key hash is already known, in one chain walk
+     * @param hash Hash of the value's key, as returned by hashOf
+     * @param value Value to insert
+     * @return Slot index of the inserted value, -1 if its key is present
+     */
+    int insertHashed(uint64_t hash, Value&& value) {
+        uint32_t tag = tagOf(hash);
+        int searchLength = 0;
+        if (findTagged(tag, keyOf(value), searchLength) != -1) {
+            return -1;
+        }
+        makeRoom();
+        return append(std::move(value), tag);
+    }
+
+    /**
+     * @brief Search for a value by key
+     * The pointer stays valid until the value is removed.
+     * @param key Search key
+     * @return Pointer to value if found, nullptr otherwise
+     */
+    Value* search(const Key& key) { return searchKey(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    Value* search(const K& key) { return searchKey(key); }
+
+    const Value* search(const Key& key) const { return searchKey(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    const Value* search(const K& key) const { return searchKey(key); }
+
+    /**
+     * @brief Check whether a key is present
+     * @param key Search key
+     * @return true if found
+     */
+    bool contains(const Key& key) const { return containsKey(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    bool contains(const K& key) const { return containsKey(key); }
+
+    /**
+     * @brief Delete a value by key
+     * @param key Key to delete
+     * @return true if deleted, false if not found
+     */
+    bool remove(const Key& key) { return removeKey(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    bool remove(const K& key) { return removeKey(key); }
+
+    /**
+     * @brief Remove the value at a slot index returned by findIndex
+     * Unlinks its node and returns it to the pool.
+     * @param index Slot index of an occupied slot
+     */
+    void erase(int index) {
+        uint32_t id = static_cast<uint32_t>(index);
+        Node& node = nodeAt(id);
+        uint32_t* link = &heads[bucketOf(node.tag)];
+        int position = 0;
+        while (*link != id) {
+            link = &nodeAt(*link).next;
+            position++;
+        }
+        *link = node.next;
+        dropDistance(position);
+
+        // Every node after it moves one closer to the head
+        for (uint32_t later = node.next; later != NIL; later = nodeAt(later).next) {
+            position++;
+            dropDistance(position);
+            addDistance(position - 1);
+        }
+
+        node.value = Value();
+        node.next = FREE_BIT | freeHead;
+        freeHead = id;
+        count--;
+    }
+
+    /**
+     * @brief Find slot index of a key
+     * @param key Search key
+     * @param searchLength Output parameter for nodes examined
+     * @return Slot index if found, -1 otherwise
+     */
+    int findIndex(const Key& key, int& searchLength) const { return findKey(key, searchLength); }
+
+    template <class K, EnableLookup<K> = 0>
+    int findIndex(const K& key, int& searchLength) const { return findKey(key, searchLength); }
+
+    /**
+     * @brief Find the slot indexes of many keys, overlapping their cache misses
+     * Works through the keys in windows of BATCH_WINDOW: hashes every key
+     * and prefetches its bucket head, then prefetches each chain's first
+     * node, then walks the chains.
+     * @param keys Keys to look up
+     * @param keyCount Number of keys
+     * @param indices Output: slot index per key, -1 if not found
+     */
+    void findBatch(const Key* keys, int keyCount, int* indices) const { findKeys(keys, keyCount, indices); }
+
+    template <class K, EnableLookup<K> = 0>
+    void findBatch(const K* keys, int keyCount, int* indices) const { findKeys(keys, keyCount, indices); }
+
+    /**
+     * @brief Get search length (nodes examined) for a key
+     * @param key Search key
+     * @return Number of nodes, -1 if not found
+     */
+    int getSearchLength(const Key& key) const { return searchLengthOf(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    int getSearchLength(const K& key) const { return searchLengthOf(key); }
+
+    /**
+     * @brief Calculate average search length
+     * @return Average number of nodes examined across all values
+     */
+    double getAverageSearchLength() const {
+        return (count > 0) ? getMeanProbeDistance() + 1.0 : 0.0;
+    }
+
+    /**
+     * @brief Get the largest position of any value in its chain
+     * Read from the histogram, except when the last bucket is in use; the
+     * chains are then walked.
+     * @return Nodes before the farthest value (0 = chain head)
+     */
+    int getMaxProbeDistance() const {
+        if (maxDistance < 0) {
+            maxDistance = 0;
+            for (uint32_t head : heads) {
+                int position = -1;
+                for (uint32_t id = head; id != NIL; id = nodeAt(id).next) {
+                    position++;
+                }
+                maxDistance = std::max(maxDistance, position);
+            }
+        }
+        return maxDistance;
+    }
+
+    /**
+     * @brief Get the mean position of values in their chains
+     */
+    double getMeanProbeDistance() const {
+        return (count > 0) ? static_cast<double>(totalDistance) / count : 0.0;
+    }
+
+    /**
+     * @brief Get the number of values at each chain position
+     */
+    const DistanceHistogram& getDistanceHistogram() const { return distanceCounts; }
+
+    int getTombstoneCount() const { return 0; }
+
+    /**
+     * @brief Estimate the nodes examined by an unsuccessful lookup
+     * Sums the chain lengths of MISS_SAMPLES evenly spread hashes.
+     * @return Mean nodes per miss; 0 for a miss on an empty bucket
+     */
+    double getMissSearchLength() const {
+        long long nodes = 0;
+        for (int sample = 0; sample < MISS_SAMPLES; sample++) {
+            uint64_t hash = (static_cast<uint64_t>(sample) + 1) * 0x9E3779B97F4A7C15ull;
+            for (uint32_t id = heads[bucketOf(tagOf(hash))]; id != NIL; id = nodeAt(id).next) {
+                nodes++;
+            }
+        }
+        return static_cast<double>(nodes) / MISS_SAMPLES;
+    }
+
+    /**
+     * @brief No tombstones are left behind, so there is nothing to compact
+     */
+    void compact() {}
+
+    int getCompactionCount() const { return 0; }
+
+    double getMaxTombstoneRatio() const { return maxTombstoneRatio; }
+
+    void setMaxTombstoneRatio(double ratio) {
+        if (ratio < 0.05) ratio = 0.05;
+        if (ratio > 1.0) ratio = 1.0;
+        maxTombstoneRatio = ratio;
+    }
+
+    /**
+     * @brief Chains compare hash tags before keys; no filter is kept
+     */
+    void setFilterBits(int) {}
+
+    int getFilterBits() const { return 0; }
+    size_t getFilterBytes() const { return 0; }
+    double getFilterFalsePositiveRate() const { return 0.0; }
+
+    /**
+     * @brief Get the number of pooled nodes not holding a value
+     */
+    int getFreeNodeCount() const { return getSlotCount() - count; }
+
+    /**
+     * @brief Remove every value, returning the pool's memory
+     */
+    void clear() {
+        heads.assign(bucketCount, NIL);
+        chunks.clear();
+        freeHead = NIL;
+        count = 0;
+        distanceCounts.fill(0);
+        totalDistance = 0;
+        maxDistance = 0;
+    }
+
+    /**
+     * @brief Check whether a slot holds a value
+     * @param index Slot index in [0, getSlotCount())
+     */
+    bool isOccupied(int index) const { return (nodeAt(static_cast<uint32_t>(index)).next & FREE_BIT) == 0; }
+
+    bool isTombstone(int) const { return false; }
+
+    /**
+     * @brief Access the value stored in a slot
+     * @param index Slot index in [0, getSlotCount())
+     */
+    Value& valueAt(int index) { return nodeAt(static_cast<uint32_t>(index)).value; }
+    const Value& valueAt(int index) const { return nodeAt(static_cast<uint32_t>(index)).value; }
+
+    int getCount() const { return count; }
+    int getSize() const { return bucketCount; }
+    int getSlotCount() const { return static_cast<int>(chunks.size()) * NODES_PER_CHUNK; }
+    ProbeStrategy getProbeStrategy() const { return ProbeStrategy::Chaining; }
+    const Hash& getHash() const { return hasher; }
+    const KeyOf& getKeyOf() const { return keyOf; }
+
+    /**
+     * @brief Get current load factor
+     * @return Load factor (count / buckets), may exceed 1
+     */
+    double getLoadFactor() const {
+        return static_cast<double>(count) / bucketCount;
+    }
+
+    double getMaxLoadFactor() const { return maxLoadFactor; }
+
+    /**
+     * @brief Set load factor threshold that triggers growth
+     * @param maxLoad Value clamped to [0.1, 8.0]
+     */
+    void setMaxLoadFactor(double maxLoad) {
+        if (maxLoad < 0.1) maxLoad = 0.1;
+        if (maxLoad > 8.0) maxLoad = 8.0;
+        maxLoadFactor = maxLoad;
+    }
+
+    bool isResizing() const { return false; }
+    double getMigrationProgress() const { return 1.0; }
+
+    /**
+     * @brief Write the bucket heads and node pool exactly as laid out in memory
+     * Values are copied as bytes and must be trivially copyable.
+     */
+    void saveSlots(SnapshotWriter& writer) const {
+        static_assert(std::is_trivially_copyable<Value>::value, "slots are saved as raw bytes");
+        writer.writeValue(static_cast<int32_t>(ProbeStrategy::Chaining));
+        writer.writeValue(maxLoadFactor);
+        writer.writeValue(static_cast<int32_t>(count));
+        writer.writeValue(freeHead);
+        writer.writeValue(distanceCounts);
+        writer.writeValue(totalDistance);
+        writer.writeValue(static_cast<int32_t>(maxDistance));
+        writer.writeArray(heads);
+        writer.writeValue(static_cast<int32_t>(chunks.size()));
+        for (const Chunk& chunk : chunks) {
+            writer.write(chunk.data(), chunk.size() * sizeof(Node));
+        }
+    }
+
+    /**
+     * @brief Replace the contents with a pool written by saveSlots
+     * The hash and key policies are this table's own; the caller checks
+     * that the snapshot was written with the same ones.
+     * @param isValid Check every stored value must pass before its key is
+     *        read, such as a record ID naming a live record
+     * @return false, leaving the table unchanged, if the data is malformed or
+     *         was written by another engine
+     */
+    template <class Check>
+    bool loadSlots(SnapshotReader& reader, const Check& isValid) {
+        int32_t loadedStrategy = 0, loadedCount = 0, loadedMaxDistance = 0, loadedChunks = 0;
+        uint32_t loadedFreeHead = 0;
+        double loadedMaxLoad = 0.0;
+        DistanceHistogram loadedCounts;
+        long long loadedTotal = 0;
+        std::vector<uint32_t, HeadAllocator> loadedHeads(heads.get_allocator());
+        if (!reader.readValue(loadedStrategy) || !reader.readValue(loadedMaxLoad) ||
+            !reader.readValue(loadedCount) || !reader.readValue(loadedFreeHead) ||
+            !reader.readValue(loadedCounts) || !reader.readValue(loadedTotal) ||
+            !reader.readValue(loadedMaxDistance) ||
+            !reader.readArray(loadedHeads, static_cast<uint64_t>(INT32_MAX)) ||
+            !reader.readValue(loadedChunks)) {
+            return false;
+        }
+        long long histogramCount = 0;
+        for (int valuesAtDistance : loadedCounts) {
+            histogramCount += valuesAtDistance;
+        }
+        if (loadedStrategy != static_cast<int32_t>(ProbeStrategy::Chaining) || loadedHeads.empty() ||
+            loadedCount < 0 || histogramCount != loadedCount || loadedTotal < 0 || loadedMaxDistance < -1 ||
+            loadedChunks < 0 || loadedChunks > INT32_MAX / NODES_PER_CHUNK ||
+            static_cast<int64_t>(loadedChunks) * NODES_PER_CHUNK < loadedCount) {
+            return false;
+        }
+
+        std::vector<Chunk> loaded;
+        loaded.reserve(loadedChunks);
+        for (int32_t i = 0; i < loadedChunks; i++) {
+            const char* data = reader.read(NODES_PER_CHUNK * sizeof(Node));
+            if (!data) {
+                return false;
+            }
+            loaded.emplace_back(static_cast<size_t>(NODES_PER_CHUNK), Node(), NodeAllocator(heads.get_allocator()));
+            std::memcpy(static_cast<void*>(loaded.back().data()), data, NODES_PER_CHUNK * sizeof(Node));
+        }
+
+        // Links must stay inside the pool, or a corrupt file could send a walk anywhere;
+        // values in use must pass the caller's check
+        uint32_t nodeCount = static_cast<uint32_t>(loadedChunks) * NODES_PER_CHUNK;
+        auto inPool = [&](uint32_t link) { return link == NIL || link < nodeCount; };
+        bool valid = inPool(loadedFreeHead);
+        for (uint32_t head : loadedHeads) {
+            valid = valid && inPool(head);
+        }
+        for (const Chunk& chunk : loaded) {
+            for (const Node& node : chunk) {
+                bool free = (node.next & FREE_BIT) != 0;
+                valid = valid && inPool(node.next & ~FREE_BIT) && (free || isValid(node.value));
+            }
+        }
+        if (!valid) {
+            return false;
+        }
+
+        heads.swap(loadedHeads);
+        chunks.swap(loaded);
+        bucketCount = static_cast<int>(heads.size());
+        freeHead = loadedFreeHead;
+        count = loadedCount;
+        maxLoadFactor = loadedMaxLoad;
+        distanceCounts = loadedCounts;
+        totalDistance = loadedTotal;
+        maxDistance = loadedMaxDistance;
+        return true;
+    }
+
+private:
+    /**
+     * @brief Tag of a hash: the high half of the hash mixed by a multiply
+     * Mixing first keeps hashes below 2^32 (Sum, Polynomial on short keys)
+     * from all sharing bucket 0.
+     */
+    static uint32_t tagOf(uint64_t hash) {
+        return static_cast<uint32_t>((hash * 0x9E3779B97F4A7C15ull) >> 32);
+    }
+
+    /**
+     * @brief Bucket of a tag: the tag scaled to the bucket count
+     */
+    int bucketOf(uint32_t tag) const {
+        return static_cast<int>((static_cast<uint64_t>(tag) * static_cast<uint64_t>(bucketCount)) >> 32);
+    }
+
+    Node& nodeAt(uint32_t id) { return chunks[id / NODES_PER_CHUNK][id % NODES_PER_CHUNK]; }
+    const Node& nodeAt(uint32_t id) const { return chunks[id / NODES_PER_CHUNK][id % NODES_PER_CHUNK]; }
+
+    template <class K>
+    Value* searchKey(const K& key) {
+        int searchLength = 0;
+        int index = findKey(key, searchLength);
+        return (index != -1) ? &valueAt(index) : nullptr;
+    }
+
+    template <class K>
+    const Value* searchKey(const K& key) const {
+        int searchLength = 0;
+        int index = findKey(key, searchLength);
+        return (index != -1) ? &valueAt(index) : nullptr;
+    }
+
+    template <class K>
+    bool prepareKey(const K& key) {
+        int searchLength = 0;
+        if (findKey(key, searchLength) != -1) {
+            return false;
+        }
+        makeRoom();
+        return true;
+    }
+
+    template <class K>
+    bool containsKey(const K& key) const {
+        int searchLength = 0;
+        return findKey(key, searchLength) != -1;
+    }
+
+    template <class K>
+    bool removeKey(const K& key) {
+        int searchLength = 0;
+        int index = findKey(key, searchLength);
+
+        if (index != -1) {
+            erase(index);
+            return true;
+        }
+
+        return false;
+    }
+
+    template <class K>
+    int searchLengthOf(const K& key) const {
+        int searchLength = 0;
+        int index = findKey(key, searchLength);
+        return (index != -1) ? searchLength : -1;
+    }
+
+    template <class K>
+    int findKey(const K& key, int& searchLength) const {
+        return findTagged(tagOf(hasher(key)), key, searchLength);
+    }
+
+    /**
+     * @brief Walk a key's chain, reading a value's key only when the tags match
+     */
+    template <class K>
+    int findTagged(uint32_t tag, const K& key, int& searchLength) const {
+        searchLength = 0;
+        for (uint32_t id = heads[bucketOf(tag)]; id != NIL;) {
+            const Node& node = nodeAt(id);
+            searchLength++;
+            if (node.tag == tag && equal(keyOf(node.value), key)) {
+                return static_cast<int>(id);
+            }
+            id = node.next;
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Look up a batch of keys in prefetching windows
+     */
+    template <class K>
+    void findKeys(const K* keys, int keyCount, int* indices) const {
+        uint32_t tags[BATCH_WINDOW];
+
+        for (int start = 0; start < keyCount; start += BATCH_WINDOW) {
+            int window = (keyCount - start < BATCH_WINDOW) ? keyCount - start : BATCH_WINDOW;
+
+            // Stage 1: hash every key and start loading its bucket head
+            for (int i = 0; i < window; i++) {
+                tags[i] = tagOf(hasher(keys[start + i]));
+                GroupProbe::prefetch(&heads[bucketOf(tags[i])]);
+            }
+
+            // Stage 2: start loading the first node of every chain
+            for (int i = 0; i < window; i++) {
+                uint32_t head = heads[bucketOf(tags[i])];
+                if (head != NIL) {
+                    GroupProbe::prefetch(&nodeAt(head));
+                }
+            }
+
+            // Stage 3: walk the chains
+            for (int i = 0; i < window; i++) {
+                int searchLength = 0;
+                indices[start + i] = findTagged(tags[i], keys[start + i], searchLength);
+            }
+        }
+    }
+
+    /**
+     * @brief Ensure the next append has a free node and keeps the load threshold
+     */
+    void makeRoom() {
+        if (count + 1 > maxLoadFactor * bucketCount) {
+            relink(bucketCount * 2 + 1);
+        }
+        if (freeHead == NIL) {
+            addChunk();
+        }
+    }
+
+    /**
+     * @brief Pool another chunk of nodes and put them on the free list
+     */
+    void addChunk() {
+        uint32_t first = static_cast<uint32_t>(chunks.size()) * NODES_PER_CHUNK;
+        chunks.emplace_back(static_cast<size_t>(NODES_PER_CHUNK), Node(), NodeAllocator(heads.get_allocator()));
+        Chunk& chunk = chunks.back();
+        for (int i = NODES_PER_CHUNK - 1; i >= 0; i--) {
+            chunk[i].next = FREE_BIT | freeHead;
+            freeHead = first + static_cast<uint32_t>(i);
+        }
+    }
+
+    /**
+     * @brief Take a free node, fill it and append it to its chain
+     * The caller guarantees the key is absent and a node is free.
+     * @return Slot index of the node
+     */
+    int append(Value&& value, uint32_t tag) {
+        uint32_t id = freeHead;
+        Node& node = nodeAt(id);
+        freeHead = node.next & ~FREE_BIT;
+        node.value = std::move(value);
+        node.tag = tag;
+        node.next = NIL;
+
+        uint32_t* link = &heads[bucketOf(tag)];
+        int position = 0;
+        while (*link != NIL) {
+            link = &nodeAt(*link).next;
+            position++;
+        }
+        *link = id;
+        addDistance(position);
+        count++;
+        return static_cast<int>(id);
+    }
+
+    /**
+     * @brief Spread the chains over newBuckets buckets
+     * Nodes are relinked by their stored tags; no key is hashed and no
+     * value moves.
+     */
+    void relink(int newBuckets) {
+        std::vector<uint32_t, HeadAllocator> oldHeads(newBuckets, NIL, heads.get_allocator());
+        oldHeads.swap(heads);
+        bucketCount = newBuckets;
+        std::vector<uint32_t> tails(newBuckets, NIL);
+        distanceCounts.fill(0);
+        totalDistance = 0;
+        maxDistance = 0;
+
+        // Appending to tails keeps each chain's relative order
+        std::vector<int> lengths(newBuckets, 0);
+        for (uint32_t head : oldHeads) {
+            for (uint32_t id = head; id != NIL;) {
+                Node& node = nodeAt(id);
+                uint32_t next = node.next;
+                int bucket = bucketOf(node.tag);
+                node.next = NIL;
+                if (tails[bucket] == NIL) {
+                    heads[bucket] = id;
+                } else {
+                    nodeAt(tails[bucket]).next = id;
+                }
+                tails[bucket] = id;
+                addDistance(lengths[bucket]++);
+                id = next;
+            }
+        }
+    }
+
+    /**
+     * @brief Bucket of the histogram a position is counted in
+     */
+    static int histogramBucket(int distance) {
+        return (distance < DISTANCE_BUCKETS) ? distance : DISTANCE_BUCKETS - 1;
+    }
+
+    void addDistance(int distance) {
+        distanceCounts[histogramBucket(distance)]++;
+        totalDistance += distance;
+        if (maxDistance >= 0 && distance > maxDistance) {
+            maxDistance = distance;
+        }
+    }
+
+    /**
+     * @brief Uncount a value leaving a chain position
+     * Past the last histogram bucket positions are not told apart, so the
+     * largest is recounted on demand instead.
+     */
+    void dropDistance(int distance) {
+        int bucket = histogramBucket(distance);
+        distanceCounts[bucket]--;
+        totalDistance -= distance;
+        if (distance != maxDistance || distanceCounts[bucket] > 0) {
+            if (distance == maxDistance && bucket == DISTANCE_BUCKETS - 1) {
+                maxDistance = -1;
+            }
+            return;
+        }
+        while (bucket > 0 && distanceCounts[bucket] == 0) {
+            bucket--;
+        }
+        maxDistance = bucket;
+    }
+};
+
+#endif // CHAINED_HASHTABLE_H
\ No newline at end of file
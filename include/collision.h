@@ -1,9 +1,24 @@
 #ifndef COLLISION_H
 #define COLLISION_H
 
+#include <cstdint>
+
+/**
+ * @brief Probe sequence and placement policy of a hash table
+ */
+enum class ProbeStrategy {
+    Linear,         // h(k, i) = (h(k) + i) mod m, lazy deletion
+    Quadratic,      // h(k, i) = (h(k) + i^2) mod m, lazy deletion
+    DoubleHashing,  // h(k, i) = (h(k) + i * h2(k)) mod m, lazy deletion
+    RobinHood,      // Linear sequence, displacement-ordered, backward-shift deletion
+    Cuckoo,         // Two 4-way buckets per key and a stash (CuckooHashTable)
+    Chaining        // Per-bucket chains of pooled nodes (ChainedHashTable)
+};
+
 /**
  * @brief Collision resolution strategies for hash table
- * Implements linear probing: h(k, i) = (h(k) + i) mod m
+ * Implements linear probing: h(k, i) = (h(k) + i) mod m,
+ * quadratic probing and double hashing
  */
 class CollisionResolution {
 public:
@@ -23,6 +38,42 @@ public:
      * @return Next probe position
      */
     static int nextProbe(int currentIndex, int tableSize);
+
+    /**
+     * @brief Quadratic probing collision resolution
+     * With a prime table size the first (m + 1) / 2 probes are distinct
+     * @param hashIndex Original hash index
+     * @param attempt Number of probing attempts (0-based)
+     * @param tableSize Size of the hash table
+     * @return New index after probing
+     */
+    static int quadraticProbe(int hashIndex, int attempt, int tableSize);
+
+    /**
+     * @brief Double hashing collision resolution
+     * @param hashIndex Original hash index
+     * @param step Step size from doubleHashStep
+     * @param attempt Number of probing attempts (0-based)
+     * @param tableSize Size of the hash table
+     * @return New index after probing
+     */
+    static int doubleHashProbe(int hashIndex, int step, int attempt, int tableSize);
+
+    /**
+     * @brief Step size for double hashing, in [1, tableSize - 1]
+     * Uses the quotient bits of the hash, independent of the home slot
+     * @param hash Full hash value of the key
+     * @param tableSize Size of the hash table
+     * @return Step size, coprime to a prime table size
+     */
+    static int doubleHashStep(uint64_t hash, int tableSize);
+
+    /**
+     * @brief Get display name of a strategy
+     * @param strategy Probe strategy
+     * @return Name such as "robin-hood"
+     */
+    static const char* name(ProbeStrategy strategy);
 };
 
 #endif // COLLISION_H
\ No newline at end of file
@@ -0,0 +1,174 @@
+#ifndef CONCURRENT_HASHTABLE_H
+#define CONCURRENT_HASHTABLE_H
+
+#include "record.h"
+#include "hashfunction.h"
+#include "epoch.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Thread-safe phone directory hash table keyed by username or phone
+ * Linear probing over an array of atomic pointers to immutable entries.
+ * Lookups take no lock and never wait: they probe the current array and
+ * validate the result against the sequence number of the key's lock
+ * stripe, retrying only if a writer of that stripe finished meanwhile
+ * (seqlock). Inserts and removes
+ * lock only the stripe selected by the high bits of the key's hash and
+ * claim slots with compare-and-swap, so writers of different stripes run
+ * in parallel. Growth locks every stripe against writers and publishes a
+ * rebuilt array; lookups keep reading the old one meanwhile.
+ *
+ * search() returns a copy of the record, never a pointer into the table.
+ * Every operation runs under an EpochManager guard, and removed entries
+ * and replaced slot arrays are retired to it, so they are deleted only
+ * once no lookup can still be reading them.
+ */
+class ConcurrentHashTable {
+public:
+    static const int STRIPE_COUNT = 128;  // Write lock stripes (power of two)
+
+    /**
+     * @brief Constructor
+     * @param tableSize Initial number of slots
+     * @param type Key type: "username" or "phone"
+     * @param maxLoad Load factor (including tombstones) that triggers growth
+     * @param hashAlgorithm Hash function for home slots and stripes
+     */
+    ConcurrentHashTable(int tableSize, const std::string& type = "username", double maxLoad = 0.75,
+                        HashAlgorithm hashAlgorithm = HashAlgorithm::WyHash);
+
+    /**
+     * @brief Destructor
+     */
+    ~ConcurrentHashTable();
+
+    ConcurrentHashTable(const ConcurrentHashTable&) = delete;
+    ConcurrentHashTable& operator=(const ConcurrentHashTable&) = delete;
+
+    /**
+     * @brief Insert a record
+     * @param record Record to insert
+     * @return true if successful, false if duplicate or empty key
+     */
+    bool insert(const Record& record);
+
+    /**
+     * @brief Search for a record by key without locking
+     * @param key Search key (username or phone)
+     * @return Copy of the record if found, empty otherwise
+     */
+    std::optional<Record> search(std::string_view key) const;
+
+    /**
+     * @brief Check whether a key is present without locking
+     * @param key Search key (username or phone)
+     * @return true if found
+     */
+    bool contains(std::string_view key) const;
+
+    /**
+     * @brief Delete a record by key (leaves a tombstone)
+     * @param key Key to delete
+     * @return true if deleted, false if not found
+     */
+    bool remove(std::string_view key);
+
+    /**
+     * @brief Delete retired entries and slot arrays no operation can reach
+     * Safe to call concurrently; when no other thread is inside an
+     * operation, everything retired so far is deleted.
+     */
+    void reclaim();
+
+    /**
+     * @brief Remove all records
+     * Must not run concurrently with any other operation on the table.
+     */
+    void clear();
+
+    int getCount() const { return count.load(std::memory_order_relaxed); }
+    int getSize() const;
+    double getLoadFactor() const;
+
+    /**
+     * @brief Get number of retired allocations not yet deleted
+     */
+    size_t getRetiredCount() const { return epochs.getPendingCount(); }
+
+private:
+    /**
+     * @brief Immutable record published into a slot
+     */
+    struct Entry {
+        uint64_t hash;
+        Record record;
+    };
+
+    /**
+     * @brief One generation of the slot array
+     */
+    struct SlotArray {
+        int capacity;
+        std::unique_ptr<std::atomic<Entry*>[]> slots;
+
+        explicit SlotArray(int slotCount);
+    };
+
+    /**
+     * @brief Write lock and version counter of a group of keys
+     * Odd while a writer holds it; each unlock moves it to the next even value.
+     */
+    struct alignas(64) Stripe {
+        std::atomic<uint32_t> sequence{0};
+    };
+
+    static Entry tombstone;  // Address marks a deleted slot
+
+    std::atomic<SlotArray*> current;   // Array searched by new operations
+    Stripe stripes[STRIPE_COUNT];
+    std::atomic<int> count;            // Live records
+    std::atomic<int> usedSlots;        // Live records plus tombstones
+    double maxLoadFactor;
+    bool byUsername;                   // Key type
+    HashAlgorithm algorithm;
+
+    mutable EpochManager epochs;       // Defers deletes until lookups have left
+
+    std::string_view keyOf(const Record& record) const {
+        return byUsername ? std::string_view(record.username) : std::string_view(record.phoneNumber);
+    }
+
+    uint64_t hashKey(std::string_view key) const { return HashFunction::hash64(key, algorithm); }
+
+    // High hash bits pick the stripe; the home slot uses the hash modulo capacity
+    static int stripeIndex(uint64_t hash) { return static_cast<int>(hash >> 57) & (STRIPE_COUNT - 1); }
+
+    /**
+     * @brief Find the entry of a key in a slot array
+     * @return Entry, nullptr if not found
+     */
+    const Entry* find(const SlotArray* array, std::string_view key, uint64_t hash) const;
+
+    /**
+     * @brief Run find() and copy out what it found, validated by the key's stripe
+     */
+    template <class Function>
+    void readValidated(std::string_view key, Function copyOut) const;
+
+    void lock(Stripe& stripe);
+    void unlock(Stripe& stripe);
+
+    /**
+     * @brief Replace a full slot array, unless another writer already did
+     * Caller holds an epoch guard and no stripe.
+     * @param observed Array the caller found full
+     */
+    void grow(SlotArray* observed);
+};
+
+#endif // CONCURRENT_HASHTABLE_H
\ No newline at end of file
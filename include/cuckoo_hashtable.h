@@ -0,0 +1,876 @@
+#ifndef CUCKOO_HASHTABLE_H
+#define CUCKOO_HASHTABLE_H
+
+#include "basic_hashtable.h"
+#include "collision.h"
+#include "group_probe.h"
+#include "snapshot.h"
+#include <array>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <utility>
+#include <type_traits>
+#include <cstdint>
+
+/**
+ * @brief Bucketized cuckoo hash table engine
+ *
+ * A drop-in alternative to BasicHashTable (ProbeStrategy::Cuckoo) with
+ * the same KeyOf, Hash and Equal policies and the same interface. Every
+ * key has two candidate buckets of BUCKET_WAYS slots, derived from its
+ * hash, and is stored in one of them or in a small stash. A lookup reads
+ * at most the two buckets, plus the stash when it is not empty, so its
+ * cost does not grow with the load factor or with clustering the way a
+ * probe sequence does.
+ *
+ * Each slot has a control byte: empty, or 6 fingerprint bits plus a flag
+ * telling whether the value sits in its second bucket. A lookup compares
+ * the flag as part of the fingerprint, so values that only visit a bucket
+ * as their alternative never match a key whose first bucket it is.
+ *
+ * An insert into two full buckets evicts a value chosen at random and
+ * moves it to its other bucket, repeating up to MAX_KICKS times (a walk
+ * that long is taken to be a cycle). The value still homeless then goes
+ * to the stash. The stash has room for STASH_SIZE values; once it is
+ * full, the next insert rehashes the table with a new bucket seed, and
+ * grows it when rehashing alone does not empty the stash. Growth past
+ * maxLoadFactor and rehashing rebuild the whole table at once; there is
+ * no incremental migration. Keys whose hashes collide outright (e.g.
+ * anagrams under HashAlgorithm::Sum) share both buckets whatever the
+ * seed; when neither reseeding nor growth helps, the stash is let grow
+ * to twice what the rebuild left in it, and lookups scan it.
+ *
+ * Deleting empties the slot, so there are no tombstones to compact. The
+ * probe distance statistics count the buckets a lookup reads past the
+ * first: 0 in the first bucket, 1 in the second, 2 in the stash.
+ *
+ * Slot indices in [0, getSize()) refer to bucket slots (bucket * ways +
+ * way) and indices in [getSize(), getSlotCount()) to the stash.
+ */
+template <class Key, class Value, class KeyOf,
+          class Hash = DefaultHash<Key>,
+          class Equal = std::equal_to<Key>,
+          class Allocator = std::allocator<Value>>
+class CuckooHashTable {
+public:
+    typedef Key KeyType;
+    typedef Value ValueType;
+
+    // Enables the lookup overloads taking a key of type K other than Key
+    template <class K>
+    using EnableLookup = typename std::enable_if<
+        !std::is_same<K, Key>::value && IsTransparent<Hash>::value && IsTransparent<Equal>::value,
+        int>::type;
+
+    static const int BUCKET_WAYS = 4;         // Slots per bucket
+    static const int STASH_SIZE = 4;          // Values kept outside the buckets before a rehash
+    static const int MAX_KICKS = 500;         // Evictions before a walk counts as a cycle
+    static const int DISTANCE_BUCKETS = 32;   // Same histogram shape as BasicHashTable
+
+    typedef std::array<int, DISTANCE_BUCKETS> DistanceHistogram;
+
+private:
+    // Control byte values; full slots hold a fingerprint and the second bucket flag
+    enum : uint8_t {
+        CTRL_EMPTY = 0x80,
+        CTRL_SECOND = 0x40,       // Value sits in its second bucket
+        FINGERPRINT_MASK = 0x3F
+    };
+
+    /**
+     * @brief Control bytes and values of one bucket, read together
+     */
+    struct Bucket {
+        uint8_t ctrl[BUCKET_WAYS];
+        Value values[BUCKET_WAYS];
+    };
+
+    typedef typename std::allocator_traits<Allocator>::template rebind_alloc<Bucket> BucketAllocator;
+
+    static const int BATCH_WINDOW = 16;       // Keys whose cache misses findBatch overlaps
+    static const int REHASH_ATTEMPTS = 4;     // Seeds tried per size before growing
+
+    Hash hasher;                   // Hash policy
+    KeyOf keyOf;                   // Key extraction policy
+    Equal equal;                   // Key comparison policy
+
+    std::vector<Bucket, BucketAllocator> buckets;
+    std::vector<Value, Allocator> stash;  // Capacity stashLimit, reserved up front
+    int stashLimit;                // Stash size that forces a rehash; STASH_SIZE unless hashes collide
+    int bucketCount;
+    int count;                     // Values in buckets and stash
+    double maxLoadFactor;          // Growth threshold for count / size
+    double maxTombstoneRatio;      // Kept for the common interface; there are no tombstones
+    uint64_t seed;                 // Mixed into bucket choice; changed by every rehash
+    uint32_t kickState;            // Random state picking eviction victims
+    int rehashes;                  // Rebuilds forced by a full stash
+
+    DistanceHistogram distanceCounts;  // Values per distance (0, 1 or 2)
+    long long totalDistance;           // Sum of every value's distance
+
+public:
+    /**
+     * @brief Constructor
+     * @param tableSize Initial number of slots, rounded up to whole buckets
+     * @param maxLoad Load factor that triggers growth
+     * @param hash Hash policy instance
+     * @param keyOfValue Key extraction policy instance
+     * @param keyEqual Key comparison policy instance
+     * @param allocator Allocator for slot storage
+     */
+    explicit CuckooHashTable(int tableSize = 16, double maxLoad = 0.75,
+                             const Hash& hash = Hash(), const KeyOf& keyOfValue = KeyOf(),
+                             const Equal& keyEqual = Equal(), const Allocator& allocator = Allocator())
+        : hasher(hash), keyOf(keyOfValue), equal(keyEqual), buckets(BucketAllocator(allocator)),
+          stash(allocator), stashLimit(STASH_SIZE), bucketCount(bucketsFor(tableSize)), count(0),
+          maxLoadFactor(0.75), maxTombstoneRatio(1.0), seed(0), kickState(0x9E3779B9u), rehashes(0),
+          distanceCounts(), totalDistance(0) {
+        setMaxLoadFactor(maxLoad);
+        stash.reserve(STASH_SIZE);
+        buckets.assign(bucketCount, emptyBucket());
+    }
+
+    /**
+     * @brief Insert a value
+     * @param value Value to insert
+     * @return true if inserted, false if its key is already present
+     */
+    bool insert(const Value& value) {
+        return insert(Value(value));
+    }
+
+    bool insert(Value&& value) {
+        if (!prepareKey(keyOf(value))) {
+            return false;
+        }
+        commitInsert(std::move(value));
+        return true;
+    }
+
+    /**
+     * @brief First phase of a two-phase insert
+     * Checks that the key is absent, grows the table if one more value
+     * would pass the load threshold, and rehashes it if the stash is
+     * full, so the matching commitInsert neither allocates nor fails.
+     * @param key Key of the value to insert
+     * @return true if the key is absent and room for it is reserved
+     */
+    bool prepareInsert(const Key& key) { return prepareKey(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    bool prepareInsert(const K& key) { return prepareKey(key); }
+
+    /**
+     * @brief Second phase of a two-phase insert
+     * The table must not be modified between prepareInsert and this call.
+     * @param value Value whose key was passed to prepareInsert
+     */
+    void commitInsert(Value&& value) {
+        uint64_t hash = hasher(keyOf(value));
+        place(std::move(value), hash);
+        count++;
+    }
+
+    /**
+     * @brief Hash a key with the table's hash policy
+     * @param key Key to hash
+     * @return Hash for insertHashed
+     */
+    uint64_t hashOf(const Key& key) const { return hasher(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    uint64_t hashOf(const K& key) const { return hasher(key); }
+
+    /**
+     * @brief Grow once so that valueCount values fit without a rebuild
+     * @param valueCount Total number of values the table should hold
+     */
+    void reserve(int valueCount) {
+        if (valueCount > maxLoadFactor * getSize()) {
+            rebuild(bucketsFor(static_cast<int>(valueCount / maxLoadFactor) + 1));
+        }
+    }
+
+    /**
+     * @brief Insert a value whose key hash is already known
+     * @param hash Hash of the value's key, as returned by hashOf
+     * @param value Value to insert
+     * @return Slot index of the inserted value, -1 if its key is present
+     */
+    int insertHashed(uint64_t hash, Value&& value) {
+        int searchLength = 0;
+        if (findHashed(hash, keyOf(value), searchLength) != -1) {
+            return -1;
+        }
+        makeRoom();
+        count++;
+        return place(std::move(value), hash);
+    }
+
+    /**
+     * @brief Search for a value by key
+     * @param key Search key
+     * @return Pointer to value if found, nullptr otherwise
+     */
+    Value* search(const Key& key) { return searchKey(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    Value* search(const K& key) { return searchKey(key); }
+
+    const Value* search(const Key& key) const { return searchKey(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    const Value* search(const K& key) const { return searchKey(key); }
+
+    /**
+     * @brief Check whether a key is present
+     * @param key Search key
+     * @return true if found
+     */
+    bool contains(const Key& key) const { return containsKey(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    bool contains(const K& key) const { return containsKey(key); }
+
+    /**
+     * @brief Delete a value by key
+     * @param key Key to delete
+     * @return true if deleted, false if not found
+     */
+    bool remove(const Key& key) { return removeKey(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    bool remove(const K& key) { return removeKey(key); }
+
+    /**
+     * @brief Remove the value at a slot index returned by findIndex
+     * A stash entry is replaced by the last one, so stash indexes change.
+     * @param index Slot index of an occupied slot
+     */
+    void erase(int index) {
+        dropDistance(distanceAt(index));
+        int size = getSize();
+        if (index < size) {
+            Bucket& bucket = buckets[index / BUCKET_WAYS];
+            bucket.ctrl[index % BUCKET_WAYS] = CTRL_EMPTY;
+            bucket.values[index % BUCKET_WAYS] = Value();
+        } else {
+            if (index - size + 1 < static_cast<int>(stash.size())) {
+                stash[index - size] = std::move(stash.back());
+            }
+            stash.pop_back();
+        }
+        count--;
+    }
+
+    /**
+     * @brief Find slot index of a key
+     * @param key Search key
+     * @param searchLength Output parameter for buckets read (the stash counts as one)
+     * @return Slot index if found, -1 otherwise
+     */
+    int findIndex(const Key& key, int& searchLength) const { return findKey(key, searchLength); }
+
+    template <class K, EnableLookup<K> = 0>
+    int findIndex(const K& key, int& searchLength) const { return findKey(key, searchLength); }
+
+    /**
+     * @brief Find the slot indexes of many keys, overlapping their cache misses
+     * Works through the keys in windows of BATCH_WINDOW: hashes every key
+     * and prefetches both of its buckets, then looks each key up.
+     * @param keys Keys to look up
+     * @param keyCount Number of keys
+     * @param indices Output: slot index per key, -1 if not found
+     */
+    void findBatch(const Key* keys, int keyCount, int* indices) const { findKeys(keys, keyCount, indices); }
+
+    template <class K, EnableLookup<K> = 0>
+    void findBatch(const K* keys, int keyCount, int* indices) const { findKeys(keys, keyCount, indices); }
+
+    /**
+     * @brief Get search length (buckets read) for a key
+     * @param key Search key
+     * @return 1 or 2, 3 if stashed; -1 if not found
+     */
+    int getSearchLength(const Key& key) const { return searchLengthOf(key); }
+
+    template <class K, EnableLookup<K> = 0>
+    int getSearchLength(const K& key) const { return searchLengthOf(key); }
+
+    /**
+     * @brief Calculate average search length
+     * @return Average number of buckets read across all values
+     */
+    double getAverageSearchLength() const {
+        return (count > 0) ? getMeanProbeDistance() + 1.0 : 0.0;
+    }
+
+    /**
+     * @brief Get the largest distance of any value
+     * @return 0 if every value is in its first bucket, 1 if some are in
+     *         their second, 2 if the stash is in use
+     */
+    int getMaxProbeDistance() const {
+        for (int distance = 2; distance > 0; distance--) {
+            if (distanceCounts[distance] > 0) {
+                return distance;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Get the mean distance across all values
+     */
+    double getMeanProbeDistance() const {
+        return (count > 0) ? static_cast<double>(totalDistance) / count : 0.0;
+    }
+
+    /**
+     * @brief Get the number of values at each distance
+     */
+    const DistanceHistogram& getDistanceHistogram() const { return distanceCounts; }
+
+    int getTombstoneCount() const { return 0; }
+
+    /**
+     * @brief Get the buckets an unsuccessful lookup reads
+     * Exact rather than sampled: both buckets, plus the stash when it is
+     * not empty.
+     */
+    double getMissSearchLength() const {
+        return stash.empty() ? 2.0 : 3.0;
+    }
+
+    /**
+     * @brief No tombstones are left behind, so there is nothing to compact
+     */
+    void compact() {}
+
+    int getCompactionCount() const { return 0; }
+
+    double getMaxTombstoneRatio() const { return maxTombstoneRatio; }
+
+    void setMaxTombstoneRatio(double ratio) {
+        if (ratio < 0.05) ratio = 0.05;
+        if (ratio > 1.0) ratio = 1.0;
+        maxTombstoneRatio = ratio;
+    }
+
+    /**
+     * @brief Lookups already read at most two buckets; no filter is kept
+     */
+    void setFilterBits(int) {}
+
+    int getFilterBits() const { return 0; }
+    size_t getFilterBytes() const { return 0; }
+    double getFilterFalsePositiveRate() const { return 0.0; }
+
+    /**
+     * @brief Get the number of rebuilds forced by a full stash
+     */
+    int getRehashCount() const { return rehashes; }
+
+    /**
+     * @brief Get the number of values held in the stash
+     */
+    int getStashCount() const { return static_cast<int>(stash.size()); }
+
+    /**
+     * @brief Remove every value, keeping the current size
+     */
+    void clear() {
+        buckets.assign(bucketCount, emptyBucket());
+        stash.clear();
+        count = 0;
+        distanceCounts.fill(0);
+        totalDistance = 0;
+    }
+
+    /**
+     * @brief Check whether a slot holds a value
+     * @param index Slot index in [0, getSlotCount())
+     */
+    bool isOccupied(int index) const {
+        int size = getSize();
+        return (index < size) ? isFull(buckets[index / BUCKET_WAYS].ctrl[index % BUCKET_WAYS])
+                              : index - size < static_cast<int>(stash.size());
+    }
+
+    bool isTombstone(int) const { return false; }
+
+    /**
+     * @brief Access the value stored in a slot
+     * @param index Slot index in [0, getSlotCount())
+     */
+    Value& valueAt(int index) {
+        int size = getSize();
+        return (index < size) ? buckets[index / BUCKET_WAYS].values[index % BUCKET_WAYS] : stash[index - size];
+    }
+
+    const Value& valueAt(int index) const {
+        int size = getSize();
+        return (index < size) ? buckets[index / BUCKET_WAYS].values[index % BUCKET_WAYS] : stash[index - size];
+    }
+
+    int getCount() const { return count; }
+    int getSize() const { return bucketCount * BUCKET_WAYS; }
+    int getSlotCount() const { return getSize() + stashLimit; }
+    ProbeStrategy getProbeStrategy() const { return ProbeStrategy::Cuckoo; }
+    const Hash& getHash() const { return hasher; }
+    const KeyOf& getKeyOf() const { return keyOf; }
+
+    /**
+     * @brief Get current load factor
+     * @return Load factor (count / size)
+     */
+    double getLoadFactor() const {
+        return static_cast<double>(count) / getSize();
+    }
+
+    double getMaxLoadFactor() const { return maxLoadFactor; }
+
+    /**
+     * @brief Set load factor threshold that triggers growth
+     * @param maxLoad Value clamped to [0.1, 0.95]
+     */
+    void setMaxLoadFactor(double maxLoad) {
+        if (maxLoad < 0.1) maxLoad = 0.1;
+        if (maxLoad > 0.95) maxLoad = 0.95;
+        maxLoadFactor = maxLoad;
+    }
+
+    bool isResizing() const { return false; }
+    double getMigrationProgress() const { return 1.0; }
+
+    /**
+     * @brief Write the buckets and stash exactly as laid out in memory
+     * Values are copied as bytes and must be trivially copyable.
+     */
+    void saveSlots(SnapshotWriter& writer) const {
+        static_assert(std::is_trivially_copyable<Value>::value, "slots are saved as raw bytes");
+        writer.writeValue(static_cast<int32_t>(ProbeStrategy::Cuckoo));
+        writer.writeValue(maxLoadFactor);
+        writer.writeValue(static_cast<int32_t>(count));
+        writer.writeValue(seed);
+        writer.writeValue(static_cast<int32_t>(rehashes));
+        writer.writeValue(distanceCounts);
+        writer.writeValue(totalDistance);
+        writer.writeArray(buckets);
+        writer.writeArray(stash);
+    }
+
+    /**
+     * @brief Replace the contents with buckets written by saveSlots
+     * The hash and key policies are this table's own; the caller checks
+     * that the snapshot was written with the same ones.
+     * @param isValid Check every stored value must pass before its key is
+     *        read, such as a record ID naming a live record
+     * @return false, leaving the table unchanged, if the data is malformed or
+     *         was written by another engine
+     */
+    template <class Check>
+    bool loadSlots(SnapshotReader& reader, const Check& isValid) {
+        int32_t loadedStrategy = 0, loadedCount = 0, loadedRehashes = 0;
+        double loadedMaxLoad = 0.0;
+        uint64_t loadedSeed = 0;
+        DistanceHistogram loadedCounts;
+        long long loadedTotal = 0;
+        std::vector<Bucket, BucketAllocator> loadedBuckets(buckets.get_allocator());
+        std::vector<Value, Allocator> loadedStash(stash.get_allocator());
+        if (!reader.readValue(loadedStrategy) || !reader.readValue(loadedMaxLoad) ||
+            !reader.readValue(loadedCount) || !reader.readValue(loadedSeed) ||
+            !reader.readValue(loadedRehashes) || !reader.readValue(loadedCounts) ||
+            !reader.readValue(loadedTotal) ||
+            !reader.readArray(loadedBuckets, static_cast<uint64_t>(INT32_MAX / BUCKET_WAYS)) ||
+            !reader.readArray(loadedStash, static_cast<uint64_t>(INT32_MAX / 2))) {
+            return false;
+        }
+        long long histogramCount = 0;
+        for (int bucketCount : loadedCounts) {
+            histogramCount += bucketCount;
+        }
+        if (loadedStrategy != static_cast<int32_t>(ProbeStrategy::Cuckoo) || loadedBuckets.empty() ||
+            loadedCount < 0 || histogramCount != loadedCount || loadedTotal < 0 ||
+            loadedCounts[2] != static_cast<int>(loadedStash.size())) {
+            return false;
+        }
+        for (const Bucket& bucket : loadedBuckets) {
+            for (int way = 0; way < BUCKET_WAYS; way++) {
+                if (isFull(bucket.ctrl[way]) && !isValid(bucket.values[way])) {
+                    return false;
+                }
+            }
+        }
+        for (const Value& value : loadedStash) {
+            if (!isValid(value)) {
+                return false;
+            }
+        }
+
+        buckets.swap(loadedBuckets);
+        stash.swap(loadedStash);
+        limitStash();
+        bucketCount = static_cast<int>(buckets.size());
+        count = loadedCount;
+        maxLoadFactor = loadedMaxLoad;
+        seed = loadedSeed;
+        rehashes = loadedRehashes;
+        distanceCounts = loadedCounts;
+        totalDistance = loadedTotal;
+        return true;
+    }
+
+private:
+    static bool isFull(uint8_t ctrl) { return (ctrl & 0x80) == 0; }
+
+    /**
+     * @brief Buckets holding slotCount slots; at least two, so a key's buckets differ
+     */
+    static int bucketsFor(int slotCount) {
+        return (slotCount > 2 * BUCKET_WAYS) ? (slotCount + BUCKET_WAYS - 1) / BUCKET_WAYS : 2;
+    }
+
+    static Bucket emptyBucket() {
+        Bucket bucket;
+        for (int way = 0; way < BUCKET_WAYS; way++) {
+            bucket.ctrl[way] = CTRL_EMPTY;
+            bucket.values[way] = Value();
+        }
+        return bucket;
+    }
+
+    static uint8_t fingerprintOf(uint64_t hash) {
+        return static_cast<uint8_t>((hash ^ (hash >> 57)) & FINGERPRINT_MASK);
+    }
+
+    /**
+     * @brief First candidate bucket: the high half of the mixed seeded hash, scaled
+     * Mixing first keeps hashes below 2^32 (Sum, Polynomial on short keys)
+     * from sharing one first bucket, and lets a new seed move every key.
+     */
+    int firstBucket(uint64_t hash) const {
+        uint64_t mixed = (hash ^ seed) * 0xC2B2AE3D27D4EB4Full;
+        mixed ^= mixed >> 31;
+        return static_cast<int>(((mixed >> 32) * static_cast<uint64_t>(bucketCount)) >> 32);
+    }
+
+    /**
+     * @brief Second candidate bucket, from a remix of the whole hash
+     * Never the first bucket.
+     */
+    int secondBucket(uint64_t hash, int first) const {
+        uint64_t mixed = (hash ^ seed) * 0x9E3779B97F4A7C15ull;
+        mixed ^= mixed >> 29;
+        int second = static_cast<int>(((mixed >> 32) * static_cast<uint64_t>(bucketCount)) >> 32);
+        if (second == first) {
+            second = (first + 1 < bucketCount) ? first + 1 : 0;
+        }
+        return second;
+    }
+
+    template <class K>
+    Value* searchKey(const K& key) {
+        int searchLength = 0;
+        int index = findKey(key, searchLength);
+        return (index != -1) ? &valueAt(index) : nullptr;
+    }
+
+    template <class K>
+    const Value* searchKey(const K& key) const {
+        int searchLength = 0;
+        int index = findKey(key, searchLength);
+        return (index != -1) ? &valueAt(index) : nullptr;
+    }
+
+    template <class K>
+    bool prepareKey(const K& key) {
+        int searchLength = 0;
+        if (findKey(key, searchLength) != -1) {
+            return false;
+        }
+        makeRoom();
+        return true;
+    }
+
+    template <class K>
+    bool containsKey(const K& key) const {
+        int searchLength = 0;
+        return findKey(key, searchLength) != -1;
+    }
+
+    template <class K>
+    bool removeKey(const K& key) {
+        int searchLength = 0;
+        int index = findKey(key, searchLength);
+
+        if (index != -1) {
+            erase(index);
+            return true;
+        }
+
+        return false;
+    }
+
+    template <class K>
+    int searchLengthOf(const K& key) const {
+        int searchLength = 0;
+        int index = findKey(key, searchLength);
+        return (index != -1) ? searchLength : -1;
+    }
+
+    template <class K>
+    int findKey(const K& key, int& searchLength) const {
+        return findHashed(hasher(key), key, searchLength);
+    }
+
+    /**
+     * @brief Look a key up in its two buckets, then in the stash
+     */
+    template <class K>
+    int findHashed(uint64_t hash, const K& key, int& searchLength) const {
+        uint8_t fingerprint = fingerprintOf(hash);
+        int first = firstBucket(hash);
+        searchLength = 1;
+        int way = matchBucket(buckets[first], fingerprint, key);
+        if (way != -1) {
+            return first * BUCKET_WAYS + way;
+        }
+
+        int second = secondBucket(hash, first);
+        searchLength = 2;
+        way = matchBucket(buckets[second], fingerprint | CTRL_SECOND, key);
+        if (way != -1) {
+            return second * BUCKET_WAYS + way;
+        }
+
+        if (!stash.empty()) {
+            searchLength++;
+            for (size_t i = 0; i < stash.size(); i++) {
+                if (equal(keyOf(stash[i]), key)) {
+                    return getSize() + static_cast<int>(i);
+                }
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Way of a bucket holding a key, -1 if none
+     */
+    template <class K>
+    int matchBucket(const Bucket& bucket, uint8_t ctrl, const K& key) const {
+        for (int way = 0; way < BUCKET_WAYS; way++) {
+            if (bucket.ctrl[way] == ctrl && equal(keyOf(bucket.values[way]), key)) {
+                return way;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Look up a batch of keys in prefetching windows
+     */
+    template <class K>
+    void findKeys(const K* keys, int keyCount, int* indices) const {
+        uint64_t hashes[BATCH_WINDOW];
+
+        for (int start = 0; start < keyCount; start += BATCH_WINDOW) {
+            int window = (keyCount - start < BATCH_WINDOW) ? keyCount - start : BATCH_WINDOW;
+
+            // Stage 1: hash every key and start loading both of its buckets
+            for (int i = 0; i < window; i++) {
+                hashes[i] = hasher(keys[start + i]);
+                int first = firstBucket(hashes[i]);
+                GroupProbe::prefetch(&buckets[first]);
+                GroupProbe::prefetch(&buckets[secondBucket(hashes[i], first)]);
+            }
+
+            // Stage 2: look up; the buckets are in cache or on their way
+            for (int i = 0; i < window; i++) {
+                int searchLength = 0;
+                indices[start + i] = findHashed(hashes[i], keys[start + i], searchLength);
+            }
+        }
+    }
+
+    /**
+     * @brief Ensure the next place() has room and keeps the load threshold
+     * Grows past the load threshold; rehashes when the stash is full.
+     */
+    void makeRoom() {
+        if (count + 1 > maxLoadFactor * getSize()) {
+            rebuild(bucketCount * 2);
+        } else if (static_cast<int>(stash.size()) >= stashLimit) {
+            rehashes++;
+            rebuild(bucketCount);
+        }
+    }
+
+    /**
+     * @brief Rehash every value into bucketTotal buckets under a new seed
+     * A seed whose placements fill the stash is abandoned for the next;
+     * after REHASH_ATTEMPTS of them the table doubles, and after as many
+     * again the last attempt is kept whatever its stash holds.
+     */
+    void rebuild(int bucketTotal) {
+        std::vector<Value, Allocator> values(stash.get_allocator());
+        values.reserve(count);
+        for (Bucket& bucket : buckets) {
+            for (int way = 0; way < BUCKET_WAYS; way++) {
+                if (isFull(bucket.ctrl[way])) {
+                    values.push_back(std::move(bucket.values[way]));
+                }
+            }
+        }
+        for (Value& value : stash) {
+            values.push_back(std::move(value));
+        }
+        std::vector<uint64_t> hashes(values.size());
+        for (size_t i = 0; i < values.size(); i++) {
+            hashes[i] = hasher(keyOf(values[i]));
+        }
+
+        for (int attempt = 0;; attempt++) {
+            if (attempt == REHASH_ATTEMPTS) {
+                bucketTotal *= 2;
+            }
+            bool last = (attempt == 2 * REHASH_ATTEMPTS - 1);
+            seed += 0x9E3779B97F4A7C15ull;
+            bucketCount = bucketTotal;
+            buckets.assign(bucketCount, emptyBucket());
+            stash.clear();
+            distanceCounts.fill(0);
+            totalDistance = 0;
+
+            // Every value is copied in, so an abandoned attempt loses nothing
+            size_t placed = 0;
+            while (placed < values.size() && (last || static_cast<int>(stash.size()) < STASH_SIZE)) {
+                Value value = values[placed];
+                place(std::move(value), hashes[placed]);
+                placed++;
+            }
+            if (last || (placed == values.size() && static_cast<int>(stash.size()) < STASH_SIZE)) {
+                limitStash();
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Put a value into one of its buckets, evicting others if need be
+     * The caller guarantees the key is absent and the stash has room.
+     * @return Slot index the value ends up in
+     */
+    int place(Value&& value, uint64_t hash) {
+        uint8_t fingerprint = fingerprintOf(hash);
+        int first = firstBucket(hash);
+        int second = secondBucket(hash, first);
+        int way = freeWay(buckets[first]);
+        if (way != -1) {
+            return put(first, way, fingerprint, std::move(value));
+        }
+        way = freeWay(buckets[second]);
+        if (way != -1) {
+            return put(second, way, fingerprint | CTRL_SECOND, std::move(value));
+        }
+
+        // Random walk: evict a value, move it to its other bucket, repeat
+        Value carried = std::move(value);
+        bool startSecond = (nextRandom() & 1) != 0;
+        uint8_t ctrl = startSecond ? (fingerprint | CTRL_SECOND) : fingerprint;
+        int bucket = startSecond ? second : first;
+        int placedAt = -1;      // Slot of the new value once it is no longer carried
+        bool carryingNew = true;
+        for (int kick = 0; kick < MAX_KICKS; kick++) {
+            way = static_cast<int>(nextRandom() % BUCKET_WAYS);
+            int slot = bucket * BUCKET_WAYS + way;
+            Bucket& target = buckets[bucket];
+            std::swap(carried, target.values[way]);
+            std::swap(ctrl, target.ctrl[way]);
+            addDistance((target.ctrl[way] & CTRL_SECOND) ? 1 : 0);
+            dropDistance((ctrl & CTRL_SECOND) ? 1 : 0);
+            if (carryingNew) {
+                placedAt = slot;
+                carryingNew = false;
+            } else if (slot == placedAt) {
+                carryingNew = true;  // The new value itself was evicted
+            }
+
+            // The evicted value moves to the bucket it was not in
+            uint64_t evictedHash = hasher(keyOf(carried));
+            int evictedFirst = firstBucket(evictedHash);
+            bool wasSecond = (ctrl & CTRL_SECOND) != 0;
+            bucket = wasSecond ? evictedFirst : secondBucket(evictedHash, evictedFirst);
+            ctrl = fingerprintOf(evictedHash) | (wasSecond ? 0 : CTRL_SECOND);
+            way = freeWay(buckets[bucket]);
+            if (way != -1) {
+                int index = put(bucket, way, ctrl, std::move(carried));
+                return carryingNew ? index : placedAt;
+            }
+        }
+
+        // A walk this long is taken to be a cycle
+        stash.push_back(std::move(carried));
+        addDistance(2);
+        return carryingNew ? getSize() + static_cast<int>(stash.size()) - 1 : placedAt;
+    }
+
+    /**
+     * @brief Set the stash size that forces the next rehash, and reserve it
+     */
+    void limitStash() {
+        int stashed = static_cast<int>(stash.size());
+        stashLimit = (stashed < STASH_SIZE) ? STASH_SIZE : 2 * stashed;
+        stash.reserve(stashLimit);
+    }
+
+    int put(int bucket, int way, uint8_t ctrl, Value&& value) {
+        buckets[bucket].ctrl[way] = ctrl;
+        buckets[bucket].values[way] = std::move(value);
+        addDistance((ctrl & CTRL_SECOND) ? 1 : 0);
+        return bucket * BUCKET_WAYS + way;
+    }
+
+    static int freeWay(const Bucket& bucket) {
+        for (int way = 0; way < BUCKET_WAYS; way++) {
+            if (!isFull(bucket.ctrl[way])) {
+                return way;
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Distance of the value at a slot: its bucket, or 2 in the stash
+     */
+    int distanceAt(int index) const {
+        if (index >= getSize()) {
+            return 2;
+        }
+        return (buckets[index / BUCKET_WAYS].ctrl[index % BUCKET_WAYS] & CTRL_SECOND) ? 1 : 0;
+    }
+
+    void addDistance(int distance) {
+        distanceCounts[distance]++;
+        totalDistance += distance;
+    }
+
+    void dropDistance(int distance) {
+        distanceCounts[distance]--;
+        totalDistance -= distance;
+    }
+
+    /**
+     * @brief Xorshift step picking eviction victims
+     */
+    uint32_t nextRandom() {
+        kickState ^= kickState << 13;
+        kickState ^= kickState >> 17;
+        kickState ^= kickState << 5;
+        return kickState;
+    }
+};
+
+#endif // CUCKOO_HASHTABLE_H
\ No newline at end of file
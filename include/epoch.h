@@ -0,0 +1,109 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Epoch-based reclamation for lock-free readers
+ * A thread reading shared objects holds a Guard, which publishes the
+ * global epoch it started in. Writers that unlink an object retire it
+ * instead of deleting it; the object is tagged with the epoch current at
+ * that time. The global epoch only advances once every active guard has
+ * seen the current one, so after two advances no guard that could have
+ * reached the object is left and it is deleted.
+ *
+ * Guards take a slot from a fixed array (each thread starts at its own
+ * slot, so the claim is normally uncontended); nothing has to be
+ * registered per thread. A stalled guard delays reclamation but never
+ * blocks readers or writers.
+ */
+class EpochManager {
+public:
+    static const int MAX_GUARDS = 256;      // Guards that can be active at once
+    static const int COLLECT_INTERVAL = 64; // Retirements between automatic collections
+
+    /**
+     * @brief Marks the current thread as reading until destroyed
+     */
+    class Guard {
+    public:
+        explicit Guard(EpochManager& manager);
+        ~Guard();
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        EpochManager& epochs;
+        int slot;
+    };
+
+    EpochManager();
+
+    /**
+     * @brief Destructor - deletes every retired object
+     * No guard may be active.
+     */
+    ~EpochManager();
+
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    /**
+     * @brief Delete an object once no guard can still reach it
+     * The object must already be unreachable for guards started from now on.
+     * @param object Object allocated with new
+     */
+    template <class T>
+    void retire(T* object) {
+        retire(object, [](void* pointer) { delete static_cast<T*>(pointer); });
+    }
+
+    /**
+     * @brief Try to advance the epoch and delete objects that became safe
+     * Safe to call at any time; objects retired two epochs back are freed.
+     */
+    void collect();
+
+    /**
+     * @brief Get number of retired objects not yet deleted
+     */
+    size_t getPendingCount() const;
+
+    uint64_t getEpoch() const { return globalEpoch.load(std::memory_order_relaxed); }
+
+private:
+    /**
+     * @brief Epoch published by one guard: (epoch << 1) | 1, 0 when free
+     */
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> state{0};
+    };
+
+    struct Retired {
+        void* object;
+        void (*deleter)(void*);
+        uint64_t epoch;   // Global epoch when retired
+    };
+
+    std::atomic<uint64_t> globalEpoch;
+    Slot slots[MAX_GUARDS];
+
+    mutable std::mutex retiredMutex;   // Guards retired
+    std::vector<Retired> retired;
+
+    void retire(void* object, void (*deleter)(void*));
+
+    int enter();
+    void leave(int slot);
+
+    /**
+     * @brief Advance the global epoch if every active guard has seen it
+     */
+    bool tryAdvance();
+};
+
+#endif // EPOCH_H
\ No newline at end of file
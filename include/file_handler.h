@@ -2,9 +2,25 @@
 #define FILE_HANDLER_H
 
 #include "hashtable.h"
+#include "mapped_file.h"
+#include <deque>
 #include <string>
+#include <string_view>
 #include <vector>
 
+class AtomicFile;
+
+/**
+ * @brief Records parsed in place from a memory-mapped file
+ * Field views point into the mapping, or into unescaped for quoted
+ * fields with doubled quotes, and stay valid as long as this object.
+ */
+struct MappedRecords {
+    MappedFile file;                     // Mapping the views point into
+    std::deque<std::string> unescaped;   // Quoted fields that had to be rewritten
+    std::vector<RecordView> records;     // One per accepted line
+};
+
 /**
  * @brief File I/O operations for hash table persistence
  * Handles saving and loading hash tables to/from disk
@@ -34,6 +50,22 @@ public:
      */
     static bool fileExists(const std::string& filename);
 
+    /**
+     * @brief Force a written file's contents to disk
+     * @param filename File path
+     * @return false if the file cannot be opened or synced
+     */
+    static bool syncFile(const std::string& filename);
+
+    /**
+     * @brief Atomically replace one file with another
+     * After a crash the target holds either its old or its new contents.
+     * @param source File to move, already synced
+     * @param target File to replace
+     * @return false if the rename failed
+     */
+    static bool replaceFile(const std::string& source, const std::string& target);
+
     /**
      * @brief Read all records from file
      * @param filename File path
@@ -41,6 +73,38 @@ public:
      */
     static std::vector<Record> readRecordsFromFile(const std::string& filename);
 
+    /**
+     * @brief Map a file and parse its records without copying fields
+     * @param filename File path
+     * @param result Output: mapping and record views into it
+     * @return false if the file cannot be opened
+     */
+    static bool mapRecordsFromFile(const std::string& filename, MappedRecords& result);
+
+    /**
+     * @brief Parse lines of "username,phone,address" into record views
+     * Fields are trimmed of spaces and tabs, lines may end in CRLF, and the
+     * address runs to the end of the line. A field starting with a double
+     * quote ends at the closing quote and may hold commas and newlines;
+     * "" inside it stands for one quote. A quote that is never closed, or
+     * is followed by more text, is read as part of an unquoted field.
+     * Lines without a username or phone number are skipped.
+     * @param text File contents
+     * @param records Output: views into text, or into unescaped
+     * @param unescaped Output: storage for quoted fields with doubled quotes
+     */
+    static void parseRecords(std::string_view text, std::vector<RecordView>& records,
+                             std::deque<std::string>& unescaped);
+
+    /**
+     * @brief Write one record as a line that parseRecords reads back unchanged
+     * Fields are quoted when they hold a line break, start with a quote,
+     * start or end with a blank, or hold a comma before the address.
+     * @param file Open output file
+     */
+    static void writeRecord(AtomicFile& file, std::string_view username,
+                            std::string_view phoneNumber, std::string_view address);
+
     /**
      * @brief Write records to file
      * @param records Vector of records
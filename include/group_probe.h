@@ -0,0 +1,116 @@
+#ifndef GROUP_PROBE_H
+#define GROUP_PROBE_H
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * @brief Result of comparing one group of control bytes
+ * Bit i refers to the i-th control byte of the group.
+ */
+struct GroupMatch {
+    uint32_t match;  // Bytes equal to the searched fingerprint
+    uint32_t empty;  // Bytes marked empty (0x80)
+};
+
+/**
+ * @brief Group probing engine for hash table control bytes
+ * Compares a whole group of control bytes against a fingerprint at once:
+ * 32 bytes with AVX2, 16 bytes with SSE2, or 16 bytes one at a time with
+ * the scalar fallback. The best engine supported by the CPU is selected
+ * at runtime.
+ */
+class GroupProbe {
+public:
+    enum class Engine {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    typedef GroupMatch (*MatchFunction)(const uint8_t* group, uint8_t fingerprint);
+
+    // Control bytes readable past the last slot by a group load
+    static const int MAX_WIDTH = 32;
+
+    /**
+     * @brief Get the fastest engine supported by this CPU
+     * @return Detected engine
+     */
+    static Engine best();
+
+    /**
+     * @brief Get the engine currently used by match()
+     * @return Active engine
+     */
+    static Engine active();
+
+    /**
+     * @brief Select the engine used by match()
+     * @param engine Engine to use
+     * @return false if the CPU does not support the engine
+     */
+    static bool select(Engine engine);
+
+    /**
+     * @brief Get group width of the active engine
+     * @return Number of control bytes compared per match()
+     */
+    static int width();
+
+    /**
+     * @brief Compare one group of control bytes
+     * @param group First control byte; width() bytes must be readable
+     * @param fingerprint Fingerprint to search for
+     * @return Match and empty bitmasks
+     */
+    static GroupMatch match(const uint8_t* group, uint8_t fingerprint);
+
+    /**
+     * @brief Get the compare function of the active engine
+     * Lets probe loops resolve the engine once per lookup
+     * @return Function equivalent to match()
+     */
+    static MatchFunction matcher();
+
+    /**
+     * @brief Get display name of an engine
+     * @param engine Probe engine
+     * @return Name such as "sse2"
+     */
+    static const char* name(Engine engine);
+
+    /**
+     * @brief Index of the lowest set bit
+     * @param mask Non-zero bitmask
+     * @return Bit position
+     */
+    static int lowestBit(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long bit;
+        _BitScanForward(&bit, mask);
+        return static_cast<int>(bit);
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    /**
+     * @brief Ask the CPU to start loading a cache line
+     * @param address Any address; it is not dereferenced
+     */
+    static void prefetch(const void* address) {
+#if defined(_MSC_VER) && !defined(__clang__)
+#if defined(_M_X64) || defined(_M_IX86)
+        _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#endif
+#else
+        __builtin_prefetch(address);
+#endif
+    }
+};
+
+#endif // GROUP_PROBE_H
\ No newline at end of file
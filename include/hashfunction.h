@@ -2,20 +2,38 @@
 #define HASHFUNCTION_H
 
 #include <string>
+#include <string_view>
+#include <cstdint>
+
+/**
+ * @brief Hash algorithms selectable per hash table
+ * Sum and Polynomial are the original course implementations and are
+ * kept for comparison; WyHash and XXHash64 are 64-bit hashers that
+ * consume 8 bytes per step and mix well for similar keys.
+ */
+enum class HashAlgorithm {
+    Sum,         // sum(ASCII values) % tableSize
+    Polynomial,  // Polynomial rolling hash (hashWithSeed)
+    WyHash,      // wyhash (final version 4)
+    XXHash64     // XXH64
+};
 
 /**
  * @brief Hash function implementation using modulo division method
- * Implements hash(key) = sum(ASCII values) % tableSize
+ * Implements hash(key) = sum(ASCII values) % tableSize and the
+ * 64-bit hashers used by HashTable by default.
  */
 class HashFunction {
 public:
+    static const uint64_t SEED = 0;  // Seed hash64 and index pass to the 64-bit hashers
+
     /**
      * @brief Calculate hash value using modulo division method
      * @param key The string key to hash
      * @param tableSize Size of the hash table
      * @return Hash index in range [0, tableSize-1]
      */
-    static int hash(const std::string& key, int tableSize);
+    static int hash(std::string_view key, int tableSize);
 
     /**
      * @brief Calculate hash with custom seed for better distribution
@@ -23,7 +41,92 @@ public:
      * @param tableSize Size of the hash table
      * @return Hash index in range [0, tableSize-1]
      */
-    static int hashWithSeed(const std::string& key, int tableSize);
+    static int hashWithSeed(std::string_view key, int tableSize);
+
+    /**
+     * @brief 64-bit wyhash of a byte string
+     * @param data Key bytes
+     * @param length Number of bytes
+     * @param seed Hash seed
+     * @return 64-bit hash value
+     */
+    static uint64_t wyhash64(const char* data, size_t length, uint64_t seed = 0);
+
+    /**
+     * @brief 64-bit XXH64 of a byte string
+     * @param data Key bytes
+     * @param length Number of bytes
+     * @param seed Hash seed
+     * @return 64-bit hash value
+     */
+    static uint64_t xxhash64(const char* data, size_t length, uint64_t seed = 0);
+
+    /**
+     * @brief Calculate the full 64-bit hash with the selected algorithm
+     * Sum and Polynomial return their values before reduction
+     * @param key The string key to hash
+     * @param algorithm Hash algorithm
+     * @return 64-bit hash value
+     */
+    static uint64_t hash64(std::string_view key, HashAlgorithm algorithm);
+
+    /**
+     * @brief Calculate table index with the selected algorithm
+     * @param key The string key to hash
+     * @param tableSize Size of the hash table
+     * @param algorithm Hash algorithm
+     * @return Hash index in range [0, tableSize-1]
+     */
+    static int index(std::string_view key, int tableSize, HashAlgorithm algorithm);
+
+    /**
+     * @brief Finalizer mixing all bits of a 64-bit integer key
+     * @param value Integer key
+     * @return 64-bit hash value
+     */
+    static uint64_t mix64(uint64_t value);
+
+    /**
+     * @brief Get display name of an algorithm
+     * @param algorithm Hash algorithm
+     * @return Name such as "wyhash"
+     */
+    static const char* name(HashAlgorithm algorithm);
 };
 
+/**
+ * @brief Hash policy for string keys with a runtime-selected algorithm
+ * Transparent: std::string, std::string_view and const char* keys hash
+ * identically, so lookups need not build a std::string.
+ */
+struct StringHash {
+    typedef void is_transparent;
+
+    HashAlgorithm algorithm;
+
+    StringHash(HashAlgorithm hashAlgorithm = HashAlgorithm::WyHash) : algorithm(hashAlgorithm) {}
+
+    uint64_t operator()(std::string_view key) const {
+        return HashFunction::hash64(key, algorithm);
+    }
+};
+
+/**
+ * @brief Hash policy for integer keys such as numeric phone numbers
+ */
+struct IntegerHash {
+    uint64_t operator()(uint64_t key) const {
+        return HashFunction::mix64(key);
+    }
+};
+
+/**
+ * @brief Default hash policy of BasicHashTable for a key type
+ */
+template <class Key>
+struct DefaultHash : IntegerHash {};
+
+template <>
+struct DefaultHash<std::string> : StringHash {};
+
 #endif // HASHFUNCTION_H
\ No newline at end of file
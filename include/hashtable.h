@@ -2,61 +2,319 @@
 #define HASHTABLE_H
 
 #include "record.h"
-#include <vector>
+#include "hashfunction.h"
+#include "collision.h"
+#include "basic_hashtable.h"
+#include "cuckoo_hashtable.h"
+#include "chained_hashtable.h"
+#include "record_store.h"
+#include <memory>
 #include <string>
+#include <string_view>
+#include <optional>
+#include <variant>
+#include <vector>
+
+/**
+ * @brief Key extraction policy indexing record IDs by username
+ */
+struct UsernameKey {
+    const RecordStore* store = nullptr;
+
+    std::string_view operator()(uint32_t id) const { return store->username(id); }
+    void prefetch(uint32_t id) const { store->prefetch(id); }
+};
+
+/**
+ * @brief Key extraction policy indexing record IDs by phone number
+ */
+struct PhoneKey {
+    const RecordStore* store = nullptr;
+
+    std::string_view operator()(uint32_t id) const { return store->phoneNumber(id); }
+    void prefetch(uint32_t id) const { store->prefetch(id); }
+};
+
+// Slots hold 32-bit record IDs; transparent hash and equality let lookups
+// take std::string_view without copying
+typedef BasicHashTable<std::string_view, uint32_t, UsernameKey, StringHash, std::equal_to<>> UsernameTable;
+typedef BasicHashTable<std::string_view, uint32_t, PhoneKey, StringHash, std::equal_to<>> PhoneTable;
+typedef CuckooHashTable<std::string_view, uint32_t, UsernameKey, StringHash, std::equal_to<>> UsernameCuckooTable;
+typedef CuckooHashTable<std::string_view, uint32_t, PhoneKey, StringHash, std::equal_to<>> PhoneCuckooTable;
+typedef ChainedHashTable<std::string_view, uint32_t, UsernameKey, StringHash, std::equal_to<>> UsernameChainedTable;
+typedef ChainedHashTable<std::string_view, uint32_t, PhoneKey, StringHash, std::equal_to<>> PhoneChainedTable;
+
+// Engine of a HashTable: one alternative per key type and table layout
+typedef std::variant<UsernameTable, PhoneTable, UsernameCuckooTable, PhoneCuckooTable,
+                     UsernameChainedTable, PhoneChainedTable> TableEngine;
+
+/**
+ * @brief Numbers shown by the statistics views for one index
+ * Read from bookkeeping the table maintains as it changes, so taking
+ * them costs O(1) whatever the table size.
+ */
+struct TableStats {
+    int size = 0;                      // Slots
+    int count = 0;                     // Records
+    double loadFactor = 0.0;           // count / size
+    double averageSearchLength = 0.0;  // Probes per successful lookup
+    int maxProbeDistance = 0;          // Slots the farthest record sits past its home
+    int tombstones = 0;                // Slots left behind by lazy deletion
+    int compactions = 0;               // In-place rehashes that dropped tombstones
+    int filterBits = 0;                // Lookup filter bits per record, 0 without a filter
+    size_t filterBytes = 0;            // Memory taken by the lookup filter
+    std::vector<int> distanceHistogram;  // Records per probe distance; the last entry counts every larger one
+
+    /**
+     * @brief Share of records found in 1, 2, ... probes
+     * @param buckets Number of shares; the last covers every longer lookup
+     * @return Fractions summing to 1, all zero for an empty table
+     */
+    std::vector<double> probeLengthShares(int buckets) const;
+};
+
+/**
+ * @brief Estimates the statistics views ask for on top of TableStats
+ * Each walks a fixed set of absent sample keys through the table, so
+ * they cost far more than TableStats and are taken only on request.
+ */
+struct SampledStats {
+    double missSearchLength = 0.0;         // Probes per unsuccessful lookup
+    double filterFalsePositiveRate = 0.0;  // Share of absent keys the filter lets through
+};
 
 /**
- * @brief Hash table implementation with linear probing
- * Supports operations by both username and phone number keys
+ * @brief Phone directory hash table keyed by username or phone number
+ * Wraps the engine instantiation selected by the key type and probe
+ * strategy given at construction: a BasicHashTable, a CuckooHashTable
+ * for ProbeStrategy::Cuckoo or a ChainedHashTable for
+ * ProbeStrategy::Chaining. The choice is made once per operation, not
+ * per probe.
+ * Adds the directory behaviour on top of the engine: empty key and
+ * duplicate diagnostics, display, and CSV save/load.
+ *
+ * Records live in a RecordStore and the slots hold only their 32-bit IDs
+ * next to the control byte fingerprints. A table creates its own store
+ * unless one is passed in; tables sharing a store (PhoneDirectory) index
+ * the same records and are kept in step by their owner through the
+ * link and unlink functions, while insert() and remove() also add and
+ * drop the record in the store.
  */
 class HashTable {
 private:
-    std::vector<Record> table;  // Hash table storage
-    int size;                   // Table size
-    int count;                  // Number of active records
-    std::string keyType;        // "username" or "phone"
+    std::shared_ptr<RecordStore> store;  // Records indexed by this table
+    TableEngine table;             // Engine for the key type and strategy
+    std::string keyType;           // "username" or "phone"
+    HashAlgorithm algorithm;       // Hash function used for home slots
+    mutable std::string savedFile;     // File of the last successful save
+    mutable uint64_t savedVersion = 0; // Store version written by that save
 
     /**
-     * @brief Find index for a given key
-     * @param key Search key
-     * @param searchLength Output parameter for probe count
-     * @return Index if found, -1 otherwise
+     * @brief Build the engine for a key type
+     */
+    static TableEngine makeTable(int tableSize, const std::string& type, double maxLoad,
+                                 HashAlgorithm hashAlgorithm, ProbeStrategy probeStrategy,
+                                 const RecordStore* store);
+
+    bool byUsername() const { return keyType == "username"; }
+
+    /**
+     * @brief hashKeys and bulkInsert for Record or RecordView input
      */
-    int findIndex(const std::string& key, int& searchLength) const;
+    template <class Records>
+    std::vector<uint64_t> hashKeysOf(const Records& records) const;
+
+    template <class Records>
+    int bulkInsertOf(const Records& records);
+
+    /**
+     * @brief Call function(record) for every active record in slot order
+     */
+    template <class Function>
+    void forEachRecord(Function function) const {
+        std::visit([&](const auto& engine) {
+            for (int i = 0; i < engine.getSlotCount(); i++) {
+                if (engine.isOccupied(i)) {
+                    function(store->view(engine.valueAt(i)));
+                }
+            }
+        }, table);
+    }
 
 public:
     /**
      * @brief Constructor
      * @param tableSize Size of hash table (should be prime for better distribution)
      * @param type Key type: "username" or "phone"
+     * @param maxLoad Load factor that triggers growth
+     * @param hashAlgorithm Hash function for computing home slots
+     * @param probeStrategy Probe sequence and deletion policy; Cuckoo selects
+     *        the bucketized cuckoo engine, Chaining the separate chaining one
+     */
+    HashTable(int tableSize, const std::string& type = "username", double maxLoad = 0.75,
+              HashAlgorithm hashAlgorithm = HashAlgorithm::WyHash,
+              ProbeStrategy probeStrategy = ProbeStrategy::Linear);
+
+    /**
+     * @brief Constructor for a table indexing a shared record store
+     * @param sharedStore Store holding the indexed records
+     * @param tableSize Initial number of slots
+     * @param type Key type: "username" or "phone"
+     * @param maxLoad Load factor that triggers growth
+     * @param hashAlgorithm Hash function for computing home slots
+     * @param probeStrategy Probe sequence and deletion policy; Cuckoo selects
+     *        the bucketized cuckoo engine, Chaining the separate chaining one
      */
-    HashTable(int tableSize, const std::string& type = "username");
+    HashTable(std::shared_ptr<RecordStore> sharedStore, int tableSize, const std::string& type,
+              double maxLoad = 0.75, HashAlgorithm hashAlgorithm = HashAlgorithm::WyHash,
+              ProbeStrategy probeStrategy = ProbeStrategy::Linear);
 
     /**
      * @brief Destructor
      */
     ~HashTable();
 
+    // Engines hold a pointer to the store, so a table is not copied
+    HashTable(const HashTable&) = delete;
+    HashTable& operator=(const HashTable&) = delete;
+
+    /**
+     * @brief Exchange contents, including the record store, with another table
+     * Each engine keeps pointing at the store it indexes.
+     */
+    void swap(HashTable& other);
+
     /**
      * @brief Insert a record into hash table
      * @param record Record to insert
-     * @return true if successful, false if duplicate or table full
+     * @return true if successful, false if duplicate or empty key
      */
     bool insert(const Record& record);
 
     /**
      * @brief Search for a record by key
      * @param key Search key (username or phone)
-     * @return Pointer to record if found, nullptr otherwise
+     * @return View of the record if found, empty otherwise
+     */
+    std::optional<RecordView> search(std::string_view key);
+
+    /**
+     * @brief Search for many keys at once
+     * Overlaps the cache misses of the lookups; faster than calling search
+     * per key once the table outgrows the cache. Does not advance migration.
+     * @param keys Search keys (usernames or phones)
+     * @param keyCount Number of keys
+     * @param results Output: view of each key's record, empty if not found
      */
-    Record* search(const std::string& key);
+    void searchBatch(const std::string_view* keys, int keyCount, std::optional<RecordView>* results) const;
 
     /**
      * @brief Delete a record by key
      * @param key Key to delete
      * @return true if deleted, false if not found
      */
-    bool remove(const std::string& key);
+    bool remove(std::string_view key);
+
+    /**
+     * @brief Index a record already in the store
+     * @param id Record ID from the store
+     * @return false if its key is empty or already indexed
+     */
+    bool link(uint32_t id);
+
+    /**
+     * @brief Reserve room for a key before its record is linked
+     * First half of link(), split so an owner can prepare several tables
+     * and then commit to all or none of them. Nothing is written, so an
+     * abandoned reservation needs no undo.
+     * @param key Key of the record to link
+     * @return false if the key is empty or already indexed
+     */
+    bool prepareLink(std::string_view key);
+
+    /**
+     * @brief Index a record whose key passed prepareLink
+     * Does not allocate; the table must not change in between.
+     * @param id Record ID from the store
+     */
+    void commitLink(uint32_t id);
+
+    /**
+     * @brief Grow once so recordCount records fit without a resize
+     * @param recordCount Total number of records the table should hold
+     */
+    void reserve(int recordCount);
+
+    /**
+     * @brief Hash the key of every record for this table
+     * Large inputs are split across hardware threads; the table is only read.
+     * @param records Records whose username or phone number is hashed
+     * @return Hash per record, for linkHashed
+     */
+    std::vector<uint64_t> hashKeys(const std::vector<Record>& records) const;
+    std::vector<uint64_t> hashKeys(const std::vector<RecordView>& records) const;
+
+    /**
+     * @brief Index a stored record whose key hash is already known
+     * Places the ID with a single probe that also detects a duplicate key.
+     * @param id Record ID from the store
+     * @param hash Hash of the record's key from hashKeys
+     * @return Slot index for unlinkAt, -1 if the key is already indexed
+     */
+    int linkHashed(uint32_t id, uint64_t hash);
+
+    /**
+     * @brief Insert many records, as when loading a file
+     * Sizes the table once for all of them, hashes their keys in parallel
+     * and places each with one probe. Records with an empty or duplicate
+     * key are skipped.
+     * @param records Records to insert (views are copied into the store)
+     * @return Number of records inserted
+     */
+    int bulkInsert(const std::vector<Record>& records);
+    int bulkInsert(const std::vector<RecordView>& records);
+
+    /**
+     * @brief Drop a key from this table only, leaving the record stored
+     * @param key Key to unlink
+     * @return ID of the unlinked record, RecordStore::NO_RECORD if not found
+     */
+    uint32_t unlink(std::string_view key);
+
+    /**
+     * @brief Find the slot holding a key, without advancing migration
+     * Slot indexes stay valid until this table is next modified.
+     * @param key Search key (username or phone)
+     * @return Slot index for getIdAt/unlinkAt, -1 if not found
+     */
+    int findSlot(std::string_view key) const;
+
+    /**
+     * @brief Drop the entry at a slot returned by findSlot
+     * @param index Slot index of an occupied slot
+     */
+    void unlinkAt(int index);
+
+    /**
+     * @brief Get the record ID held by a slot
+     * @param index Slot index, 0 to getSlotCount() - 1
+     * @return Record ID, RecordStore::NO_RECORD for empty and deleted slots
+     */
+    uint32_t getIdAt(int index) const;
+
+    /**
+     * @brief Look up the record ID of a key
+     * @param key Search key (username or phone)
+     * @return Record ID, RecordStore::NO_RECORD if not found
+     */
+    uint32_t findId(std::string_view key) const;
+
+    /**
+     * @brief Check whether a key is present
+     * @param key Search key (username or phone)
+     * @return true if found
+     */
+    bool contains(std::string_view key) const;
 
     /**
      * @brief Display all active records
@@ -68,7 +326,7 @@ public:
      * @param key Search key
      * @return Number of probes, -1 if not found
      */
-    int getSearchLength(const std::string& key) const;
+    int getSearchLength(std::string_view key) const;
 
     /**
      * @brief Calculate average search length
@@ -76,17 +334,119 @@ public:
      */
     double getAverageSearchLength() const;
 
+    /**
+     * @brief Get size, count, load factor and probe distance statistics
+     * @return Statistics of this table
+     */
+    TableStats getStats() const;
+
+    /**
+     * @brief Sample the miss search length and filter false positive rate
+     * @return Estimates for this table
+     */
+    SampledStats getSampledStats() const;
+
+    /**
+     * @brief Get the largest probe distance of any record
+     * @return Probes beyond the home slot (0 = at home)
+     */
+    int getMaxProbeDistance() const;
+
+    /**
+     * @brief Get the mean probe distance across all records
+     * @return Average probes beyond the home slot
+     */
+    double getMeanProbeDistance() const;
+
     /**
      * @brief Get current load factor
      * @return Load factor (count / size)
      */
     double getLoadFactor() const;
 
+    /**
+     * @brief Get load factor threshold that triggers growth
+     * @return Maximum load factor
+     */
+    double getMaxLoadFactor() const;
+
+    /**
+     * @brief Set load factor threshold that triggers growth
+     * Quadratic probing is capped at 0.5, where a prime table size
+     * guarantees the sequence reaches a free slot
+     * @param maxLoad Value clamped to [0.1, 0.95]; up to 8.0 for Chaining
+     */
+    void setMaxLoadFactor(double maxLoad);
+
+    /**
+     * @brief Get the share of non-record slots tombstones may take before
+     * an insert compacts the table
+     */
+    double getMaxTombstoneRatio() const;
+
+    /**
+     * @brief Set the tombstone share that triggers compaction
+     * @param ratio Value clamped to [0.05, 1.0]; 1.0 never compacts
+     */
+    void setMaxTombstoneRatio(double ratio);
+
+    /**
+     * @brief Rehash the table in place, turning tombstones back into empty slots
+     * Slot indices from before the call are invalidated.
+     */
+    void compact();
+
+    /**
+     * @brief Estimate the probes taken by an unsuccessful lookup
+     * @return Mean probes per miss over a fixed set of sample positions
+     */
+    double getMissSearchLength() const;
+
+    /**
+     * @brief Enable, resize or disable the Bloom filter consulted before probing
+     * Absent keys are then mostly rejected without touching a slot.
+     * @param bitsPerRecord Filter bits per record; 0 disables the filter
+     */
+    void setFilterBits(int bitsPerRecord);
+
+    /**
+     * @brief Get the lookup filter's bits per record, 0 when disabled
+     */
+    int getFilterBits() const;
+
+    /**
+     * @brief Check whether an incremental resize is in progress
+     * @return true while old slots remain to be migrated
+     */
+    bool isResizing() const;
+
+    /**
+     * @brief Get progress of the current incremental resize
+     * @return Fraction of old slots migrated, 1.0 when not resizing
+     */
+    double getMigrationProgress() const;
+
     /**
      * @brief Save hash table to file
+     * Rows are written in large blocks to a temporary file, which is synced
+     * and renamed over filename, so an interrupted save keeps the old file.
+     * @param filename File path
+     * @return false if the file could not be written
+     */
+    bool saveToFile(const std::string& filename) const;
+
+    /**
+     * @brief Save only if the records changed since the last save to filename
      * @param filename File path
+     * @return false if a save was needed and failed
      */
-    void saveToFile(const std::string& filename) const;
+    bool saveIfModified(const std::string& filename) const;
+
+    /**
+     * @brief Check whether the records changed since the last save to filename
+     * Also true if the file has never been saved by this table or is missing.
+     */
+    bool isModifiedSince(const std::string& filename) const;
 
     /**
      * @brief Load hash table from file
@@ -95,8 +455,23 @@ public:
      */
     int loadFromFile(const std::string& filename);
 
+    /**
+     * @brief Write this table's slots to a snapshot (the store is saved by its owner)
+     */
+    void saveIndex(SnapshotWriter& writer) const;
+
+    /**
+     * @brief Restore slots written by saveIndex
+     * The store must already hold the records the slots refer to; a slot
+     * naming any other ID makes the data malformed.
+     * @return false, leaving the table unchanged, if the data is malformed or
+     *         belongs to another key type or probe strategy
+     */
+    bool loadIndex(SnapshotReader& reader);
+
     /**
      * @brief Clear all records
+     * Empties the record store as well, including records of tables sharing it
      */
     void clear();
 
@@ -104,13 +479,19 @@ public:
      * @brief Get number of active records
      * @return Record count
      */
-    int getCount() const { return count; }
+    int getCount() const;
 
     /**
      * @brief Get table size
      * @return Table size
      */
-    int getSize() const { return size; }
+    int getSize() const;
+
+    /**
+     * @brief Get number of addressable slots for getRecordAt
+     * @return Table size plus old table size while resizing
+     */
+    int getSlotCount() const;
 
     /**
      * @brief Get key type
@@ -118,12 +499,36 @@ public:
      */
     std::string getKeyType() const { return keyType; }
 
+    /**
+     * @brief Get hash algorithm
+     * @return Algorithm used for home slots
+     */
+    HashAlgorithm getHashAlgorithm() const { return algorithm; }
+
+    /**
+     * @brief Get probe strategy
+     * @return Strategy chosen at construction
+     */
+    ProbeStrategy getProbeStrategy() const;
+
     /**
      * @brief Get record at specific index (for GUI display)
-     * @param index Table index
-     * @return Const pointer to record, nullptr if invalid index
+     * Empty and deleted slots yield a view flagged isEmpty or isDeleted.
+     * @param index Slot index in [0, getSlotCount())
+     * @return View of the slot, empty if invalid index
+     */
+    std::optional<RecordView> getRecordAt(int index) const;
+
+    /**
+     * @brief Get bytes held by the string arena
+     * @return Bytes of chunks allocated for record fields
+     */
+    size_t getStringBytes() const { return store->getStringBytes(); }
+
+    /**
+     * @brief Get the record store indexed by this table
      */
-    const Record* getRecordAt(int index) const;
+    const RecordStore& getStore() const { return *store; }
 };
 
 #endif // HASHTABLE_H
\ No newline at end of file
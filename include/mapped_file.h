@@ -0,0 +1,55 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ * The file's bytes are addressed directly through the page cache, so
+ * reading it needs no buffer and no copy. The mapping is released when
+ * the object is destroyed or reassigned; views into it are valid until
+ * then. An empty file maps to an empty view.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    /**
+     * @brief Destructor - unmaps the file
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * @brief Map a file, replacing any current mapping
+     * @param filename File path
+     * @return false if the file cannot be opened or mapped
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Unmap the file
+     */
+    void close();
+
+    bool isOpen() const { return opened; }
+
+    /**
+     * @brief Get the mapped bytes
+     */
+    std::string_view text() const { return std::string_view(data, length); }
+
+private:
+    const char* data = nullptr;  // Start of the mapping, null for an empty file
+    size_t length = 0;           // Bytes mapped
+    bool opened = false;         // open() succeeded
+};
+
+#endif // MAPPED_FILE_H
\ No newline at end of file
@@ -1,26 +1,38 @@
 #ifndef OPERATIONS_H
 #define OPERATIONS_H
 
-#include "hashtable.h"
+#include "phone_directory.h"
+#include "sharded_directory.h"
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <vector>
 
 /**
  * @brief User interface operations and menu management
- * Manages dual hash tables (by username and phone)
+ * Manages a phone directory indexed by username and phone. In sharded
+ * mode the records are served by a ShardedDirectory instead, which logs
+ * its changes to the same write-ahead log, and the PhoneDirectory only
+ * holds them while they are loaded or checkpointed.
  */
 class Operations {
 private:
-    std::unique_ptr<HashTable> usernameTable;
-    std::unique_ptr<HashTable> phoneTable;
-    const std::string usernameFile;
-    const std::string phoneFile;
+    std::unique_ptr<PhoneDirectory> directory;
+    std::unique_ptr<ShardedDirectory> sharded;  // Serves the menu in sharded mode, null otherwise
+    const std::string recordFile;          // Every record, once
+    const std::string legacyUsernameFile;  // Older two-file layout, read if recordFile is missing
+    const std::string legacyPhoneFile;
+    const std::string snapshotFile;   // Checkpoint of the write-ahead log
+    const std::string logFile;        // Changes since the checkpoint
 
 public:
     /**
      * @brief Constructor
      * @param tableSize Size of hash tables
+     * @param shardCount Shards, each with its own worker thread; 0 serves
+     *        every record from one directory on the calling thread
      */
-    Operations(int tableSize);
+    Operations(int tableSize, int shardCount = 0);
 
     /**
      * @brief Display main menu
@@ -40,6 +52,8 @@ public:
 
     /**
      * @brief Load data from files at startup
+     * Restores the checkpoint snapshot (or the record file if there is
+     * none yet), then replays the write-ahead log on top.
      */
     void loadData();
 
@@ -57,22 +71,46 @@ private:
     void deleteByPhone();
     void displayAllRecords();
     void displayStatistics();
+    void printTableStats(const TableStats& stats, const SampledStats& sampled);
+    void printShardRows(const std::vector<TableStats>& shards);
     void saveToFiles();
     void loadFromFiles();
 
+    /**
+     * @brief Load the record file, or migrate a legacy two-file dataset
+     * @return Number of records loaded
+     */
+    int loadRecordFile();
+
+    /**
+     * @brief Move the records loaded into the directory to the shards
+     */
+    void shardRecords();
+
+    /**
+     * @brief Write the shards' records as the checkpoint snapshot
+     * The directory holds them only while the snapshot is written.
+     * @param records Every record in the shards
+     * @param logSequence Last logged change the records include
+     * @return false if the snapshot could not be written
+     */
+    bool writeShardCheckpoint(const std::vector<Record>& records, uint64_t logSequence);
+
+    /**
+     * @brief Look up a record in the directory or the shards
+     * @param key Username or phone number
+     * @param byUsername Whether key is a username
+     * @param searchLength Output: probes taken in the key's table
+     * @return Copy of the record if found, empty otherwise
+     */
+    std::optional<Record> findRecord(const std::string& key, bool byUsername, int& searchLength);
+
     /**
      * @brief Get validated string input
      * @param prompt Prompt message
      * @return User input string
      */
     std::string getStringInput(const std::string& prompt) const;
-
-    /**
-     * @brief Sync record across both hash tables
-     * @param record Record to sync
-     * @param operation "insert" or "delete"
-     */
-    bool syncTables(const Record& record, const std::string& operation);
 };
 
 #endif // OPERATIONS_H
\ No newline at end of file
@@ -0,0 +1,285 @@
+#ifndef PHONE_DIRECTORY_H
+#define PHONE_DIRECTORY_H
+
+#include "hashtable.h"
+#include "record_store.h"
+#include "write_ahead_log.h"
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Result of checking that a directory's indexes agree
+ */
+struct ConsistencyReport {
+    int records = 0;          // Live records in the store
+    int usernameEntries = 0;  // Occupied slots of the username table
+    int phoneEntries = 0;     // Occupied slots of the phone table
+    int dangling = 0;         // Entries holding the ID of a removed record
+    int unreachable = 0;      // Entries their own table cannot find by key
+    int unmatched = 0;        // Entries the other table maps to a different ID
+
+    bool isConsistent() const {
+        return dangling == 0 && unreachable == 0 && unmatched == 0 &&
+               usernameEntries == records && phoneEntries == records;
+    }
+};
+
+/**
+ * @brief Differences between the two files of a legacy dataset
+ * Older versions saved the same records to a username file and a phone
+ * file; the two could drift apart.
+ */
+struct DriftReport {
+    int usernameFileRecords = 0;  // Records parsed from the username file
+    int phoneFileRecords = 0;     // Records parsed from the phone file
+    int matching = 0;             // Phone file records identical to a loaded record
+    int conflicting = 0;          // Phone file records sharing a key with a different record
+    int onlyInPhoneFile = 0;      // Phone file records sharing no key; loaded as well
+    int onlyInUsernameFile = 0;   // Loaded records no phone file record shares a key with
+
+    bool hasDrift() const { return conflicting > 0 || onlyInPhoneFile > 0 || onlyInUsernameFile > 0; }
+};
+
+/**
+ * @brief Phone directory indexed by username and by phone number
+ * Every record is stored once in a shared RecordStore; the username and
+ * phone tables hold only record IDs. Inserting adds the record to the
+ * store and links it into both tables, removing unlinks it from both and
+ * drops it from the store. Each is all or nothing: slots in both tables
+ * are reserved or located before either table changes, so the two
+ * indexes always describe the same records.
+ *
+ * With a write-ahead log opened, every successful change is appended to
+ * it, and the log is checkpointed into a snapshot whenever it grows past
+ * its limit. Reopening restores the snapshot and replays the log on top.
+ */
+class PhoneDirectory {
+private:
+    std::shared_ptr<RecordStore> store;  // Single copy of every record
+    HashTable usernameTable;             // Index by username
+    HashTable phoneTable;                // Index by phone number
+    std::unique_ptr<WriteAheadLog> log;  // Null unless openLog succeeded
+    std::string checkpointFile;          // Snapshot the log is checkpointed into
+    uint64_t logSequence = 0;            // Sequence number of the last logged change
+
+    /**
+     * @brief Unlink a record from both tables and drop it from the store
+     * @return false, changing nothing, if the tables disagree on the record
+     */
+    bool erase(uint32_t id);
+
+    /**
+     * @brief bulkInsert for Record or RecordView input
+     */
+    template <class Records>
+    int bulkInsertOf(const Records& records);
+
+    /**
+     * @brief Append a change to the log, if one is open
+     * Checkpoints once the log has grown past its limit.
+     */
+    void logChange(LogOperation operation, std::string_view first = {},
+                   std::string_view second = {}, std::string_view third = {});
+
+    /**
+     * @brief Write a snapshot without reporting success
+     */
+    bool writeSnapshot(const std::string& filename) const;
+
+public:
+    /**
+     * @brief Constructor
+     * @param tableSize Initial size of each table
+     * @param maxLoad Load factor that triggers growth
+     * @param hashAlgorithm Hash function for computing home slots
+     * @param probeStrategy Probe sequence and deletion policy
+     */
+    PhoneDirectory(int tableSize, double maxLoad = 0.75,
+                   HashAlgorithm hashAlgorithm = HashAlgorithm::WyHash,
+                   ProbeStrategy probeStrategy = ProbeStrategy::Linear);
+
+    /**
+     * @brief Insert a record into both tables
+     * @param record Record to insert
+     * @return true if inserted, false if a key is empty or already used
+     */
+    bool insert(const Record& record);
+
+    /**
+     * @brief Put a Bloom filter in front of both tables
+     * Searches for absent usernames or phone numbers, and the duplicate
+     * checks of inserts, are then mostly answered without probing.
+     * @param bitsPerRecord Filter bits per record; 0 removes the filters
+     */
+    void setLookupFilter(int bitsPerRecord);
+
+    /**
+     * @brief Search by username
+     * @param username Search key
+     * @return View of the record if found, empty otherwise
+     */
+    std::optional<RecordView> searchByUsername(std::string_view username);
+
+    /**
+     * @brief Search by phone number
+     * @param phone Search key
+     * @return View of the record if found, empty otherwise
+     */
+    std::optional<RecordView> searchByPhone(std::string_view phone);
+
+    /**
+     * @brief Delete the record with a username from both tables
+     * @param username Key to delete
+     * @return true if deleted, false if not found
+     */
+    bool removeByUsername(std::string_view username);
+
+    /**
+     * @brief Delete the record with a phone number from both tables
+     * @param phone Key to delete
+     * @return true if deleted, false if not found
+     */
+    bool removeByPhone(std::string_view phone);
+
+    /**
+     * @brief Insert many records into both tables, as when loading a file
+     * Sizes the store and both tables once, hashes all keys in parallel
+     * and builds the two tables at the same time, linking each record with
+     * one probe per table. Records are accepted exactly as inserting them
+     * one by one in order would accept them, each all or nothing, and a
+     * load with duplicates leaves no tombstones.
+     * @param records Records to insert (views are copied into the store)
+     * @return Number of records inserted
+     */
+    int bulkInsert(const std::vector<Record>& records);
+    int bulkInsert(const std::vector<RecordView>& records);
+
+    /**
+     * @brief Load records from file into both tables
+     * Format: username,phone,address, or a snapshot from saveSnapshot
+     * @param filename File path
+     * @return Number of records loaded
+     */
+    int loadFromFile(const std::string& filename);
+
+    /**
+     * @brief Load a legacy dataset saved as a username file and a phone file
+     * The username file is loaded and the phone file compared against it;
+     * records found only in the phone file are loaded too, and where the
+     * files disagree the username file wins. Either file may be missing.
+     * @param usernameFile Username file path
+     * @param phoneFile Phone file path
+     * @param drift Output: how far the files have drifted apart
+     * @return Number of records loaded
+     */
+    int loadLegacyFiles(const std::string& usernameFile, const std::string& phoneFile, DriftReport& drift);
+
+    /**
+     * @brief Save the store and both indexes as a binary snapshot
+     * Records, field bytes and slot arrays are written as laid out in
+     * memory, behind a header naming the hash function, seed, probe
+     * strategy and record count plus a checksum of the rest. The file is
+     * replaced atomically, as by HashTable::saveToFile.
+     * @param filename Output file path
+     * @return false if the file could not be written
+     */
+    bool saveSnapshot(const std::string& filename) const;
+
+    /**
+     * @brief Replace all records with a snapshot written by saveSnapshot
+     * The file is mapped, its checksum verified, and the arrays copied
+     * back in place; no key is hashed or compared.
+     * @param filename Snapshot file path
+     * @return false, leaving the directory unchanged, if the file is missing,
+     *         damaged, or written with another hash function or probe strategy
+     */
+    bool loadSnapshot(const std::string& filename);
+
+    /**
+     * @brief Replay a write-ahead log and log every later change to it
+     * Call after restoring the checkpoint snapshot, if there is one; log
+     * entries the snapshot already holds are skipped. Bulk inserts and
+     * snapshot loads are not logged entry by entry but checkpointed.
+     * @param logFile Log file path, created if missing
+     * @param snapshotFile Snapshot that checkpoints are written to
+     * @param options Group commit and checkpoint policy
+     * @return Number of changes replayed, -1 if the log cannot be opened
+     */
+    int openLog(const std::string& logFile, const std::string& snapshotFile,
+                const LogOptions& options = LogOptions());
+
+    /**
+     * @brief Save a snapshot and empty the log
+     * The snapshot is written beside the old one and renamed over it once
+     * synced, so a crash at any point leaves a snapshot and log that
+     * together hold every committed change.
+     * @return false if no log is open or the snapshot could not be written
+     */
+    bool checkpoint();
+
+    /**
+     * @brief Commit pending log entries and stop logging
+     */
+    void closeLog();
+
+    /**
+     * @brief Get the open log, or null (sync policy, statistics)
+     */
+    WriteAheadLog* getLog() const { return log.get(); }
+
+    /**
+     * @brief Get the sequence number of the last change logged or replayed
+     */
+    uint64_t getLogSequence() const { return logSequence; }
+
+    /**
+     * @brief Mark the records held as including changes logged elsewhere
+     * A snapshot saved next tells replay to skip entries up to sequence,
+     * as when a ShardedDirectory checkpoints through this directory.
+     */
+    void setLogSequence(uint64_t sequence) { logSequence = sequence; }
+
+    /**
+     * @brief Clear all records
+     */
+    void clear();
+
+    /**
+     * @brief Verify that both indexes hold exactly the stored records
+     * Visits every slot of both tables once and looks each record up by
+     * both keys; linear in the table sizes.
+     * @return Counts of entries and of each kind of disagreement
+     */
+    ConsistencyReport checkConsistency() const { return checkIndexes(*store, usernameTable, phoneTable); }
+
+    /**
+     * @brief Verify a username and a phone table indexing the same store
+     * @param store Store the tables index
+     * @param usernames Table keyed by username
+     * @param phones Table keyed by phone number
+     * @return Counts of entries and of each kind of disagreement
+     */
+    static ConsistencyReport checkIndexes(const RecordStore& store, const HashTable& usernames,
+                                          const HashTable& phones);
+
+    /**
+     * @brief Get number of records
+     * @return Record count
+     */
+    int getCount() const { return store->getCount(); }
+
+    /**
+     * @brief Get the username index (statistics, display, saving)
+     */
+    const HashTable& getUsernameTable() const { return usernameTable; }
+
+    /**
+     * @brief Get the phone number index (statistics, display, saving)
+     */
+    const HashTable& getPhoneTable() const { return phoneTable; }
+};
+
+#endif // PHONE_DIRECTORY_H
\ No newline at end of file
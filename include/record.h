@@ -2,6 +2,9 @@
 #define RECORD_H
 
 #include <string>
+#include <string_view>
+
+struct RecordView;
 
 /**
  * @brief Record structure for phone directory entry
@@ -21,6 +24,9 @@ struct Record {
     Record(const std::string& user, const std::string& phone, const std::string& addr)
         : username(user), phoneNumber(phone), address(addr), isDeleted(false), isEmpty(false) {}
 
+    // Copy of a record read from a table
+    explicit Record(const RecordView& view);
+
     // Check if slot is available for insertion
     bool isAvailable() const {
         return isEmpty || isDeleted;
@@ -36,4 +42,21 @@ struct Record {
     }
 };
 
+/**
+ * @brief Read-only view of a record stored in a hash table
+ * Fields point into the table's string storage and stay valid until the
+ * table is next modified; copy into a Record to keep them longer.
+ */
+struct RecordView {
+    std::string_view username;
+    std::string_view phoneNumber;
+    std::string_view address;
+    bool isDeleted = false;  // Slot holds a tombstone
+    bool isEmpty = false;    // Slot never used
+};
+
+inline Record::Record(const RecordView& view)
+    : username(view.username), phoneNumber(view.phoneNumber), address(view.address),
+      isDeleted(false), isEmpty(false) {}
+
 #endif // RECORD_H
\ No newline at end of file
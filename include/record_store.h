@@ -0,0 +1,140 @@
+#ifndef RECORD_STORE_H
+#define RECORD_STORE_H
+
+#include "group_probe.h"
+#include "record.h"
+#include "string_arena.h"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Record as kept by a RecordStore
+ * Fields are references into the store's StringArena.
+ */
+struct PackedRecord {
+    StringRef username;
+    StringRef phoneNumber;
+    StringRef address;
+};
+
+/**
+ * @brief Primary storage of directory records addressed by stable IDs
+ * Each record is stored once; hash tables index it by its 32-bit ID, so
+ * the username and phone tables of a directory share one copy. IDs of
+ * removed records are reused by later inserts. Field bytes live in a
+ * StringArena that is rebuilt from the live records once removals leave
+ * most of it dead; IDs do not change when that happens.
+ */
+class RecordStore {
+public:
+    static const uint32_t NO_RECORD = 0xFFFFFFFFu;  // ID returned for "not found"
+
+    /**
+     * @brief Store a record
+     * @return ID of the new record
+     * @throws std::length_error when IDs or arena space run out; no record
+     *         is added
+     */
+    uint32_t add(std::string_view username, std::string_view phoneNumber, std::string_view address);
+
+    uint32_t add(const Record& record) {
+        return add(record.username, record.phoneNumber, record.address);
+    }
+
+    /**
+     * @brief Remove a record; its ID may be reused
+     * @param id ID returned by add
+     */
+    void remove(uint32_t id);
+
+    /**
+     * @brief Access the fields of a stored record
+     * Views stay valid until the store is next modified.
+     * @param id ID returned by add
+     */
+    RecordView view(uint32_t id) const {
+        const PackedRecord& record = records[id];
+        RecordView result;
+        result.username = strings.view(record.username);
+        result.phoneNumber = strings.view(record.phoneNumber);
+        result.address = strings.view(record.address);
+        return result;
+    }
+
+    std::string_view username(uint32_t id) const { return strings.view(records[id].username); }
+    std::string_view phoneNumber(uint32_t id) const { return strings.view(records[id].phoneNumber); }
+
+    /**
+     * @brief Start loading a record's field references into the cache
+     * @param id ID returned by add
+     */
+    void prefetch(uint32_t id) const { GroupProbe::prefetch(&records[id]); }
+
+    /**
+     * @brief Check whether an ID refers to a stored record
+     * @param id Any ID
+     * @return false for removed or never assigned IDs
+     */
+    bool isLive(uint32_t id) const;
+
+    /**
+     * @brief Make room for recordCount records in total without reallocating
+     * @param recordCount Records the store should hold
+     */
+    void reserve(int recordCount) {
+        if (recordCount > 0 && static_cast<size_t>(recordCount) > records.capacity()) {
+            records.reserve(recordCount);
+        }
+    }
+
+    /**
+     * @brief Remove every record and free their storage
+     */
+    void clear();
+
+    /**
+     * @brief Write records and field bytes as laid out in memory
+     * IDs and field references are unchanged by a save and load.
+     */
+    void save(SnapshotWriter& writer) const;
+
+    /**
+     * @brief Replace the contents with a store written by save
+     * @return false, leaving the store unchanged, if the data is malformed
+     */
+    bool load(SnapshotReader& reader);
+
+    int getCount() const { return count; }
+
+    /**
+     * @brief Stamp of the last change to the records
+     * Every add, remove, clear or load takes a new stamp, unique across
+     * all stores, so an unchanged stamp means unchanged records.
+     */
+    uint64_t getVersion() const { return version; }
+
+    /**
+     * @brief Get bytes held by the string arena
+     * @return Bytes of chunks allocated for record fields
+     */
+    size_t getStringBytes() const { return strings.getReservedBytes(); }
+
+private:
+    static const uint32_t FREE_LENGTH = 0xFFFFFFFFu;  // Username length marking a removed record
+
+    StringArena strings;                 // Field bytes of every record
+    std::vector<PackedRecord> records;   // Record per ID
+    uint32_t freeHead = NO_RECORD;       // Most recently removed ID, heads the free list
+    int count = 0;                       // Live records
+    uint64_t version = nextVersion();    // Stamp of the last change
+
+    static uint64_t nextVersion();
+
+    /**
+     * @brief Copy live strings into a fresh arena and drop the old one
+     */
+    void compactStrings();
+};
+
+#endif // RECORD_STORE_H
\ No newline at end of file
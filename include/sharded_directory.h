@@ -0,0 +1,310 @@
+#ifndef SHARDED_DIRECTORY_H
+#define SHARDED_DIRECTORY_H
+
+#include "hashtable.h"
+#include "write_ahead_log.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief Statistics of one shard's username and phone tables
+ */
+struct ShardStats {
+    TableStats username;
+    TableStats phone;
+    SampledStats usernameSampled;  // Filled only when asked for
+    SampledStats phoneSampled;
+    int storedRecords = 0;  // Records in the shard's store, full or key-only
+};
+
+/**
+ * @brief Phone directory partitioned by key hash across worker threads
+ * Both indexes are split into shardCount shards; a key belongs to the
+ * shard picked by the high bits of its hash, so a record's username and
+ * phone number usually live in different shards. Each shard owns one
+ * username HashTable and one phone HashTable and is served by its own
+ * worker thread (pinned to a core on Linux) draining its own request
+ * queue. Only the owning worker touches a shard's tables, so they need
+ * no locks, and shards share nothing.
+ *
+ * The two tables of a shard index one RecordStore. A record is stored in
+ * full once, in its username's shard; when its phone number belongs to
+ * the same shard the phone table links that same entry, otherwise the
+ * phone shard stores only the username and phone number, and searches by
+ * phone read the address from the username shard.
+ *
+ * The calls below may be made from any number of threads; each posts to
+ * the owning shard's queue and waits for the answer. An insert reserves
+ * the username and the phone number in their shards first (a reserved
+ * key counts as taken but is not yet found by searches), then commits
+ * both or releases both. A delete reserves the record's username, which
+ * also holds its phone number, since no delete reaches the phone number
+ * without the username, before unlinking both. Each index is consistent
+ * on its own; between the two commits of an insert or the two removals
+ * of a delete, one index may briefly show the record and the other not.
+ *
+ * With a write-ahead log opened, every successful insert, delete and
+ * clear is appended to it in PhoneDirectory's format, so the directory
+ * replays it on the next start. A change is logged while its keys are
+ * reserved, and the log numbers entries as it buffers them, so changes
+ * to the same key are logged in the order they take effect while
+ * changes to different keys still run in parallel. Only opening,
+ * closing and checkpointing the log, and clear, wait for every change in
+ * flight. The shards cannot snapshot themselves: checkpoints hand the
+ * records to a CheckpointWriter supplied by the owner.
+ */
+class ShardedDirectory {
+public:
+    /**
+     * @brief Writes a checkpoint snapshot of records as of a logged change
+     * @return false if the snapshot could not be written
+     */
+    typedef std::function<bool(const std::vector<Record>& records, uint64_t logSequence)> CheckpointWriter;
+
+    /**
+     * @brief Constructor - starts one worker per shard
+     * @param shardCount Number of shards (at least 1)
+     * @param tableSize Initial size of each shard's tables
+     * @param hashAlgorithm Hash function for shard selection and home slots
+     */
+    ShardedDirectory(int shardCount, int tableSize, HashAlgorithm hashAlgorithm = HashAlgorithm::WyHash);
+
+    /**
+     * @brief Destructor - finishes queued requests and stops the workers
+     */
+    ~ShardedDirectory();
+
+    ShardedDirectory(const ShardedDirectory&) = delete;
+    ShardedDirectory& operator=(const ShardedDirectory&) = delete;
+
+    /**
+     * @brief Insert a record into both indexes
+     * @param record Record to insert
+     * @return true if inserted, false if a key is empty or already used
+     */
+    bool insert(const Record& record);
+
+    /**
+     * @brief Search by username
+     * @return Copy of the record if found, empty otherwise
+     */
+    std::optional<Record> searchByUsername(std::string_view username);
+
+    /**
+     * @brief Search by phone number
+     * @return Copy of the record if found, empty otherwise
+     */
+    std::optional<Record> searchByPhone(std::string_view phone);
+
+    /**
+     * @brief Delete the record with a username from both indexes
+     * @return true if deleted, false if not found
+     */
+    bool removeByUsername(std::string_view username);
+
+    /**
+     * @brief Delete the record with a phone number from both indexes
+     * @return true if deleted, false if not found
+     */
+    bool removeByPhone(std::string_view phone);
+
+    /**
+     * @brief Insert many records, from one client thread per core
+     * Meant for loading records known to be unique: when two records
+     * clash, which one is kept depends on thread timing. The records are
+     * not logged; checkpoint afterwards to make them durable.
+     * @param records Records to insert
+     * @return Number of records inserted
+     */
+    int insertAll(const std::vector<Record>& records);
+
+    /**
+     * @brief Copy every record, shard by shard
+     */
+    std::vector<Record> getRecords();
+
+    /**
+     * @brief Get search length (number of probes) for a key in its shard
+     * @param key Username or phone number
+     * @param byUsername Whether key is a username
+     * @return Number of probes, -1 if not found
+     */
+    int getSearchLength(std::string_view key, bool byUsername);
+
+    /**
+     * @brief Clear all records
+     */
+    void clear();
+
+    /**
+     * @brief Get number of records
+     */
+    int getCount();
+
+    int getShardCount() const { return static_cast<int>(shards.size()); }
+
+    /**
+     * @brief Shard owning a key
+     * @param key Username or phone number
+     * @return Shard index, 0 to getShardCount() - 1
+     */
+    int shardOf(std::string_view key) const;
+
+    /**
+     * @brief Get statistics of every shard
+     * @param sampled Whether to also sample each table's SampledStats
+     */
+    std::vector<ShardStats> getShardStats(bool sampled = false);
+
+    /**
+     * @brief Combine per-shard statistics of one index into one
+     * Sizes, counts, tombstones and histograms add up; load factor and
+     * average search length are those of the union of the shards, and
+     * the largest probe distance and filter bits are the largest of any
+     * shard.
+     * @param shards Statistics of each shard
+     * @return Totals in the form the statistics views print
+     */
+    static TableStats combine(const std::vector<TableStats>& shards);
+
+    /**
+     * @brief Combine per-shard estimates of one index: the shards' means
+     */
+    static SampledStats combine(const std::vector<SampledStats>& shards);
+
+    /**
+     * @brief Log every later change to a write-ahead log
+     * Entries already in the file are kept but not applied: the owner has
+     * replayed them into the records the shards were loaded from. New
+     * entries are numbered after both them and lastSequence.
+     * @param logFile Log file path, usually one PhoneDirectory opened
+     * @param lastSequence Last change the loaded records include
+     * @param writer Called with the records at each checkpoint
+     * @param options Group commit and checkpoint policy
+     * @return Number of entries found in the log, -1 if it cannot be opened
+     */
+    int openLog(const std::string& logFile, uint64_t lastSequence, CheckpointWriter writer,
+                const LogOptions& options = LogOptions());
+
+    /**
+     * @brief Write a checkpoint snapshot and empty the log
+     * Changes wait while the records are copied and written.
+     * @return false if no log is open or the snapshot could not be written
+     */
+    bool checkpoint();
+
+    /**
+     * @brief Commit pending log entries and stop logging
+     */
+    void closeLog();
+
+    /**
+     * @brief Get the open log, or null (sync policy, statistics)
+     * The log stays valid until closeLog or openLog.
+     */
+    WriteAheadLog* getLog() const;
+
+private:
+    /**
+     * @brief Tables, reservations and request queue of one shard
+     */
+    struct Shard {
+        std::shared_ptr<RecordStore> store;           // Records of both tables
+        HashTable usernames;                          // Full records whose username hashes here
+        HashTable phones;                             // Records whose phone hashes here
+        std::unordered_set<std::string> reservedUsernames;  // Keys of inserts in flight
+        std::unordered_set<std::string> reservedPhones;
+
+        std::mutex queueMutex;
+        std::condition_variable queueReady;
+        std::deque<std::function<void()>> queue;      // Requests for the worker
+        bool stopping = false;
+        std::thread worker;
+
+        Shard(int tableSize, HashAlgorithm hashAlgorithm);
+
+        /**
+         * @brief Unlink a key from one table, freeing its record once
+         *        neither table of the shard links it
+         * @param fromUsernames Whether key is a username
+         * @param key Key to unlink
+         * @param otherKey The record's other key
+         */
+        void unlinkKey(bool fromUsernames, std::string_view key, std::string_view otherKey);
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    HashAlgorithm algorithm;
+
+    std::unique_ptr<WriteAheadLog> log;  // Null unless openLog succeeded
+    CheckpointWriter checkpointWriter;   // Writes the snapshot the log is checkpointed into
+    mutable std::shared_mutex logMutex;  // Shared by changes; exclusive to swap, checkpoint or clear
+
+    /**
+     * @brief Worker loop: run queued requests until stopped
+     */
+    static void serve(Shard& shard);
+
+    /**
+     * @brief Run function(shard) on a shard's worker
+     * @return Future for the function's result
+     */
+    template <class Function>
+    auto post(int index, Function function) -> std::future<decltype(function(std::declval<Shard&>()))> {
+        typedef decltype(function(std::declval<Shard&>())) Result;
+        Shard& shard = *shards[index];
+        auto task = std::make_shared<std::packaged_task<Result()>>([&shard, function]() { return function(shard); });
+        std::future<Result> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> guard(shard.queueMutex);
+            shard.queue.push_back([task]() { (*task)(); });
+        }
+        shard.queueReady.notify_one();
+        return result;
+    }
+
+    /**
+     * @brief Append a change to the log, if one is open; logMutex is shared
+     * @return true if the log has grown past its checkpoint limit
+     */
+    bool logChange(LogOperation operation, std::string_view first = {},
+                   std::string_view second = {}, std::string_view third = {});
+
+    /**
+     * @brief checkpoint with logMutex already held exclusively
+     */
+    bool checkpointLocked();
+
+    /**
+     * @brief Checkpoint unless another thread already emptied the log
+     */
+    void checkpointIfFull();
+
+    /**
+     * @brief Insert a record into both indexes, logging it if logged is set
+     * @param logged Whether to log the insert; logMutex is then shared
+     * @param full Output: set if the log has grown past its limit
+     */
+    bool insertRecord(const Record& record, bool logged, bool& full);
+
+    /**
+     * @brief Remove a record from both indexes, found through one key
+     * @param key Username or phone number
+     * @param byUsername Whether key is a username
+     */
+    bool removeBy(std::string_view key, bool byUsername);
+};
+
+#endif // SHARDED_DIRECTORY_H
\ No newline at end of file
@@ -0,0 +1,157 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Fixed header at the start of a binary snapshot file
+ * The payload after it is a sequence of sections written by
+ * SnapshotWriter, holding structures exactly as laid out in memory (in
+ * the writing machine's byte order). checksum chains the hashes of the
+ * payload's CHECKSUM_BLOCK byte blocks, so the file can be verified
+ * before any of it is used.
+ */
+struct SnapshotHeader {
+    char magic[8];            // SnapshotHeader::MAGIC
+    uint32_t version;         // SnapshotHeader::VERSION
+    uint32_t hashAlgorithm;   // HashAlgorithm of the tables
+    uint64_t hashSeed;        // HashFunction::SEED at write time
+    uint32_t probeStrategy;   // ProbeStrategy of the tables
+    uint32_t tableCount;      // Indexes following the record store
+    uint64_t recordCount;     // Live records
+    uint64_t logSequence;     // Last write-ahead log change included
+    uint64_t payloadBytes;    // Bytes following the header
+    uint64_t checksum;        // checksumOf(payload)
+
+    static const char MAGIC[8];
+    static const uint32_t VERSION = 5;
+    static const size_t CHECKSUM_BLOCK = 1 << 20;
+
+    /**
+     * @brief Chained hash of a payload, block by block
+     */
+    static uint64_t checksumOf(std::string_view payload);
+
+    /**
+     * @brief Check whether bytes start with a snapshot header
+     * @param bytes File contents, or at least its first bytes
+     */
+    static bool matches(std::string_view bytes);
+};
+
+/**
+ * @brief Writes the payload sections of a snapshot to a stream
+ * Sections are gathered into CHECKSUM_BLOCK byte blocks, so the stream
+ * sees large writes whatever the section sizes and each block is hashed
+ * once. Call finish() after the last section.
+ */
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(std::ostream& output);
+
+    /**
+     * @brief Append raw bytes
+     */
+    void write(const void* data, size_t bytes);
+
+    /**
+     * @brief Write out the last partial block
+     * @return Checksum of everything written, as checksumOf computes it
+     */
+    uint64_t finish();
+
+    /**
+     * @brief Write one trivially copyable value
+     */
+    template <class T>
+    void writeValue(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values are copied as bytes");
+        write(&value, sizeof(T));
+    }
+
+    /**
+     * @brief Write the element count and then the elements of an array
+     */
+    template <class T, class Allocator>
+    void writeArray(const std::vector<T, Allocator>& array) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values are copied as bytes");
+        writeValue(static_cast<uint64_t>(array.size()));
+        write(array.data(), array.size() * sizeof(T));
+    }
+
+    uint64_t getBytesWritten() const { return written; }
+
+private:
+    std::ostream& out;
+    std::vector<char> block;   // Bytes not yet written, less than CHECKSUM_BLOCK
+    uint64_t checksum = 0;     // Chained hash of the blocks written
+    uint64_t written = 0;
+
+    void flushBlock();
+};
+
+/**
+ * @brief Reads payload sections back from a snapshot in memory
+ * Sections must be read in the order they were written. A read past the
+ * end fails and leaves the reader failed.
+ */
+class SnapshotReader {
+public:
+    explicit SnapshotReader(std::string_view payload) : bytes(payload) {}
+
+    /**
+     * @brief Take the next section of a given size
+     * @return Pointer to its bytes (e.g. inside a mapping), nullptr if too short
+     */
+    const char* read(size_t size);
+
+    /**
+     * @brief Read one trivially copyable value
+     */
+    template <class T>
+    bool readValue(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values are copied as bytes");
+        const char* data = read(sizeof(T));
+        if (data) {
+            std::memcpy(&value, data, sizeof(T));
+        }
+        return data != nullptr;
+    }
+
+    /**
+     * @brief Read an array written by writeArray
+     * @param maxCount Largest element count accepted
+     */
+    template <class T, class Allocator>
+    bool readArray(std::vector<T, Allocator>& array, uint64_t maxCount) {
+        uint64_t count = 0;
+        if (!readValue(count) || count > maxCount || count > bytes.size() / sizeof(T)) {
+            failed = true;
+            return false;
+        }
+        const char* data = read(count * sizeof(T));
+        if (!data) {
+            return false;
+        }
+        array.resize(count);
+        if (count > 0) {
+            std::memcpy(array.data(), data, count * sizeof(T));
+        }
+        return true;
+    }
+
+    bool ok() const { return !failed; }
+    bool atEnd() const { return bytes.empty(); }
+
+private:
+    std::string_view bytes;   // Unread payload
+    bool failed = false;
+};
+
+#endif // SNAPSHOT_H
\ No newline at end of file
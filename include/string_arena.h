@@ -0,0 +1,121 @@
+#ifndef STRING_ARENA_H
+#define STRING_ARENA_H
+
+#include "snapshot.h"
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Location of a string inside a StringArena
+ * offset packs the chunk index (high bits) and the position in the chunk.
+ */
+struct StringRef {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+};
+
+/**
+ * @brief Append-only string pool backed by large chunks
+ * Strings are copied back to back into CHUNK_SIZE chunks and addressed by
+ * an 8-byte StringRef, so storing a string costs its bytes plus the ref
+ * instead of a heap block per string. Released strings are only counted
+ * as dead; the owner rebuilds the arena when shouldCompact() says enough
+ * space is wasted. clear() frees every chunk at once.
+ *
+ * Views returned by view() stay valid until clear() or swap(); appends
+ * never move existing bytes.
+ */
+class StringArena {
+public:
+    static const uint32_t CHUNK_BITS = 22;                    // Position bits of an offset
+    static const uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;      // Bytes per regular chunk
+    static const uint32_t MAX_CHUNKS = 1u << (32 - CHUNK_BITS);
+
+    /**
+     * @brief Copy a string into the arena
+     * Strings longer than CHUNK_SIZE get a chunk of their own.
+     * @param text String to store
+     * @return Reference to the stored copy
+     * @throws std::length_error when the arena runs out of chunk indices
+     */
+    StringRef append(std::string_view text);
+
+    /**
+     * @brief Access a stored string
+     * @param ref Reference returned by append
+     * @return View of the stored bytes
+     */
+    std::string_view view(StringRef ref) const {
+        if (ref.length == 0) {
+            return std::string_view();
+        }
+        return std::string_view(chunks[ref.offset >> CHUNK_BITS].get() + (ref.offset & (CHUNK_SIZE - 1)),
+                                ref.length);
+    }
+
+    /**
+     * @brief Check whether a reference lies inside the stored bytes
+     * Used on references read from a snapshot before they are viewed.
+     * @param ref Reference to check
+     * @return true if view(ref) reads only written bytes
+     */
+    bool contains(StringRef ref) const;
+
+    /**
+     * @brief Mark a stored string as no longer used
+     * @param ref Reference returned by append
+     */
+    void release(StringRef ref) { deadBytes += ref.length; }
+
+    /**
+     * @brief Check whether dead strings waste enough space to rebuild
+     * @return true once dead bytes exceed live bytes past the first chunk
+     */
+    bool shouldCompact() const {
+        return usedBytes > CHUNK_SIZE && deadBytes * 2 > usedBytes;
+    }
+
+    /**
+     * @brief Free every chunk
+     */
+    void clear();
+
+    /**
+     * @brief Exchange contents with another arena
+     */
+    void swap(StringArena& other);
+
+    /**
+     * @brief Write every chunk as laid out in memory
+     * References stay valid in an arena restored with load().
+     */
+    void save(SnapshotWriter& writer) const;
+
+    /**
+     * @brief Replace the contents with chunks written by save
+     * @return false, leaving the arena unchanged, if the data is malformed
+     */
+    bool load(SnapshotReader& reader);
+
+    size_t getUsedBytes() const { return usedBytes; }
+    size_t getLiveBytes() const { return usedBytes - deadBytes; }
+    size_t getReservedBytes() const { return reservedBytes; }
+
+private:
+    std::vector<std::unique_ptr<char[]>> chunks;  // Chunk storage, index = offset >> CHUNK_BITS
+    std::vector<size_t> chunkBytes;    // Allocated size of each chunk
+    uint32_t chunkUsed = CHUNK_SIZE;   // Bytes used in the last chunk (full when none)
+    size_t usedBytes = 0;              // Bytes appended
+    size_t deadBytes = 0;              // Bytes of released strings
+    size_t reservedBytes = 0;          // Bytes allocated for chunks
+
+    /**
+     * @brief Start a new chunk of at least minBytes
+     */
+    void addChunk(size_t minBytes);
+};
+
+#endif // STRING_ARENA_H
\ No newline at end of file
@@ -0,0 +1,190 @@
+#ifndef WRITE_AHEAD_LOG_H
+#define WRITE_AHEAD_LOG_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Kind of change recorded by a log entry
+ */
+enum class LogOperation : uint8_t {
+    Insert = 1,   // fields: username, phone, address
+    Remove = 2,   // fields: username
+    Clear = 3     // no fields
+};
+
+/**
+ * @brief One change read back from the log
+ * Field views point into the log file's mapping and are valid only
+ * during the replay callback.
+ */
+struct LogEntry {
+    uint64_t sequence = 0;            // Position in the directory's history
+    LogOperation operation = LogOperation::Insert;
+    std::string_view fields[3];       // Unused fields are empty
+};
+
+/**
+ * @brief When appended entries are forced to disk
+ */
+struct LogOptions {
+    // Group commit: entries are written and synced together at most this
+    // long after the first of them was appended. Zero syncs every append
+    // before it returns.
+    std::chrono::microseconds commitDelay{2000};
+
+    // Buffered bytes that trigger a commit before the delay runs out
+    size_t commitBytes = 1 << 20;
+
+    // Log size at which the directory checkpoints into its snapshot
+    uint64_t checkpointBytes = 64ull << 20;
+};
+
+/**
+ * @brief Append-only log of directory changes
+ * Each entry is framed by its length and a checksum, so a write torn by a
+ * crash is recognised on replay and cut off. With a commit delay, append()
+ * only buffers the entry and a background thread writes and syncs every
+ * buffered entry at once (group commit): many changes share one fsync, and
+ * a crash loses at most the last commitDelay worth of acknowledged changes.
+ * With no delay, every append is on disk when it returns.
+ */
+class WriteAheadLog {
+public:
+    WriteAheadLog() = default;
+
+    /**
+     * @brief Destructor - commits buffered entries and closes the file
+     */
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    /**
+     * @brief Replay a log file and open it for appending
+     * Entries are passed to replay in order. Anything after the last intact
+     * entry is truncated away, so new entries follow it directly. A missing
+     * file is created empty.
+     * @param filename Log file path
+     * @param options Commit policy
+     * @param replay Called for every intact entry
+     * @return Number of entries replayed, -1 if the file cannot be opened
+     */
+    int open(const std::string& filename, const LogOptions& options,
+             const std::function<void(const LogEntry&)>& replay);
+
+    /**
+     * @brief Commit buffered entries and close the file
+     */
+    void close();
+
+    /**
+     * @brief Record a change
+     * @param sequence Sequence number of the change
+     * @param operation Kind of change
+     * @param first,second,third Fields of the change
+     */
+    void append(uint64_t sequence, LogOperation operation, std::string_view first,
+                std::string_view second = {}, std::string_view third = {});
+
+    /**
+     * @brief Record a change under the next sequence number
+     * The number is taken while the entry is buffered, so entries appended
+     * from several threads reach the file in sequence order.
+     * @param operation Kind of change
+     * @param first,second,third Fields of the change
+     * @return Sequence number given to the change, 0 if the log is closed
+     */
+    uint64_t appendNext(LogOperation operation, std::string_view first = {},
+                        std::string_view second = {}, std::string_view third = {});
+
+    /**
+     * @brief Number later appendNext entries after a sequence number
+     */
+    void setLastSequence(uint64_t sequence);
+
+    /**
+     * @brief Largest sequence number replayed or appended since open
+     */
+    uint64_t getLastSequence() const;
+
+    /**
+     * @brief Write and sync every appended entry now
+     * @return false if the log could not be written
+     */
+    bool sync();
+
+    /**
+     * @brief Drop every entry, once a checkpoint holds their changes
+     * @return false if the file could not be truncated
+     */
+    bool truncate();
+
+    bool isOpen() const { return file != INVALID_FILE; }
+    const LogOptions& getOptions() const { return options; }
+
+    /**
+     * @brief Bytes in the log, including entries not yet committed
+     */
+    uint64_t getBytes() const;
+
+    /**
+     * @brief Number of fsyncs issued since open
+     */
+    uint64_t getSyncCount() const;
+
+private:
+#ifdef _WIN32
+    using FileHandle = void*;
+#else
+    using FileHandle = int;
+#endif
+    static const FileHandle INVALID_FILE;
+
+    FileHandle file = INVALID_FILE;
+    std::string path;
+    LogOptions options;
+
+    // Buffered entries, shared with the committer thread
+    mutable std::mutex bufferMutex;
+    std::condition_variable bufferReady;  // Entries appended, sync() called or stopping
+    std::condition_variable committed;    // A commit finished
+    std::vector<char> buffer;             // Entries appended but not yet written
+    std::chrono::steady_clock::time_point firstBuffered;  // Append time of buffer's first entry
+    uint64_t appendedBytes = 0;           // Log size including buffer
+    uint64_t lastSequence = 0;            // Largest sequence number replayed or appended
+    uint64_t commitsRequested = 0;        // Incremented by sync() to commit immediately
+    uint64_t commitsDone = 0;             // Commits finished by the thread
+    uint64_t syncCount = 0;
+    bool stopping = false;
+    bool failed = false;                  // A write or fsync failed
+
+    // Held while writing to or truncating the file; taken after bufferMutex
+    std::mutex fileMutex;
+    std::thread committer;
+
+    void commitLoop();
+
+    /**
+     * @brief Frame an entry into the buffer and start or run its commit
+     */
+    void frame(std::unique_lock<std::mutex>& lock, uint64_t sequence, LogOperation operation,
+               std::string_view first, std::string_view second, std::string_view third);
+
+    /**
+     * @brief Write and sync the buffer; bufferMutex is released meanwhile
+     */
+    void commit(std::unique_lock<std::mutex>& lock);
+
+    bool writeAndSync(const std::vector<char>& bytes);
+};
+
+#endif // WRITE_AHEAD_LOG_H
\ No newline at end of file
@@ -9,6 +9,14 @@
 #include <iomanip>
 #include <sstream>
 
+/**
+ * @brief Convert a field of a stored record for display
+ */
+static QString toQString(std::string_view text)
+{
+    return QString::fromUtf8(text.data(), static_cast<int>(text.size()));
+}
+
 /**
  * @brief Constructor - Initialize GUI and hash tables
  */
@@ -42,7 +50,7 @@ MainWindow::MainWindow(QWidget *parent)
     displayAllRecords();
     
     // Update status bar
-    updateStatusBar("Ready. Loaded " + QString::number(usernameTable->getCount()) + " records.");
+    updateStatusBar("Ready. Loaded " + QString::number(directory->getCount()) + " records.");
 }
 
 /**
@@ -78,9 +86,9 @@ void MainWindow::closeEvent(QCloseEvent *event)
  */
 void MainWindow::initializeHashTables()
 {
-    const int TABLE_SIZE = 30; // Size matches number of records
-    usernameTable = std::make_unique<HashTable>(TABLE_SIZE, "username");
-    phoneTable = std::make_unique<HashTable>(TABLE_SIZE, "phone");
+    const int TABLE_SIZE = 31; // Initial size, tables grow automatically
+    directory = std::make_unique<PhoneDirectory>(TABLE_SIZE);
+    directory->setLookupFilter(BloomFilter::DEFAULT_BITS_PER_KEY);
 }
 
 /**
@@ -88,13 +96,25 @@ void MainWindow::initializeHashTables()
  */
 void MainWindow::loadDataFromFiles()
 {
-    if (FileHandler::fileExists(usernameFile.toStdString())) {
-        int count = usernameTable->loadFromFile(usernameFile.toStdString());
-        updateStatusBar("Loaded " + QString::number(count) + " records from username file.");
-    }
-    
-    if (FileHandler::fileExists(phoneFile.toStdString())) {
-        phoneTable->loadFromFile(phoneFile.toStdString());
+    // Both indexes are built from the one record file
+    if (FileHandler::fileExists(recordFile.toStdString())) {
+        int count = directory->loadFromFile(recordFile.toStdString());
+        updateStatusBar("Loaded " + QString::number(count) + " records.");
+    } else if (FileHandler::fileExists(legacyUsernameFile.toStdString()) ||
+               FileHandler::fileExists(legacyPhoneFile.toStdString())) {
+        DriftReport drift;
+        int count = directory->loadLegacyFiles(legacyUsernameFile.toStdString(),
+                                               legacyPhoneFile.toStdString(), drift);
+        if (drift.hasDrift()) {
+            QMessageBox::warning(this, "Data Files Disagree",
+                                 "The username and phone files had drifted apart:\n" +
+                                 QString::number(drift.conflicting) + " conflicting records\n" +
+                                 QString::number(drift.onlyInUsernameFile) + " only in the username file\n" +
+                                 QString::number(drift.onlyInPhoneFile) + " only in the phone file\n\n" +
+                                 "The username file was kept where they conflict.");
+        }
+        directory->getUsernameTable().saveToFile(recordFile.toStdString());
+        updateStatusBar("Loaded " + QString::number(count) + " records and migrated to " + recordFile + ".");
     }
 }
 
@@ -103,9 +123,8 @@ void MainWindow::loadDataFromFiles()
  */
 void MainWindow::saveDataToFiles()
 {
-    usernameTable->saveToFile(usernameFile.toStdString());
-    phoneTable->saveToFile(phoneFile.toStdString());
-    updateStatusBar("Data saved successfully!");
+    bool saved = directory->getUsernameTable().saveIfModified(recordFile.toStdString());
+    updateStatusBar(saved ? "Data saved successfully!" : "Save failed, previous files kept!");
 }
 
 /**
@@ -138,32 +157,6 @@ QString MainWindow::validateInput()
     return "";
 }
 
-/**
- * @brief Synchronize record across both hash tables
- */
-bool MainWindow::syncTables(const Record& record, const QString& operation)
-{
-    if (operation == "insert") {
-        bool usernameOk = usernameTable->insert(record);
-        bool phoneOk = phoneTable->insert(record);
-        
-        if (!usernameOk || !phoneOk) {
-            // Rollback if one failed
-            if (usernameOk) usernameTable->remove(record.username);
-            if (phoneOk) phoneTable->remove(record.phoneNumber);
-            return false;
-        }
-        return true;
-    }
-    else if (operation == "delete") {
-        bool usernameOk = usernameTable->remove(record.username);
-        bool phoneOk = phoneTable->remove(record.phoneNumber);
-        return usernameOk || phoneOk;
-    }
-    
-    return false;
-}
-
 /**
  * @brief Display all records in table widget
  */
@@ -172,14 +165,14 @@ void MainWindow::displayAllRecords()
     ui->tableWidget->setRowCount(0);
     
     int rowCount = 0;
-    for (int i = 0; i < usernameTable->getSize(); i++) {
-        const Record* rec = usernameTable->getRecordAt(i);
+    for (int i = 0; i < directory->getUsernameTable().getSlotCount(); i++) {
+        std::optional<RecordView> rec = directory->getUsernameTable().getRecordAt(i);
         if (rec && !rec->isEmpty && !rec->isDeleted) {
             ui->tableWidget->insertRow(rowCount);
             ui->tableWidget->setItem(rowCount, 0, new QTableWidgetItem(QString::number(i)));
-            ui->tableWidget->setItem(rowCount, 1, new QTableWidgetItem(QString::fromStdString(rec->username)));
-            ui->tableWidget->setItem(rowCount, 2, new QTableWidgetItem(QString::fromStdString(rec->phoneNumber)));
-            ui->tableWidget->setItem(rowCount, 3, new QTableWidgetItem(QString::fromStdString(rec->address)));
+            ui->tableWidget->setItem(rowCount, 1, new QTableWidgetItem(toQString(rec->username)));
+            ui->tableWidget->setItem(rowCount, 2, new QTableWidgetItem(toQString(rec->phoneNumber)));
+            ui->tableWidget->setItem(rowCount, 3, new QTableWidgetItem(toQString(rec->address)));
             rowCount++;
         }
     }
@@ -236,13 +229,13 @@ void MainWindow::on_btnInsert_clicked()
     
     Record record(username.toStdString(), phone.toStdString(), address.toStdString());
     
-    if (syncTables(record, "insert")) {
+    if (directory->insert(record)) {
         showSuccessMessage("Success", "Record inserted successfully!\n\nUsername: " + username + "\nPhone: " + phone);
         displayAllRecords();
         clearInputFields();
-        updateStatusBar("Record inserted. Total: " + QString::number(usernameTable->getCount()));
+        updateStatusBar("Record inserted. Total: " + QString::number(directory->getCount()));
     } else {
-        showErrorMessage("Insert Failed", "Cannot insert record!\nDuplicate key or table is full.");
+        showErrorMessage("Insert Failed", "Cannot insert record!\nDuplicate key.");
     }
 }
 
@@ -258,15 +251,15 @@ void MainWindow::on_btnSearchUsername_clicked()
         return;
     }
     
-    Record* found = usernameTable->search(username.toStdString());
+    std::optional<RecordView> found = directory->searchByUsername(username.toStdString());
     
     if (found) {
-        int searchLength = usernameTable->getSearchLength(username.toStdString());
+        int searchLength = directory->getUsernameTable().getSearchLength(username.toStdString());
         
         QString message = QString("✓ RECORD FOUND!\n\n") +
-                         "Username: " + QString::fromStdString(found->username) + "\n" +
-                         "Phone: " + QString::fromStdString(found->phoneNumber) + "\n" +
-                         "Address: " + QString::fromStdString(found->address) + "\n\n" +
+                         "Username: " + toQString(found->username) + "\n" +
+                         "Phone: " + toQString(found->phoneNumber) + "\n" +
+                         "Address: " + toQString(found->address) + "\n\n" +
                          "Search Length: " + QString::number(searchLength) + " probe(s)";
         
         showSuccessMessage("Search Result", message);
@@ -274,7 +267,7 @@ void MainWindow::on_btnSearchUsername_clicked()
         
         // Highlight in table
         for (int row = 0; row < ui->tableWidget->rowCount(); row++) {
-            if (ui->tableWidget->item(row, 1)->text() == QString::fromStdString(found->username)) {
+            if (ui->tableWidget->item(row, 1)->text() == toQString(found->username)) {
                 ui->tableWidget->selectRow(row);
                 ui->tableWidget->scrollToItem(ui->tableWidget->item(row, 0));
                 break;
@@ -298,15 +291,15 @@ void MainWindow::on_btnSearchPhone_clicked()
         return;
     }
     
-    Record* found = phoneTable->search(phone.toStdString());
+    std::optional<RecordView> found = directory->searchByPhone(phone.toStdString());
     
     if (found) {
-        int searchLength = phoneTable->getSearchLength(phone.toStdString());
+        int searchLength = directory->getPhoneTable().getSearchLength(phone.toStdString());
         
         QString message = QString("✓ RECORD FOUND!\n\n") +
-                         "Username: " + QString::fromStdString(found->username) + "\n" +
-                         "Phone: " + QString::fromStdString(found->phoneNumber) + "\n" +
-                         "Address: " + QString::fromStdString(found->address) + "\n\n" +
+                         "Username: " + toQString(found->username) + "\n" +
+                         "Phone: " + toQString(found->phoneNumber) + "\n" +
+                         "Address: " + toQString(found->address) + "\n\n" +
                          "Search Length: " + QString::number(searchLength) + " probe(s)";
         
         showSuccessMessage("Search Result", message);
@@ -314,7 +307,7 @@ void MainWindow::on_btnSearchPhone_clicked()
         
         // Highlight in table
         for (int row = 0; row < ui->tableWidget->rowCount(); row++) {
-            if (ui->tableWidget->item(row, 2)->text() == QString::fromStdString(found->phoneNumber)) {
+            if (ui->tableWidget->item(row, 2)->text() == toQString(found->phoneNumber)) {
                 ui->tableWidget->selectRow(row);
                 ui->tableWidget->scrollToItem(ui->tableWidget->item(row, 0));
                 break;
@@ -338,22 +331,21 @@ void MainWindow::on_btnDeleteUsername_clicked()
         return;
     }
     
-    Record* found = usernameTable->search(username.toStdString());
+    std::optional<RecordView> found = directory->searchByUsername(username.toStdString());
     if (found) {
         QMessageBox::StandardButton reply;
         reply = QMessageBox::question(this, "Confirm Deletion",
                                       "Are you sure you want to delete this record?\n\n" +
-                                      QString::fromStdString(found->username) + " - " +
-                                      QString::fromStdString(found->phoneNumber),
+                                      toQString(found->username) + " - " +
+                                      toQString(found->phoneNumber),
                                       QMessageBox::Yes | QMessageBox::No);
         
         if (reply == QMessageBox::Yes) {
-            Record record = *found;
-            if (syncTables(record, "delete")) {
+            if (directory->removeByUsername(username.toStdString())) {
                 showSuccessMessage("Success", "Record deleted successfully!");
                 displayAllRecords();
                 clearInputFields();
-                updateStatusBar("Record deleted. Total: " + QString::number(usernameTable->getCount()));
+                updateStatusBar("Record deleted. Total: " + QString::number(directory->getCount()));
             } else {
                 showErrorMessage("Delete Failed", "Failed to delete record.");
             }
@@ -375,22 +367,21 @@ void MainWindow::on_btnDeletePhone_clicked()
         return;
     }
     
-    Record* found = phoneTable->search(phone.toStdString());
+    std::optional<RecordView> found = directory->searchByPhone(phone.toStdString());
     if (found) {
         QMessageBox::StandardButton reply;
         reply = QMessageBox::question(this, "Confirm Deletion",
                                       "Are you sure you want to delete this record?\n\n" +
-                                      QString::fromStdString(found->username) + " - " +
-                                      QString::fromStdString(found->phoneNumber),
+                                      toQString(found->username) + " - " +
+                                      toQString(found->phoneNumber),
                                       QMessageBox::Yes | QMessageBox::No);
         
         if (reply == QMessageBox::Yes) {
-            Record record = *found;
-            if (syncTables(record, "delete")) {
+            if (directory->removeByPhone(phone.toStdString())) {
                 showSuccessMessage("Success", "Record deleted successfully!");
                 displayAllRecords();
                 clearInputFields();
-                updateStatusBar("Record deleted. Total: " + QString::number(usernameTable->getCount()));
+                updateStatusBar("Record deleted. Total: " + QString::number(directory->getCount()));
             } else {
                 showErrorMessage("Delete Failed", "Failed to delete record.");
             }
@@ -428,8 +419,7 @@ void MainWindow::on_btnLoad_clicked()
                                   QMessageBox::Yes | QMessageBox::No);
     
     if (reply == QMessageBox::Yes) {
-        usernameTable->clear();
-        phoneTable->clear();
+        directory->clear();
         loadDataFromFiles();
         displayAllRecords();
         showSuccessMessage("Success", "Data loaded from files successfully!");
@@ -441,29 +431,49 @@ void MainWindow::on_btnLoad_clicked()
  */
 void MainWindow::on_btnStatistics_clicked()
 {
-    std::stringstream ss;
-    ss << std::fixed << std::setprecision(2);
+    // Both tables maintain their statistics, so reading them is O(1); the
+    // miss search length and filter rate are sampled on top
+    auto tableSection = [](const HashTable& index) {
+        TableStats table = index.getStats();
+        SampledStats sampled = index.getSampledStats();
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2);
+        ss << "   • Table Size: " << table.size << "\n";
+        ss << "   • Record Count: " << table.count << "\n";
+        ss << "   • Load Factor: " << (table.loadFactor * 100) << "%\n";
+        ss << "   • Avg Search Length: " << table.averageSearchLength << " probes\n";
+        ss << "   • Max Probe Distance: " << table.maxProbeDistance << "\n";
+        ss << "   • Tombstones: " << table.tombstones << " (" << table.compactions << " compactions)\n";
+        ss << "   • Miss Search Length: " << sampled.missSearchLength << " probes\n";
+        if (table.filterBits > 0) {
+            ss << "   • Lookup Filter: " << table.filterBits << " bits/record, "
+               << table.filterBytes / 1024 << " KB, " << sampled.filterFalsePositiveRate * 100
+               << "% false positives\n";
+        } else {
+            ss << "   • Lookup Filter: off\n";
+        }
+        ss << "   • Probe Lengths:";
+        std::vector<double> shares = table.probeLengthShares(5);
+        for (size_t i = 0; i < shares.size(); i++) {
+            ss << " " << (i + 1) << (i + 1 == shares.size() ? "+: " : ": ")
+               << static_cast<int>(shares[i] * 100 + 0.5) << "%";
+        }
+        ss << "\n";
+        return QString::fromStdString(ss.str());
+    };
     
     QString stats = "═══════════════════════════════════════\n";
     stats += "📊 HASH TABLE STATISTICS\n";
     stats += "═══════════════════════════════════════\n\n";
     
     stats += "📌 USERNAME HASH TABLE:\n";
-    stats += "   • Table Size: " + QString::number(usernameTable->getSize()) + "\n";
-    stats += "   • Record Count: " + QString::number(usernameTable->getCount()) + "\n";
-    ss << "   • Load Factor: " << (usernameTable->getLoadFactor() * 100) << "%\n";
-    ss << "   • Avg Search Length: " << usernameTable->getAverageSearchLength() << " probes\n\n";
-    
-    stats += QString::fromStdString(ss.str());
-    ss.str("");
+    stats += tableSection(directory->getUsernameTable()) + "\n";
     
     stats += "📌 PHONE NUMBER HASH TABLE:\n";
-    stats += "   • Table Size: " + QString::number(phoneTable->getSize()) + "\n";
-    stats += "   • Record Count: " + QString::number(phoneTable->getCount()) + "\n";
-    ss << "   • Load Factor: " << (phoneTable->getLoadFactor() * 100) << "%\n";
-    ss << "   • Avg Search Length: " << phoneTable->getAverageSearchLength() << " probes\n";
+    stats += tableSection(directory->getPhoneTable());
     
-    stats += QString::fromStdString(ss.str());
+    ConsistencyReport consistency = directory->checkConsistency();
+    stats += "\n🔗 Indexes Consistent: " + QString(consistency.isConsistent() ? "Yes" : "NO") + "\n";
     
     showInfoMessage("Hash Table Statistics", stats);
 }
@@ -8,7 +8,7 @@
 #include <QTextEdit>
 #include <QStatusBar>
 #include <memory>
-#include "hashtable.h"
+#include "phone_directory.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -45,13 +45,13 @@ private slots:
 private:
     Ui::MainWindow *ui;
     
-    // Hash tables
-    std::unique_ptr<HashTable> usernameTable;
-    std::unique_ptr<HashTable> phoneTable;
+    // Records indexed by username and phone
+    std::unique_ptr<PhoneDirectory> directory;
     
     // Data files
-    const QString usernameFile = "data/records_username.txt";
-    const QString phoneFile = "data/records_phone.txt";
+    const QString recordFile = "data/records.txt";
+    const QString legacyUsernameFile = "data/records_username.txt";  // Older two-file layout
+    const QString legacyPhoneFile = "data/records_phone.txt";
     
     // Helper functions
     void initializeHashTables();
@@ -63,7 +63,6 @@ private:
     void showSuccessMessage(const QString& title, const QString& message);
     void showErrorMessage(const QString& title, const QString& message);
     void showInfoMessage(const QString& title, const QString& message);
-    bool syncTables(const Record& record, const QString& operation);
     QString validateInput();
 };
 
@@ -0,0 +1,53 @@
+#include "atomic_file.h"
+#include "file_handler.h"
+#include <cstdio>
+
+/**
+ * @brief Create the temporary next to the target
+ */
+AtomicFile::AtomicFile(const std::string& filename)
+    : target(filename), temporary(filename + ".tmp"),
+      file(temporary, std::ios::binary | std::ios::trunc) {
+    block.reserve(WRITE_BLOCK);
+}
+
+/**
+ * @brief Destructor - deletes the temporary unless committed
+ */
+AtomicFile::~AtomicFile() {
+    if (!committed && file.is_open()) {
+        file.close();
+        std::remove(temporary.c_str());
+    }
+}
+
+std::ofstream& AtomicFile::stream() {
+    flushBlock();
+    return file;
+}
+
+/**
+ * @brief Write everything, sync it and replace the target
+ * The data must be on disk before the rename, or a crash could leave the
+ * new name pointing at an empty or partial file.
+ */
+bool AtomicFile::commit() {
+    if (!file.is_open()) {
+        return false;
+    }
+    flushBlock();
+    file.close();
+    if (!file || !FileHandler::syncFile(temporary) || !FileHandler::replaceFile(temporary, target)) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    committed = true;
+    return true;
+}
+
+void AtomicFile::flushBlock() {
+    if (!block.empty()) {
+        file.write(block.data(), static_cast<std::streamsize>(block.size()));
+        block.clear();
+    }
+}
\ No newline at end of file
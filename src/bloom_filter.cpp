@@ -0,0 +1,41 @@
+#include "bloom_filter.h"
+#include <utility>
+
+namespace {
+
+const int BLOCK_BITS = BloomFilter::BLOCK_WORDS * 32;
+
+size_t blocksFor(int capacity, int bitsPerKey) {
+    uint64_t bits = static_cast<uint64_t>(capacity > 0 ? capacity : 1) * bitsPerKey;
+    return static_cast<size_t>((bits + BLOCK_BITS - 1) / BLOCK_BITS);
+}
+
+} // namespace
+
+/**
+ * @brief Empty the filter and size it for a number of keys
+ */
+void BloomFilter::reset(int capacity, int keyBits) {
+    bitsPerKey = keyBits > 0 ? keyBits : 1;
+    blocks.assign(blocksFor(capacity, bitsPerKey), Block());
+}
+
+/**
+ * @brief Free the blocks, disabling the filter
+ */
+void BloomFilter::release() {
+    std::vector<Block>().swap(blocks);
+    bitsPerKey = 0;
+}
+
+/**
+ * @brief Replace the contents with a filter read from a snapshot
+ */
+bool BloomFilter::adopt(std::vector<Block>&& loadedBlocks, int loadedBitsPerKey) {
+    if (loadedBitsPerKey < 0 || (loadedBitsPerKey == 0) != loadedBlocks.empty()) {
+        return false;
+    }
+    blocks = std::move(loadedBlocks);
+    bitsPerKey = loadedBitsPerKey;
+    return true;
+}
\ No newline at end of file
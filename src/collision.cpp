@@ -25,4 +25,64 @@ int CollisionResolution::nextProbe(int currentIndex, int tableSize) {
         return 0;
     }
     return (currentIndex + 1) % tableSize;
+}
+
+/**
+ * @brief Quadratic probing: h(k, i) = (h(k) + i^2) mod m
+ * @param hashIndex Original hash value
+ * @param attempt Probe attempt number (0, 1, 2, ...)
+ * @param tableSize Size of hash table
+ * @return New index after probing
+ */
+int CollisionResolution::quadraticProbe(int hashIndex, int attempt, int tableSize) {
+    if (tableSize <= 0) {
+        return 0;
+    }
+    long long offset = static_cast<long long>(attempt) * attempt;
+    return static_cast<int>((hashIndex + offset) % tableSize);
+}
+
+/**
+ * @brief Double hashing: h(k, i) = (h(k) + i * step) mod m
+ * @param hashIndex Original hash value
+ * @param step Step size from doubleHashStep
+ * @param attempt Probe attempt number (0, 1, 2, ...)
+ * @param tableSize Size of hash table
+ * @return New index after probing
+ */
+int CollisionResolution::doubleHashProbe(int hashIndex, int step, int attempt, int tableSize) {
+    if (tableSize <= 0) {
+        return 0;
+    }
+    long long offset = static_cast<long long>(attempt) * step;
+    return static_cast<int>((hashIndex + offset) % tableSize);
+}
+
+/**
+ * @brief Step size for double hashing
+ * @param hash Full hash value of the key
+ * @param tableSize Size of hash table
+ * @return Step in [1, tableSize - 1], 1 for tables of two slots or fewer
+ */
+int CollisionResolution::doubleHashStep(uint64_t hash, int tableSize) {
+    if (tableSize <= 2) {
+        return 1;
+    }
+    uint64_t quotient = hash / static_cast<uint64_t>(tableSize);
+    return 1 + static_cast<int>(quotient % static_cast<uint64_t>(tableSize - 1));
+}
+
+/**
+ * @brief Get display name of a strategy
+ */
+const char* CollisionResolution::name(ProbeStrategy strategy) {
+    switch (strategy) {
+        case ProbeStrategy::Linear:        return "linear";
+        case ProbeStrategy::Quadratic:     return "quadratic";
+        case ProbeStrategy::DoubleHashing: return "double-hashing";
+        case ProbeStrategy::RobinHood:     return "robin-hood";
+        case ProbeStrategy::Cuckoo:        return "cuckoo";
+        case ProbeStrategy::Chaining:      return "chaining";
+    }
+    return "unknown";
 }
\ No newline at end of file
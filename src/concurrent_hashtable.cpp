@@ -0,0 +1,311 @@
+#include "concurrent_hashtable.h"
+#include "hashtable.h"
+#include <iostream>
+#include <thread>
+
+ConcurrentHashTable::Entry ConcurrentHashTable::tombstone{0, Record()};
+
+/**
+ * @brief Allocate a slot array with every slot empty
+ */
+ConcurrentHashTable::SlotArray::SlotArray(int slotCount)
+    : capacity(slotCount), slots(new std::atomic<Entry*>[slotCount]) {
+    for (int i = 0; i < capacity; i++) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Constructor
+ */
+ConcurrentHashTable::ConcurrentHashTable(int tableSize, const std::string& type, double maxLoad,
+                                         HashAlgorithm hashAlgorithm)
+    : current(new SlotArray(tableSize > 0 ? tableSize : 1)), count(0), usedSlots(0),
+      maxLoadFactor(maxLoad > 0.0 && maxLoad < 1.0 ? maxLoad : 0.75),
+      byUsername(type != "phone"), algorithm(hashAlgorithm) {
+}
+
+/**
+ * @brief Destructor
+ */
+ConcurrentHashTable::~ConcurrentHashTable() {
+    clear();
+    delete current.load();
+}
+
+/**
+ * @brief Take a stripe's write lock
+ * Moving the sequence to an odd value both locks and tells lookups to retry.
+ */
+void ConcurrentHashTable::lock(Stripe& stripe) {
+    for (int spins = 0;; spins++) {
+        uint32_t sequence = stripe.sequence.load(std::memory_order_relaxed);
+        if ((sequence & 1) == 0 &&
+            stripe.sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire)) {
+            return;
+        }
+        if (spins > 64) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+/**
+ * @brief Release a stripe's write lock
+ */
+void ConcurrentHashTable::unlock(Stripe& stripe) {
+    stripe.sequence.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * @brief Find the entry of a key in a slot array
+ * Slots only go from empty to full and between full and tombstone until
+ * the array is replaced, so an empty slot always ends the chain.
+ */
+const ConcurrentHashTable::Entry* ConcurrentHashTable::find(const SlotArray* array, std::string_view key,
+                                                            uint64_t hash) const {
+    int index = static_cast<int>(hash % static_cast<uint64_t>(array->capacity));
+    for (int attempt = 0; attempt < array->capacity; attempt++) {
+        const Entry* entry = array->slots[index].load(std::memory_order_acquire);
+        if (entry == nullptr) {
+            return nullptr;
+        }
+        if (entry != &tombstone && entry->hash == hash && keyOf(entry->record) == key) {
+            return entry;
+        }
+        index = (index + 1 == array->capacity) ? 0 : index + 1;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Run find() and copy out what it found, validated by the key's stripe
+ * Every writer of the key holds its stripe, so an unchanged sequence means
+ * no insert, remove or growth of the key finished during the read. A
+ * writer still holding the stripe does not force a retry: slots change by
+ * single pointer stores and a growing table leaves the old array intact,
+ * so what was read is the state before that writer.
+ */
+template <class Function>
+void ConcurrentHashTable::readValidated(std::string_view key, Function copyOut) const {
+    uint64_t hash = hashKey(key);
+    const Stripe& stripe = stripes[stripeIndex(hash)];
+    EpochManager::Guard guard(epochs);
+
+    for (;;) {
+        uint32_t before = stripe.sequence.load(std::memory_order_acquire);
+
+        // The slot loads are acquires, so the check below cannot move above them
+        copyOut(find(current.load(std::memory_order_acquire), key, hash));
+
+        if (stripe.sequence.load(std::memory_order_acquire) == before) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Search for a record by key without locking
+ */
+std::optional<Record> ConcurrentHashTable::search(std::string_view key) const {
+    std::optional<Record> result;
+    readValidated(key, [&](const Entry* entry) {
+        if (entry) {
+            result = entry->record;
+        } else {
+            result.reset();
+        }
+    });
+    return result;
+}
+
+/**
+ * @brief Check whether a key is present without locking
+ */
+bool ConcurrentHashTable::contains(std::string_view key) const {
+    bool found = false;
+    readValidated(key, [&](const Entry* entry) { found = entry != nullptr; });
+    return found;
+}
+
+/**
+ * @brief Insert a record
+ * The stripe lock makes the duplicate check and the claim of a slot one
+ * step for this key; writers of other stripes may race for the same free
+ * slot, which the compare-and-swap settles.
+ */
+bool ConcurrentHashTable::insert(const Record& record) {
+    std::string_view key = keyOf(record);
+    if (key.empty()) {
+        std::cerr << "Error: Key cannot be empty!" << std::endl;
+        return false;
+    }
+
+    uint64_t hash = hashKey(key);
+    Stripe& stripe = stripes[stripeIndex(hash)];
+    Entry* entry = nullptr;
+    EpochManager::Guard guard(epochs);  // Other stripes' entries on the chain may be retired
+
+    lock(stripe);
+    for (;;) {
+        SlotArray* array = current.load(std::memory_order_acquire);
+
+        // Walk the chain once: reject duplicates, remember where to place
+        int index = static_cast<int>(hash % static_cast<uint64_t>(array->capacity));
+        int tombstoneIndex = -1;
+        int emptyIndex = -1;
+        for (int attempt = 0; attempt < array->capacity; attempt++) {
+            const Entry* slot = array->slots[index].load(std::memory_order_acquire);
+            if (slot == nullptr) {
+                emptyIndex = index;
+                break;
+            }
+            if (slot == &tombstone) {
+                if (tombstoneIndex == -1) {
+                    tombstoneIndex = index;
+                }
+            } else if (slot->hash == hash && keyOf(slot->record) == key) {
+                unlock(stripe);
+                delete entry;
+                std::cerr << "Error: Record with key '" << key << "' already exists!" << std::endl;
+                return false;
+            }
+            index = (index + 1 == array->capacity) ? 0 : index + 1;
+        }
+
+        if (!entry) {
+            entry = new Entry{hash, record};
+        }
+
+        // Reuse a tombstone, or take an empty slot while under the load limit
+        Entry* expected = &tombstone;
+        if (tombstoneIndex != -1 &&
+            array->slots[tombstoneIndex].compare_exchange_strong(expected, entry, std::memory_order_release)) {
+            break;
+        }
+        if (emptyIndex != -1 && usedSlots.load(std::memory_order_relaxed) + 1 <= maxLoadFactor * array->capacity) {
+            expected = nullptr;
+            if (array->slots[emptyIndex].compare_exchange_strong(expected, entry, std::memory_order_release)) {
+                usedSlots.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+            continue;  // Another stripe's writer took the slot; walk again
+        }
+        if (tombstoneIndex != -1) {
+            continue;  // Lost the tombstone to another stripe's writer
+        }
+
+        unlock(stripe);
+        grow(array);
+        lock(stripe);
+    }
+
+    count.fetch_add(1, std::memory_order_relaxed);
+    unlock(stripe);
+    return true;
+}
+
+/**
+ * @brief Delete a record by key (leaves a tombstone)
+ */
+bool ConcurrentHashTable::remove(std::string_view key) {
+    uint64_t hash = hashKey(key);
+    Stripe& stripe = stripes[stripeIndex(hash)];
+    EpochManager::Guard guard(epochs);
+
+    lock(stripe);
+    SlotArray* array = current.load(std::memory_order_acquire);
+    int index = static_cast<int>(hash % static_cast<uint64_t>(array->capacity));
+    for (int attempt = 0; attempt < array->capacity; attempt++) {
+        Entry* slot = array->slots[index].load(std::memory_order_acquire);
+        if (slot == nullptr) {
+            break;
+        }
+        if (slot != &tombstone && slot->hash == hash && keyOf(slot->record) == key) {
+            array->slots[index].store(&tombstone, std::memory_order_release);
+            count.fetch_sub(1, std::memory_order_relaxed);
+            unlock(stripe);
+            epochs.retire(slot);
+            return true;
+        }
+        index = (index + 1 == array->capacity) ? 0 : index + 1;
+    }
+
+    unlock(stripe);
+    return false;
+}
+
+/**
+ * @brief Replace a full slot array, unless another writer already did
+ * Holding every stripe stops all writers, so the live entries can be
+ * moved without copying records. Lookups are not held up: they read the
+ * old array, which stays valid until retired epochs have passed.
+ */
+void ConcurrentHashTable::grow(SlotArray* observed) {
+    for (Stripe& stripe : stripes) {
+        lock(stripe);
+    }
+
+    if (current.load(std::memory_order_relaxed) == observed) {
+        // Double unless most used slots are tombstones that a rebuild drops
+        int live = count.load(std::memory_order_relaxed);
+        int newSize = observed->capacity;
+        if (live + 1 > maxLoadFactor * observed->capacity / 2) {
+            newSize = UsernameTable::nextPrime(observed->capacity * 2 + 1);
+        }
+
+        SlotArray* array = new SlotArray(newSize);
+        for (int i = 0; i < observed->capacity; i++) {
+            Entry* entry = observed->slots[i].load(std::memory_order_relaxed);
+            if (entry == nullptr || entry == &tombstone) {
+                continue;
+            }
+            int index = static_cast<int>(entry->hash % static_cast<uint64_t>(newSize));
+            while (array->slots[index].load(std::memory_order_relaxed) != nullptr) {
+                index = (index + 1 == newSize) ? 0 : index + 1;
+            }
+            array->slots[index].store(entry, std::memory_order_relaxed);
+        }
+
+        usedSlots.store(live, std::memory_order_relaxed);
+        current.store(array, std::memory_order_release);
+        epochs.retire(observed);
+    }
+
+    for (Stripe& stripe : stripes) {
+        unlock(stripe);
+    }
+}
+
+/**
+ * @brief Delete retired entries and slot arrays no operation can reach
+ * Two epoch advances pass everything retired before the call.
+ */
+void ConcurrentHashTable::reclaim() {
+    epochs.collect();
+    epochs.collect();
+}
+
+/**
+ * @brief Remove all records
+ */
+void ConcurrentHashTable::clear() {
+    SlotArray* array = current.load();
+    for (int i = 0; i < array->capacity; i++) {
+        Entry* entry = array->slots[i].exchange(nullptr);
+        if (entry != nullptr && entry != &tombstone) {
+            delete entry;
+        }
+    }
+    count = 0;
+    usedSlots = 0;
+}
+
+int ConcurrentHashTable::getSize() const {
+    EpochManager::Guard guard(epochs);
+    return current.load(std::memory_order_acquire)->capacity;
+}
+
+double ConcurrentHashTable::getLoadFactor() const {
+    return static_cast<double>(getCount()) / getSize();
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "epoch.h"
+#include <thread>
+
+/**
+ * @brief Slot a thread tries first, spread round-robin over threads
+ */
+static int preferredSlot() {
+    static std::atomic<int> nextThread(0);
+    thread_local int slot = nextThread.fetch_add(1, std::memory_order_relaxed) % EpochManager::MAX_GUARDS;
+    return slot;
+}
+
+EpochManager::Guard::Guard(EpochManager& manager) : epochs(manager), slot(manager.enter()) {
+}
+
+EpochManager::Guard::~Guard() {
+    epochs.leave(slot);
+}
+
+EpochManager::EpochManager() : globalEpoch(0) {
+}
+
+/**
+ * @brief Destructor - deletes every retired object
+ */
+EpochManager::~EpochManager() {
+    for (const Retired& item : retired) {
+        item.deleter(item.object);
+    }
+}
+
+/**
+ * @brief Claim a guard slot and publish the current epoch in it
+ * The epoch is read again after publishing: an advance that scanned the
+ * slots before the publish became visible is caught and the newer epoch
+ * published, so reads never start under a stale epoch.
+ */
+int EpochManager::enter() {
+    int start = preferredSlot();
+    for (int attempt = 0;; attempt++) {
+        int index = (start + attempt) % MAX_GUARDS;
+        uint64_t epoch = globalEpoch.load();
+        uint64_t expected = 0;
+        if (slots[index].state.compare_exchange_strong(expected, epoch << 1 | 1)) {
+            for (uint64_t now = globalEpoch.load(); now != epoch; now = globalEpoch.load()) {
+                epoch = now;
+                slots[index].state.store(epoch << 1 | 1);
+            }
+            return index;
+        }
+        if (attempt % MAX_GUARDS == MAX_GUARDS - 1) {
+            std::this_thread::yield();  // More guards than slots; wait for one to leave
+        }
+    }
+}
+
+void EpochManager::leave(int slot) {
+    slots[slot].state.store(0, std::memory_order_release);
+}
+
+/**
+ * @brief Advance the global epoch if every active guard has seen it
+ */
+bool EpochManager::tryAdvance() {
+    uint64_t epoch = globalEpoch.load();
+    for (const Slot& slot : slots) {
+        uint64_t state = slot.state.load();
+        if ((state & 1) != 0 && (state >> 1) != epoch) {
+            return false;
+        }
+    }
+    return globalEpoch.compare_exchange_strong(epoch, epoch + 1);
+}
+
+/**
+ * @brief Queue an object for deletion
+ */
+void EpochManager::retire(void* object, void (*deleter)(void*)) {
+    bool collectNow;
+    {
+        std::lock_guard<std::mutex> guard(retiredMutex);
+        retired.push_back(Retired{object, deleter, globalEpoch.load()});
+        collectNow = retired.size() % COLLECT_INTERVAL == 0;
+    }
+    if (collectNow) {
+        collect();
+    }
+}
+
+/**
+ * @brief Try to advance the epoch and delete objects that became safe
+ * Objects are deleted outside the lock.
+ */
+void EpochManager::collect() {
+    tryAdvance();
+    uint64_t epoch = globalEpoch.load();
+
+    std::vector<Retired> safe;
+    {
+        std::lock_guard<std::mutex> guard(retiredMutex);
+        size_t kept = 0;
+        for (const Retired& item : retired) {
+            if (item.epoch + 2 <= epoch) {
+                safe.push_back(item);
+            } else {
+                retired[kept++] = item;
+            }
+        }
+        retired.resize(kept);
+    }
+
+    for (const Retired& item : safe) {
+        item.deleter(item.object);
+    }
+}
+
+/**
+ * @brief Get number of retired objects not yet deleted
+ */
+size_t EpochManager::getPendingCount() const {
+    std::lock_guard<std::mutex> guard(retiredMutex);
+    return retired.size();
+}
\ No newline at end of file
@@ -1,14 +1,158 @@
 #include "file_handler.h"
+#include "atomic_file.h"
+#include "group_probe.h"
+#include <cstdio>
+#include <cstring>
 #include <fstream>
-#include <sstream>
 #include <iostream>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FILE_SCAN_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+/**
+ * @brief First ',' or '\n' at or after p, end if none
+ * Compares 16 bytes at a time with SSE2.
+ */
+const char* findDelimiter(const char* p, const char* end) {
+#if defined(FILE_SCAN_SSE2)
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; end - p >= 16; p += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, comma), _mm_cmpeq_epi8(bytes, newline))));
+        if (mask != 0) {
+            return p + GroupProbe::lowestBit(mask);
+        }
+    }
+#endif
+    while (p < end && *p != ',' && *p != '\n') {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * @brief First occurrence of c at or after p, end if none
+ */
+const char* findByte(const char* p, const char* end, char c) {
+    const void* found = (p < end) ? std::memchr(p, c, end - p) : nullptr;
+    return found ? static_cast<const char*>(found) : end;
+}
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/**
+ * @brief Parse one field starting at p
+ * @param toLineEnd Whether the field runs to the end of the line (address)
+ * @param field Output: the field's text
+ * @return Position of the ',' or '\n' that ended the field, or end
+ */
+const char* parseField(const char* p, const char* end, bool toLineEnd, std::string_view& field,
+                       std::deque<std::string>& unescaped) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+
+    if (p < end && *p == '"') {
+        const char* start = p + 1;
+        const char* q = start;
+        std::string* copy = nullptr;
+        for (;;) {
+            const char* quote = findByte(q, end, '"');
+            if (quote == end) {
+                break;
+            }
+            if (quote + 1 < end && quote[1] == '"') {
+                // Doubled quote: the field no longer matches the file bytes
+                if (!copy) {
+                    unescaped.emplace_back();
+                    copy = &unescaped.back();
+                }
+                copy->append(q, quote + 1 - q);
+                q = quote + 2;
+                continue;
+            }
+            const char* after = quote + 1;
+            while (after < end && (*after == ' ' || *after == '\t' || *after == '\r')) {
+                after++;
+            }
+            if (after == end || *after == '\n' || (!toLineEnd && *after == ',')) {
+                if (copy) {
+                    copy->append(q, quote - q);
+                    field = *copy;
+                } else {
+                    field = std::string_view(start, quote - start);
+                }
+                return after;
+            }
+            break;
+        }
+        // Unclosed, or text after the closing quote: the quote is part of
+        // a field written as is, which ends at the delimiter or line end
+        if (copy) {
+            unescaped.pop_back();
+        }
+    }
+
+    const char* delimiter = toLineEnd ? findByte(p, end, '\n') : findDelimiter(p, end);
+    const char* last = delimiter;
+    while (last > p && isBlank(last[-1])) {
+        last--;
+    }
+    field = std::string_view(p, last - p);
+    return delimiter;
+}
+
+/**
+ * @brief Write one field, quoted if parseField would not read it back as is
+ * Fields holding a line break, or a comma unless they run to the line end,
+ * or starting with a quote or starting or ending with a blank, are quoted
+ * with their quotes doubled.
+ */
+void writeField(AtomicFile& file, std::string_view field, bool toLineEnd) {
+    bool quoted = field.find_first_of("\r\n") != std::string_view::npos ||
+                  (!toLineEnd && field.find(',') != std::string_view::npos) ||
+                  (!field.empty() && (field.front() == '"' ||
+                                      field.front() == ' ' || field.front() == '\t' ||
+                                      field.back() == ' ' || field.back() == '\t'));
+    if (!quoted) {
+        file.write(field);
+        return;
+    }
+    file.write("\"");
+    for (size_t quote = field.find('"'); quote != std::string_view::npos;
+         quote = field.find('"')) {
+        file.write(field.substr(0, quote + 1));
+        file.write("\"");
+        field.remove_prefix(quote + 1);
+    }
+    file.write(field);
+    file.write("\"");
+}
+
+} // namespace
 
 /**
  * @brief Save hash table to file
  */
 bool FileHandler::saveHashTable(const HashTable& ht, const std::string& filename) {
-    ht.saveToFile(filename);
-    return true;
+    return ht.saveToFile(filename);
 }
 
 /**
@@ -26,60 +170,133 @@ bool FileHandler::fileExists(const std::string& filename) {
     return file.good();
 }
 
+/**
+ * @brief Force a written file's contents to disk
+ */
+bool FileHandler::syncFile(const std::string& filename) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    bool synced = FlushFileBuffers(file) != 0;
+    CloseHandle(file);
+#else
+    int file = ::open(filename.c_str(), O_WRONLY);
+    if (file < 0) {
+        return false;
+    }
+    bool synced = fsync(file) == 0;
+    ::close(file);
+#endif
+    return synced;
+}
+
+/**
+ * @brief Atomically replace one file with another
+ * On POSIX the rename is made durable by syncing the target's directory.
+ */
+bool FileHandler::replaceFile(const std::string& source, const std::string& target) {
+#ifdef _WIN32
+    return MoveFileExA(source.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (std::rename(source.c_str(), target.c_str()) != 0) {
+        return false;
+    }
+    size_t slash = target.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : target.substr(0, slash + 1);
+    int handle = ::open(directory.c_str(), O_RDONLY);
+    if (handle >= 0) {
+        fsync(handle);
+        ::close(handle);
+    }
+    return true;
+#endif
+}
+
 /**
  * @brief Read all records from file
  */
 std::vector<Record> FileHandler::readRecordsFromFile(const std::string& filename) {
     std::vector<Record> records;
-    std::ifstream file(filename);
-    
-    if (!file.is_open()) {
+    MappedRecords mapped;
+    if (!mapRecordsFromFile(filename, mapped)) {
         return records;
     }
 
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
+    records.reserve(mapped.records.size());
+    for (const RecordView& view : mapped.records) {
+        records.push_back(Record(view));
+    }
+    return records;
+}
 
-        std::stringstream ss(line);
-        std::string username, phone, address;
+/**
+ * @brief Map a file and parse its records without copying fields
+ */
+bool FileHandler::mapRecordsFromFile(const std::string& filename, MappedRecords& result) {
+    result.records.clear();
+    result.unescaped.clear();
+    if (!result.file.open(filename)) {
+        return false;
+    }
+    parseRecords(result.file.text(), result.records, result.unescaped);
+    return true;
+}
 
-        std::getline(ss, username, ',');
-        std::getline(ss, phone, ',');
-        std::getline(ss, address);
+/**
+ * @brief Parse lines of "username,phone,address" into record views
+ */
+void FileHandler::parseRecords(std::string_view text, std::vector<RecordView>& records,
+                               std::deque<std::string>& unescaped) {
+    const char* p = text.data();
+    const char* end = p + text.size();
 
-        // Trim whitespace
-        username.erase(0, username.find_first_not_of(" \t\r\n"));
-        username.erase(username.find_last_not_of(" \t\r\n") + 1);
-        phone.erase(0, phone.find_first_not_of(" \t\r\n"));
-        phone.erase(phone.find_last_not_of(" \t\r\n") + 1);
-        address.erase(0, address.find_first_not_of(" \t\r\n"));
-        address.erase(address.find_last_not_of(" \t\r\n") + 1);
+    while (p < end) {
+        RecordView record;
+        const char* next = parseField(p, end, false, record.username, unescaped);
+        if (next < end && *next == ',') {
+            next = parseField(next + 1, end, false, record.phoneNumber, unescaped);
+        }
+        if (next < end && *next == ',') {
+            next = parseField(next + 1, end, true, record.address, unescaped);
+        }
+        p = (next < end) ? next + 1 : end;
 
-        if (!username.empty() && !phone.empty()) {
-            records.push_back(Record(username, phone, address));
+        if (!record.username.empty() && !record.phoneNumber.empty()) {
+            records.push_back(record);
         }
     }
+}
 
-    file.close();
-    return records;
+/**
+ * @brief Write one record as a line of the file
+ */
+void FileHandler::writeRecord(AtomicFile& file, std::string_view username,
+                              std::string_view phoneNumber, std::string_view address) {
+    writeField(file, username, false);
+    file.write(",");
+    writeField(file, phoneNumber, false);
+    file.write(",");
+    writeField(file, address, true);
+    file.write("\n");
 }
 
 /**
  * @brief Write records to file
  */
 bool FileHandler::writeRecordsToFile(const std::vector<Record>& records, const std::string& filename) {
-    std::ofstream file(filename);
+    AtomicFile file(filename);
     
-    if (!file.is_open()) {
+    if (!file.isOpen()) {
         std::cerr << "Error: Could not open file '" << filename << "' for writing!" << std::endl;
         return false;
     }
 
     for (const auto& rec : records) {
-        file << rec.username << "," << rec.phoneNumber << "," << rec.address << std::endl;
+        writeRecord(file, rec.username, rec.phoneNumber, rec.address);
     }
 
-    file.close();
-    return true;
+    return file.commit();
 }
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "group_probe.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GROUP_PROBE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(GROUP_PROBE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define GROUP_PROBE_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define GROUP_PROBE_AVX2_TARGET
+#endif
+
+namespace {
+
+const uint8_t CTRL_EMPTY = 0x80;
+
+/**
+ * @brief Scalar fallback: 16 control bytes, one comparison each
+ */
+GroupMatch matchScalar(const uint8_t* group, uint8_t fingerprint) {
+    GroupMatch result = {0, 0};
+    for (int i = 0; i < 16; i++) {
+        result.match |= static_cast<uint32_t>(group[i] == fingerprint) << i;
+        result.empty |= static_cast<uint32_t>(group[i] == CTRL_EMPTY) << i;
+    }
+    return result;
+}
+
+#if defined(GROUP_PROBE_X86)
+/**
+ * @brief SSE2: 16 control bytes per compare
+ */
+GroupMatch matchSSE2(const uint8_t* group, uint8_t fingerprint) {
+    __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    GroupMatch result;
+    result.match = static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(ctrl, _mm_set1_epi8(static_cast<char>(fingerprint)))));
+    result.empty = static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(ctrl, _mm_set1_epi8(static_cast<char>(CTRL_EMPTY)))));
+    return result;
+}
+
+/**
+ * @brief AVX2: 32 control bytes per compare
+ */
+GROUP_PROBE_AVX2_TARGET
+GroupMatch matchAVX2(const uint8_t* group, uint8_t fingerprint) {
+    __m256i ctrl = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(group));
+    GroupMatch result;
+    result.match = static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(ctrl, _mm256_set1_epi8(static_cast<char>(fingerprint)))));
+    result.empty = static_cast<uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(ctrl, _mm256_set1_epi8(static_cast<char>(CTRL_EMPTY)))));
+    return result;
+}
+
+/**
+ * @brief Check CPU and OS support for AVX2
+ */
+bool cpuHasAVX2() {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+#endif
+
+struct EngineState {
+    GroupProbe::Engine engine;
+    GroupProbe::MatchFunction function;
+    int width;
+};
+
+EngineState engineState(GroupProbe::Engine engine) {
+    switch (engine) {
+#if defined(GROUP_PROBE_X86)
+        case GroupProbe::Engine::AVX2:
+            return {engine, matchAVX2, 32};
+        case GroupProbe::Engine::SSE2:
+            return {engine, matchSSE2, 16};
+#endif
+        default:
+            return {GroupProbe::Engine::Scalar, matchScalar, 16};
+    }
+}
+
+EngineState activeState = engineState(GroupProbe::best());
+
+} // namespace
+
+/**
+ * @brief Get the fastest engine supported by this CPU
+ */
+GroupProbe::Engine GroupProbe::best() {
+#if defined(GROUP_PROBE_X86)
+    static const bool avx2 = cpuHasAVX2();
+    return avx2 ? Engine::AVX2 : Engine::SSE2;
+#else
+    return Engine::Scalar;
+#endif
+}
+
+/**
+ * @brief Get the engine currently used by match()
+ */
+GroupProbe::Engine GroupProbe::active() {
+    return activeState.engine;
+}
+
+/**
+ * @brief Select the engine used by match()
+ */
+bool GroupProbe::select(Engine engine) {
+    if (static_cast<int>(engine) > static_cast<int>(best())) {
+        return false;
+    }
+    activeState = engineState(engine);
+    return true;
+}
+
+/**
+ * @brief Get group width of the active engine
+ */
+int GroupProbe::width() {
+    return activeState.width;
+}
+
+/**
+ * @brief Compare one group of control bytes with the active engine
+ */
+GroupMatch GroupProbe::match(const uint8_t* group, uint8_t fingerprint) {
+    return activeState.function(group, fingerprint);
+}
+
+/**
+ * @brief Get the compare function of the active engine
+ */
+GroupProbe::MatchFunction GroupProbe::matcher() {
+    return activeState.function;
+}
+
+/**
+ * @brief Get display name of an engine
+ */
+const char* GroupProbe::name(Engine engine) {
+    switch (engine) {
+        case Engine::Scalar: return "scalar";
+        case Engine::SSE2:   return "sse2";
+        case Engine::AVX2:   return "avx2";
+    }
+    return "unknown";
+}
\ No newline at end of file
@@ -1,10 +1,85 @@
 #include "hashfunction.h"
+#include <cstring>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace {
+
+// Keys are read as little-endian words; all supported targets are little-endian
+inline uint64_t read64(const unsigned char* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t read32(const unsigned char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+/**
+ * @brief Full 64x64 -> 128 bit multiply, low half in a, high half in b
+ */
+inline void multiply128(uint64_t& a, uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    a = static_cast<uint64_t>(r);
+    b = static_cast<uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    a = _umul128(a, b, &b);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    a = lo;
+#endif
+}
+
+inline uint64_t wyMix(uint64_t a, uint64_t b) {
+    multiply128(a, b);
+    return a ^ b;
+}
+
+const uint64_t WY_SECRET[4] = {
+    0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+    0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL
+};
+
+const uint64_t XXH_PRIME1 = 11400714785074694791ULL;
+const uint64_t XXH_PRIME2 = 14029467366897019727ULL;
+const uint64_t XXH_PRIME3 = 1609587929392839161ULL;
+const uint64_t XXH_PRIME4 = 9650029242287828579ULL;
+const uint64_t XXH_PRIME5 = 2870177450012600261ULL;
+
+inline uint64_t xxhRound(uint64_t acc, uint64_t input) {
+    acc += input * XXH_PRIME2;
+    acc = rotl64(acc, 31);
+    return acc * XXH_PRIME1;
+}
+
+inline uint64_t xxhMerge(uint64_t acc, uint64_t value) {
+    acc ^= xxhRound(0, value);
+    return acc * XXH_PRIME1 + XXH_PRIME4;
+}
+
+} // namespace
 
 /**
  * @brief Hash function using modulo division method
  * Implements: hash(key) = (sum of ASCII values) % tableSize
  */
-int HashFunction::hash(const std::string& key, int tableSize) {
+int HashFunction::hash(std::string_view key, int tableSize) {
     if (key.empty() || tableSize <= 0) {
         return 0;
     }
@@ -21,7 +96,7 @@ int HashFunction::hash(const std::string& key, int tableSize) {
  * @brief Enhanced hash function with polynomial rolling hash
  * Better distribution for similar keys
  */
-int HashFunction::hashWithSeed(const std::string& key, int tableSize) {
+int HashFunction::hashWithSeed(std::string_view key, int tableSize) {
     if (key.empty() || tableSize <= 0) {
         return 0;
     }
@@ -36,4 +111,182 @@ int HashFunction::hashWithSeed(const std::string& key, int tableSize) {
     }
 
     return static_cast<int>(hashValue);
+}
+
+/**
+ * @brief wyhash (final version 4)
+ * Mixes 16 bytes per multiply; short keys are read with overlapping loads
+ */
+uint64_t HashFunction::wyhash64(const char* data, size_t length, uint64_t seed) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    seed ^= wyMix(seed ^ WY_SECRET[0], WY_SECRET[1]);
+    uint64_t a, b;
+
+    if (length <= 16) {
+        if (length >= 4) {
+            a = (read32(p) << 32) | read32(p + ((length >> 3) << 2));
+            b = (read32(p + length - 4) << 32) | read32(p + length - 4 - ((length >> 3) << 2));
+        } else if (length > 0) {
+            a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[length >> 1]) << 8) | p[length - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = length;
+        if (i > 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = wyMix(read64(p) ^ WY_SECRET[1], read64(p + 8) ^ seed);
+                see1 = wyMix(read64(p + 16) ^ WY_SECRET[2], read64(p + 24) ^ see1);
+                see2 = wyMix(read64(p + 32) ^ WY_SECRET[3], read64(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = wyMix(read64(p) ^ WY_SECRET[1], read64(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = read64(p + i - 16);
+        b = read64(p + i - 8);
+    }
+
+    a ^= WY_SECRET[1];
+    b ^= seed;
+    multiply128(a, b);
+    return wyMix(a ^ WY_SECRET[0] ^ length, b ^ WY_SECRET[1]);
+}
+
+/**
+ * @brief XXH64
+ * Four 8-byte lanes per 32-byte stripe, then 8/4/1-byte tail steps
+ */
+uint64_t HashFunction::xxhash64(const char* data, size_t length, uint64_t seed) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = p + length;
+    uint64_t h64;
+
+    if (length >= 32) {
+        uint64_t v1 = seed + XXH_PRIME1 + XXH_PRIME2;
+        uint64_t v2 = seed + XXH_PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_PRIME1;
+        const unsigned char* limit = end - 32;
+        do {
+            v1 = xxhRound(v1, read64(p));
+            v2 = xxhRound(v2, read64(p + 8));
+            v3 = xxhRound(v3, read64(p + 16));
+            v4 = xxhRound(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        h64 = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h64 = xxhMerge(h64, v1);
+        h64 = xxhMerge(h64, v2);
+        h64 = xxhMerge(h64, v3);
+        h64 = xxhMerge(h64, v4);
+    } else {
+        h64 = seed + XXH_PRIME5;
+    }
+
+    h64 += length;
+
+    while (p + 8 <= end) {
+        h64 ^= xxhRound(0, read64(p));
+        h64 = rotl64(h64, 27) * XXH_PRIME1 + XXH_PRIME4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h64 ^= read32(p) * XXH_PRIME1;
+        h64 = rotl64(h64, 23) * XXH_PRIME2 + XXH_PRIME3;
+        p += 4;
+    }
+    while (p < end) {
+        h64 ^= (*p) * XXH_PRIME5;
+        h64 = rotl64(h64, 11) * XXH_PRIME1;
+        p++;
+    }
+
+    h64 ^= h64 >> 33;
+    h64 *= XXH_PRIME2;
+    h64 ^= h64 >> 29;
+    h64 *= XXH_PRIME3;
+    h64 ^= h64 >> 32;
+    return h64;
+}
+
+/**
+ * @brief Calculate the full 64-bit hash with the selected algorithm
+ */
+uint64_t HashFunction::hash64(std::string_view key, HashAlgorithm algorithm) {
+    switch (algorithm) {
+        case HashAlgorithm::Sum: {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < key.length(); i++) {
+                sum += static_cast<unsigned char>(key[i]);
+            }
+            return sum;
+        }
+        case HashAlgorithm::Polynomial: {
+            uint64_t hashValue = 0;
+            uint64_t power = 1;
+            for (size_t i = 0; i < key.length(); i++) {
+                hashValue += static_cast<unsigned char>(key[i]) * power;
+                power *= 31;
+            }
+            return hashValue;
+        }
+        case HashAlgorithm::XXHash64:
+            return xxhash64(key.data(), key.size(), SEED);
+        case HashAlgorithm::WyHash:
+        default:
+            return wyhash64(key.data(), key.size(), SEED);
+    }
+}
+
+/**
+ * @brief Calculate table index with the selected algorithm
+ * Legacy algorithms keep their exact original results
+ */
+int HashFunction::index(std::string_view key, int tableSize, HashAlgorithm algorithm) {
+    if (tableSize <= 0) {
+        return 0;
+    }
+
+    switch (algorithm) {
+        case HashAlgorithm::Sum:
+            return hash(key, tableSize);
+        case HashAlgorithm::Polynomial:
+            return hashWithSeed(key, tableSize);
+        case HashAlgorithm::XXHash64:
+            return static_cast<int>(xxhash64(key.data(), key.size(), SEED) % static_cast<uint64_t>(tableSize));
+        case HashAlgorithm::WyHash:
+        default:
+            return static_cast<int>(wyhash64(key.data(), key.size(), SEED) % static_cast<uint64_t>(tableSize));
+    }
+}
+
+/**
+ * @brief Finalizer mixing all bits of a 64-bit integer key (SplitMix64)
+ */
+uint64_t HashFunction::mix64(uint64_t value) {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+/**
+ * @brief Get display name of an algorithm
+ */
+const char* HashFunction::name(HashAlgorithm algorithm) {
+    switch (algorithm) {
+        case HashAlgorithm::Sum:        return "sum";
+        case HashAlgorithm::Polynomial: return "polynomial";
+        case HashAlgorithm::WyHash:     return "wyhash";
+        case HashAlgorithm::XXHash64:   return "xxhash64";
+    }
+    return "unknown";
 }
\ No newline at end of file
@@ -1,20 +1,66 @@
 #include "hashtable.h"
 #include "hashfunction.h"
 #include "collision.h"
+#include "file_handler.h"
+#include "atomic_file.h"
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <thread>
 
 /**
- * @brief Constructor - Initialize hash table
+ * @brief Build the engine for a key type and probe strategy
  */
-HashTable::HashTable(int tableSize, const std::string& type) 
-    : size(tableSize), count(0), keyType(type) {
-    table.resize(size);
-    for (int i = 0; i < size; i++) {
-        table[i] = Record();  // Initialize with empty records
+TableEngine HashTable::makeTable(int tableSize, const std::string& type, double maxLoad,
+                                 HashAlgorithm hashAlgorithm, ProbeStrategy probeStrategy,
+                                 const RecordStore* store) {
+    bool cuckoo = (probeStrategy == ProbeStrategy::Cuckoo);
+    bool chaining = (probeStrategy == ProbeStrategy::Chaining);
+    if (type == "username") {
+        UsernameKey keyOf;
+        keyOf.store = store;
+        if (cuckoo) {
+            return TableEngine(std::in_place_type<UsernameCuckooTable>, tableSize, maxLoad,
+                               StringHash(hashAlgorithm), keyOf);
+        }
+        if (chaining) {
+            return TableEngine(std::in_place_type<UsernameChainedTable>, tableSize, maxLoad,
+                               StringHash(hashAlgorithm), keyOf);
+        }
+        return TableEngine(std::in_place_type<UsernameTable>, tableSize, maxLoad, probeStrategy,
+                           StringHash(hashAlgorithm), keyOf);
+    }
+    PhoneKey keyOf;
+    keyOf.store = store;
+    if (cuckoo) {
+        return TableEngine(std::in_place_type<PhoneCuckooTable>, tableSize, maxLoad,
+                           StringHash(hashAlgorithm), keyOf);
+    }
+    if (chaining) {
+        return TableEngine(std::in_place_type<PhoneChainedTable>, tableSize, maxLoad,
+                           StringHash(hashAlgorithm), keyOf);
     }
+    return TableEngine(std::in_place_type<PhoneTable>, tableSize, maxLoad, probeStrategy,
+                       StringHash(hashAlgorithm), keyOf);
+}
+
+/**
+ * @brief Constructor - Initialize hash table with its own record store
+ */
+HashTable::HashTable(int tableSize, const std::string& type, double maxLoad,
+                     HashAlgorithm hashAlgorithm, ProbeStrategy probeStrategy) 
+    : HashTable(std::make_shared<RecordStore>(), tableSize, type, maxLoad, hashAlgorithm, probeStrategy) {
+}
+
+/**
+ * @brief Constructor - Initialize hash table indexing a shared record store
+ */
+HashTable::HashTable(std::shared_ptr<RecordStore> sharedStore, int tableSize, const std::string& type,
+                     double maxLoad, HashAlgorithm hashAlgorithm, ProbeStrategy probeStrategy)
+    : store(std::move(sharedStore)),
+      table(makeTable(tableSize, type, maxLoad, hashAlgorithm, probeStrategy, store.get())),
+      keyType(type), algorithm(hashAlgorithm) {
 }
 
 /**
@@ -25,125 +71,276 @@ HashTable::~HashTable() {
 }
 
 /**
- * @brief Find index for a given key
+ * @brief Exchange contents, including the record store, with another table
  */
-int HashTable::findIndex(const std::string& key, int& searchLength) const {
-    searchLength = 0;
-    
-    if (key.empty()) {
-        return -1;
-    }
-
-    int hashIndex = HashFunction::hash(key, size);
-    int attempt = 0;
-    int index = hashIndex;
-
-    // Linear probing
-    while (attempt < size) {
-        searchLength++;
-        
-        // Check if slot is empty (never used)
-        if (table[index].isEmpty && !table[index].isDeleted) {
-            return -1;  // Key not found
-        }
+void HashTable::swap(HashTable& other) {
+    store.swap(other.store);
+    table.swap(other.table);
+    keyType.swap(other.keyType);
+    std::swap(algorithm, other.algorithm);
+}
 
-        // Check if key matches and not deleted
-        std::string currentKey = (keyType == "username") ? 
-                                  table[index].username : 
-                                  table[index].phoneNumber;
+/**
+ * @brief Insert a record into hash table
+ */
+bool HashTable::insert(const Record& record) {
+    // Get the key based on table type
+    const std::string& key = byUsername() ? record.username : record.phoneNumber;
 
-        if (!table[index].isDeleted && currentKey == key) {
-            return index;  // Found
-        }
+    if (key.empty()) {
+        std::cerr << "Error: Key cannot be empty!" << std::endl;
+        return false;
+    }
 
-        // Continue probing
-        attempt++;
-        index = CollisionResolution::linearProbe(hashIndex, attempt, size);
+    if (!prepareLink(key)) {
+        std::cerr << "Error: Record with key '" << key << "' already exists!" << std::endl;
+        return false;
     }
 
-    return -1;  // Not found after full cycle
+    commitLink(store->add(record));
+    return true;
 }
 
 /**
- * @brief Insert a record into hash table
+ * @brief Index a record already in the store
  */
-bool HashTable::insert(const Record& record) {
-    if (count >= size) {
-        std::cerr << "Error: Hash table is full!" << std::endl;
+bool HashTable::link(uint32_t id) {
+    std::string_view key = std::visit([&](const auto& engine) { return engine.getKeyOf()(id); }, table);
+    if (!prepareLink(key)) {
         return false;
     }
 
-    // Get the key based on table type
-    std::string key = (keyType == "username") ? record.username : record.phoneNumber;
+    commitLink(id);
+    return true;
+}
 
+/**
+ * @brief Reserve room for a key before its record is linked
+ */
+bool HashTable::prepareLink(std::string_view key) {
     if (key.empty()) {
-        std::cerr << "Error: Key cannot be empty!" << std::endl;
         return false;
     }
+    return std::visit([&](auto& engine) { return engine.prepareInsert(key); }, table);
+}
 
-    // Check for duplicate
-    int dummyLength = 0;
-    if (findIndex(key, dummyLength) != -1) {
-        std::cerr << "Error: Record with key '" << key << "' already exists!" << std::endl;
-        return false;
+/**
+ * @brief Index a record whose key passed prepareLink
+ */
+void HashTable::commitLink(uint32_t id) {
+    std::visit([&](auto& engine) { engine.commitInsert(uint32_t(id)); }, table);
+}
+
+/**
+ * @brief Grow once so recordCount records fit without a resize
+ */
+void HashTable::reserve(int recordCount) {
+    store->reserve(recordCount);
+    std::visit([&](auto& engine) { engine.reserve(recordCount); }, table);
+}
+
+/**
+ * @brief Hash the key of every record for this table
+ * Each thread hashes one contiguous range; threads are only started for
+ * inputs large enough to amortise them.
+ */
+template <class Records>
+std::vector<uint64_t> HashTable::hashKeysOf(const Records& records) const {
+    const size_t MIN_PER_THREAD = 1 << 16;
+    std::vector<uint64_t> hashes(records.size());
+    bool username = byUsername();
+
+    auto hashRange = [&](size_t begin, size_t end) {
+        std::visit([&](const auto& engine) {
+            for (size_t i = begin; i < end; i++) {
+                hashes[i] = engine.hashOf(std::string_view(username ? records[i].username
+                                                                      : records[i].phoneNumber));
+            }
+        }, table);
+    };
+
+    size_t threadCount = records.size() / MIN_PER_THREAD + 1;
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    if (threadCount > cores) {
+        threadCount = cores;
     }
+    size_t chunk = (records.size() + threadCount - 1) / threadCount;
 
-    int hashIndex = HashFunction::hash(key, size);
-    int attempt = 0;
-    int index = hashIndex;
-
-    // Find first available slot
-    while (attempt < size) {
-        if (table[index].isAvailable()) {
-            table[index] = record;
-            table[index].isEmpty = false;
-            table[index].isDeleted = false;
-            count++;
-            return true;
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threadCount; t++) {
+        workers.emplace_back(hashRange, t * chunk, std::min((t + 1) * chunk, records.size()));
+    }
+    hashRange(0, std::min(chunk, records.size()));
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return hashes;
+}
+
+std::vector<uint64_t> HashTable::hashKeys(const std::vector<Record>& records) const {
+    return hashKeysOf(records);
+}
+
+std::vector<uint64_t> HashTable::hashKeys(const std::vector<RecordView>& records) const {
+    return hashKeysOf(records);
+}
+
+/**
+ * @brief Index a stored record whose key hash is already known
+ */
+int HashTable::linkHashed(uint32_t id, uint64_t hash) {
+    return std::visit([&](auto& engine) { return engine.insertHashed(hash, uint32_t(id)); }, table);
+}
+
+/**
+ * @brief Insert many records, as when loading a file
+ * A record is stored before it is linked, since the placement probe
+ * compares keys through the store; a duplicate is dropped again.
+ */
+template <class Records>
+int HashTable::bulkInsertOf(const Records& records) {
+    bool username = byUsername();
+    reserve(getCount() + static_cast<int>(records.size()));
+    std::vector<uint64_t> hashes = hashKeysOf(records);
+
+    int inserted = 0;
+    for (size_t i = 0; i < records.size(); i++) {
+        std::string_view key = username ? records[i].username : records[i].phoneNumber;
+        if (key.empty()) {
+            std::cerr << "Error: Key cannot be empty!" << std::endl;
+            continue;
+        }
+
+        uint32_t id = store->add(records[i].username, records[i].phoneNumber, records[i].address);
+        if (linkHashed(id, hashes[i]) == -1) {
+            store->remove(id);
+            std::cerr << "Error: Record with key '" << key << "' already exists!" << std::endl;
+            continue;
         }
+        inserted++;
+    }
+    return inserted;
+}
+
+int HashTable::bulkInsert(const std::vector<Record>& records) {
+    return bulkInsertOf(records);
+}
 
-        attempt++;
-        index = CollisionResolution::linearProbe(hashIndex, attempt, size);
+int HashTable::bulkInsert(const std::vector<RecordView>& records) {
+    return bulkInsertOf(records);
+}
+
+/**
+ * @brief Drop a key from this table only, leaving the record stored
+ */
+uint32_t HashTable::unlink(std::string_view key) {
+    int index = findSlot(key);
+    if (index == -1) {
+        return RecordStore::NO_RECORD;
     }
 
-    std::cerr << "Error: Could not find available slot!" << std::endl;
-    return false;
+    uint32_t id = getIdAt(index);
+    unlinkAt(index);
+    return id;
+}
+
+/**
+ * @brief Find the slot holding a key, without advancing migration
+ */
+int HashTable::findSlot(std::string_view key) const {
+    return std::visit([&](const auto& engine) {
+        int searchLength = 0;
+        return engine.findIndex(key, searchLength);
+    }, table);
+}
+
+/**
+ * @brief Drop the entry at a slot returned by findSlot
+ */
+void HashTable::unlinkAt(int index) {
+    std::visit([&](auto& engine) { engine.erase(index); }, table);
+}
+
+/**
+ * @brief Get the record ID held by a slot
+ */
+uint32_t HashTable::getIdAt(int index) const {
+    return std::visit([&](const auto& engine) {
+        return engine.isOccupied(index) ? engine.valueAt(index) : RecordStore::NO_RECORD;
+    }, table);
+}
+
+/**
+ * @brief Look up the record ID of a key
+ */
+uint32_t HashTable::findId(std::string_view key) const {
+    const uint32_t* found = std::visit([&](const auto& engine) { return engine.search(key); }, table);
+    return found ? *found : RecordStore::NO_RECORD;
 }
 
 /**
  * @brief Search for a record by key
  */
-Record* HashTable::search(const std::string& key) {
-    int searchLength = 0;
-    int index = findIndex(key, searchLength);
+std::optional<RecordView> HashTable::search(std::string_view key) {
+    const uint32_t* found = std::visit([&](auto& engine) -> const uint32_t* {
+        return engine.search(key);
+    }, table);
 
-    if (index != -1) {
-        return &table[index];
+    if (found) {
+        return store->view(*found);
     }
-
-    return nullptr;
+    return std::nullopt;
 }
 
 /**
- * @brief Delete a record by key (lazy deletion)
+ * @brief Search for many keys at once
+ * Chunks keep the slot indexes on the stack.
  */
-bool HashTable::remove(const std::string& key) {
-    int searchLength = 0;
-    int index = findIndex(key, searchLength);
+void HashTable::searchBatch(const std::string_view* keys, int keyCount, std::optional<RecordView>* results) const {
+    const int CHUNK = 64;
+    int indices[CHUNK];
+
+    for (int start = 0; start < keyCount; start += CHUNK) {
+        int chunk = (keyCount - start < CHUNK) ? keyCount - start : CHUNK;
+        std::visit([&](const auto& engine) {
+            engine.findBatch(keys + start, chunk, indices);
+            for (int i = 0; i < chunk; i++) {
+                if (indices[i] == -1) {
+                    results[start + i].reset();
+                } else {
+                    results[start + i] = store->view(engine.valueAt(indices[i]));
+                }
+            }
+        }, table);
+    }
+}
 
-    if (index != -1) {
-        table[index].isDeleted = true;
-        count--;
-        return true;
+/**
+ * @brief Delete a record by key
+ * Lazy deletion, or backward shift for Robin Hood
+ */
+bool HashTable::remove(std::string_view key) {
+    uint32_t id = unlink(key);
+    if (id == RecordStore::NO_RECORD) {
+        return false;
     }
 
-    return false;
+    store->remove(id);
+    return true;
+}
+
+/**
+ * @brief Check whether a key is present
+ */
+bool HashTable::contains(std::string_view key) const {
+    return std::visit([&](const auto& engine) { return engine.contains(key); }, table);
 }
 
 /**
  * @brief Display all active records with enhanced UI
  */
 void HashTable::display() const {
+    int count = getCount();
     if (count == 0) {
         std::cout << "\033[1;33m⚠ Hash table is empty.\033[0m" << std::endl;
         return;
@@ -158,22 +355,20 @@ void HashTable::display() const {
     std::cout << "╠══════╬═══════════════════════╬═══════════════════╬═════════════════════════════════════╣\033[0m\n";
 
     int displayed = 0;
-    for (int i = 0; i < size; i++) {
-        if (!table[i].isEmpty && !table[i].isDeleted) {
-            displayed++;
-            std::string username = table[i].username.length() > 20 ? table[i].username.substr(0, 17) + "..." : table[i].username;
-            std::string phone = table[i].phoneNumber.length() > 17 ? table[i].phoneNumber.substr(0, 14) + "..." : table[i].phoneNumber;
-            std::string address = table[i].address.length() > 35 ? table[i].address.substr(0, 32) + "..." : table[i].address;
-            
-            // Alternating row colors for better readability
-            std::string rowColor = (displayed % 2 == 0) ? "\033[0;97m" : "\033[0;37m";
-            
-            std::cout << "\033[1;96m║\033[0m " << rowColor << std::setw(4) << std::right << displayed << " \033[1;96m║\033[0m "
-                      << rowColor << std::setw(20) << std::left << username << " \033[1;96m║\033[0m "
-                      << rowColor << std::setw(17) << std::left << phone << " \033[1;96m║\033[0m "
-                      << rowColor << std::setw(35) << std::left << address << " \033[1;96m║\033[0m" << std::endl;
-        }
-    }
+    forEachRecord([&](const RecordView& rec) {
+        displayed++;
+        std::string username = rec.username.length() > 20 ? std::string(rec.username.substr(0, 17)) + "..." : std::string(rec.username);
+        std::string phone = rec.phoneNumber.length() > 17 ? std::string(rec.phoneNumber.substr(0, 14)) + "..." : std::string(rec.phoneNumber);
+        std::string address = rec.address.length() > 35 ? std::string(rec.address.substr(0, 32)) + "..." : std::string(rec.address);
+        
+        // Alternating row colors for better readability
+        std::string rowColor = (displayed % 2 == 0) ? "\033[0;97m" : "\033[0;37m";
+        
+        std::cout << "\033[1;96m║\033[0m " << rowColor << std::setw(4) << std::right << displayed << " \033[1;96m║\033[0m "
+                  << rowColor << std::setw(20) << std::left << username << " \033[1;96m║\033[0m "
+                  << rowColor << std::setw(17) << std::left << phone << " \033[1;96m║\033[0m "
+                  << rowColor << std::setw(35) << std::left << address << " \033[1;96m║\033[0m" << std::endl;
+    });
 
     std::cout << "\033[1;96m╚══════╩═══════════════════════╩═══════════════════╩═════════════════════════════════════╝\033[0m\n";
     std::cout << "\033[1;92m✨ Total records displayed: \033[1;93m" << displayed << "\033[1;92m / \033[1;94m" << count << "\033[1;92m entries in table\033[0m\n" << std::endl;
@@ -182,116 +377,237 @@ void HashTable::display() const {
 /**
  * @brief Get search length for a specific key
  */
-int HashTable::getSearchLength(const std::string& key) const {
-    int searchLength = 0;
-    int index = findIndex(key, searchLength);
-    
-    return (index != -1) ? searchLength : -1;
+int HashTable::getSearchLength(std::string_view key) const {
+    return std::visit([&](const auto& engine) { return engine.getSearchLength(key); }, table);
 }
 
 /**
  * @brief Calculate average search length across all records
  */
 double HashTable::getAverageSearchLength() const {
-    if (count == 0) {
-        return 0.0;
-    }
+    return std::visit([](const auto& engine) { return engine.getAverageSearchLength(); }, table);
+}
 
-    int totalLength = 0;
-    int recordCount = 0;
-
-    for (int i = 0; i < size; i++) {
-        if (!table[i].isEmpty && !table[i].isDeleted) {
-            std::string key = (keyType == "username") ? 
-                              table[i].username : 
-                              table[i].phoneNumber;
-            
-            int searchLength = getSearchLength(key);
-            if (searchLength > 0) {
-                totalLength += searchLength;
-                recordCount++;
-            }
-        }
+/**
+ * @brief Share of records found in 1, 2, ... probes
+ */
+std::vector<double> TableStats::probeLengthShares(int buckets) const {
+    std::vector<double> shares(buckets > 0 ? buckets : 0, 0.0);
+    if (count == 0 || shares.empty()) {
+        return shares;
     }
+    for (size_t distance = 0; distance < distanceHistogram.size(); distance++) {
+        size_t bucket = (distance < shares.size()) ? distance : shares.size() - 1;
+        shares[bucket] += static_cast<double>(distanceHistogram[distance]) / count;
+    }
+    return shares;
+}
+
+/**
+ * @brief Get size, count, load factor and probe distance statistics
+ */
+TableStats HashTable::getStats() const {
+    TableStats stats;
+    stats.size = getSize();
+    stats.count = getCount();
+    stats.loadFactor = getLoadFactor();
+    std::visit([&](const auto& engine) {
+        stats.averageSearchLength = engine.getAverageSearchLength();
+        stats.maxProbeDistance = engine.getMaxProbeDistance();
+        stats.tombstones = engine.getTombstoneCount();
+        stats.compactions = engine.getCompactionCount();
+        stats.filterBits = engine.getFilterBits();
+        stats.filterBytes = engine.getFilterBytes();
+        stats.distanceHistogram.assign(engine.getDistanceHistogram().begin(), engine.getDistanceHistogram().end());
+    }, table);
+    return stats;
+}
+
+/**
+ * @brief Sample the miss search length and filter false positive rate
+ */
+SampledStats HashTable::getSampledStats() const {
+    SampledStats sampled;
+    std::visit([&](const auto& engine) {
+        sampled.missSearchLength = engine.getMissSearchLength();
+        sampled.filterFalsePositiveRate = engine.getFilterFalsePositiveRate();
+    }, table);
+    return sampled;
+}
+
+/**
+ * @brief Get the largest probe distance of any record
+ */
+int HashTable::getMaxProbeDistance() const {
+    return std::visit([](const auto& engine) { return engine.getMaxProbeDistance(); }, table);
+}
 
-    return (recordCount > 0) ? (static_cast<double>(totalLength) / recordCount) : 0.0;
+/**
+ * @brief Get the mean probe distance across all records
+ */
+double HashTable::getMeanProbeDistance() const {
+    return std::visit([](const auto& engine) { return engine.getMeanProbeDistance(); }, table);
 }
 
 /**
  * @brief Get current load factor
  */
 double HashTable::getLoadFactor() const {
-    return (size > 0) ? (static_cast<double>(count) / size) : 0.0;
+    return std::visit([](const auto& engine) { return engine.getLoadFactor(); }, table);
+}
+
+/**
+ * @brief Get load factor threshold that triggers growth
+ */
+double HashTable::getMaxLoadFactor() const {
+    return std::visit([](const auto& engine) { return engine.getMaxLoadFactor(); }, table);
+}
+
+/**
+ * @brief Set load factor threshold that triggers growth
+ */
+void HashTable::setMaxLoadFactor(double maxLoad) {
+    std::visit([&](auto& engine) { engine.setMaxLoadFactor(maxLoad); }, table);
+}
+
+/**
+ * @brief Get the tombstone share that triggers compaction
+ */
+double HashTable::getMaxTombstoneRatio() const {
+    return std::visit([](const auto& engine) { return engine.getMaxTombstoneRatio(); }, table);
+}
+
+/**
+ * @brief Set the tombstone share that triggers compaction
+ */
+void HashTable::setMaxTombstoneRatio(double ratio) {
+    std::visit([&](auto& engine) { engine.setMaxTombstoneRatio(ratio); }, table);
+}
+
+/**
+ * @brief Rehash the table in place, dropping its tombstones
+ */
+void HashTable::compact() {
+    std::visit([](auto& engine) { engine.compact(); }, table);
+}
+
+/**
+ * @brief Estimate the probes taken by an unsuccessful lookup
+ */
+double HashTable::getMissSearchLength() const {
+    return std::visit([](const auto& engine) { return engine.getMissSearchLength(); }, table);
+}
+
+/**
+ * @brief Enable, resize or disable the lookup filter
+ */
+void HashTable::setFilterBits(int bitsPerRecord) {
+    std::visit([&](auto& engine) { engine.setFilterBits(bitsPerRecord); }, table);
+}
+
+/**
+ * @brief Get the lookup filter's bits per record
+ */
+int HashTable::getFilterBits() const {
+    return std::visit([](const auto& engine) { return engine.getFilterBits(); }, table);
+}
+
+/**
+ * @brief Check whether an incremental resize is in progress
+ */
+bool HashTable::isResizing() const {
+    return std::visit([](const auto& engine) { return engine.isResizing(); }, table);
+}
+
+/**
+ * @brief Get progress of the current incremental resize
+ */
+double HashTable::getMigrationProgress() const {
+    return std::visit([](const auto& engine) { return engine.getMigrationProgress(); }, table);
 }
 
 /**
  * @brief Save hash table to file
  * Format: username,phone,address
  */
-void HashTable::saveToFile(const std::string& filename) const {
-    std::ofstream file(filename);
+bool HashTable::saveToFile(const std::string& filename) const {
+    AtomicFile file(filename);
     
-    if (!file.is_open()) {
+    if (!file.isOpen()) {
         std::cerr << "Error: Could not open file '" << filename << "' for writing!" << std::endl;
-        return;
+        return false;
     }
 
     int saved = 0;
-    for (int i = 0; i < size; i++) {
-        if (!table[i].isEmpty && !table[i].isDeleted) {
-            file << table[i].username << ","
-                 << table[i].phoneNumber << ","
-                 << table[i].address << std::endl;
-            saved++;
-        }
-    }
+    forEachRecord([&](const RecordView& rec) {
+        FileHandler::writeRecord(file, rec.username, rec.phoneNumber, rec.address);
+        saved++;
+    });
 
-    file.close();
+    if (!file.commit()) {
+        std::cerr << "Error: Could not save '" << filename << "', previous contents kept!" << std::endl;
+        return false;
+    }
+    savedFile = filename;
+    savedVersion = store->getVersion();
     std::cout << "Saved " << saved << " records to '" << filename << "'" << std::endl;
+    return true;
 }
 
 /**
- * @brief Load hash table from file
- * Format: username,phone,address
+ * @brief Save only if the records changed since the last save to filename
  */
-int HashTable::loadFromFile(const std::string& filename) {
-    std::ifstream file(filename);
-    
-    if (!file.is_open()) {
-        std::cerr << "Warning: Could not open file '" << filename << "' for reading!" << std::endl;
-        return 0;
+bool HashTable::saveIfModified(const std::string& filename) const {
+    if (!isModifiedSince(filename)) {
+        std::cout << "'" << filename << "' is up to date" << std::endl;
+        return true;
     }
+    return saveToFile(filename);
+}
 
-    int loaded = 0;
-    std::string line;
-
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-
-        std::stringstream ss(line);
-        std::string username, phone, address;
+/**
+ * @brief Check whether the records changed since the last save to filename
+ * The store's version changes with every insert, removal or load.
+ */
+bool HashTable::isModifiedSince(const std::string& filename) const {
+    return filename != savedFile || store->getVersion() != savedVersion || !FileHandler::fileExists(filename);
+}
 
-        std::getline(ss, username, ',');
-        std::getline(ss, phone, ',');
-        std::getline(ss, address);
+/**
+ * @brief Write this table's slots to a snapshot
+ * A tag in front records the key type.
+ */
+void HashTable::saveIndex(SnapshotWriter& writer) const {
+    writer.writeValue(static_cast<int32_t>(table.index()));
+    std::visit([&](const auto& engine) { engine.saveSlots(writer); }, table);
+}
 
-        // Trim whitespace
-        username.erase(0, username.find_first_not_of(" \t\r\n"));
-        username.erase(username.find_last_not_of(" \t\r\n") + 1);
-        phone.erase(0, phone.find_first_not_of(" \t\r\n"));
-        phone.erase(phone.find_last_not_of(" \t\r\n") + 1);
-        address.erase(0, address.find_first_not_of(" \t\r\n"));
-        address.erase(address.find_last_not_of(" \t\r\n") + 1);
+/**
+ * @brief Restore slots written by saveIndex
+ * Record IDs are checked against the store, so no lookup reads past it.
+ */
+bool HashTable::loadIndex(SnapshotReader& reader) {
+    int32_t keyTag = -1;
+    if (!reader.readValue(keyTag) || keyTag != static_cast<int32_t>(table.index())) {
+        return false;
+    }
+    const RecordStore& records = *store;
+    auto isLive = [&records](uint32_t id) { return records.isLive(id); };
+    return std::visit([&](auto& engine) { return engine.loadSlots(reader, isLive); }, table);
+}
 
-        if (!username.empty() && !phone.empty()) {
-            Record rec(username, phone, address);
-            if (insert(rec)) {
-                loaded++;
-            }
-        }
+/**
+ * @brief Load hash table from file
+ * Format: username,phone,address
+ */
+int HashTable::loadFromFile(const std::string& filename) {
+    MappedRecords mapped;
+    if (!FileHandler::mapRecordsFromFile(filename, mapped)) {
+        std::cerr << "Warning: Could not open file '" << filename << "' for reading!" << std::endl;
+        return 0;
     }
 
-    file.close();
+    int loaded = bulkInsert(mapped.records);
     std::cout << "Loaded " << loaded << " records from '" << filename << "'" << std::endl;
     return loaded;
 }
@@ -300,17 +616,43 @@ int HashTable::loadFromFile(const std::string& filename) {
  * @brief Clear all records
  */
 void HashTable::clear() {
-    for (int i = 0; i < size; i++) {
-        table[i].clear();
-    }
-    count = 0;
+    std::visit([](auto& engine) { engine.clear(); }, table);
+    store->clear();
+}
+
+int HashTable::getCount() const {
+    return std::visit([](const auto& engine) { return engine.getCount(); }, table);
 }
+
+int HashTable::getSize() const {
+    return std::visit([](const auto& engine) { return engine.getSize(); }, table);
+}
+
+int HashTable::getSlotCount() const {
+    return std::visit([](const auto& engine) { return engine.getSlotCount(); }, table);
+}
+
+ProbeStrategy HashTable::getProbeStrategy() const {
+    return std::visit([](const auto& engine) { return engine.getProbeStrategy(); }, table);
+}
+
 /**
  * @brief Get record at specific index (for GUI display)
  */
-const Record* HashTable::getRecordAt(int index) const {
-    if (index >= 0 && index < size) {
-        return &table[index];
+std::optional<RecordView> HashTable::getRecordAt(int index) const {
+    if (index < 0 || index >= getSlotCount()) {
+        return std::nullopt;
     }
-    return nullptr;
+
+    return std::visit([&](const auto& engine) {
+        RecordView slot;
+        if (engine.isOccupied(index)) {
+            slot = store->view(engine.valueAt(index));
+        } else if (engine.isTombstone(index)) {
+            slot.isDeleted = true;
+        } else {
+            slot.isEmpty = true;
+        }
+        return slot;
+    }, table);
 }
\ No newline at end of file
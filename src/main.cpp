@@ -1,4 +1,6 @@
 #include "operations.h"
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 /**
@@ -12,16 +14,24 @@
  * - Dual hash tables (by username and phone number)
  * - File persistence
  * - Complete CRUD operations
+ * - Optional sharded mode: --shards=N serves records from N worker threads
  */
 
-int main() {
+int main(int argc, char* argv[]) {
     try {
-        // Table size should be prime for better distribution
-        // Using 30 for 30 records gives load factor ~1.0
-        const int TABLE_SIZE = 30;
+        int shardCount = 0;
+        for (int i = 1; i < argc; i++) {
+            if (std::strncmp(argv[i], "--shards=", 9) == 0) {
+                shardCount = std::atoi(argv[i] + 9);
+            }
+        }
+        
+        // Initial table size should be prime for better distribution
+        // Tables grow automatically once the load factor passes 0.75
+        const int TABLE_SIZE = 31;
         
         // Create operations manager with dual hash tables
-        Operations ops(TABLE_SIZE);
+        Operations ops(TABLE_SIZE, shardCount);
         
         // Run main program loop
         ops.run();
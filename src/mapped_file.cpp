@@ -0,0 +1,116 @@
+#include "mapped_file.h"
+#include <utility>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Destructor - unmaps the file
+ */
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data(std::exchange(other.data, nullptr)), length(std::exchange(other.length, 0)),
+      opened(std::exchange(other.opened, false)) {
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        data = std::exchange(other.data, nullptr);
+        length = std::exchange(other.length, 0);
+        opened = std::exchange(other.opened, false);
+    }
+    return *this;
+}
+
+/**
+ * @brief Map a file, replacing any current mapping
+ * The handles used to create the mapping are closed straight away; the
+ * mapping keeps the file contents reachable on its own.
+ */
+bool MappedFile::open(const std::string& filename) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+    if (fileSize.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) {
+            CloseHandle(file);
+            return false;
+        }
+        data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping);
+        if (data == nullptr) {
+            CloseHandle(file);
+            return false;
+        }
+        length = static_cast<size_t>(fileSize.QuadPart);
+    }
+    CloseHandle(file);
+#else
+    int file = ::open(filename.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    struct stat status;
+    if (fstat(file, &status) != 0) {
+        ::close(file);
+        return false;
+    }
+    if (status.st_size > 0) {
+        int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        flags |= MAP_POPULATE;  // Map every page up front instead of faulting them in one by one
+#endif
+        void* mapping = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, flags, file, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(file);
+            return false;
+        }
+        madvise(mapping, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+        data = static_cast<const char*>(mapping);
+        length = static_cast<size_t>(status.st_size);
+    }
+    ::close(file);
+#endif
+
+    opened = true;
+    return true;
+}
+
+/**
+ * @brief Unmap the file
+ */
+void MappedFile::close() {
+    if (data != nullptr) {
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+#else
+        munmap(const_cast<char*>(data), length);
+#endif
+    }
+    data = nullptr;
+    length = 0;
+    opened = false;
+}
\ No newline at end of file
@@ -5,14 +5,36 @@
 #include <limits>
 
 /**
- * @brief Constructor - Initialize dual hash tables
+ * @brief Constructor - Initialize the directory and its two indexes
  */
-Operations::Operations(int tableSize)
-    : usernameFile("data/records_username.txt"),
-      phoneFile("data/records_phone.txt") {
+Operations::Operations(int tableSize, int shardCount)
+    : recordFile("data/records.txt"),
+      legacyUsernameFile("data/records_username.txt"),
+      legacyPhoneFile("data/records_phone.txt"),
+      snapshotFile("data/records.snapshot"),
+      logFile("data/records.wal") {
     
-    usernameTable = std::make_unique<HashTable>(tableSize, "username");
-    phoneTable = std::make_unique<HashTable>(tableSize, "phone");
+    directory = std::make_unique<PhoneDirectory>(tableSize);
+    directory->setLookupFilter(BloomFilter::DEFAULT_BITS_PER_KEY);
+    if (shardCount > 0) {
+        sharded = std::make_unique<ShardedDirectory>(shardCount, tableSize);
+    }
+}
+
+/**
+ * @brief Look up a record in the directory or the shards
+ */
+std::optional<Record> Operations::findRecord(const std::string& key, bool byUsername, int& searchLength) {
+    if (sharded) {
+        std::optional<Record> found = byUsername ? sharded->searchByUsername(key) : sharded->searchByPhone(key);
+        searchLength = found ? sharded->getSearchLength(key, byUsername) : -1;
+        return found;
+    }
+
+    std::optional<RecordView> found = byUsername ? directory->searchByUsername(key) : directory->searchByPhone(key);
+    const HashTable& index = byUsername ? directory->getUsernameTable() : directory->getPhoneTable();
+    searchLength = found ? index.getSearchLength(key) : -1;
+    return found ? std::optional<Record>(Record(*found)) : std::nullopt;
 }
 
 /**
@@ -51,31 +73,6 @@ std::string Operations::getStringInput(const std::string& prompt) const {
     return input;
 }
 
-/**
- * @brief Sync record across both hash tables
- */
-bool Operations::syncTables(const Record& record, const std::string& operation) {
-    if (operation == "insert") {
-        bool usernameOk = usernameTable->insert(record);
-        bool phoneOk = phoneTable->insert(record);
-        
-        if (!usernameOk || !phoneOk) {
-            // Rollback if one failed
-            if (usernameOk) usernameTable->remove(record.username);
-            if (phoneOk) phoneTable->remove(record.phoneNumber);
-            return false;
-        }
-        return true;
-    }
-    else if (operation == "delete") {
-        bool usernameOk = usernameTable->remove(record.username);
-        bool phoneOk = phoneTable->remove(record.phoneNumber);
-        return usernameOk || phoneOk;
-    }
-    
-    return false;
-}
-
 /**
  * @brief Insert new record with enhanced UI
  */
@@ -100,13 +97,14 @@ void Operations::insertRecord() {
     
     Record record(username, phone, address);
     
-    if (syncTables(record, "insert")) {
+    bool inserted = sharded ? sharded->insert(record) : directory->insert(record);
+    if (inserted) {
         std::cout << "\n\033[1;32m✓ SUCCESS: Record inserted successfully!\033[0m" << std::endl;
         std::cout << "\033[1;36m  → Username: " << username << "\033[0m" << std::endl;
         std::cout << "\033[1;36m  → Phone: " << phone << "\033[0m" << std::endl;
     } else {
         std::cout << "\n\033[1;31m✗ FAILED: Cannot insert record!\033[0m" << std::endl;
-        std::cout << "\033[1;33m  (Duplicate key or table full)\033[0m" << std::endl;
+        std::cout << "\033[1;33m  (Duplicate key)\033[0m" << std::endl;
     }
 }
 
@@ -124,10 +122,10 @@ void Operations::searchByUsername() {
         return;
     }
     
-    Record* found = usernameTable->search(username);
+    int searchLength = 0;
+    std::optional<Record> found = findRecord(username, true, searchLength);
     
     if (found) {
-        int searchLength = usernameTable->getSearchLength(username);
         std::cout << "\n\033[1;32m✓ RECORD FOUND!\033[0m" << std::endl;
         std::cout << "\033[1;36m┌─────────────────────────────────────────────┐\033[0m\n";
         std::cout << "\033[1;36m│\033[0m \033[1;37mUsername:\033[0m " << std::left << std::setw(32) << found->username << "\033[1;36m│\033[0m\n";
@@ -155,10 +153,10 @@ void Operations::searchByPhone() {
         return;
     }
     
-    Record* found = phoneTable->search(phone);
+    int searchLength = 0;
+    std::optional<Record> found = findRecord(phone, false, searchLength);
     
     if (found) {
-        int searchLength = phoneTable->getSearchLength(phone);
         std::cout << "\n\033[1;32m✓ RECORD FOUND!\033[0m" << std::endl;
         std::cout << "\033[1;36m┌─────────────────────────────────────────────┐\033[0m\n";
         std::cout << "\033[1;36m│\033[0m \033[1;37mUsername:\033[0m " << std::left << std::setw(32) << found->username << "\033[1;36m│\033[0m\n";
@@ -186,16 +184,11 @@ void Operations::deleteByUsername() {
         return;
     }
     
-    // Find the record first to get phone number
-    Record* found = usernameTable->search(username);
-    if (found) {
-        Record record = *found;  // Make a copy
-        if (syncTables(record, "delete")) {
-            std::cout << "\n\033[1;32m✓ SUCCESS: Record deleted!\033[0m" << std::endl;
-            std::cout << "\033[1;33m  → Deleted: " << username << "\033[0m" << std::endl;
-        } else {
-            std::cout << "\n\033[1;31m✗ FAILED: Could not delete record!\033[0m" << std::endl;
-        }
+    // One removal drops the record from both indexes
+    bool removed = sharded ? sharded->removeByUsername(username) : directory->removeByUsername(username);
+    if (removed) {
+        std::cout << "\n\033[1;32m✓ SUCCESS: Record deleted!\033[0m" << std::endl;
+        std::cout << "\033[1;33m  → Deleted: " << username << "\033[0m" << std::endl;
     } else {
         std::cout << "\n\033[1;31m✗ NOT FOUND: No record with username '" << username << "'\033[0m" << std::endl;
     }
@@ -215,16 +208,11 @@ void Operations::deleteByPhone() {
         return;
     }
     
-    // Find the record first to get username
-    Record* found = phoneTable->search(phone);
-    if (found) {
-        Record record = *found;  // Make a copy
-        if (syncTables(record, "delete")) {
-            std::cout << "\n\033[1;32m✓ SUCCESS: Record deleted!\033[0m" << std::endl;
-            std::cout << "\033[1;33m  → Deleted: " << phone << "\033[0m" << std::endl;
-        } else {
-            std::cout << "\n\033[1;31m✗ FAILED: Could not delete record!\033[0m" << std::endl;
-        }
+    // One removal drops the record from both indexes
+    bool removed = sharded ? sharded->removeByPhone(phone) : directory->removeByPhone(phone);
+    if (removed) {
+        std::cout << "\n\033[1;32m✓ SUCCESS: Record deleted!\033[0m" << std::endl;
+        std::cout << "\033[1;33m  → Deleted: " << phone << "\033[0m" << std::endl;
     } else {
         std::cout << "\n\033[1;31m✗ NOT FOUND: No record with phone '" << phone << "'\033[0m" << std::endl;
     }
@@ -237,7 +225,62 @@ void Operations::displayAllRecords() {
     std::cout << "\n\033[1;35m╔═══════════════════════════════════════╗\n";
     std::cout << "║     📋 DISPLAY ALL RECORDS            ║\n";
     std::cout << "╚═══════════════════════════════════════╝\033[0m\n";
-    usernameTable->display();
+    if (sharded) {
+        // Gathered from every shard into one table for the listing
+        std::vector<Record> records = sharded->getRecords();
+        HashTable listing(static_cast<int>(records.size()) + 1, "username");
+        listing.bulkInsert(records);
+        listing.display();
+        return;
+    }
+    directory->getUsernameTable().display();
+}
+
+/**
+ * @brief Print the statistics rows of one index
+ */
+void Operations::printTableStats(const TableStats& stats, const SampledStats& sampled) {
+    std::cout << "\033[1;37m║    • Table Size:         " << std::setw(35) << std::left << stats.size << "║\033[0m\n";
+    std::cout << "\033[1;37m║    • Record Count:       " << std::setw(35) << std::left << stats.count << "║\033[0m\n";
+    std::cout << "\033[1;32m║    • Load Factor:        " << std::fixed << std::setprecision(2)
+              << std::setw(34) << std::left << (std::to_string((int)(stats.loadFactor * 100)) + "%") << "║\033[0m\n";
+    std::cout << "\033[1;33m║    • Avg Search Length:  " << std::fixed << std::setprecision(2)
+              << std::setw(28) << std::left << (std::to_string(stats.averageSearchLength).substr(0,4) + " probes") << "      ║\033[0m\n";
+    std::cout << "\033[1;37m║    • Max Probe Distance: " << std::setw(35) << std::left << stats.maxProbeDistance << "║\033[0m\n";
+    std::cout << "\033[1;37m║    • Tombstones:         " << std::setw(35) << std::left
+              << (std::to_string(stats.tombstones) + " (" + std::to_string(stats.compactions) + " compactions)")
+              << "║\033[0m\n";
+    std::cout << "\033[1;33m║    • Miss Search Length: " << std::setw(28) << std::left
+              << (std::to_string(sampled.missSearchLength).substr(0,4) + " probes") << "       ║\033[0m\n";
+    std::cout << "\033[1;37m║    • Lookup Filter:      " << std::setw(35) << std::left
+              << (stats.filterBits > 0 ? std::to_string(stats.filterBits) + " bits/rec, " +
+                                             std::to_string(stats.filterBytes / 1024) + " KB, " +
+                                             std::to_string(sampled.filterFalsePositiveRate * 100).substr(0, 4) + "% FP"
+                                       : std::string("off"))
+              << "║\033[0m\n";
+
+    // Lookups by probe count: 1, 2, 3, 4 and 5 or more
+    std::vector<double> shares = stats.probeLengthShares(5);
+    std::string lengths;
+    for (size_t i = 0; i < shares.size(); i++) {
+        lengths += std::to_string(i + 1) + (i + 1 == shares.size() ? "+:" : ":") +
+                   std::to_string(static_cast<int>(shares[i] * 100 + 0.5)) + "% ";
+    }
+    std::cout << "\033[1;37m║    • Probe Lengths:      " << std::setw(35) << std::left << lengths << "║\033[0m\n";
+}
+
+/**
+ * @brief Print count, load factor and average search length of every shard
+ */
+void Operations::printShardRows(const std::vector<TableStats>& shards) {
+    for (size_t i = 0; i < shards.size(); i++) {
+        std::cout << "\033[1;37m║      - " << std::setw(18) << std::left << ("Shard " + std::to_string(i) + ":")
+                  << std::setw(35) << std::left
+                  << (std::to_string(shards[i].count) + " recs, " +
+                      std::to_string((int)(shards[i].loadFactor * 100)) + "%, " +
+                      std::to_string(shards[i].averageSearchLength).substr(0, 4) + " probes")
+                  << "║\033[0m\n";
+    }
 }
 
 /**
@@ -248,22 +291,42 @@ void Operations::displayStatistics() {
     std::cout << "║              📊 HASH TABLE STATISTICS                         ║\n";
     std::cout << "╠════════════════════════════════════════════════════════════════╣\033[0m\n";
     
+    if (sharded) {
+        // Shard totals in the same rows as one table, then each shard
+        std::vector<TableStats> usernames;
+        std::vector<TableStats> phones;
+        std::vector<SampledStats> usernamesSampled;
+        std::vector<SampledStats> phonesSampled;
+        for (const ShardStats& shard : sharded->getShardStats(true)) {
+            usernames.push_back(shard.username);
+            phones.push_back(shard.phone);
+            usernamesSampled.push_back(shard.usernameSampled);
+            phonesSampled.push_back(shard.phoneSampled);
+        }
+        std::cout << "\033[1;36m║  📌 USERNAME HASH TABLES (" << std::setw(2) << std::right << usernames.size()
+                  << " shards)                           ║\033[0m\n";
+        printTableStats(ShardedDirectory::combine(usernames), ShardedDirectory::combine(usernamesSampled));
+        printShardRows(usernames);
+        std::cout << "\033[1;36m║                                                                ║\n";
+        std::cout << "║  📌 PHONE NUMBER HASH TABLES (" << std::setw(2) << std::right << phones.size()
+                  << " shards)                       ║\033[0m\n";
+        printTableStats(ShardedDirectory::combine(phones), ShardedDirectory::combine(phonesSampled));
+        printShardRows(phones);
+        std::cout << "\033[1;33m╚════════════════════════════════════════════════════════════════╝\033[0m\n";
+        return;
+    }
+    
     std::cout << "\033[1;36m║  📌 USERNAME HASH TABLE                                        ║\033[0m\n";
-    std::cout << "\033[1;37m║    • Table Size:         " << std::setw(35) << std::left << usernameTable->getSize() << "║\033[0m\n";
-    std::cout << "\033[1;37m║    • Record Count:       " << std::setw(35) << std::left << usernameTable->getCount() << "║\033[0m\n";
-    std::cout << "\033[1;32m║    • Load Factor:        " << std::fixed << std::setprecision(2) 
-              << std::setw(34) << std::left << (std::to_string((int)(usernameTable->getLoadFactor() * 100)) + "%") << "║\033[0m\n";
-    std::cout << "\033[1;33m║    • Avg Search Length:  " << std::fixed << std::setprecision(2)
-              << std::setw(28) << std::left << (std::to_string(usernameTable->getAverageSearchLength()).substr(0,4) + " probes") << "      ║\033[0m\n";
+    printTableStats(directory->getUsernameTable().getStats(), directory->getUsernameTable().getSampledStats());
     
     std::cout << "\033[1;36m║                                                                ║\n";
     std::cout << "║  📌 PHONE NUMBER HASH TABLE                                    ║\033[0m\n";
-    std::cout << "\033[1;37m║    • Table Size:         " << std::setw(35) << std::left << phoneTable->getSize() << "║\033[0m\n";
-    std::cout << "\033[1;37m║    • Record Count:       " << std::setw(35) << std::left << phoneTable->getCount() << "║\033[0m\n";
-    std::cout << "\033[1;32m║    • Load Factor:        " << std::fixed << std::setprecision(2)
-              << std::setw(34) << std::left << (std::to_string((int)(phoneTable->getLoadFactor() * 100)) + "%") << "║\033[0m\n";
-    std::cout << "\033[1;33m║    • Avg Search Length:  " << std::fixed << std::setprecision(2)
-              << std::setw(28) << std::left << (std::to_string(phoneTable->getAverageSearchLength()).substr(0,4) + " probes") << "      ║\033[0m\n";
+    printTableStats(directory->getPhoneTable().getStats(), directory->getPhoneTable().getSampledStats());
+    
+    ConsistencyReport consistency = directory->checkConsistency();
+    std::cout << "\033[1;36m║                                                                ║\033[0m\n";
+    std::cout << "\033[1;37m║    • Indexes Consistent: " << std::setw(35) << std::left
+              << (consistency.isConsistent() ? "Yes" : "NO") << "║\033[0m\n";
     
     std::cout << "\033[1;33m╚════════════════════════════════════════════════════════════════╝\033[0m\n";
 }
@@ -273,9 +336,27 @@ void Operations::displayStatistics() {
  */
 void Operations::saveToFiles() {
     std::cout << "\n\033[1;36m💾 Saving Data...\033[0m" << std::endl;
-    usernameTable->saveToFile(usernameFile);
-    phoneTable->saveToFile(phoneFile);
-    std::cout << "\033[1;32m✓ Data saved successfully!\033[0m" << std::endl;
+    bool saved;
+    if (sharded) {
+        // The shards hold every change since loading, so the file is always rewritten
+        std::vector<Record> records = sharded->getRecords();
+        saved = FileHandler::writeRecordsToFile(records, recordFile);
+        if (sharded->getLog()) {
+            sharded->checkpoint();
+        } else {
+            // Without a log the snapshot still has to keep up with the record file
+            saved = writeShardCheckpoint(records, directory->getLogSequence()) && saved;
+        }
+    } else {
+        // An unchanged file is not rewritten; a write replaces the file atomically
+        saved = directory->getUsernameTable().saveIfModified(recordFile);
+        directory->checkpoint();
+    }
+    if (saved) {
+        std::cout << "\033[1;32m✓ Data saved successfully!\033[0m" << std::endl;
+    } else {
+        std::cout << "\033[1;31m✗ Save failed, previous files kept!\033[0m" << std::endl;
+    }
 }
 
 /**
@@ -285,27 +366,105 @@ void Operations::loadFromFiles() {
     std::cout << "\n\033[1;36m📂 Loading Data...\033[0m" << std::endl;
     
     // Clear existing data
-    usernameTable->clear();
-    phoneTable->clear();
+    directory->clear();
+    if (sharded) {
+        sharded->clear();
+    }
     
-    int loaded = usernameTable->loadFromFile(usernameFile);
-    phoneTable->loadFromFile(phoneFile);
+    int loaded = loadRecordFile();
+    if (sharded) {
+        // Loaded records are not logged one by one but checkpointed
+        shardRecords();
+        sharded->checkpoint();
+    }
     
-    std::cout << "\033[1;32m✓ Data loaded successfully!\033[0m" << std::endl;
+    std::cout << "\033[1;32m✓ Data loaded successfully! (" << loaded << " records)\033[0m" << std::endl;
+}
+
+/**
+ * @brief Load the record file, or migrate a legacy two-file dataset
+ * Both indexes are built from the one file. A legacy dataset is checked
+ * for drift between its files and rewritten as the record file at once.
+ */
+int Operations::loadRecordFile() {
+    if (FileHandler::fileExists(recordFile)) {
+        return directory->loadFromFile(recordFile);
+    }
+    if (!FileHandler::fileExists(legacyUsernameFile) && !FileHandler::fileExists(legacyPhoneFile)) {
+        return 0;
+    }
+
+    DriftReport drift;
+    int loaded = directory->loadLegacyFiles(legacyUsernameFile, legacyPhoneFile, drift);  // Reports any drift
+    if (directory->getUsernameTable().saveToFile(recordFile)) {
+        std::cout << "\033[1;36m→ Migrated to " << recordFile << "\033[0m" << std::endl;
+    }
+    return loaded;
 }
 
 /**
  * @brief Load data at startup
  */
 void Operations::loadData() {
-    if (FileHandler::fileExists(usernameFile)) {
-        usernameTable->loadFromFile(usernameFile);
+    // The checkpoint is at least as new as the record file
+    if (FileHandler::fileExists(snapshotFile)) {
+        directory->loadFromFile(snapshotFile);
+    } else {
+        loadRecordFile();
+    }
+
+    // Changes made since the last checkpoint
+    if (directory->openLog(logFile, snapshotFile) < 0) {
+        std::cout << "\033[1;31m✗ Warning: could not open the change log; changes are saved only by [8] and on exit\033[0m" << std::endl;
     }
-    if (FileHandler::fileExists(phoneFile)) {
-        phoneTable->loadFromFile(phoneFile);
+
+    if (sharded) {
+        // The shards append to the same log, numbered after the replayed changes
+        bool logged = directory->getLog() != nullptr;
+        directory->closeLog();
+        shardRecords();
+        if (logged) {
+            auto writer = [this](const std::vector<Record>& records, uint64_t logSequence) {
+                return writeShardCheckpoint(records, logSequence);
+            };
+            if (sharded->openLog(logFile, directory->getLogSequence(), writer) < 0) {
+                std::cout << "\033[1;31m✗ Warning: could not open the change log; changes are saved only by [8] and on exit\033[0m" << std::endl;
+            }
+        }
+        std::cout << "\033[1;36m→ Serving from " << sharded->getShardCount() << " shards\033[0m" << std::endl;
     }
 }
 
+/**
+ * @brief Move the records loaded into the directory to the shards
+ * The directory is emptied afterwards, so each record is held once.
+ */
+void Operations::shardRecords() {
+    const HashTable& usernames = directory->getUsernameTable();
+    std::vector<Record> records;
+    records.reserve(usernames.getCount());
+    for (int i = 0; i < usernames.getSlotCount(); i++) {
+        std::optional<RecordView> record = usernames.getRecordAt(i);
+        if (record && !record->isEmpty && !record->isDeleted) {
+            records.push_back(Record(*record));
+        }
+    }
+    directory->clear();
+    sharded->insertAll(records);
+}
+
+/**
+ * @brief Write the shards' records as the checkpoint snapshot
+ */
+bool Operations::writeShardCheckpoint(const std::vector<Record>& records, uint64_t logSequence) {
+    directory->clear();
+    directory->bulkInsert(records);
+    directory->setLogSequence(logSequence);
+    bool saved = directory->saveSnapshot(snapshotFile);
+    directory->clear();
+    return saved;
+}
+
 /**
  * @brief Save data before exit
  */
@@ -405,4 +564,4 @@ void Operations::run() {
     std::cout << "║                       Goodbye! 👋                             ║\n";
     std::cout << "║                                                               ║\n";
     std::cout << "╚═══════════════════════════════════════════════════════════════╝\033[0m\n\n";
-}
+}
\ No newline at end of file
@@ -0,0 +1,596 @@
+#include "phone_directory.h"
+#include "file_handler.h"
+#include "atomic_file.h"
+#include "mapped_file.h"
+#include "snapshot.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+/**
+ * @brief Constructor - Initialize both tables over one record store
+ */
+PhoneDirectory::PhoneDirectory(int tableSize, double maxLoad,
+                               HashAlgorithm hashAlgorithm, ProbeStrategy probeStrategy)
+    : store(std::make_shared<RecordStore>()),
+      usernameTable(store, tableSize, "username", maxLoad, hashAlgorithm, probeStrategy),
+      phoneTable(store, tableSize, "phone", maxLoad, hashAlgorithm, probeStrategy) {
+}
+
+/**
+ * @brief Insert a record into both tables
+ * Both tables reserve room for their key before the record is stored and
+ * nothing is linked until every step that can fail has succeeded, so a
+ * rejected or failed insert leaves the directory unchanged.
+ */
+bool PhoneDirectory::insert(const Record& record) {
+    if (record.username.empty() || record.phoneNumber.empty()) {
+        std::cerr << "Error: Key cannot be empty!" << std::endl;
+        return false;
+    }
+
+    if (!usernameTable.prepareLink(record.username)) {
+        std::cerr << "Error: Record with key '" << record.username << "' already exists!" << std::endl;
+        return false;
+    }
+    if (!phoneTable.prepareLink(record.phoneNumber)) {
+        std::cerr << "Error: Record with key '" << record.phoneNumber << "' already exists!" << std::endl;
+        return false;
+    }
+
+    uint32_t id = store->add(record);
+    usernameTable.commitLink(id);
+    phoneTable.commitLink(id);
+    logChange(LogOperation::Insert, record.username, record.phoneNumber, record.address);
+    return true;
+}
+
+/**
+ * @brief Put a Bloom filter in front of both tables
+ */
+void PhoneDirectory::setLookupFilter(int bitsPerRecord) {
+    usernameTable.setFilterBits(bitsPerRecord);
+    phoneTable.setFilterBits(bitsPerRecord);
+}
+
+/**
+ * @brief Search by username
+ */
+std::optional<RecordView> PhoneDirectory::searchByUsername(std::string_view username) {
+    return usernameTable.search(username);
+}
+
+/**
+ * @brief Search by phone number
+ */
+std::optional<RecordView> PhoneDirectory::searchByPhone(std::string_view phone) {
+    return phoneTable.search(phone);
+}
+
+/**
+ * @brief Delete the record with a username from both tables
+ */
+bool PhoneDirectory::removeByUsername(std::string_view username) {
+    uint32_t id = usernameTable.findId(username);
+    if (id == RecordStore::NO_RECORD) {
+        return false;
+    }
+
+    return erase(id);
+}
+
+/**
+ * @brief Delete the record with a phone number from both tables
+ */
+bool PhoneDirectory::removeByPhone(std::string_view phone) {
+    uint32_t id = phoneTable.findId(phone);
+    if (id == RecordStore::NO_RECORD) {
+        return false;
+    }
+
+    return erase(id);
+}
+
+/**
+ * @brief Unlink a record from both tables and drop it from the store
+ * Both slots are located before either is touched; if the tables do not
+ * both map the record's keys to it, nothing is changed.
+ */
+bool PhoneDirectory::erase(uint32_t id) {
+    RecordView record = store->view(id);
+    int usernameSlot = usernameTable.findSlot(record.username);
+    int phoneSlot = phoneTable.findSlot(record.phoneNumber);
+
+    if (usernameSlot == -1 || phoneSlot == -1 ||
+        usernameTable.getIdAt(usernameSlot) != id || phoneTable.getIdAt(phoneSlot) != id) {
+        std::cerr << "Error: Indexes disagree on record '" << record.username << "', not deleted!" << std::endl;
+        return false;
+    }
+
+    // Removing may compact the store's strings, so the logged key is copied first
+    std::string username = log ? std::string(record.username) : std::string();
+
+    // Erasing never allocates and one table's slots do not move when the other changes
+    usernameTable.unlinkAt(usernameSlot);
+    phoneTable.unlinkAt(phoneSlot);
+    store->remove(id);
+    logChange(LogOperation::Remove, username);
+    return true;
+}
+
+/**
+ * @brief Insert many records into both tables, as when loading a file
+ * Every record is stored first; the store is then only read while the
+ * username table is built on a second thread and the phone table on this
+ * one. Each table's placement probe doubles as its duplicate check. A
+ * record that only one table accepted is unlinked from it afterwards and
+ * retried once the batch is built, so the outcome matches inserting the
+ * records one by one; the tables are compacted if any was unlinked.
+ */
+template <class Records>
+int PhoneDirectory::bulkInsertOf(const Records& records) {
+    const size_t MIN_PARALLEL = 1 << 14;  // Smaller batches are built on this thread alone
+    int total = getCount() + static_cast<int>(records.size());
+    usernameTable.reserve(total);
+    phoneTable.reserve(total);
+    std::vector<uint64_t> usernameHashes = usernameTable.hashKeys(records);
+    std::vector<uint64_t> phoneHashes = phoneTable.hashKeys(records);
+
+    std::vector<uint32_t> ids(records.size(), uint32_t(RecordStore::NO_RECORD));
+    try {
+        for (size_t i = 0; i < records.size(); i++) {
+            const auto& record = records[i];
+            if (record.username.empty() || record.phoneNumber.empty()) {
+                std::cerr << "Error: Key cannot be empty!" << std::endl;
+                continue;
+            }
+            ids[i] = store->add(record.username, record.phoneNumber, record.address);
+        }
+    } catch (...) {
+        for (uint32_t id : ids) {
+            if (id != RecordStore::NO_RECORD) {
+                store->remove(id);
+            }
+        }
+        throw;
+    }
+
+    std::vector<bool> usernameLinked(records.size(), false);
+    std::vector<bool> phoneLinked(records.size(), false);
+    auto build = [&ids](HashTable& table, const std::vector<uint64_t>& hashes, std::vector<bool>& linked) {
+        for (size_t i = 0; i < ids.size(); i++) {
+            if (ids[i] != RecordStore::NO_RECORD) {
+                linked[i] = table.linkHashed(ids[i], hashes[i]) != -1;
+            }
+        }
+    };
+    if (records.size() >= MIN_PARALLEL && std::thread::hardware_concurrency() > 1) {
+        std::thread usernameBuilder(build, std::ref(usernameTable), std::cref(usernameHashes),
+                                    std::ref(usernameLinked));
+        build(phoneTable, phoneHashes, phoneLinked);
+        usernameBuilder.join();
+    } else {
+        build(usernameTable, usernameHashes, usernameLinked);
+        build(phoneTable, phoneHashes, phoneLinked);
+    }
+
+    // A record both tables accepted is one sequential inserts accept too;
+    // the rest are first unlinked from the table that took them
+    std::vector<size_t> rejected;
+    for (size_t i = 0; i < records.size(); i++) {
+        if (ids[i] == RecordStore::NO_RECORD || (usernameLinked[i] && phoneLinked[i])) {
+            continue;
+        }
+        if (usernameLinked[i]) {
+            usernameTable.unlinkAt(usernameTable.findSlot(records[i].username));
+        } else if (phoneLinked[i]) {
+            phoneTable.unlinkAt(phoneTable.findSlot(records[i].phoneNumber));
+        }
+        rejected.push_back(i);
+    }
+
+    // Then retried in order, checking both keys before linking either: a
+    // key may have been held only by a record rolled back above
+    int inserted = static_cast<int>(records.size() - std::count(ids.begin(), ids.end(),
+                                                                 uint32_t(RecordStore::NO_RECORD)));
+    for (size_t i : rejected) {
+        const auto& record = records[i];
+        bool usernameTaken = usernameTable.findSlot(record.username) != -1;
+        if (!usernameTaken && phoneTable.findSlot(record.phoneNumber) == -1) {
+            usernameTable.linkHashed(ids[i], usernameHashes[i]);
+            phoneTable.linkHashed(ids[i], phoneHashes[i]);
+            continue;
+        }
+        store->remove(ids[i]);
+        inserted--;
+        std::cerr << "Error: Record with key '" << (usernameTaken ? record.username : record.phoneNumber)
+                  << "' already exists!" << std::endl;
+    }
+
+    // The unlinks left tombstones behind; a load leaves none
+    if (!rejected.empty()) {
+        usernameTable.compact();
+        phoneTable.compact();
+    }
+    return inserted;
+}
+
+int PhoneDirectory::bulkInsert(const std::vector<Record>& records) {
+    int inserted = bulkInsertOf(records);
+    if (log && inserted > 0) {
+        checkpoint();
+    }
+    return inserted;
+}
+
+int PhoneDirectory::bulkInsert(const std::vector<RecordView>& records) {
+    int inserted = bulkInsertOf(records);
+    if (log && inserted > 0) {
+        checkpoint();
+    }
+    return inserted;
+}
+
+/**
+ * @brief Load records from file into both tables
+ */
+int PhoneDirectory::loadFromFile(const std::string& filename) {
+    MappedFile file;
+    if (file.open(filename) && SnapshotHeader::matches(file.text())) {
+        file.close();
+        if (getCount() == 0) {
+            return loadSnapshot(filename) ? getCount() : 0;
+        }
+
+        // Records already present: merge the snapshot's records in
+        PhoneDirectory snapshot(1, usernameTable.getMaxLoadFactor(), usernameTable.getHashAlgorithm(),
+                                usernameTable.getProbeStrategy());
+        if (!snapshot.loadSnapshot(filename)) {
+            return 0;
+        }
+        std::vector<RecordView> records;
+        records.reserve(snapshot.getCount());
+        for (int i = 0; i < snapshot.usernameTable.getSlotCount(); i++) {
+            uint32_t id = snapshot.usernameTable.getIdAt(i);
+            if (id != RecordStore::NO_RECORD) {
+                records.push_back(snapshot.store->view(id));
+            }
+        }
+        int loaded = bulkInsert(records);
+        std::cout << "Loaded " << loaded << " records from '" << filename << "'" << std::endl;
+        return loaded;
+    }
+
+    MappedRecords mapped;
+    if (!FileHandler::mapRecordsFromFile(filename, mapped)) {
+        std::cerr << "Warning: Could not open file '" << filename << "' for reading!" << std::endl;
+        return 0;
+    }
+
+    int loaded = bulkInsert(mapped.records);
+
+    std::cout << "Loaded " << loaded << " records from '" << filename << "'" << std::endl;
+    return loaded;
+}
+
+/**
+ * @brief Load a legacy dataset saved as a username file and a phone file
+ * Both files are mapped and parsed once; the phone file's records are
+ * looked up by both keys instead of being inserted, so records the files
+ * agree on are not reported as duplicates.
+ */
+int PhoneDirectory::loadLegacyFiles(const std::string& usernameFile, const std::string& phoneFile,
+                                    DriftReport& drift) {
+    drift = DriftReport();
+    MappedRecords usernameRecords;
+    MappedRecords phoneRecords;
+    bool haveUsernameFile = FileHandler::mapRecordsFromFile(usernameFile, usernameRecords);
+    bool havePhoneFile = FileHandler::mapRecordsFromFile(phoneFile, phoneRecords);
+    if (!haveUsernameFile && !havePhoneFile) {
+        std::cerr << "Warning: Could not open '" << usernameFile << "' or '" << phoneFile << "'!" << std::endl;
+        return 0;
+    }
+    drift.usernameFileRecords = static_cast<int>(usernameRecords.records.size());
+    drift.phoneFileRecords = static_cast<int>(phoneRecords.records.size());
+
+    int loaded = bulkInsert(usernameRecords.records);
+    if (!haveUsernameFile || !havePhoneFile) {
+        loaded += bulkInsert(phoneRecords.records);
+        std::cout << "Loaded " << loaded << " records from '" << (haveUsernameFile ? usernameFile : phoneFile)
+                  << "'" << std::endl;
+        return loaded;
+    }
+
+    std::vector<bool> claimed(usernameTable.getSlotCount(), false);  // Slots a phone file record matched
+    std::vector<RecordView> phoneOnly;
+    for (const RecordView& record : phoneRecords.records) {
+        int usernameSlot = usernameTable.findSlot(record.username);
+        uint32_t byUsername = usernameSlot == -1 ? RecordStore::NO_RECORD : usernameTable.getIdAt(usernameSlot);
+        uint32_t byPhone = phoneTable.findId(record.phoneNumber);
+        if (byUsername == RecordStore::NO_RECORD && byPhone == RecordStore::NO_RECORD) {
+            drift.onlyInPhoneFile++;
+            phoneOnly.push_back(record);
+            continue;
+        }
+
+        RecordView stored = store->view(byUsername != RecordStore::NO_RECORD ? byUsername : byPhone);
+        if (byUsername == byPhone && stored.address == record.address) {
+            drift.matching++;
+        } else {
+            drift.conflicting++;
+        }
+        if (usernameSlot != -1) {
+            claimed[usernameSlot] = true;
+        } else {
+            claimed[usernameTable.findSlot(stored.username)] = true;
+        }
+    }
+    int unclaimed = 0;
+    for (int i = 0; i < usernameTable.getSlotCount(); i++) {
+        if (!claimed[i] && usernameTable.getIdAt(i) != RecordStore::NO_RECORD) {
+            unclaimed++;
+        }
+    }
+    drift.onlyInUsernameFile = unclaimed;
+    loaded += bulkInsert(phoneOnly);
+
+    if (drift.hasDrift()) {
+        std::cerr << "Warning: '" << usernameFile << "' and '" << phoneFile << "' have drifted apart: "
+                  << drift.conflicting << " conflicting, " << drift.onlyInUsernameFile << " only in the first, "
+                  << drift.onlyInPhoneFile << " only in the second (the first file wins conflicts)" << std::endl;
+    }
+    std::cout << "Loaded " << loaded << " records from '" << usernameFile << "' and '" << phoneFile << "'"
+              << std::endl;
+    return loaded;
+}
+
+/**
+ * @brief Save the store and both indexes as a binary snapshot
+ */
+bool PhoneDirectory::saveSnapshot(const std::string& filename) const {
+    if (!writeSnapshot(filename)) {
+        return false;
+    }
+    std::cout << "Saved " << getCount() << " records to snapshot '" << filename << "'" << std::endl;
+    return true;
+}
+
+/**
+ * @brief Write a snapshot without reporting success
+ * The header is written last, once the checksum of the payload is known.
+ */
+bool PhoneDirectory::writeSnapshot(const std::string& filename) const {
+    AtomicFile output(filename);
+    if (!output.isOpen()) {
+        std::cerr << "Error: Could not open file '" << filename << "' for writing!" << std::endl;
+        return false;
+    }
+
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, SnapshotHeader::MAGIC, sizeof(header.magic));
+    header.version = SnapshotHeader::VERSION;
+    header.hashAlgorithm = static_cast<uint32_t>(usernameTable.getHashAlgorithm());
+    header.hashSeed = HashFunction::SEED;
+    header.probeStrategy = static_cast<uint32_t>(usernameTable.getProbeStrategy());
+    header.tableCount = 2;
+    header.recordCount = static_cast<uint64_t>(store->getCount());
+    header.logSequence = logSequence;
+    std::ofstream& file = output.stream();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    SnapshotWriter writer(file);
+    store->save(writer);
+    usernameTable.saveIndex(writer);
+    phoneTable.saveIndex(writer);
+    header.checksum = writer.finish();
+    header.payloadBytes = writer.getBytesWritten();
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!output.commit()) {
+        std::cerr << "Error: Could not write snapshot '" << filename << "'!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Replace all records with a snapshot written by saveSnapshot
+ * Everything is restored into a scratch directory first and swapped in
+ * only once the whole payload has been read, so a bad file changes nothing.
+ */
+bool PhoneDirectory::loadSnapshot(const std::string& filename) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Warning: Could not open file '" << filename << "' for reading!" << std::endl;
+        return false;
+    }
+    std::string_view bytes = file.text();
+    if (!SnapshotHeader::matches(bytes)) {
+        std::cerr << "Error: '" << filename << "' is not a snapshot!" << std::endl;
+        return false;
+    }
+
+    SnapshotHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    std::string_view payload = bytes.substr(sizeof(header));
+    if (header.version != SnapshotHeader::VERSION || header.payloadBytes != payload.size() ||
+        header.checksum != SnapshotHeader::checksumOf(payload)) {
+        std::cerr << "Error: Snapshot '" << filename << "' is damaged or of another version!" << std::endl;
+        return false;
+    }
+    if (header.hashAlgorithm != static_cast<uint32_t>(usernameTable.getHashAlgorithm()) ||
+        header.hashSeed != HashFunction::SEED ||
+        header.probeStrategy != static_cast<uint32_t>(usernameTable.getProbeStrategy()) ||
+        header.tableCount != 2) {
+        std::cerr << "Error: Snapshot '" << filename << "' was written with another hash function, "
+                  << "seed or probe strategy!" << std::endl;
+        return false;
+    }
+
+    PhoneDirectory loaded(1, usernameTable.getMaxLoadFactor(), usernameTable.getHashAlgorithm(),
+                          usernameTable.getProbeStrategy());
+    SnapshotReader reader(payload);
+    if (!loaded.store->load(reader) || !loaded.usernameTable.loadIndex(reader) ||
+        !loaded.phoneTable.loadIndex(reader) || !reader.atEnd() ||
+        static_cast<uint64_t>(loaded.getCount()) != header.recordCount) {
+        std::cerr << "Error: Snapshot '" << filename << "' is malformed!" << std::endl;
+        return false;
+    }
+
+    // The snapshot's filters are kept unless this directory is set up differently
+    int usernameFilterBits = usernameTable.getFilterBits();
+    int phoneFilterBits = phoneTable.getFilterBits();
+    store.swap(loaded.store);
+    usernameTable.swap(loaded.usernameTable);
+    phoneTable.swap(loaded.phoneTable);
+    if (usernameTable.getFilterBits() != usernameFilterBits) {
+        usernameTable.setFilterBits(usernameFilterBits);
+    }
+    if (phoneTable.getFilterBits() != phoneFilterBits) {
+        phoneTable.setFilterBits(phoneFilterBits);
+    }
+    std::cout << "Loaded " << getCount() << " records from snapshot '" << filename << "'" << std::endl;
+
+    // An open log continues its own numbering and is restarted from this state
+    if (log) {
+        logSequence = std::max(logSequence, header.logSequence);
+        file.close();  // The checkpoint may replace this very file
+        checkpoint();
+    } else {
+        logSequence = header.logSequence;
+    }
+    return true;
+}
+
+/**
+ * @brief Clear all records
+ */
+void PhoneDirectory::clear() {
+    usernameTable.clear();
+    phoneTable.clear();
+    logChange(LogOperation::Clear);
+}
+
+/**
+ * @brief Replay a write-ahead log and log every later change to it
+ * Replayed changes go through the ordinary operations while no log is
+ * attached, so they are not logged a second time.
+ */
+int PhoneDirectory::openLog(const std::string& logFile, const std::string& snapshotFile,
+                            const LogOptions& options) {
+    closeLog();
+
+    std::unique_ptr<WriteAheadLog> opened = std::make_unique<WriteAheadLog>();
+    int replayed = opened->open(logFile, options, [this](const LogEntry& entry) {
+        if (entry.sequence <= logSequence) {
+            return;  // Already in the snapshot: the log outlived a checkpoint's rename
+        }
+        switch (entry.operation) {
+            case LogOperation::Insert:
+                insert(Record(std::string(entry.fields[0]), std::string(entry.fields[1]),
+                              std::string(entry.fields[2])));
+                break;
+            case LogOperation::Remove:
+                removeByUsername(entry.fields[0]);
+                break;
+            case LogOperation::Clear:
+                clear();
+                break;
+        }
+        logSequence = entry.sequence;
+    });
+    if (replayed < 0) {
+        return -1;
+    }
+
+    log = std::move(opened);
+    checkpointFile = snapshotFile;
+    if (replayed > 0) {
+        std::cout << "Replayed " << replayed << " changes from log '" << logFile << "'" << std::endl;
+    }
+    return replayed;
+}
+
+/**
+ * @brief Save a snapshot and empty the log
+ * Entries still buffered in the log are dropped with it: the snapshot
+ * already holds their changes.
+ */
+bool PhoneDirectory::checkpoint() {
+    if (!log) {
+        return false;
+    }
+    if (!writeSnapshot(checkpointFile)) {
+        std::cerr << "Error: Could not checkpoint into '" << checkpointFile << "'!" << std::endl;
+        return false;
+    }
+    return log->truncate();
+}
+
+/**
+ * @brief Commit pending log entries and stop logging
+ */
+void PhoneDirectory::closeLog() {
+    log.reset();
+}
+
+/**
+ * @brief Append a change to the log, if one is open
+ */
+void PhoneDirectory::logChange(LogOperation operation, std::string_view first,
+                               std::string_view second, std::string_view third) {
+    if (!log) {
+        return;
+    }
+    log->append(++logSequence, operation, first, second, third);
+    if (log->getBytes() >= log->getOptions().checkpointBytes) {
+        checkpoint();
+    }
+}
+
+/**
+ * @brief Check that every entry of one table is live and found by both tables
+ */
+static int checkIndex(const RecordStore& store, const HashTable& index, const HashTable& other,
+                      bool byUsername, ConsistencyReport& report) {
+    int entries = 0;
+    for (int i = 0; i < index.getSlotCount(); i++) {
+        uint32_t id = index.getIdAt(i);
+        if (id == RecordStore::NO_RECORD) {
+            continue;
+        }
+        entries++;
+
+        if (!store.isLive(id)) {
+            report.dangling++;
+            continue;
+        }
+
+        RecordView record = store.view(id);
+        std::string_view ownKey = byUsername ? record.username : record.phoneNumber;
+        std::string_view otherKey = byUsername ? record.phoneNumber : record.username;
+        if (index.findId(ownKey) != id) {
+            report.unreachable++;
+        }
+        if (other.findId(otherKey) != id) {
+            report.unmatched++;
+        }
+    }
+    return entries;
+}
+
+/**
+ * @brief Verify that two tables over a store index exactly its records
+ */
+ConsistencyReport PhoneDirectory::checkIndexes(const RecordStore& store, const HashTable& usernames,
+                                               const HashTable& phones) {
+    ConsistencyReport report;
+    report.records = store.getCount();
+    report.usernameEntries = checkIndex(store, usernames, phones, true, report);
+    report.phoneEntries = checkIndex(store, phones, usernames, false, report);
+    return report;
+}
\ No newline at end of file
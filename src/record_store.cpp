@@ -0,0 +1,179 @@
+#include "record_store.h"
+#include <atomic>
+#include <stdexcept>
+
+/**
+ * @brief Next version stamp; shared by all stores so stamps never repeat
+ */
+uint64_t RecordStore::nextVersion() {
+    static std::atomic<uint64_t> counter{0};
+    return ++counter;
+}
+
+/**
+ * @brief Store a record
+ * Room for a new ID is reserved before any field is copied and the ID is
+ * claimed only once every copy succeeded, so a failure adds no record.
+ */
+uint32_t RecordStore::add(std::string_view username, std::string_view phoneNumber, std::string_view address) {
+    if (freeHead == NO_RECORD) {
+        if (records.size() >= NO_RECORD) {
+            throw std::length_error("RecordStore: record ID space exhausted");
+        }
+        if (records.size() == records.capacity()) {
+            records.reserve(records.size() * 2 + 1);
+        }
+    }
+
+    PackedRecord packed;
+    try {
+        packed.username = strings.append(username);
+        packed.phoneNumber = strings.append(phoneNumber);
+        packed.address = strings.append(address);
+    } catch (...) {
+        strings.release(packed.username);
+        strings.release(packed.phoneNumber);
+        throw;
+    }
+
+    uint32_t id;
+    if (freeHead != NO_RECORD) {
+        id = freeHead;
+        freeHead = records[id].username.offset;
+        records[id] = packed;
+    } else {
+        id = static_cast<uint32_t>(records.size());
+        records.push_back(packed);  // Capacity reserved above
+    }
+
+    count++;
+    version = nextVersion();
+    return id;
+}
+
+/**
+ * @brief Remove a record; its ID may be reused
+ * The freed slot is marked with FREE_LENGTH and links to the previous
+ * free ID through its username offset, so removing never allocates.
+ */
+void RecordStore::remove(uint32_t id) {
+    PackedRecord& packed = records[id];
+    strings.release(packed.username);
+    strings.release(packed.phoneNumber);
+    strings.release(packed.address);
+    packed = PackedRecord();
+    packed.username.offset = freeHead;
+    packed.username.length = FREE_LENGTH;
+    freeHead = id;
+    count--;
+    version = nextVersion();
+
+    if (strings.shouldCompact()) {
+        try {
+            compactStrings();
+        } catch (const std::bad_alloc&) {
+            // Compaction only reclaims space; the current arena stays valid
+        }
+    }
+}
+
+/**
+ * @brief Check whether an ID refers to a stored record
+ */
+bool RecordStore::isLive(uint32_t id) const {
+    return id < records.size() && records[id].username.length != FREE_LENGTH;
+}
+
+/**
+ * @brief Remove every record and free their storage
+ */
+void RecordStore::clear() {
+    strings.clear();
+    std::vector<PackedRecord>().swap(records);
+    freeHead = NO_RECORD;
+    count = 0;
+    version = nextVersion();
+}
+
+/**
+ * @brief Copy live strings into a fresh arena and drop the old one
+ * The new refs are collected first and only installed once every copy
+ * succeeded, so a failed compaction leaves the records untouched.
+ */
+void RecordStore::compactStrings() {
+    StringArena compacted;
+    std::vector<PackedRecord> moved(records);
+    for (PackedRecord& packed : moved) {
+        if (packed.username.length == FREE_LENGTH) {
+            continue;
+        }
+        packed.username = compacted.append(strings.view(packed.username));
+        packed.phoneNumber = compacted.append(strings.view(packed.phoneNumber));
+        packed.address = compacted.append(strings.view(packed.address));
+    }
+    strings.swap(compacted);
+    records.swap(moved);
+}
+
+/**
+ * @brief Write records and field bytes as laid out in memory
+ */
+void RecordStore::save(SnapshotWriter& writer) const {
+    writer.writeValue(freeHead);
+    writer.writeValue(static_cast<int64_t>(count));
+    writer.writeArray(records);
+    strings.save(writer);
+}
+
+/**
+ * @brief Replace the contents with a store written by save
+ * Field references must lie inside the loaded strings, and the free list
+ * must link every removed ID once, so reading or reusing any ID stays in
+ * bounds.
+ */
+bool RecordStore::load(SnapshotReader& reader) {
+    uint32_t loadedFreeHead = NO_RECORD;
+    int64_t loadedCount = 0;
+    std::vector<PackedRecord> loadedRecords;
+    StringArena loadedStrings;
+    if (!reader.readValue(loadedFreeHead) || !reader.readValue(loadedCount) ||
+        !reader.readArray(loadedRecords, NO_RECORD) || !loadedStrings.load(reader)) {
+        return false;
+    }
+    if (loadedCount < 0 || static_cast<uint64_t>(loadedCount) > loadedRecords.size() ||
+        (loadedFreeHead != NO_RECORD && loadedFreeHead >= loadedRecords.size())) {
+        return false;
+    }
+
+    size_t live = 0;
+    for (const PackedRecord& packed : loadedRecords) {
+        if (packed.username.length == FREE_LENGTH) {
+            continue;
+        }
+        if (!loadedStrings.contains(packed.username) || !loadedStrings.contains(packed.phoneNumber) ||
+            !loadedStrings.contains(packed.address)) {
+            return false;
+        }
+        live++;
+    }
+    if (live != static_cast<uint64_t>(loadedCount)) {
+        return false;
+    }
+    size_t freed = 0;
+    for (uint32_t id = loadedFreeHead; id != NO_RECORD; id = loadedRecords[id].username.offset) {
+        if (id >= loadedRecords.size() || loadedRecords[id].username.length != FREE_LENGTH ||
+            ++freed > loadedRecords.size() - live) {
+            return false;  // Out of range, a live record, or a cycle
+        }
+    }
+    if (freed != loadedRecords.size() - live) {
+        return false;
+    }
+
+    freeHead = loadedFreeHead;
+    count = static_cast<int>(loadedCount);
+    records.swap(loadedRecords);
+    strings.swap(loadedStrings);
+    version = nextVersion();
+    return true;
+}
\ No newline at end of file
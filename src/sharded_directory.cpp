@@ -0,0 +1,552 @@
+#include "sharded_directory.h"
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <iostream>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/**
+ * @brief Create the store and tables of one shard
+ */
+ShardedDirectory::Shard::Shard(int tableSize, HashAlgorithm hashAlgorithm)
+    : store(std::make_shared<RecordStore>()),
+      usernames(store, tableSize, "username", 0.75, hashAlgorithm),
+      phones(store, tableSize, "phone", 0.75, hashAlgorithm) {
+}
+
+/**
+ * @brief Unlink a key from one table, freeing its record once neither table links it
+ */
+void ShardedDirectory::Shard::unlinkKey(bool fromUsernames, std::string_view key, std::string_view otherKey) {
+    HashTable& index = fromUsernames ? usernames : phones;
+    HashTable& other = fromUsernames ? phones : usernames;
+    uint32_t id = index.unlink(key);
+    if (id != RecordStore::NO_RECORD && other.findId(otherKey) != id) {
+        store->remove(id);
+    }
+}
+
+/**
+ * @brief Constructor - starts one worker per shard
+ */
+ShardedDirectory::ShardedDirectory(int shardCount, int tableSize, HashAlgorithm hashAlgorithm)
+    : algorithm(hashAlgorithm) {
+    if (shardCount < 1) {
+        shardCount = 1;
+    }
+
+    unsigned cores = std::thread::hardware_concurrency();
+    for (int i = 0; i < shardCount; i++) {
+        shards.push_back(std::make_unique<Shard>(tableSize, hashAlgorithm));
+        Shard& shard = *shards.back();
+        shard.worker = std::thread(serve, std::ref(shard));
+
+#ifdef __linux__
+        // Best effort: keep each shard's tables in one core's caches
+        if (cores > 1) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(i % cores, &cpus);
+            pthread_setaffinity_np(shard.worker.native_handle(), sizeof(cpus), &cpus);
+        }
+#endif
+    }
+}
+
+/**
+ * @brief Destructor - finishes queued requests and stops the workers
+ */
+ShardedDirectory::~ShardedDirectory() {
+    for (std::unique_ptr<Shard>& shard : shards) {
+        {
+            std::lock_guard<std::mutex> guard(shard->queueMutex);
+            shard->stopping = true;
+        }
+        shard->queueReady.notify_one();
+    }
+    for (std::unique_ptr<Shard>& shard : shards) {
+        shard->worker.join();
+    }
+}
+
+/**
+ * @brief Worker loop: run queued requests until stopped
+ */
+void ShardedDirectory::serve(Shard& shard) {
+    for (;;) {
+        std::function<void()> request;
+        {
+            std::unique_lock<std::mutex> lock(shard.queueMutex);
+            shard.queueReady.wait(lock, [&]() { return !shard.queue.empty() || shard.stopping; });
+            if (shard.queue.empty()) {
+                return;
+            }
+            request = std::move(shard.queue.front());
+            shard.queue.pop_front();
+        }
+        request();
+    }
+}
+
+/**
+ * @brief Shard owning a key
+ * Multiplying the high 32 hash bits by the shard count maps them evenly
+ * onto any number of shards and leaves the low bits to the tables.
+ */
+int ShardedDirectory::shardOf(std::string_view key) const {
+    uint64_t high = HashFunction::hash64(key, algorithm) >> 32;
+    return static_cast<int>((high * shards.size()) >> 32);
+}
+
+/**
+ * @brief Insert a record into both indexes, logging it if a log is open
+ */
+bool ShardedDirectory::insert(const Record& record) {
+    std::shared_lock<std::shared_mutex> logging(logMutex);
+    bool full = false;
+    bool inserted = insertRecord(record, true, full);
+    logging.unlock();
+    if (full) {
+        checkpointIfFull();
+    }
+    return inserted;
+}
+
+/**
+ * @brief Insert a record into both indexes without logging it
+ * Both keys are reserved in parallel; the record is committed to both
+ * shards only if both reservations succeed, otherwise both are released.
+ * The username shard stores the full record. The phone shard links it
+ * when it is the same shard (the username commit is queued first, so it
+ * has run) and otherwise stores the two keys alone. A logged insert is
+ * appended while both keys are still reserved.
+ */
+bool ShardedDirectory::insertRecord(const Record& record, bool logged, bool& full) {
+    if (record.username.empty() || record.phoneNumber.empty()) {
+        std::cerr << "Error: Key cannot be empty!" << std::endl;
+        return false;
+    }
+
+    int usernameShard = shardOf(record.username);
+    int phoneShard = shardOf(record.phoneNumber);
+    const std::string& username = record.username;
+    const std::string& phone = record.phoneNumber;
+
+    std::future<bool> usernameReserved = post(usernameShard, [&username](Shard& shard) {
+        if (shard.usernames.contains(username) || shard.reservedUsernames.count(username)) {
+            return false;
+        }
+        shard.reservedUsernames.insert(username);
+        return true;
+    });
+    std::future<bool> phoneReserved = post(phoneShard, [&phone](Shard& shard) {
+        if (shard.phones.contains(phone) || shard.reservedPhones.count(phone)) {
+            return false;
+        }
+        shard.reservedPhones.insert(phone);
+        return true;
+    });
+    bool usernameOk = usernameReserved.get();
+    bool phoneOk = phoneReserved.get();
+
+    bool commit = usernameOk && phoneOk;
+    if (commit && logged) {
+        full = logChange(LogOperation::Insert, record.username, record.phoneNumber, record.address);
+    }
+    std::future<void> usernameDone;
+    std::future<void> phoneDone;
+    if (usernameOk) {
+        usernameDone = post(usernameShard, [&record, commit](Shard& shard) {
+            shard.reservedUsernames.erase(record.username);
+            if (commit) {
+                shard.usernames.insert(record);
+            }
+        });
+    }
+    if (phoneOk) {
+        bool sameShard = (usernameShard == phoneShard);
+        phoneDone = post(phoneShard, [&record, commit, sameShard](Shard& shard) {
+            shard.reservedPhones.erase(record.phoneNumber);
+            if (commit && sameShard) {
+                shard.phones.link(shard.usernames.findId(record.username));
+            } else if (commit) {
+                shard.phones.insert(Record(record.username, record.phoneNumber, ""));
+            }
+        });
+    }
+    if (usernameDone.valid()) {
+        usernameDone.get();
+    }
+    if (phoneDone.valid()) {
+        phoneDone.get();
+    }
+
+    if (!commit) {
+        std::cerr << "Error: Record with key '" << (usernameOk ? phone : username) << "' already exists!" << std::endl;
+    }
+    return commit;
+}
+
+/**
+ * @brief Search by username
+ */
+std::optional<Record> ShardedDirectory::searchByUsername(std::string_view username) {
+    return post(shardOf(username), [username](Shard& shard) -> std::optional<Record> {
+        std::optional<RecordView> found = shard.usernames.search(username);
+        return found ? std::optional<Record>(Record(*found)) : std::nullopt;
+    }).get();
+}
+
+/**
+ * @brief Search by phone number
+ * The phone shard names the username; unless that is the same shard,
+ * the full record is then read from the username shard.
+ */
+std::optional<Record> ShardedDirectory::searchByPhone(std::string_view phone) {
+    int phoneShard = shardOf(phone);
+    std::optional<Record> keys = post(phoneShard, [phone](Shard& shard) -> std::optional<Record> {
+        std::optional<RecordView> found = shard.phones.search(phone);
+        return found ? std::optional<Record>(Record(*found)) : std::nullopt;
+    }).get();
+    if (!keys || shardOf(keys->username) == phoneShard) {
+        return keys;
+    }
+
+    const std::string& username = keys->username;
+    return post(shardOf(username), [&username, phone](Shard& shard) -> std::optional<Record> {
+        std::optional<RecordView> found = shard.usernames.search(username);
+        if (!found || found->phoneNumber != phone) {
+            return std::nullopt;  // Removed since the phone shard answered
+        }
+        return Record(*found);
+    }).get();
+}
+
+bool ShardedDirectory::removeByUsername(std::string_view username) {
+    return removeBy(username, true);
+}
+
+bool ShardedDirectory::removeByPhone(std::string_view phone) {
+    return removeBy(phone, false);
+}
+
+/**
+ * @brief Remove a record from both indexes, found through one key
+ * The username is reserved first: by then no other delete can reach the
+ * record, and its phone number cannot be reused while it is linked. A
+ * delete through the phone number that finds the record gone or changed
+ * by the time it reaches the username shard reports nothing removed.
+ * The delete is logged while the username is reserved, then both keys
+ * are unlinked in parallel.
+ */
+bool ShardedDirectory::removeBy(std::string_view key, bool byUsername) {
+    std::shared_lock<std::shared_mutex> logging(logMutex);
+
+    std::string phone;
+    std::string username;
+    if (byUsername) {
+        username = std::string(key);
+    } else {
+        std::optional<std::string> owner = post(shardOf(key), [key](Shard& shard) -> std::optional<std::string> {
+            std::optional<RecordView> found = shard.phones.search(key);
+            return found ? std::optional<std::string>(std::string(found->username)) : std::nullopt;
+        }).get();
+        if (!owner) {
+            return false;
+        }
+        username = std::move(*owner);
+        phone = std::string(key);
+    }
+
+    std::optional<std::string> reservedPhone = post(shardOf(username), [&username, &phone](Shard& shard) -> std::optional<std::string> {
+        std::optional<RecordView> found = shard.usernames.search(username);
+        if (!found || shard.reservedUsernames.count(username) ||
+            (!phone.empty() && found->phoneNumber != phone)) {
+            return std::nullopt;
+        }
+        shard.reservedUsernames.insert(username);
+        return std::string(found->phoneNumber);
+    }).get();
+    if (!reservedPhone) {
+        return false;
+    }
+    phone = std::move(*reservedPhone);
+
+    bool full = logChange(LogOperation::Remove, username);
+
+    std::future<void> phoneDone = post(shardOf(phone), [&username, &phone](Shard& shard) {
+        std::optional<RecordView> found = shard.phones.search(phone);
+        if (found && found->username == username) {
+            shard.unlinkKey(false, phone, username);
+        }
+    });
+    std::future<void> usernameDone = post(shardOf(username), [&username, &phone](Shard& shard) {
+        shard.reservedUsernames.erase(username);
+        shard.unlinkKey(true, username, phone);
+    });
+    phoneDone.get();
+    usernameDone.get();
+
+    logging.unlock();
+    if (full) {
+        checkpointIfFull();
+    }
+    return true;
+}
+
+/**
+ * @brief Insert many records, from one client thread per core
+ */
+int ShardedDirectory::insertAll(const std::vector<Record>& records) {
+    size_t clients = std::max(1u, std::thread::hardware_concurrency());
+    std::atomic<int> inserted(0);
+    auto insertStride = [&](size_t first) {
+        for (size_t i = first; i < records.size(); i += clients) {
+            bool full = false;
+            inserted += insertRecord(records[i], false, full);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < clients; t++) {
+        threads.emplace_back(insertStride, t);
+    }
+    insertStride(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    return inserted;
+}
+
+/**
+ * @brief Copy every record, shard by shard
+ * Full records are read from the username tables.
+ */
+std::vector<Record> ShardedDirectory::getRecords() {
+    std::vector<std::future<std::vector<Record>>> pending;
+    for (int i = 0; i < getShardCount(); i++) {
+        pending.push_back(post(i, [](Shard& shard) {
+            std::vector<Record> records;
+            records.reserve(shard.usernames.getCount());
+            for (int slot = 0; slot < shard.usernames.getSlotCount(); slot++) {
+                std::optional<RecordView> record = shard.usernames.getRecordAt(slot);
+                if (record && !record->isEmpty && !record->isDeleted) {
+                    records.push_back(Record(*record));
+                }
+            }
+            return records;
+        }));
+    }
+
+    std::vector<Record> result;
+    for (std::future<std::vector<Record>>& records : pending) {
+        std::vector<Record> shardRecords = records.get();
+        std::move(shardRecords.begin(), shardRecords.end(), std::back_inserter(result));
+    }
+    return result;
+}
+
+/**
+ * @brief Get search length (number of probes) for a key in its shard
+ */
+int ShardedDirectory::getSearchLength(std::string_view key, bool byUsername) {
+    return post(shardOf(key), [key, byUsername](Shard& shard) {
+        return (byUsername ? shard.usernames : shard.phones).getSearchLength(key);
+    }).get();
+}
+
+/**
+ * @brief Clear all records
+ */
+void ShardedDirectory::clear() {
+    std::unique_lock<std::shared_mutex> logging(logMutex);
+    std::vector<std::future<void>> done;
+    for (int i = 0; i < getShardCount(); i++) {
+        done.push_back(post(i, [](Shard& shard) {
+            shard.usernames.clear();
+            shard.phones.clear();
+        }));
+    }
+    for (std::future<void>& shardDone : done) {
+        shardDone.get();
+    }
+    if (logChange(LogOperation::Clear)) {
+        checkpointLocked();
+    }
+}
+
+/**
+ * @brief Get number of records
+ */
+int ShardedDirectory::getCount() {
+    std::vector<std::future<int>> pending;
+    for (int i = 0; i < getShardCount(); i++) {
+        pending.push_back(post(i, [](Shard& shard) { return shard.usernames.getCount(); }));
+    }
+
+    int count = 0;
+    for (std::future<int>& shardCount : pending) {
+        count += shardCount.get();
+    }
+    return count;
+}
+
+/**
+ * @brief Get statistics of every shard
+ */
+std::vector<ShardStats> ShardedDirectory::getShardStats(bool sampled) {
+    std::vector<std::future<ShardStats>> pending;
+    for (int i = 0; i < getShardCount(); i++) {
+        pending.push_back(post(i, [sampled](Shard& shard) {
+            ShardStats stats;
+            stats.username = shard.usernames.getStats();
+            stats.phone = shard.phones.getStats();
+            if (sampled) {
+                stats.usernameSampled = shard.usernames.getSampledStats();
+                stats.phoneSampled = shard.phones.getSampledStats();
+            }
+            stats.storedRecords = shard.store->getCount();
+            return stats;
+        }));
+    }
+
+    std::vector<ShardStats> result;
+    for (std::future<ShardStats>& stats : pending) {
+        result.push_back(stats.get());
+    }
+    return result;
+}
+
+/**
+ * @brief Combine per-shard statistics of one index into one
+ */
+TableStats ShardedDirectory::combine(const std::vector<TableStats>& shards) {
+    TableStats total;
+    double probes = 0.0;
+    for (const TableStats& shard : shards) {
+        total.size += shard.size;
+        total.count += shard.count;
+        probes += shard.averageSearchLength * shard.count;
+        total.tombstones += shard.tombstones;
+        total.compactions += shard.compactions;
+        total.filterBytes += shard.filterBytes;
+        total.filterBits = std::max(total.filterBits, shard.filterBits);
+        total.maxProbeDistance = std::max(total.maxProbeDistance, shard.maxProbeDistance);
+        if (total.distanceHistogram.size() < shard.distanceHistogram.size()) {
+            total.distanceHistogram.resize(shard.distanceHistogram.size());
+        }
+        for (size_t i = 0; i < shard.distanceHistogram.size(); i++) {
+            total.distanceHistogram[i] += shard.distanceHistogram[i];
+        }
+    }
+    if (total.size > 0) {
+        total.loadFactor = static_cast<double>(total.count) / total.size;
+    }
+    if (total.count > 0) {
+        total.averageSearchLength = probes / total.count;
+    }
+    return total;
+}
+
+/**
+ * @brief Combine per-shard estimates of one index
+ * Misses spread evenly over the shards, so the means are the totals.
+ */
+SampledStats ShardedDirectory::combine(const std::vector<SampledStats>& shards) {
+    SampledStats total;
+    for (const SampledStats& shard : shards) {
+        total.missSearchLength += shard.missSearchLength / shards.size();
+        total.filterFalsePositiveRate += shard.filterFalsePositiveRate / shards.size();
+    }
+    return total;
+}
+
+/**
+ * @brief Log every later change to a write-ahead log
+ * The entries found only advance the numbering.
+ */
+int ShardedDirectory::openLog(const std::string& logFile, uint64_t lastSequence, CheckpointWriter writer,
+                              const LogOptions& options) {
+    std::unique_lock<std::shared_mutex> guard(logMutex);
+    log.reset();
+
+    std::unique_ptr<WriteAheadLog> opened = std::make_unique<WriteAheadLog>();
+    int found = opened->open(logFile, options, [](const LogEntry&) {});
+    if (found < 0) {
+        return -1;
+    }
+    opened->setLastSequence(std::max(lastSequence, opened->getLastSequence()));
+
+    log = std::move(opened);
+    checkpointWriter = std::move(writer);
+    return found;
+}
+
+/**
+ * @brief Write a checkpoint snapshot and empty the log
+ */
+bool ShardedDirectory::checkpoint() {
+    std::unique_lock<std::shared_mutex> guard(logMutex);
+    return checkpointLocked();
+}
+
+/**
+ * @brief checkpoint with logMutex already held exclusively
+ * No change is in flight, so every logged change is in the records.
+ * Entries still buffered in the log are dropped with it: the snapshot
+ * already holds their changes.
+ */
+bool ShardedDirectory::checkpointLocked() {
+    if (!log) {
+        return false;
+    }
+    if (!checkpointWriter(getRecords(), log->getLastSequence())) {
+        std::cerr << "Error: Could not checkpoint the shards!" << std::endl;
+        return false;
+    }
+    return log->truncate();
+}
+
+/**
+ * @brief Checkpoint unless another thread already emptied the log
+ */
+void ShardedDirectory::checkpointIfFull() {
+    std::unique_lock<std::shared_mutex> guard(logMutex);
+    if (log && log->getBytes() >= log->getOptions().checkpointBytes) {
+        checkpointLocked();
+    }
+}
+
+/**
+ * @brief Commit pending log entries and stop logging
+ */
+void ShardedDirectory::closeLog() {
+    std::unique_lock<std::shared_mutex> guard(logMutex);
+    log.reset();
+    checkpointWriter = nullptr;
+}
+
+/**
+ * @brief Get the open log, or null
+ */
+WriteAheadLog* ShardedDirectory::getLog() const {
+    std::shared_lock<std::shared_mutex> guard(logMutex);
+    return log.get();
+}
+
+/**
+ * @brief Append a change to the log, if one is open
+ * Changes never wait on each other here: the log takes the next
+ * sequence number as it buffers the entry.
+ */
+bool ShardedDirectory::logChange(LogOperation operation, std::string_view first,
+                                 std::string_view second, std::string_view third) {
+    if (!log) {
+        return false;
+    }
+    log->appendNext(operation, first, second, third);
+    return log->getBytes() >= log->getOptions().checkpointBytes;
+}
@@ -0,0 +1,76 @@
+#include "snapshot.h"
+#include "hashfunction.h"
+
+const char SnapshotHeader::MAGIC[8] = {'A', 'H', 'T', 'S', 'N', 'A', 'P', '\0'};
+
+/**
+ * @brief Check whether bytes start with a snapshot header
+ */
+bool SnapshotHeader::matches(std::string_view bytes) {
+    return bytes.size() >= sizeof(SnapshotHeader) && std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) == 0;
+}
+
+/**
+ * @brief Chained hash of a payload, block by block
+ * Each block's hash is seeded with the hash so far, so the checksum
+ * depends on the order of the blocks as well as their bytes.
+ */
+uint64_t SnapshotHeader::checksumOf(std::string_view payload) {
+    uint64_t checksum = 0;
+    for (size_t offset = 0; offset < payload.size(); offset += CHECKSUM_BLOCK) {
+        size_t length = payload.size() - offset < CHECKSUM_BLOCK ? payload.size() - offset : CHECKSUM_BLOCK;
+        checksum = HashFunction::wyhash64(payload.data() + offset, length, checksum);
+    }
+    return checksum;
+}
+
+SnapshotWriter::SnapshotWriter(std::ostream& output) : out(output) {
+    block.reserve(SnapshotHeader::CHECKSUM_BLOCK);
+}
+
+/**
+ * @brief Append raw bytes
+ */
+void SnapshotWriter::write(const void* data, size_t bytes) {
+    const char* text = static_cast<const char*>(data);
+    written += bytes;
+    while (bytes > 0) {
+        size_t room = SnapshotHeader::CHECKSUM_BLOCK - block.size();
+        size_t take = bytes < room ? bytes : room;
+        block.insert(block.end(), text, text + take);
+        text += take;
+        bytes -= take;
+        if (block.size() == SnapshotHeader::CHECKSUM_BLOCK) {
+            flushBlock();
+        }
+    }
+}
+
+/**
+ * @brief Write out the last partial block
+ */
+uint64_t SnapshotWriter::finish() {
+    if (!block.empty()) {
+        flushBlock();
+    }
+    return checksum;
+}
+
+void SnapshotWriter::flushBlock() {
+    checksum = HashFunction::wyhash64(block.data(), block.size(), checksum);
+    out.write(block.data(), static_cast<std::streamsize>(block.size()));
+    block.clear();
+}
+
+/**
+ * @brief Take the next section of a given size
+ */
+const char* SnapshotReader::read(size_t size) {
+    if (failed || size > bytes.size()) {
+        failed = true;
+        return nullptr;
+    }
+    const char* data = bytes.data();
+    bytes.remove_prefix(size);
+    return data;
+}
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "string_arena.h"
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+/**
+ * @brief Copy a string into the arena
+ */
+StringRef StringArena::append(std::string_view text) {
+    StringRef ref;
+    if (text.empty()) {
+        return ref;
+    }
+
+    if (text.size() > CHUNK_SIZE - chunkUsed) {
+        addChunk(text.size());
+    }
+
+    uint32_t chunk = static_cast<uint32_t>(chunks.size() - 1);
+    std::memcpy(chunks[chunk].get() + chunkUsed, text.data(), text.size());
+
+    ref.offset = (chunk << CHUNK_BITS) | chunkUsed;
+    ref.length = static_cast<uint32_t>(text.size());
+
+    // An oversized chunk is never appended to again
+    chunkUsed = (text.size() >= CHUNK_SIZE) ? CHUNK_SIZE : chunkUsed + ref.length;
+    usedBytes += text.size();
+    return ref;
+}
+
+/**
+ * @brief Start a new chunk of at least minBytes
+ */
+void StringArena::addChunk(size_t minBytes) {
+    if (chunks.size() >= MAX_CHUNKS) {
+        throw std::length_error("StringArena: chunk limit reached");
+    }
+
+    // Zero the unused tail of the regular chunk left behind, so saved chunks
+    // hold no stale bytes (an oversized chunk is always full)
+    if (!chunks.empty() && chunkBytes.back() == CHUNK_SIZE) {
+        std::memset(chunks.back().get() + chunkUsed, 0, CHUNK_SIZE - chunkUsed);
+    }
+
+    size_t bytes = (minBytes > CHUNK_SIZE) ? minBytes : CHUNK_SIZE;
+    chunkBytes.reserve(chunks.size() + 1);
+    chunks.emplace_back(new char[bytes]);
+    chunkBytes.push_back(bytes);
+    chunkUsed = 0;
+    reservedBytes += bytes;
+}
+
+/**
+ * @brief Check whether a reference lies inside the stored bytes
+ */
+bool StringArena::contains(StringRef ref) const {
+    if (ref.length == 0) {
+        return true;
+    }
+    size_t chunk = ref.offset >> CHUNK_BITS;
+    if (chunk >= chunks.size()) {
+        return false;
+    }
+    // Only the last regular chunk is partly written
+    bool last = (chunk + 1 == chunks.size());
+    size_t written = (last && chunkBytes[chunk] == CHUNK_SIZE) ? chunkUsed : chunkBytes[chunk];
+    return (ref.offset & (CHUNK_SIZE - 1)) + static_cast<size_t>(ref.length) <= written;
+}
+
+/**
+ * @brief Free every chunk
+ */
+void StringArena::clear() {
+    std::vector<std::unique_ptr<char[]>>().swap(chunks);
+    std::vector<size_t>().swap(chunkBytes);
+    chunkUsed = CHUNK_SIZE;
+    usedBytes = 0;
+    deadBytes = 0;
+    reservedBytes = 0;
+}
+
+/**
+ * @brief Exchange contents with another arena
+ */
+void StringArena::swap(StringArena& other) {
+    chunks.swap(other.chunks);
+    chunkBytes.swap(other.chunkBytes);
+    std::swap(chunkUsed, other.chunkUsed);
+    std::swap(usedBytes, other.usedBytes);
+    std::swap(deadBytes, other.deadBytes);
+    std::swap(reservedBytes, other.reservedBytes);
+}
+
+/**
+ * @brief Write every chunk as laid out in memory
+ * Only the used part of the last regular chunk is written; earlier
+ * chunks are written whole, since references address them by position.
+ */
+void StringArena::save(SnapshotWriter& writer) const {
+    writer.writeValue(static_cast<uint64_t>(chunks.size()));
+    writer.writeValue(static_cast<uint64_t>(chunkUsed));
+    writer.writeValue(static_cast<uint64_t>(usedBytes));
+    writer.writeValue(static_cast<uint64_t>(deadBytes));
+    for (size_t i = 0; i < chunks.size(); i++) {
+        bool last = (i + 1 == chunks.size());
+        size_t used = (last && chunkBytes[i] == CHUNK_SIZE) ? chunkUsed : chunkBytes[i];
+        writer.writeValue(static_cast<uint64_t>(chunkBytes[i]));
+        writer.writeValue(static_cast<uint64_t>(used));
+        writer.write(chunks[i].get(), used);
+    }
+}
+
+/**
+ * @brief Replace the contents with chunks written by save
+ * Every chunk but a last regular one must be written whole, so a chunk
+ * larger than CHUNK_SIZE (one long string) is never allocated beyond the
+ * bytes the file holds.
+ */
+bool StringArena::load(SnapshotReader& reader) {
+    uint64_t chunkCount = 0, used = 0, appended = 0, dead = 0;
+    if (!reader.readValue(chunkCount) || !reader.readValue(used) || !reader.readValue(appended) ||
+        !reader.readValue(dead) || chunkCount > MAX_CHUNKS || used > CHUNK_SIZE) {
+        return false;
+    }
+
+    StringArena loaded;
+    loaded.chunks.reserve(chunkCount);
+    loaded.chunkBytes.reserve(chunkCount);
+    for (uint64_t i = 0; i < chunkCount; i++) {
+        uint64_t bytes = 0, written = 0;
+        if (!reader.readValue(bytes) || !reader.readValue(written) || bytes < CHUNK_SIZE) {
+            return false;
+        }
+        bool partial = (i + 1 == chunkCount && bytes == CHUNK_SIZE);
+        if (written != (partial ? used : bytes)) {
+            return false;
+        }
+        const char* data = reader.read(written);
+        if (!data) {
+            return false;
+        }
+        loaded.chunks.emplace_back(new char[bytes]);
+        loaded.chunkBytes.push_back(bytes);
+        std::memcpy(loaded.chunks.back().get(), data, written);
+        loaded.reservedBytes += bytes;
+    }
+    loaded.chunkUsed = static_cast<uint32_t>(used);
+    loaded.usedBytes = appended;
+    loaded.deadBytes = dead;
+
+    swap(loaded);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,390 @@
+#include "write_ahead_log.h"
+#include "hashfunction.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+const WriteAheadLog::FileHandle WriteAheadLog::INVALID_FILE = INVALID_HANDLE_VALUE;
+#else
+const WriteAheadLog::FileHandle WriteAheadLog::INVALID_FILE = -1;
+#endif
+
+namespace {
+
+// Entry layout: uint32 body length, uint32 checksum, then the body:
+// uint64 sequence, uint8 operation, and three uint32 length-prefixed fields
+const size_t FRAME_BYTES = 2 * sizeof(uint32_t);
+const size_t MIN_BODY_BYTES = sizeof(uint64_t) + 1 + 3 * sizeof(uint32_t);
+
+uint32_t checksumOf(const char* body, uint32_t length) {
+    return static_cast<uint32_t>(HashFunction::wyhash64(body, length, length));
+}
+
+template <class T>
+void put(std::vector<char>& out, T value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <class T>
+T get(const char* in) {
+    T value;
+    std::memcpy(&value, in, sizeof(T));
+    return value;
+}
+
+/**
+ * @brief Decode the entry at the start of bytes
+ * @return Bytes taken by the entry, 0 if it is torn or damaged
+ */
+size_t decodeEntry(std::string_view bytes, LogEntry& entry) {
+    if (bytes.size() < FRAME_BYTES) {
+        return 0;
+    }
+    uint32_t length = get<uint32_t>(bytes.data());
+    if (length < MIN_BODY_BYTES || length > bytes.size() - FRAME_BYTES) {
+        return 0;
+    }
+    const char* body = bytes.data() + FRAME_BYTES;
+    if (get<uint32_t>(bytes.data() + sizeof(uint32_t)) != checksumOf(body, length)) {
+        return 0;
+    }
+
+    const char* end = body + length;
+    entry.sequence = get<uint64_t>(body);
+    uint8_t operation = static_cast<uint8_t>(body[sizeof(uint64_t)]);
+    if (operation < static_cast<uint8_t>(LogOperation::Insert) ||
+        operation > static_cast<uint8_t>(LogOperation::Clear)) {
+        return 0;
+    }
+    entry.operation = static_cast<LogOperation>(operation);
+    const char* p = body + sizeof(uint64_t) + 1;
+    for (std::string_view& field : entry.fields) {
+        if (static_cast<size_t>(end - p) < sizeof(uint32_t)) {
+            return 0;
+        }
+        uint32_t fieldLength = get<uint32_t>(p);
+        p += sizeof(uint32_t);
+        if (fieldLength > static_cast<size_t>(end - p)) {
+            return 0;
+        }
+        field = std::string_view(p, fieldLength);
+        p += fieldLength;
+    }
+    return p == end ? FRAME_BYTES + length : 0;
+}
+
+} // namespace
+
+/**
+ * @brief Destructor - commits buffered entries and closes the file
+ */
+WriteAheadLog::~WriteAheadLog() {
+    close();
+}
+
+/**
+ * @brief Replay a log file and open it for appending
+ * The file is mapped for the replay and unmapped before it is truncated
+ * to its intact prefix and reopened for writing.
+ */
+int WriteAheadLog::open(const std::string& filename, const LogOptions& logOptions,
+                        const std::function<void(const LogEntry&)>& replay) {
+    close();
+
+    int replayed = 0;
+    uint64_t intactBytes = 0;
+    {
+        MappedFile mapped;
+        if (mapped.open(filename)) {
+            std::string_view bytes = mapped.text();
+            LogEntry entry;
+            while (size_t taken = decodeEntry(bytes.substr(intactBytes), entry)) {
+                replay(entry);
+                lastSequence = std::max(lastSequence, entry.sequence);
+                intactBytes += taken;
+                replayed++;
+            }
+            if (intactBytes < bytes.size()) {
+                std::cerr << "Warning: Dropped " << bytes.size() - intactBytes
+                          << " damaged bytes at the end of log '" << filename << "'" << std::endl;
+            }
+        }
+    }
+
+#ifdef _WIN32
+    file = CreateFileA(filename.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                       FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER end;
+    end.QuadPart = static_cast<LONGLONG>(intactBytes);
+    if (file != INVALID_FILE &&
+        (!SetFilePointerEx(file, end, nullptr, FILE_BEGIN) || !SetEndOfFile(file))) {
+        CloseHandle(file);
+        file = INVALID_FILE;
+    }
+#else
+    file = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (file != INVALID_FILE && ftruncate(file, static_cast<off_t>(intactBytes)) != 0) {
+        ::close(file);
+        file = INVALID_FILE;
+    }
+#endif
+    if (file == INVALID_FILE) {
+        std::cerr << "Error: Could not open log '" << filename << "' for writing!" << std::endl;
+        return -1;
+    }
+
+    path = filename;
+    options = logOptions;
+    appendedBytes = intactBytes;
+    if (options.commitDelay.count() > 0) {
+        committer = std::thread(&WriteAheadLog::commitLoop, this);
+    }
+    return replayed;
+}
+
+/**
+ * @brief Commit buffered entries and close the file
+ */
+void WriteAheadLog::close() {
+    if (committer.joinable()) {
+        {
+            std::lock_guard<std::mutex> guard(bufferMutex);
+            stopping = true;
+        }
+        bufferReady.notify_one();
+        committer.join();
+    }
+
+    if (file != INVALID_FILE) {
+#ifdef _WIN32
+        CloseHandle(file);
+#else
+        ::close(file);
+#endif
+    }
+    file = INVALID_FILE;
+    buffer.clear();
+    appendedBytes = 0;
+    lastSequence = 0;
+    commitsRequested = 0;
+    commitsDone = 0;
+    syncCount = 0;
+    stopping = false;
+    failed = false;
+}
+
+/**
+ * @brief Record a change
+ */
+void WriteAheadLog::append(uint64_t sequence, LogOperation operation, std::string_view first,
+                           std::string_view second, std::string_view third) {
+    if (!isOpen()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(bufferMutex);
+    lastSequence = std::max(lastSequence, sequence);
+    frame(lock, sequence, operation, first, second, third);
+}
+
+/**
+ * @brief Record a change under the next sequence number
+ */
+uint64_t WriteAheadLog::appendNext(LogOperation operation, std::string_view first,
+                                   std::string_view second, std::string_view third) {
+    if (!isOpen()) {
+        return 0;
+    }
+
+    std::unique_lock<std::mutex> lock(bufferMutex);
+    uint64_t sequence = ++lastSequence;
+    frame(lock, sequence, operation, first, second, third);
+    return sequence;
+}
+
+/**
+ * @brief Number later appendNext entries after a sequence number
+ */
+void WriteAheadLog::setLastSequence(uint64_t sequence) {
+    std::lock_guard<std::mutex> guard(bufferMutex);
+    lastSequence = sequence;
+}
+
+uint64_t WriteAheadLog::getLastSequence() const {
+    std::lock_guard<std::mutex> guard(bufferMutex);
+    return lastSequence;
+}
+
+/**
+ * @brief Frame an entry into the buffer and start or run its commit
+ * With a commit delay the entry is only buffered; the first entry of an
+ * empty buffer starts the delay and a full buffer cuts it short.
+ */
+void WriteAheadLog::frame(std::unique_lock<std::mutex>& lock, uint64_t sequence, LogOperation operation,
+                          std::string_view first, std::string_view second, std::string_view third) {
+    bool wasEmpty = buffer.empty();
+    size_t start = buffer.size();
+    uint32_t length = static_cast<uint32_t>(MIN_BODY_BYTES + first.size() + second.size() + third.size());
+    put(buffer, length);
+    put(buffer, uint32_t(0));  // Checksum, filled in below
+    put(buffer, sequence);
+    put(buffer, static_cast<uint8_t>(operation));
+    for (std::string_view field : {first, second, third}) {
+        put(buffer, static_cast<uint32_t>(field.size()));
+        buffer.insert(buffer.end(), field.begin(), field.end());
+    }
+    uint32_t checksum = checksumOf(buffer.data() + start + FRAME_BYTES, length);
+    std::memcpy(buffer.data() + start + sizeof(uint32_t), &checksum, sizeof(checksum));
+    appendedBytes += FRAME_BYTES + length;
+
+    if (options.commitDelay.count() == 0) {
+        commit(lock);
+    } else if (wasEmpty) {
+        firstBuffered = std::chrono::steady_clock::now();
+        bufferReady.notify_one();
+    } else if (buffer.size() >= options.commitBytes) {
+        bufferReady.notify_one();
+    }
+}
+
+/**
+ * @brief Write and sync every appended entry now
+ */
+bool WriteAheadLog::sync() {
+    std::unique_lock<std::mutex> lock(bufferMutex);
+    if (committer.joinable()) {
+        uint64_t request = ++commitsRequested;
+        bufferReady.notify_one();
+        committed.wait(lock, [&]() { return commitsDone >= request; });
+    }
+    return !failed;
+}
+
+/**
+ * @brief Drop every entry, once a checkpoint holds their changes
+ * Buffered entries are discarded; a commit already under way finishes
+ * first, since it holds the file.
+ */
+bool WriteAheadLog::truncate() {
+    std::lock_guard<std::mutex> guard(bufferMutex);
+    if (!isOpen()) {
+        return false;
+    }
+    buffer.clear();
+    std::lock_guard<std::mutex> fileGuard(fileMutex);
+#ifdef _WIN32
+    LARGE_INTEGER start = {};
+    bool truncated = SetFilePointerEx(file, start, nullptr, FILE_BEGIN) && SetEndOfFile(file) &&
+                     FlushFileBuffers(file);
+#else
+    bool truncated = ftruncate(file, 0) == 0 && fsync(file) == 0;
+#endif
+    if (!truncated) {
+        std::cerr << "Error: Could not truncate log '" << path << "'!" << std::endl;
+        return false;
+    }
+    appendedBytes = 0;
+    return true;
+}
+
+uint64_t WriteAheadLog::getBytes() const {
+    std::lock_guard<std::mutex> guard(bufferMutex);
+    return appendedBytes;
+}
+
+uint64_t WriteAheadLog::getSyncCount() const {
+    std::lock_guard<std::mutex> guard(bufferMutex);
+    return syncCount;
+}
+
+/**
+ * @brief Committer thread: commit the buffer once its delay runs out
+ */
+void WriteAheadLog::commitLoop() {
+    std::unique_lock<std::mutex> lock(bufferMutex);
+    for (;;) {
+        bufferReady.wait(lock, [&]() { return stopping || !buffer.empty() || commitsRequested > commitsDone; });
+        bufferReady.wait_until(lock, firstBuffered + options.commitDelay, [&]() {
+            return stopping || commitsRequested > commitsDone || buffer.size() >= options.commitBytes;
+        });
+
+        uint64_t served = commitsRequested;
+        commit(lock);
+        commitsDone = served;
+        committed.notify_all();
+        if (stopping && buffer.empty()) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Write and sync the buffer; bufferMutex is released meanwhile
+ * The file is claimed before the buffer is let go, so commits reach the
+ * file in the order their entries were appended.
+ */
+void WriteAheadLog::commit(std::unique_lock<std::mutex>& lock) {
+    if (buffer.empty()) {
+        return;
+    }
+    std::vector<char> bytes;
+    bytes.swap(buffer);
+    std::unique_lock<std::mutex> fileLock(fileMutex);
+    lock.unlock();
+    bool written = writeAndSync(bytes);
+    fileLock.unlock();
+    lock.lock();
+
+    syncCount++;
+    if (!written && !failed) {
+        failed = true;
+        std::cerr << "Error: Could not write log '" << path << "'!" << std::endl;
+    }
+}
+
+bool WriteAheadLog::writeAndSync(const std::vector<char>& bytes) {
+    const char* data = bytes.data();
+    size_t remaining = bytes.size();
+#ifdef _WIN32
+    while (remaining > 0) {
+        DWORD written = 0;
+        DWORD chunk = remaining < (1u << 30) ? static_cast<DWORD>(remaining) : (1u << 30);
+        if (!WriteFile(file, data, chunk, &written, nullptr)) {
+            return false;
+        }
+        data += written;
+        remaining -= written;
+    }
+    return FlushFileBuffers(file) != 0;
+#else
+    while (remaining > 0) {
+        ssize_t written = ::write(file, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+#ifdef __linux__
+    return fdatasync(file) == 0;
+#else
+    return fsync(file) == 0;
+#endif
+#endif
+}
\ No newline at end of file
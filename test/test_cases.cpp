@@ -1,7 +1,34 @@
 #include "../include/hashtable.h"
 #include "../include/record.h"
+#include "../include/hashfunction.h"
+#include "../include/group_probe.h"
+#include "../include/basic_hashtable.h"
+#include "../include/cuckoo_hashtable.h"
+#include "../include/chained_hashtable.h"
+#include "../include/string_arena.h"
+#include "../include/record_store.h"
+#include "../include/phone_directory.h"
+#include "../include/concurrent_hashtable.h"
+#include "../include/epoch.h"
+#include "../include/sharded_directory.h"
+#include "../include/file_handler.h"
 #include <iostream>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <random>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 /**
@@ -9,6 +36,70 @@
  * @brief Unit tests for hash table implementation
  */
 
+// Counting global allocator: every heap allocation in the test binary goes
+// through it. The whole replaceable family is defined so that every new has
+// its matching delete.
+static std::atomic<size_t> heapAllocations(0);
+
+static void* countedAllocate(std::size_t bytes) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(bytes ? bytes : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+// Over-aligned blocks are carved out of a larger malloc block whose address
+// is kept just before them (aligned_alloc is missing from some C runtimes)
+static void* countedAllocate(std::size_t bytes, std::align_val_t alignment) {
+    std::size_t align = static_cast<std::size_t>(alignment);
+    char* block = static_cast<char*>(countedAllocate(bytes + align + sizeof(void*)));
+    std::uintptr_t start = reinterpret_cast<std::uintptr_t>(block + sizeof(void*));
+    char* memory = block + sizeof(void*) + (align - start % align) % align;
+    std::memcpy(memory - sizeof(void*), &block, sizeof(void*));
+    return memory;
+}
+
+static void alignedFree(void* memory) noexcept {
+    if (memory) {
+        void* block;
+        std::memcpy(&block, static_cast<char*>(memory) - sizeof(void*), sizeof(void*));
+        std::free(block);
+    }
+}
+
+void* operator new(std::size_t bytes) { return countedAllocate(bytes); }
+void* operator new[](std::size_t bytes) { return countedAllocate(bytes); }
+void* operator new(std::size_t bytes, std::align_val_t alignment) { return countedAllocate(bytes, alignment); }
+void* operator new[](std::size_t bytes, std::align_val_t alignment) { return countedAllocate(bytes, alignment); }
+
+void* operator new(std::size_t bytes, const std::nothrow_t&) noexcept {
+    try {
+        return countedAllocate(bytes);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t bytes, const std::nothrow_t&) noexcept {
+    try {
+        return countedAllocate(bytes);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { alignedFree(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { alignedFree(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { alignedFree(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { alignedFree(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+
 void testRecordCreation() {
     std::cout << "Test 1: Record Creation... ";
     
@@ -58,17 +149,17 @@ void testHashTableSearch() {
     ht.insert(rec1);
     ht.insert(rec2);
     
-    Record* found1 = ht.search("Alice");
-    assert(found1 != nullptr);
+    std::optional<RecordView> found1 = ht.search("Alice");
+    assert(found1 != std::nullopt);
     assert(found1->username == "Alice");
     assert(found1->phoneNumber == "1234567890");
     
-    Record* found2 = ht.search("Bob");
-    assert(found2 != nullptr);
+    std::optional<RecordView> found2 = ht.search("Bob");
+    assert(found2 != std::nullopt);
     assert(found2->username == "Bob");
     
-    Record* found3 = ht.search("Charlie");
-    assert(found3 == nullptr);
+    std::optional<RecordView> found3 = ht.search("Charlie");
+    assert(found3 == std::nullopt);
     
     std::cout << "PASSED" << std::endl;
 }
@@ -85,8 +176,8 @@ void testHashTableDelete() {
     assert(ht.remove("Alice") == true);
     assert(ht.getCount() == 0);
     
-    Record* found = ht.search("Alice");
-    assert(found == nullptr);
+    std::optional<RecordView> found = ht.search("Alice");
+    assert(found == std::nullopt);
     
     // Test delete non-existent
     assert(ht.remove("Bob") == false);
@@ -139,26 +230,36 @@ void testLoadFactor() {
 void testCollisionHandling() {
     std::cout << "Test 7: Collision Handling... ";
     
-    // Small table to force collisions
-    HashTable ht(5, "username");
-    
     std::vector<Record> records = {
         Record("Alice", "1111111111", "Address 1"),
         Record("Bob", "2222222222", "Address 2"),
         Record("Charlie", "3333333333", "Address 3"),
-        Record("David", "4444444444", "Address 4")
+        Record("David", "4444444444", "Address 4"),
+        Record("Noah", "5555555555", "Address 5"),
+        Record("Haon", "6666666666", "Address 6")  // Anagram of Noah
     };
     
-    // Insert all records
-    for (const auto& rec : records) {
-        assert(ht.insert(rec) == true);
-    }
+    const HashAlgorithm algorithms[] = {
+        HashAlgorithm::Sum, HashAlgorithm::Polynomial,
+        HashAlgorithm::WyHash, HashAlgorithm::XXHash64
+    };
     
-    // Verify all can be found
-    for (const auto& rec : records) {
-        Record* found = ht.search(rec.username);
-        assert(found != nullptr);
-        assert(found->username == rec.username);
+    for (HashAlgorithm algorithm : algorithms) {
+        // Small table to force collisions
+        HashTable ht(5, "username", 0.75, algorithm);
+        assert(ht.getHashAlgorithm() == algorithm);
+        
+        // Insert all records
+        for (const auto& rec : records) {
+            assert(ht.insert(rec) == true);
+        }
+        
+        // Verify all can be found
+        for (const auto& rec : records) {
+            std::optional<RecordView> found = ht.search(rec.username);
+            assert(found != std::nullopt);
+            assert(found->username == rec.username);
+        }
     }
     
     std::cout << "PASSED" << std::endl;
@@ -183,8 +284,8 @@ void testFileOperations() {
     assert(loaded == 2);
     assert(ht2.getCount() == 2);
     
-    Record* found = ht2.search("Alice");
-    assert(found != nullptr);
+    std::optional<RecordView> found = ht2.search("Alice");
+    assert(found != std::nullopt);
     assert(found->phoneNumber == "1234567890");
     
     std::cout << "PASSED" << std::endl;
@@ -201,12 +302,12 @@ void testPhoneNumberKey() {
     assert(ht.insert(rec1) == true);
     assert(ht.insert(rec2) == true);
     
-    Record* found1 = ht.search("1234567890");
-    assert(found1 != nullptr);
+    std::optional<RecordView> found1 = ht.search("1234567890");
+    assert(found1 != std::nullopt);
     assert(found1->username == "Alice");
     
-    Record* found2 = ht.search("0987654321");
-    assert(found2 != nullptr);
+    std::optional<RecordView> found2 = ht.search("0987654321");
+    assert(found2 != std::nullopt);
     assert(found2->username == "Bob");
     
     std::cout << "PASSED" << std::endl;
@@ -215,7 +316,7 @@ void testPhoneNumberKey() {
 void testLargeDataset() {
     std::cout << "Test 10: Large Dataset (30+ records)... ";
     
-    HashTable ht(30, "username");  // Size matches number of records
+    HashTable ht(30, "username");  // Grows past the initial size
     
     // Insert 30 records
     for (int i = 0; i < 30; i++) {
@@ -232,13 +333,2034 @@ void testLargeDataset() {
     // Verify all can be found
     for (int i = 0; i < 30; i++) {
         std::string name = "User" + std::to_string(i);
-        Record* found = ht.search(name);
-        assert(found != nullptr);
+        std::optional<RecordView> found = ht.search(name);
+        assert(found != std::nullopt);
         assert(found->username == name);
     }
     
     double loadFactor = ht.getLoadFactor();
-    assert(loadFactor > 0.5 && loadFactor < 0.6);
+    assert(loadFactor > 0.0 && loadFactor <= ht.getMaxLoadFactor());
+    assert(ht.getSize() > 30);
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testIncrementalResize() {
+    std::cout << "Test 11: Incremental Resize... ";
+    
+    HashTable ht(7, "username", 0.5);
+    assert(ht.getMaxLoadFactor() == 0.5);
+    assert(!ht.isResizing());
+    assert(ht.getMigrationProgress() == 1.0);
+    
+    bool sawResize = false;
+    for (int i = 0; i < 500; i++) {
+        Record rec("User" + std::to_string(i), "555-" + std::to_string(i), "Address");
+        assert(ht.insert(rec) == true);
+        assert(ht.getLoadFactor() <= 0.5);
+        
+        if (ht.isResizing()) {
+            sawResize = true;
+            assert(ht.getMigrationProgress() < 1.0);
+        }
+        
+        // Records must stay reachable while a migration is in flight
+        assert(ht.getSearchLength("User0") > 0);
+    }
+    assert(sawResize);
+    assert(ht.getCount() == 500);
+    
+    for (int i = 0; i < 500; i += 7) {
+        std::string name = "User" + std::to_string(i);
+        assert(ht.remove(name) == true);
+        assert(ht.search(name) == std::nullopt);
+    }
+    for (int i = 1; i < 500; i += 7) {
+        std::optional<RecordView> found = ht.search("User" + std::to_string(i));
+        assert(found != std::nullopt);
+        assert(found->phoneNumber == "555-" + std::to_string(i));
+    }
+    
+    // Every live record is addressable through getRecordAt
+    int visible = 0;
+    for (int i = 0; i < ht.getSlotCount(); i++) {
+        std::optional<RecordView> rec = ht.getRecordAt(i);
+        if (rec && !rec->isEmpty && !rec->isDeleted) {
+            visible++;
+        }
+    }
+    assert(visible == ht.getCount());
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testHashFunctions() {
+    std::cout << "Test 12: Hash Functions... ";
+    
+    // Reference values of the published algorithms
+    assert(HashFunction::xxhash64("", 0) == 0xEF46DB3751D8E999ULL);
+    assert(HashFunction::xxhash64("a", 1) == 0xD24EC4F1A98C6E5BULL);
+    assert(HashFunction::wyhash64("", 0) == 0x93228A4DE0EEC5A2ULL);
+    
+    // Legacy options keep their original results
+    assert(HashFunction::index("Noah", 31, HashAlgorithm::Sum) == HashFunction::hash("Noah", 31));
+    assert(HashFunction::index("Noah", 31, HashAlgorithm::Polynomial) == HashFunction::hashWithSeed("Noah", 31));
+    
+    // Anagrams always collide under the ASCII sum but not under 64-bit hashers
+    assert(HashFunction::hash("Noah", 1009) == HashFunction::hash("Haon", 1009));
+    assert(HashFunction::wyhash64("Noah", 4) != HashFunction::wyhash64("Haon", 4));
+    assert(HashFunction::xxhash64("Noah", 4) != HashFunction::xxhash64("Haon", 4));
+    
+    // Every length path stays in range
+    std::string key;
+    for (int length = 0; length < 80; length++) {
+        int index = HashFunction::index(key, 31, HashAlgorithm::WyHash);
+        assert(index >= 0 && index < 31);
+        index = HashFunction::index(key, 31, HashAlgorithm::XXHash64);
+        assert(index >= 0 && index < 31);
+        key += static_cast<char>('a' + length % 26);
+    }
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testSlotLayout() {
+    std::cout << "Test 13: Control Bytes and Record Slots... ";
+    
+    // ASCII sum gives many equal fingerprints, so key comparison must still decide
+    HashTable ht(11, "username", 0.75, HashAlgorithm::Sum);
+    for (int i = 0; i < 1000; i++) {
+        assert(ht.insert(Record("User" + std::to_string(i), std::to_string(i), "Address")) == true);
+    }
+    for (int i = 0; i < 1000; i++) {
+        std::optional<RecordView> found = ht.search("User" + std::to_string(i));
+        assert(found != std::nullopt);
+        assert(found->phoneNumber == std::to_string(i));
+    }
+    assert(ht.search("resU1") == std::nullopt);
+    
+    // getRecordAt exposes the same slots, with flags kept in step with removals
+    int deletedSlot = -1;
+    for (int i = 0; i < ht.getSlotCount() && deletedSlot == -1; i++) {
+        std::optional<RecordView> rec = ht.getRecordAt(i);
+        if (rec && !rec->isEmpty && !rec->isDeleted && rec->username == "User500") {
+            deletedSlot = i;
+        }
+    }
+    assert(deletedSlot != -1);
+    assert(ht.remove("User500") == true);
+    assert(ht.getRecordAt(deletedSlot)->isDeleted);
+    assert(ht.getRecordAt(ht.getSlotCount()) == std::nullopt);
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testGroupProbeEngines() {
+    std::cout << "Test 14: Group Probe Engines... ";
+    
+    HashTable ht(101, "phone", 0.9);
+    for (int i = 0; i < 900; i++) {
+        assert(ht.insert(Record("User" + std::to_string(i), "555-" + std::to_string(i), "")) == true);
+    }
+    for (int i = 0; i < 900; i += 3) {
+        ht.remove("555-" + std::to_string(i));  // Tombstones inside probe chains
+    }
+    
+    // Scalar lengths are the reference for every SIMD engine
+    GroupProbe::Engine original = GroupProbe::active();
+    assert(GroupProbe::select(GroupProbe::Engine::Scalar));
+    std::vector<int> expected;
+    for (int i = 0; i < 1200; i++) {
+        expected.push_back(ht.getSearchLength("555-" + std::to_string(i)));
+    }
+    
+    const GroupProbe::Engine engines[] = {GroupProbe::Engine::SSE2, GroupProbe::Engine::AVX2};
+    for (GroupProbe::Engine engine : engines) {
+        if (!GroupProbe::select(engine)) {
+            continue;  // Not supported on this CPU
+        }
+        assert(GroupProbe::active() == engine);
+        for (int i = 0; i < 1200; i++) {
+            assert(ht.getSearchLength("555-" + std::to_string(i)) == expected[i]);
+        }
+    }
+    GroupProbe::select(original);
+    
+    // Tables smaller than a group wrap through the mirrored control bytes
+    HashTable tiny(3, "username", 0.95);
+    assert(tiny.insert(Record("A", "1", "")) == true);
+    assert(tiny.insert(Record("B", "2", "")) == true);
+    assert(tiny.search("A") != std::nullopt && tiny.search("B") != std::nullopt);
+    assert(tiny.search("C") == std::nullopt);
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testProbeStrategies() {
+    std::cout << "Test 15: Probe Strategies... ";
+    
+    const ProbeStrategy strategies[] = {
+        ProbeStrategy::Linear, ProbeStrategy::Quadratic,
+        ProbeStrategy::DoubleHashing, ProbeStrategy::RobinHood
+    };
+    
+    for (ProbeStrategy strategy : strategies) {
+        HashTable ht(20, "phone", 0.75, HashAlgorithm::WyHash, strategy);
+        assert(ht.getProbeStrategy() == strategy);
+        if (strategy == ProbeStrategy::Quadratic) {
+            assert(ht.getMaxLoadFactor() == 0.5);
+            assert(ht.getSize() == 23);  // Rounded up to a prime
+        }
+        
+        // Churn: insert, delete every other key, insert a new batch
+        for (int i = 0; i < 2000; i++) {
+            assert(ht.insert(Record("User" + std::to_string(i), std::to_string(i), "")) == true);
+        }
+        for (int i = 0; i < 2000; i += 2) {
+            assert(ht.remove(std::to_string(i)) == true);
+        }
+        for (int i = 2000; i < 3000; i++) {
+            assert(ht.insert(Record("User" + std::to_string(i), std::to_string(i), "")) == true);
+        }
+        
+        assert(ht.getCount() == 2000);
+        for (int i = 0; i < 3000; i++) {
+            std::optional<RecordView> found = ht.search(std::to_string(i));
+            bool expected = (i >= 2000) || (i % 2 == 1);
+            assert((found != std::nullopt) == expected);
+            if (found) {
+                assert(found->username == "User" + std::to_string(i));
+            }
+        }
+        
+        assert(ht.getMaxProbeDistance() >= 0);
+        assert(ht.getMeanProbeDistance() <= ht.getMaxProbeDistance());
+        
+        if (strategy == ProbeStrategy::RobinHood && !ht.isResizing()) {
+            // Backward-shift deletion leaves no tombstones
+            for (int i = 0; i < ht.getSlotCount(); i++) {
+                assert(!ht.getRecordAt(i)->isDeleted);
+            }
+        }
+    }
+    
+    // Robin Hood reorders a linear probing table without changing total displacement
+    HashTable linear(4001, "phone", 0.9, HashAlgorithm::WyHash, ProbeStrategy::Linear);
+    HashTable robin(4001, "phone", 0.9, HashAlgorithm::WyHash, ProbeStrategy::RobinHood);
+    for (int i = 0; i < 3500; i++) {
+        linear.insert(Record("", std::to_string(i), ""));
+        robin.insert(Record("", std::to_string(i), ""));
+    }
+    double difference = linear.getMeanProbeDistance() - robin.getMeanProbeDistance();
+    assert(difference < 1e-9 && difference > -1e-9);
+    assert(robin.getMaxProbeDistance() <= linear.getMaxProbeDistance());
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+/**
+ * @brief Directory entry keyed by a numeric phone number
+ */
+struct NumericEntry {
+    uint64_t phone;
+    std::string username;
+};
+
+struct NumericPhoneKey {
+    uint64_t operator()(const NumericEntry& entry) const { return entry.phone; }
+};
+
+struct RecordUsernameKey {
+    const std::string& operator()(const Record& record) const { return record.username; }
+};
+
+typedef BasicHashTable<std::string, Record, RecordUsernameKey, StringHash, std::equal_to<>> RecordTable;
+
+void testTemplateKeys() {
+    std::cout << "Test 16: Template Key Types... ";
+    
+    const ProbeStrategy strategies[] = {
+        ProbeStrategy::Linear, ProbeStrategy::Quadratic,
+        ProbeStrategy::DoubleHashing, ProbeStrategy::RobinHood
+    };
+    
+    // Integer keys hash directly, without formatting to a string
+    for (ProbeStrategy strategy : strategies) {
+        BasicHashTable<uint64_t, NumericEntry, NumericPhoneKey> ht(17, 0.75, strategy);
+        for (uint64_t i = 0; i < 3000; i++) {
+            assert(ht.insert(NumericEntry{5550000000ULL + i, "User" + std::to_string(i)}) == true);
+        }
+        assert(ht.insert(NumericEntry{5550000000ULL, "Dup"}) == false);
+        for (uint64_t i = 0; i < 3000; i += 2) {
+            assert(ht.remove(5550000000ULL + i) == true);
+        }
+        
+        assert(ht.getCount() == 1500);
+        for (uint64_t i = 0; i < 3000; i++) {
+            const NumericEntry* found = ht.search(5550000000ULL + i);
+            assert((found != nullptr) == (i % 2 == 1));
+            if (found) {
+                assert(found->username == "User" + std::to_string(i));
+            }
+        }
+        assert(ht.search(5559999999ULL) == nullptr);
+    }
+    
+    // The directory tables are instantiations of the same engine
+    RecordStore store;
+    UsernameKey keyOf;
+    keyOf.store = &store;
+    UsernameTable users(11, 0.75, ProbeStrategy::Linear, StringHash(), keyOf);
+    uint32_t alice = store.add("Alice", "555-0001", "");
+    assert(users.insert(alice) == true);
+    assert(*users.search("Alice") == alice);
+    assert(users.search("555-0001") == nullptr);
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testHeterogeneousLookup() {
+    std::cout << "Test 17: Heterogeneous Lookup... ";
+    
+    // Keys longer than the small string buffer, so any copy would allocate
+    std::vector<std::string> keys;
+    for (int i = 0; i < 2000; i++) {
+        keys.push_back("directory-user-with-a-long-name-" + std::to_string(i));
+    }
+    const std::string missing = "directory-user-who-is-not-present";
+    
+    size_t before = heapAllocations;
+    std::string copy(missing);
+    assert(heapAllocations == before + 1);  // The counter sees string copies
+    
+    const ProbeStrategy strategies[] = {
+        ProbeStrategy::Linear, ProbeStrategy::Quadratic,
+        ProbeStrategy::DoubleHashing, ProbeStrategy::RobinHood
+    };
+    
+    for (ProbeStrategy strategy : strategies) {
+        RecordTable engine(7, 0.75, strategy);
+        HashTable ht(7, "username", 0.75, HashAlgorithm::WyHash, strategy);
+        for (const std::string& key : keys) {
+            engine.insert(Record(key, "555-0000", ""));
+            ht.insert(Record(key, "555-0000", ""));
+        }
+        
+        before = heapAllocations;
+        int found = 0;
+        for (const std::string& key : keys) {
+            std::string_view view(key);
+            found += engine.search(view) != nullptr;
+            found += engine.search(key.c_str()) != nullptr;
+            found += engine.contains(view);
+            found += engine.getSearchLength(view) > 0;
+            found += ht.search(view) != std::nullopt;
+            found += ht.contains(key.c_str());
+            found += ht.getSearchLength(view) > 0;
+        }
+        found += engine.contains(std::string_view(missing)) + ht.contains(missing);
+        for (size_t i = 0; i < keys.size(); i += 2) {
+            found += engine.remove(std::string_view(keys[i]));
+            found += ht.remove(keys[i].c_str());
+        }
+        assert(heapAllocations == before);  // Lookup path never allocates
+        
+        assert(found == 7 * 2000 + 2 * 1000);
+        assert(engine.getCount() == 1000 && ht.getCount() == 1000);
+        assert(!engine.contains(std::string_view(keys[0])) && engine.contains(keys[1].c_str()));
+    }
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testStringArena() {
+    std::cout << "Test 18: String Arena... ";
+    
+    StringArena arena;
+    StringRef empty = arena.append("");
+    StringRef name = arena.append("Alice");
+    std::string large(StringArena::CHUNK_SIZE + 100, 'x');
+    StringRef big = arena.append(large);
+    StringRef after = arena.append("Bob");
+    assert(arena.view(empty).empty());
+    assert(arena.view(name) == "Alice");
+    assert(arena.view(big) == large);    // Oversized strings get their own chunk
+    assert(arena.view(after) == "Bob");
+    assert(arena.getUsedBytes() == 5 + large.size() + 3);
+    
+    arena.release(big);
+    assert(arena.getLiveBytes() == 8);
+    assert(arena.shouldCompact());
+    arena.clear();
+    assert(arena.getUsedBytes() == 0 && arena.getReservedBytes() == 0);
+    
+    // Removing most records rebuilds the table's arena; lookups stay valid
+    HashTable ht(101, "phone");
+    const std::string address(200, 'a');
+    for (int i = 0; i < 40000; i++) {
+        assert(ht.insert(Record("User" + std::to_string(i), std::to_string(i), address)) == true);
+    }
+    size_t fullBytes = ht.getStringBytes();
+    for (int i = 0; i < 40000; i++) {
+        if (i % 10 != 0) {
+            assert(ht.remove(std::to_string(i)) == true);
+        }
+    }
+    assert(ht.getStringBytes() < fullBytes / 2);
+    for (int i = 0; i < 40000; i++) {
+        std::optional<RecordView> found = ht.search(std::to_string(i));
+        assert((found != std::nullopt) == (i % 10 == 0));
+        if (found) {
+            assert(found->username == "User" + std::to_string(i));
+            assert(found->address == address);
+        }
+    }
+    
+    ht.clear();
+    assert(ht.getCount() == 0 && ht.getStringBytes() == 0);
+    assert(ht.insert(Record("Alice", "555-0001", "Main St")) == true);
+    assert(ht.search("555-0001")->address == "Main St");
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testPhoneDirectory() {
+    std::cout << "Test 19: Phone Directory... ";
+    
+    const ProbeStrategy strategies[] = {
+        ProbeStrategy::Linear, ProbeStrategy::Quadratic,
+        ProbeStrategy::DoubleHashing, ProbeStrategy::RobinHood
+    };
+    
+    for (ProbeStrategy strategy : strategies) {
+        PhoneDirectory directory(7, 0.75, HashAlgorithm::WyHash, strategy);
+        for (int i = 0; i < 3000; i++) {
+            assert(directory.insert(Record("User" + std::to_string(i), "555-" + std::to_string(i), "Street")) == true);
+        }
+        
+        // A duplicate in either index rejects the record without storing it
+        assert(directory.insert(Record("User1", "555-new", "")) == false);
+        assert(directory.insert(Record("NewUser", "555-1", "")) == false);
+        assert(directory.insert(Record("", "555-x", "")) == false);
+        assert(directory.getCount() == 3000);
+        assert(directory.getUsernameTable().getCount() == 3000);
+        assert(directory.getPhoneTable().getCount() == 3000);
+        assert(directory.searchByPhone("555-new") == std::nullopt);
+        
+        // Removing by either key drops the record from both indexes
+        for (int i = 0; i < 3000; i += 2) {
+            if (i % 4 == 0) {
+                assert(directory.removeByUsername("User" + std::to_string(i)) == true);
+            } else {
+                assert(directory.removeByPhone("555-" + std::to_string(i)) == true);
+            }
+        }
+        assert(directory.removeByUsername("User0") == false);
+        assert(directory.removeByPhone("555-2") == false);
+        assert(directory.getCount() == 1500);
+        assert(directory.getUsernameTable().getCount() == 1500);
+        assert(directory.getPhoneTable().getCount() == 1500);
+        
+        for (int i = 0; i < 3000; i++) {
+            std::optional<RecordView> byName = directory.searchByUsername("User" + std::to_string(i));
+            std::optional<RecordView> byPhone = directory.searchByPhone("555-" + std::to_string(i));
+            assert((byName != std::nullopt) == (i % 2 == 1));
+            assert((byPhone != std::nullopt) == (i % 2 == 1));
+            if (byName) {
+                assert(byName->phoneNumber == "555-" + std::to_string(i));
+                assert(byPhone->username == "User" + std::to_string(i));
+            }
+        }
+        
+        // Both indexes resolve a key to the same record ID
+        uint32_t id = directory.getUsernameTable().findId("User1");
+        assert(id != RecordStore::NO_RECORD);
+        assert(directory.getPhoneTable().findId("555-1") == id);
+        
+        directory.clear();
+        assert(directory.getCount() == 0 && directory.getPhoneTable().getCount() == 0);
+        assert(directory.insert(Record("Alice", "555-0001", "Main St")) == true);
+        assert(directory.searchByPhone("555-0001")->address == "Main St");
+    }
+    
+    // Removed IDs are reused by later inserts
+    RecordStore store;
+    uint32_t first = store.add("Alice", "555-0001", "");
+    uint32_t second = store.add("Bob", "555-0002", "");
+    store.remove(first);
+    assert(store.add("Carol", "555-0003", "") == first);
+    assert(store.view(first).username == "Carol" && store.username(second) == "Bob");
+    assert(store.getCount() == 2);
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testAtomicDirectoryWrites() {
+    std::cout << "Test 20: Atomic Directory Writes... ";
+    
+    const ProbeStrategy strategies[] = {
+        ProbeStrategy::Linear, ProbeStrategy::Quadratic,
+        ProbeStrategy::DoubleHashing, ProbeStrategy::RobinHood
+    };
+    
+    for (ProbeStrategy strategy : strategies) {
+        // A phone clash after the username table reserved its slot, growing
+        // if needed, must leave no username entry or tombstone behind
+        PhoneDirectory directory(7, 0.75, HashAlgorithm::WyHash, strategy);
+        for (int i = 0; i < 5; i++) {
+            assert(directory.insert(Record("User" + std::to_string(i), "555-" + std::to_string(i), "")) == true);
+        }
+        assert(directory.insert(Record("NewUser", "555-3", "")) == false);
+        assert(!directory.getUsernameTable().contains("NewUser"));
+        assert(directory.getUsernameTable().getCount() == 5);
+        for (int i = 0; i < directory.getUsernameTable().getSlotCount(); i++) {
+            assert(!directory.getUsernameTable().getRecordAt(i)->isDeleted);
+        }
+        assert(directory.checkConsistency().isConsistent());
+        assert(directory.insert(Record("NewUser", "555-new", "")) == true);
+        assert(directory.searchByPhone("555-new")->username == "NewUser");
+        
+        // Random inserts and deletes by either key keep the indexes in step
+        std::mt19937 rng(42);
+        std::vector<bool> present(4000, false);
+        int expected = directory.getCount();
+        for (int op = 0; op < 40000; op++) {
+            int i = static_cast<int>(rng() % present.size());
+            std::string name = "Member" + std::to_string(i);
+            std::string phone = "666-" + std::to_string(i);
+            if (!present[i]) {
+                assert(directory.insert(Record(name, phone, "Street")) == true);
+                expected++;
+            } else if (rng() % 2 == 0) {
+                assert(directory.removeByUsername(name) == true);
+                expected--;
+            } else {
+                assert(directory.removeByPhone(phone) == true);
+                expected--;
+            }
+            present[i] = !present[i];
+        }
+        
+        ConsistencyReport report = directory.checkConsistency();
+        assert(report.isConsistent());
+        assert(report.records == expected && directory.getCount() == expected);
+        assert(report.usernameEntries == expected && report.phoneEntries == expected);
+    }
+    
+    // The checker reports indexes that have drifted apart
+    std::shared_ptr<RecordStore> store = std::make_shared<RecordStore>();
+    HashTable usernames(store, 11, "username");
+    HashTable phones(store, 11, "phone");
+    for (int i = 0; i < 3; i++) {
+        uint32_t id = store->add("User" + std::to_string(i), "555-" + std::to_string(i), "");
+        assert(usernames.link(id) && phones.link(id));
+    }
+    assert(PhoneDirectory::checkIndexes(*store, usernames, phones).isConsistent());
+    
+    uint32_t unlinked = phones.unlink("555-1");
+    ConsistencyReport report = PhoneDirectory::checkIndexes(*store, usernames, phones);
+    assert(!report.isConsistent());
+    assert(report.unmatched == 1 && report.phoneEntries == 2 && report.dangling == 0);
+    
+    store->remove(unlinked);
+    report = PhoneDirectory::checkIndexes(*store, usernames, phones);
+    assert(report.dangling == 1 && report.records == 2);
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testConcurrentHashTable() {
+    std::cout << "Test 21: Concurrent Hash Table... ";
+    
+    // Same semantics as HashTable on one thread
+    ConcurrentHashTable table(7, "phone");
+    assert(table.insert(Record("Alice", "555-0001", "Main St")) == true);
+    assert(table.insert(Record("Alice2", "555-0001", "")) == false);
+    assert(table.insert(Record("Nobody", "", "")) == false);
+    assert(table.search("555-0001")->username == "Alice");
+    assert(table.search("555-9999") == std::nullopt);
+    assert(table.remove("555-0001") == true && table.remove("555-0001") == false);
+    assert(!table.contains("555-0001") && table.getCount() == 0);
+    
+    // Writers grow the table while readers look up keys that never change
+    const int threads = 4;
+    const int perThread = 5000;
+    ConcurrentHashTable shared(7, "username");
+    for (int i = 0; i < 1000; i++) {
+        assert(shared.insert(Record("Stable" + std::to_string(i), std::to_string(i), "")) == true);
+    }
+    
+    std::atomic<bool> readersFailed(false);
+    std::atomic<int> writersDone(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            for (int i = 0; i < perThread; i++) {
+                std::string name = "Writer" + std::to_string(t) + "-" + std::to_string(i);
+                assert(shared.insert(Record(name, std::to_string(i), "")) == true);
+                if (i % 2 == 0) {
+                    assert(shared.remove(name) == true);
+                }
+            }
+            writersDone++;
+        });
+        workers.emplace_back([&, t]() {
+            for (int round = 0; writersDone < threads; round++) {
+                int i = (round * 7 + t) % 1000;
+                std::optional<Record> found = shared.search("Stable" + std::to_string(i));
+                if (!found || found->phoneNumber != std::to_string(i)) {
+                    readersFailed = true;
+                }
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    
+    assert(!readersFailed);
+    assert(shared.getCount() == 1000 + threads * perThread / 2);
+    for (int t = 0; t < threads; t++) {
+        for (int i = 0; i < perThread; i++) {
+            std::string name = "Writer" + std::to_string(t) + "-" + std::to_string(i);
+            assert(shared.contains(name) == (i % 2 == 1));
+        }
+    }
+    
+    shared.reclaim();
+    assert(shared.getRetiredCount() == 0);
+    assert(shared.search("Stable5")->phoneNumber == "5");
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+// Counts deletions of retired objects
+struct Tracked {
+    std::atomic<int>* deleted;
+    ~Tracked() { (*deleted)++; }
+};
+
+void testEpochReclamation() {
+    std::cout << "Test 22: Epoch Reclamation... ";
+    
+    // A retired object outlives every guard that was active when it was retired
+    std::atomic<int> deleted(0);
+    {
+        EpochManager epochs;
+        {
+            EpochManager::Guard reader(epochs);
+            epochs.retire(new Tracked{&deleted});
+            for (int i = 0; i < 5; i++) {
+                epochs.collect();
+            }
+            assert(deleted == 0 && epochs.getPendingCount() == 1);
+        }
+        epochs.collect();
+        epochs.collect();
+        assert(deleted == 1 && epochs.getPendingCount() == 0);
+        
+        epochs.retire(new Tracked{&deleted});
+    }
+    assert(deleted == 2);  // The manager deletes what is still pending
+    
+    // Stress: searches, inserts and removes on overlapping keys while the
+    // table grows from a few slots; run under -fsanitize=thread to check
+    // that no lookup touches a freed entry or slot array
+    const int threads = 8;
+    const int keys = 2000;
+    ConcurrentHashTable table(5, "phone");
+    std::atomic<int> inserted(0);
+    std::atomic<int> removed(0);
+    std::atomic<bool> wrongRecord(false);
+    std::vector<std::thread> workers;
+    std::cerr.setstate(std::ios::failbit);  // Silence the expected duplicate errors
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 rng(t);
+            for (int op = 0; op < 20000; op++) {
+                int i = static_cast<int>(rng() % keys);
+                std::string phone = "555-" + std::to_string(i);
+                switch (rng() % 4) {
+                case 0:
+                    inserted += table.insert(Record("User" + std::to_string(i), phone, "Street"));
+                    break;
+                case 1:
+                    removed += table.remove(phone);
+                    break;
+                default: {
+                    std::optional<Record> found = table.search(phone);
+                    if (found && found->username != "User" + std::to_string(i)) {
+                        wrongRecord = true;
+                    }
+                    break;
+                }
+                }
+                if (op % 5000 == 0) {
+                    table.reclaim();
+                }
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    std::cerr.clear();
+    
+    assert(!wrongRecord);
+    assert(table.getCount() == inserted - removed);
+    int present = 0;
+    for (int i = 0; i < keys; i++) {
+        present += table.contains("555-" + std::to_string(i));
+    }
+    assert(present == table.getCount());
+    
+    table.reclaim();
+    assert(table.getRetiredCount() == 0);
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testShardedDirectory() {
+    std::cout << "Test 23: Sharded Directory... ";
+    
+    ShardedDirectory directory(4, 11);
+    for (int i = 0; i < 2000; i++) {
+        assert(directory.insert(Record("User" + std::to_string(i), "555-" + std::to_string(i), "Street")) == true);
+    }
+    
+    // Both reservations must succeed; a clash in either shard stores nothing
+    assert(directory.insert(Record("User1", "555-new", "")) == false);
+    assert(directory.insert(Record("NewUser", "555-1", "")) == false);
+    assert(directory.searchByPhone("555-new") == std::nullopt);
+    assert(directory.searchByUsername("NewUser") == std::nullopt);
+    assert(directory.getCount() == 2000);
+    
+    assert(directory.searchByPhone("555-7")->username == "User7");
+    assert(directory.searchByUsername("User7")->phoneNumber == "555-7");
+    assert(directory.removeByUsername("User7") == true);
+    assert(directory.searchByPhone("555-7") == std::nullopt);
+    assert(directory.removeByPhone("555-8") == true);
+    assert(directory.searchByUsername("User8") == std::nullopt);
+    assert(directory.removeByPhone("555-8") == false);
+    
+    // Keys are spread over every shard and the totals add up
+    std::vector<ShardStats> shards = directory.getShardStats();
+    assert(static_cast<int>(shards.size()) == 4);
+    std::vector<TableStats> usernames;
+    std::vector<TableStats> phones;
+    for (const ShardStats& shard : shards) {
+        assert(shard.username.count > 300 && shard.phone.count > 300);
+        usernames.push_back(shard.username);
+        phones.push_back(shard.phone);
+    }
+    TableStats total = ShardedDirectory::combine(usernames);
+    assert(total.count == 1998 && ShardedDirectory::combine(phones).count == 1998);
+    assert(total.loadFactor > 0.0 && total.loadFactor < 1.0);
+    assert(total.averageSearchLength >= 1.0);
+    
+    // A record is stored in full once; phone shards hold key-only copies of the rest
+    int stored = 0;
+    for (const ShardStats& shard : shards) {
+        stored += shard.storedRecords;
+    }
+    assert(stored > 1998 && stored < 2 * 1998);
+    for (int i = 100; i < 200; i++) {
+        std::optional<Record> found = directory.searchByPhone("555-" + std::to_string(i));
+        assert(found->username == "User" + std::to_string(i) && found->address == "Street");
+    }
+    assert(directory.getSearchLength("User100", true) >= 1 && directory.getSearchLength("555-7", false) == -1);
+    
+    // Records copied out load back into another directory
+    std::vector<Record> records = directory.getRecords();
+    assert(records.size() == 1998);
+    ShardedDirectory copy(3, 7);
+    assert(copy.insertAll(records) == 1998);
+    assert(copy.searchByPhone("555-1999")->address == "Street");
+    auto storedIn = [](ShardedDirectory& sharded) {
+        int total = 0;
+        for (const ShardStats& shard : sharded.getShardStats()) {
+            total += shard.storedRecords;
+        }
+        return total;
+    };
+    int storedBefore = storedIn(copy);
+    assert(copy.removeByPhone("555-1999") == true && copy.searchByUsername("User1999") == std::nullopt);
+    assert(copy.removeByUsername("User1998") == true && copy.searchByPhone("555-1998") == std::nullopt);
+    int freed = storedBefore - storedIn(copy);  // One entry per record, two if its keys' shards differ
+    assert(freed >= 2 && freed <= 4);
+    
+    // Clients on several threads racing for the same usernames: exactly one wins each
+    std::atomic<int> wins(0);
+    std::vector<std::thread> clients;
+    std::cerr.setstate(std::ios::failbit);  // Silence the expected duplicate errors
+    for (int t = 0; t < 4; t++) {
+        clients.emplace_back([&, t]() {
+            for (int i = 0; i < 500; i++) {
+                wins += directory.insert(Record("Racer" + std::to_string(i),
+                                                "666-" + std::to_string(t) + "-" + std::to_string(i), ""));
+            }
+        });
+    }
+    for (std::thread& client : clients) {
+        client.join();
+    }
+    std::cerr.clear();
+    
+    assert(wins == 500);
+    assert(directory.getCount() == 1998 + 500);
+    for (int i = 0; i < 500; i++) {
+        std::optional<Record> racer = directory.searchByUsername("Racer" + std::to_string(i));
+        assert(racer && directory.searchByPhone(racer->phoneNumber)->username == racer->username);
+    }
+    
+    directory.clear();
+    assert(directory.getCount() == 0);
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testBatchSearch() {
+    std::cout << "Test 24: Batch Search... ";
+    
+    const ProbeStrategy strategies[] = {
+        ProbeStrategy::Linear, ProbeStrategy::Quadratic,
+        ProbeStrategy::DoubleHashing, ProbeStrategy::RobinHood
+    };
+    
+    for (ProbeStrategy strategy : strategies) {
+        HashTable table(7, "phone", 0.75, HashAlgorithm::WyHash, strategy);
+        
+        // Keys present, removed and never inserted, more than one chunk of them
+        std::vector<std::string> keys;
+        for (int i = 0; i < 300; i++) {
+            keys.push_back("555-" + std::to_string(i));
+        }
+        std::vector<std::string_view> views(keys.begin(), keys.end());
+        std::vector<std::optional<RecordView>> results(views.size());
+        
+        bool sawResize = false;
+        for (int i = 0; i < 200; i++) {
+            assert(table.insert(Record("User" + std::to_string(i), keys[i], "Street")) == true);
+            if (i % 5 == 4) {
+                assert(table.remove(keys[i - 2]) == true);
+            }
+            
+            // Batches agree with single searches, also while a resize is under way
+            sawResize = sawResize || table.isResizing();
+            table.searchBatch(views.data(), static_cast<int>(views.size()), results.data());
+            for (size_t k = 0; k < views.size(); k++) {
+                std::optional<RecordView> single = table.search(views[k]);
+                assert((results[k] != std::nullopt) == (single != std::nullopt));
+                if (single) {
+                    assert(results[k]->phoneNumber == views[k]);
+                    assert(results[k]->username == single->username);
+                }
+            }
+        }
+        assert(sawResize);
+        
+        table.searchBatch(views.data(), 0, results.data());
+        table.searchBatch(views.data() + 250, 1, results.data());
+        assert(results[0] == std::nullopt);
+    }
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testBulkInsert() {
+    std::cout << "Test 25: Bulk Insert... ";
+    
+    const ProbeStrategy strategies[] = {
+        ProbeStrategy::Linear, ProbeStrategy::Quadratic,
+        ProbeStrategy::DoubleHashing, ProbeStrategy::RobinHood
+    };
+    
+    std::cerr.setstate(std::ios::failbit);  // Silence the expected duplicate errors
+    for (ProbeStrategy strategy : strategies) {
+        PhoneDirectory directory(7, 0.75, HashAlgorithm::WyHash, strategy);
+        for (int i = 0; i < 100; i++) {
+            directory.insert(Record("User" + std::to_string(i), "555-" + std::to_string(i), "Street"));
+        }
+        
+        // Clashes with stored records and within the batch, in either key
+        std::vector<Record> batch;
+        for (int i = 50; i < 3000; i++) {
+            batch.push_back(Record("User" + std::to_string(i), "555-" + std::to_string(i), "Avenue"));
+        }
+        batch.push_back(Record("User2999", "555-new", ""));
+        batch.push_back(Record("NewUser", "555-2999", ""));
+        batch.push_back(Record("", "555-empty", ""));
+        batch.push_back(Record("Last", "555-last", "End"));
+        
+        assert(directory.bulkInsert(batch) == 2901);
+        assert(directory.getCount() == 3001);
+        assert(directory.checkConsistency().isConsistent());
+        assert(directory.searchByUsername("User10")->address == "Street");
+        assert(directory.searchByUsername("User2000")->phoneNumber == "555-2000");
+        assert(directory.searchByPhone("555-new") == std::nullopt);
+        assert(directory.searchByUsername("NewUser") == std::nullopt);
+        assert(directory.searchByPhone("555-last")->username == "Last");
+        
+        // Rolled back links leave no tombstones behind
+        assert(directory.getUsernameTable().getStats().tombstones == 0);
+        assert(directory.getPhoneTable().getStats().tombstones == 0);
+        
+        // A key freed by a rejected record goes to the next record carrying it,
+        // as with one insert per record
+        std::vector<Record> claims = {
+            Record("Claim1", "555-c1", ""), Record("Claim1", "555-c2", ""), Record("Claim3", "555-c2", "")
+        };
+        assert(directory.bulkInsert(claims) == 2);
+        assert(directory.searchByPhone("555-c2")->username == "Claim3");
+        assert(directory.getUsernameTable().getStats().tombstones == 0);
+        assert(directory.getPhoneTable().getStats().tombstones == 0);
+        assert(directory.checkConsistency().isConsistent());
+        
+        // The table keeps working normally afterwards
+        assert(directory.removeByPhone("555-1500") == true);
+        assert(directory.insert(Record("User1500", "555-1500", "")) == true);
+        assert(directory.checkConsistency().isConsistent());
+    }
+    
+    // Enough records to hash on several threads, loaded into a table mid-resize
+    HashTable table(7, "phone");
+    for (int i = 0; i < 6; i++) {
+        table.insert(Record("", "555-" + std::to_string(i), ""));
+    }
+    std::vector<Record> records;
+    for (int i = 0; i < 200000; i++) {
+        records.push_back(Record("", "555-" + std::to_string(i), ""));
+    }
+    assert(table.bulkInsert(records) == 200000 - 6);
+    assert(table.getCount() == 200000);
+    assert(table.getLoadFactor() <= 0.75);
+    for (int i = 0; i < 200000; i += 997) {
+        assert(table.search("555-" + std::to_string(i)) != std::nullopt);
+    }
+    std::cerr.clear();
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testMappedLoader() {
+    std::cout << "Test 26: Memory-Mapped Loader... ";
+    
+    // CRLF, blanks, quoted fields with commas, newlines and doubled quotes,
+    // rejected lines, and a last line without a newline
+    const char* text =
+        "Alice,111, 1 Main St, Apt 4\r\n"
+        "\r\n"
+        "  Bob ,\t222\t,\"2 Elm St, Floor 3\"\r\n"
+        "\"Carol \"\"CJ\"\" Jones\",\"333\",Oak\n"
+        "\"Dave\nSmith\",444,\n"
+        "NoPhone\n"
+        ",555,Nobody\n"
+        "Eve,666";
+    std::vector<RecordView> records;
+    std::deque<std::string> unescaped;
+    FileHandler::parseRecords(text, records, unescaped);
+    
+    assert(records.size() == 5);
+    assert(records[0].username == "Alice" && records[0].phoneNumber == "111");
+    assert(records[0].address == "1 Main St, Apt 4");
+    assert(records[1].username == "Bob" && records[1].phoneNumber == "222");
+    assert(records[1].address == "2 Elm St, Floor 3");
+    assert(records[2].username == "Carol \"CJ\" Jones" && records[2].phoneNumber == "333");
+    assert(records[2].address == "Oak");
+    assert(records[3].username == "Dave\nSmith" && records[3].address.empty());
+    assert(records[4].username == "Eve" && records[4].phoneNumber == "666");
+    assert(unescaped.size() == 1);
+    
+    // An unclosed quote, or text after a closing one, is read as written
+    // and ends at the line end
+    records.clear();
+    FileHandler::parseRecords("Fay,777,\"Apt 5\nGus,888,\"Elm\" St\nHal,999,x\n",
+                              records, unescaped);
+    assert(records.size() == 3);
+    assert(records[0].address == "\"Apt 5" && records[1].address == "\"Elm\" St");
+    assert(records[2].username == "Hal");
+    
+    // Whatever the fields hold, a saved table loads back unchanged
+    {
+        const Record tricky[] = {
+            Record("Ann", "100", "Apt 5\", Main St"),
+            Record("Ben, Jr.", "101", "\"Unclosed, 2 Elm St"),
+            Record(" Cal", "102", "Line one\r\nLine two "),
+            Record("Dee \"D\"", "\"103\"", ",,"),
+            Record("Eli", "104", "")
+        };
+        HashTable table(11, "username");
+        for (const auto& record : tricky) {
+            assert(table.insert(record));
+        }
+        assert(table.saveToFile("test_quoted.txt"));
+        std::vector<Record> loaded = FileHandler::readRecordsFromFile("test_quoted.txt");
+        assert(loaded.size() == 5);
+        for (const auto& record : tricky) {
+            auto found = std::find_if(loaded.begin(), loaded.end(), [&](const Record& r) {
+                return r.username == record.username;
+            });
+            assert(found != loaded.end());
+            assert(found->phoneNumber == record.phoneNumber && found->address == record.address);
+        }
+        
+        std::vector<Record> copy(std::begin(tricky), std::end(tricky));
+        assert(FileHandler::writeRecordsToFile(copy, "test_quoted.txt"));
+        loaded = FileHandler::readRecordsFromFile("test_quoted.txt");
+        assert(loaded.size() == 5);
+        for (size_t i = 0; i < loaded.size(); i++) {
+            assert(loaded[i].username == copy[i].username);
+            assert(loaded[i].phoneNumber == copy[i].phoneNumber);
+            assert(loaded[i].address == copy[i].address);
+        }
+        std::remove("test_quoted.txt");
+    }
+    
+    // Through a mapping, into a directory
+    {
+        std::ofstream file("test_mapped.txt", std::ios::binary);
+        file << text;
+    }
+    MappedRecords mapped;
+    assert(FileHandler::mapRecordsFromFile("test_mapped.txt", mapped) == true);
+    assert(mapped.records.size() == 5);
+    assert(FileHandler::readRecordsFromFile("test_mapped.txt").size() == 5);
+    
+    PhoneDirectory directory(7);
+    assert(directory.loadFromFile("test_mapped.txt") == 5);
+    assert(directory.searchByPhone("222")->address == "2 Elm St, Floor 3");
+    assert(directory.checkConsistency().isConsistent());
+    std::remove("test_mapped.txt");
+    
+    { std::ofstream empty("test_empty.txt"); }
+    assert(FileHandler::mapRecordsFromFile("test_empty.txt", mapped) == true);
+    assert(mapped.records.empty());
+    std::remove("test_empty.txt");
+    assert(FileHandler::mapRecordsFromFile("test_missing.txt", mapped) == false);
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testSnapshot() {
+    std::cout << "Test 27: Binary Snapshot... ";
+    
+    const ProbeStrategy strategies[] = {
+        ProbeStrategy::Linear, ProbeStrategy::Quadratic,
+        ProbeStrategy::DoubleHashing, ProbeStrategy::RobinHood
+    };
+    
+    std::cout.setstate(std::ios::failbit);  // Silence the load and save messages
+    std::cerr.setstate(std::ios::failbit);
+    for (ProbeStrategy strategy : strategies) {
+        PhoneDirectory directory(7, 0.75, HashAlgorithm::WyHash, strategy);
+        for (int i = 0; i < 3000; i++) {
+            directory.insert(Record("User" + std::to_string(i), "555-" + std::to_string(i),
+                                    std::string(i % 7 == 0 ? 5000 : 10, 'a')));  // Some fields span chunks
+        }
+        for (int i = 0; i < 3000; i += 3) {
+            directory.removeByUsername("User" + std::to_string(i));
+        }
+        directory.insert(Record("Last", "555-last", "End"));  // Reuses a free ID
+        bool resizing = directory.getUsernameTable().isResizing();
+        assert(directory.saveSnapshot("test_snapshot.bin") == true);
+        
+        PhoneDirectory restored(7, 0.75, HashAlgorithm::WyHash, strategy);
+        restored.insert(Record("Old", "555-old", ""));
+        assert(restored.loadSnapshot("test_snapshot.bin") == true);
+        assert(restored.getCount() == 2001);
+        assert(restored.getUsernameTable().isResizing() == resizing);
+        assert(restored.getUsernameTable().getSize() == directory.getUsernameTable().getSize());
+        assert(restored.searchByUsername("Old") == std::nullopt);
+        assert(restored.searchByUsername("User3") == std::nullopt);
+        assert(restored.searchByPhone("555-7")->address == std::string(5000, 'a'));
+        assert(restored.searchByUsername("Last")->phoneNumber == "555-last");
+        assert(restored.checkConsistency().isConsistent());
+        
+        // The restored directory keeps working, free list included
+        assert(restored.removeByPhone("555-1") == true);
+        assert(restored.insert(Record("User3", "555-3", "")) == true);
+        assert(restored.insert(Record("User4", "555-x", "")) == false);
+        assert(restored.checkConsistency().isConsistent());
+        
+        // loadFromFile recognises a snapshot; into a non-empty directory it merges
+        PhoneDirectory merged(7, 0.75, HashAlgorithm::WyHash, strategy);
+        merged.insert(Record("Other", "555-other", ""));
+        merged.insert(Record("User2", "555-2", "kept"));
+        assert(merged.loadFromFile("test_snapshot.bin") == 2000);
+        assert(merged.getCount() == 2002);
+        assert(merged.searchByUsername("User2")->address == "kept");
+        assert(merged.checkConsistency().isConsistent());
+    }
+    
+    // Another probe strategy or a damaged byte is rejected and changes nothing
+    PhoneDirectory robinHood(7, 0.75, HashAlgorithm::WyHash, ProbeStrategy::RobinHood);
+    robinHood.insert(Record("Keep", "555-keep", ""));
+    PhoneDirectory linear(7);
+    linear.insert(Record("Keep", "555-keep", ""));
+    assert(linear.loadSnapshot("test_snapshot.bin") == false);
+    {
+        std::fstream file("test_snapshot.bin", std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(200);
+        file.put('\x7f');
+    }
+    assert(robinHood.loadSnapshot("test_snapshot.bin") == false);
+    assert(robinHood.getCount() == 1 && robinHood.searchByUsername("Keep") != std::nullopt);
+    assert(robinHood.loadSnapshot("test_missing.bin") == false);
+
+    // Crafted payloads with valid checksums: references, sizes and record
+    // IDs out of bounds are rejected before anything reads through them
+    PhoneDirectory small(64);
+    for (int i = 0; i < 4; i++) {
+        small.insert(Record("User" + std::to_string(i), "555-" + std::to_string(i), "Street"));
+    }
+    small.removeByUsername("User1");  // ID 1 heads the free list
+    assert(small.saveSnapshot("test_snapshot.bin") == true);
+    std::string saved;
+    {
+        std::ifstream file("test_snapshot.bin", std::ios::binary);
+        saved.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    auto loadsWith = [&saved](size_t offset, const void* bytes, size_t length) {
+        std::string tampered = saved;
+        std::memcpy(&tampered[sizeof(SnapshotHeader) + offset], bytes, length);
+        std::string_view payload = std::string_view(tampered).substr(sizeof(SnapshotHeader));
+        SnapshotHeader header;
+        std::memcpy(&header, tampered.data(), sizeof(header));
+        header.checksum = SnapshotHeader::checksumOf(payload);
+        std::memcpy(&tampered[0], &header, sizeof(header));
+        std::ofstream("test_snapshot.bin", std::ios::binary | std::ios::trunc) << tampered;
+        PhoneDirectory target(64);
+        return target.loadSnapshot("test_snapshot.bin");
+    };
+    // Payload: free head, count, record array (length, then 24-byte records), arena
+    const size_t recordsAt = 4 + 8 + 8;
+    const size_t arenaAt = recordsAt + 4 * sizeof(PackedRecord);
+    const size_t phoneValuesAt = saved.size() - sizeof(SnapshotHeader) - 64 * sizeof(uint32_t);
+    uint32_t freeId = 1;
+    assert(loadsWith(0, &freeId, sizeof(freeId)) == true);  // Unchanged
+    uint32_t longLength = 1 << 20;
+    assert(loadsWith(recordsAt + 4, &longLength, sizeof(longLength)) == false);  // Past the written bytes
+    uint64_t hugeChunk = uint64_t(1) << 40;
+    assert(loadsWith(arenaAt + 32, &hugeChunk, sizeof(hugeChunk)) == false);  // More than the file holds
+    assert(loadsWith(recordsAt + sizeof(PackedRecord), &freeId, sizeof(freeId)) == false);  // Free list cycle
+    assert(small.getPhoneTable().getSize() == 64);
+    for (uint32_t id : {freeId, 0xFFFF0000u}) {
+        std::vector<uint32_t> slots(64, id);  // A removed record, or none at all
+        assert(loadsWith(phoneValuesAt, slots.data(), slots.size() * sizeof(uint32_t)) == false);
+    }
+    std::remove("test_snapshot.bin");
+    std::cout.clear();
+    std::cerr.clear();
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testWriteAheadLog() {
+    std::cout << "Test 28: Write-Ahead Log... ";
+    
+    const char* logFile = "test_log.wal";
+    const char* snapshotFile = "test_log.snapshot";
+    std::remove(logFile);
+    std::remove(snapshotFile);
+    LogOptions immediate;
+    immediate.commitDelay = std::chrono::microseconds(0);
+    
+    std::cout.setstate(std::ios::failbit);  // Silence the replay and checkpoint messages
+    std::cerr.setstate(std::ios::failbit);
+    {
+        PhoneDirectory directory(7);
+        assert(directory.openLog(logFile, snapshotFile, immediate) == 0);
+        for (int i = 0; i < 100; i++) {
+            directory.insert(Record("User" + std::to_string(i), "555-" + std::to_string(i), "Addr"));
+        }
+        assert(directory.insert(Record("User5", "555-dup", "")) == false);  // Not logged
+        directory.removeByUsername("User1");
+        directory.removeByPhone("555-2");
+        directory.insert(Record("User1", "555-new", "Back"));
+        assert(directory.getLog()->getSyncCount() == 103);  // One fsync per change
+    }   // Never saved: only the log holds the changes
+    
+    // A write torn off at the end is dropped; new entries follow the intact ones
+    {
+        std::ofstream file(logFile, std::ios::binary | std::ios::app);
+        file.write("\x40\x00\x00\x00torn", 8);
+    }
+    {
+        PhoneDirectory restored(7);
+        assert(restored.openLog(logFile, snapshotFile, immediate) == 103);
+        assert(restored.getCount() == 99);
+        assert(restored.searchByUsername("User1")->phoneNumber == "555-new");
+        assert(restored.searchByPhone("555-2") == std::nullopt);
+        assert(restored.checkConsistency().isConsistent());
+        restored.insert(Record("Late", "555-late", ""));
+    }
+    
+    // Group commit: many changes share one fsync; sync() commits at once
+    std::string staleLog;
+    {
+        LogOptions grouped;
+        grouped.commitDelay = std::chrono::milliseconds(50);
+        PhoneDirectory directory(7);
+        assert(directory.openLog(logFile, snapshotFile, grouped) == 104);
+        assert(directory.searchByUsername("Late") != std::nullopt);
+        for (int i = 0; i < 1000; i++) {
+            directory.insert(Record("Bulk" + std::to_string(i), "777-" + std::to_string(i), ""));
+        }
+        assert(directory.getLog()->sync() == true);
+        assert(directory.getLog()->getSyncCount() < 100);
+        
+        std::ifstream file(logFile, std::ios::binary);
+        staleLog.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        file.close();
+        
+        // A checkpoint moves everything into the snapshot and empties the log
+        assert(directory.checkpoint() == true);
+        assert(directory.getLog()->getBytes() == 0);
+        directory.removeByUsername("Bulk0");
+        directory.clear();
+        directory.insert(Record("After", "555-after", ""));
+    }
+    {
+        PhoneDirectory restored(7);
+        assert(restored.loadFromFile(snapshotFile) == 1100);
+        assert(restored.openLog(logFile, snapshotFile, immediate) == 3);
+        assert(restored.getCount() == 1);
+        assert(restored.searchByUsername("After") != std::nullopt);
+    }
+    
+    // A crash between the snapshot's rename and the truncation leaves the old
+    // log beside the new snapshot: entries the snapshot holds are skipped
+    {
+        PhoneDirectory directory(7);
+        directory.loadFromFile(snapshotFile);
+        directory.openLog(logFile, snapshotFile, immediate);
+        assert(directory.checkpoint() == true);
+    }
+    {
+        std::ofstream file(logFile, std::ios::binary | std::ios::trunc);
+        file.write(staleLog.data(), static_cast<std::streamsize>(staleLog.size()));
+    }
+    {
+        PhoneDirectory restored(7);
+        restored.loadFromFile(snapshotFile);
+        assert(restored.openLog(logFile, snapshotFile, immediate) == 1104);
+        assert(restored.getCount() == 1);
+        assert(restored.searchByUsername("Bulk5") == std::nullopt);
+    }
+    
+    // The log is checkpointed on its own once it outgrows its limit
+    {
+        LogOptions small = immediate;
+        small.checkpointBytes = 4096;
+        PhoneDirectory directory(7);
+        directory.openLog(logFile, snapshotFile, small);
+        directory.clear();
+        for (int i = 0; i < 500; i++) {
+            directory.insert(Record("Auto" + std::to_string(i), "888-" + std::to_string(i), ""));
+        }
+        assert(directory.getLog()->getBytes() < 4096);
+    }
+    {
+        PhoneDirectory restored(7);
+        restored.loadFromFile(snapshotFile);
+        restored.openLog(logFile, snapshotFile, immediate);
+        assert(restored.getCount() == 500);
+        assert(restored.checkConsistency().isConsistent());
+    }
+
+    // Shards append to the same log, numbered after the directory's changes
+    int checkpoints = 0;
+    auto writer = [&](const std::vector<Record>& records, uint64_t logSequence) {
+        PhoneDirectory staging(7);
+        staging.bulkInsert(records);
+        staging.setLogSequence(logSequence);
+        checkpoints++;
+        return staging.saveSnapshot(snapshotFile);
+    };
+    uint64_t sequence = 0;
+    int earlier = 0;  // Entries left by the directory since its last checkpoint
+    {
+        PhoneDirectory directory(7);
+        directory.loadFromFile(snapshotFile);
+        directory.openLog(logFile, snapshotFile, immediate);
+        sequence = directory.getLogSequence();
+    }
+    {
+        std::vector<Record> records;
+        for (int i = 0; i < 500; i++) {
+            records.push_back(Record("Auto" + std::to_string(i), "888-" + std::to_string(i), ""));
+        }
+        ShardedDirectory shards(4, 7);
+        assert(shards.insertAll(records) == 500);
+        earlier = shards.openLog(logFile, sequence, writer, immediate);
+        assert(earlier >= 0);
+        assert(shards.removeByUsername("Auto0") == true);
+        assert(shards.removeByPhone("888-1") == true);
+        assert(shards.insert(Record("Sharded", "999-1", "Addr")) == true);
+        assert(shards.insert(Record("Auto2", "999-2", "")) == false);  // Not logged
+        assert(shards.getLog()->getSyncCount() == 3);
+        assert(checkpoints == 0);
+    }   // Never saved: only the log holds the changes
+    {
+        PhoneDirectory restored(7);
+        restored.loadFromFile(snapshotFile);
+        assert(restored.openLog(logFile, snapshotFile, immediate) == earlier + 3);
+        assert(restored.getCount() == 499);
+        assert(restored.searchByUsername("Auto0") == std::nullopt);
+        assert(restored.searchByPhone("888-1") == std::nullopt);
+        assert(restored.searchByPhone("999-1")->address == "Addr");
+        sequence = restored.getLogSequence();
+    }
+    {
+        // A checkpoint hands the records to the writer and empties the log
+        ShardedDirectory shards(4, 7);
+        assert(shards.checkpoint() == false);  // No log open
+        shards.openLog(logFile, sequence, writer, immediate);
+        shards.insert(Record("Only", "555-only", ""));
+        assert(shards.checkpoint() == true && checkpoints == 1);
+        assert(shards.getLog()->getBytes() == 0);
+        shards.clear();
+    }
+    {
+        PhoneDirectory restored(7);
+        assert(restored.loadFromFile(snapshotFile) == 1);
+        assert(restored.openLog(logFile, snapshotFile, immediate) == 1);
+        assert(restored.getCount() == 0);
+        sequence = restored.getLogSequence();
+    }
+
+    // Clients racing on the same keys: replay ends where the shards did
+    std::vector<Record> survivors;
+    {
+        LogOptions grouped;
+        grouped.commitDelay = std::chrono::milliseconds(1);
+        ShardedDirectory shards(4, 7);
+        shards.openLog(logFile, sequence, writer, grouped);
+        std::vector<std::thread> clients;
+        for (int t = 0; t < 4; t++) {
+            clients.emplace_back([&, t]() {
+                for (int i = 0; i < 400; i++) {
+                    std::string key = std::to_string((i * 7 + t) % 50);
+                    switch ((i + t) % 3) {
+                        case 0: shards.insert(Record("Race" + key, "444-" + std::to_string(t) + "-" + key, "")); break;
+                        case 1: shards.removeByUsername("Race" + key); break;
+                        default: shards.removeByPhone("444-" + std::to_string((t + 1) % 4) + "-" + key); break;
+                    }
+                }
+            });
+        }
+        for (std::thread& client : clients) {
+            client.join();
+        }
+        survivors = shards.getRecords();
+    }
+    {
+        PhoneDirectory restored(7);
+        restored.loadFromFile(snapshotFile);
+        restored.openLog(logFile, snapshotFile, immediate);
+        assert(restored.getCount() == static_cast<int>(survivors.size()));
+        for (const Record& record : survivors) {
+            assert(restored.searchByUsername(record.username)->phoneNumber == record.phoneNumber);
+        }
+        assert(restored.checkConsistency().isConsistent());
+    }
+    std::remove(logFile);
+    std::remove(snapshotFile);
+    std::cout.clear();
+    std::cerr.clear();
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testAtomicSave() {
+    std::cout << "Test 29: Atomic and Incremental Saves... ";
+    
+    const char* filename = "test_atomic.txt";
+    auto contents = [&]() {
+        std::ifstream file(filename, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    };
+    
+    std::cout.setstate(std::ios::failbit);  // Silence the save messages
+    std::cerr.setstate(std::ios::failbit);
+    PhoneDirectory directory(7);
+    for (int i = 0; i < 1000; i++) {
+        directory.insert(Record("User" + std::to_string(i), "555-" + std::to_string(i), "Addr, Apt " + std::to_string(i)));
+    }
+    const HashTable& usernames = directory.getUsernameTable();
+    assert(usernames.isModifiedSince(filename) == true);
+    assert(usernames.saveToFile(filename) == true);
+    assert(FileHandler::fileExists(std::string(filename) + ".tmp") == false);
+    assert(usernames.isModifiedSince(filename) == false);
+    std::string saved = contents();
+    
+    HashTable reloaded(7, "username");
+    assert(reloaded.loadFromFile(filename) == 1000);
+    assert(reloaded.search("User7")->address == "Addr, Apt 7");
+    
+    // Unchanged records are not rewritten
+    {
+        std::ofstream file(filename, std::ios::binary | std::ios::app);
+        file << "marker";
+    }
+    assert(usernames.saveIfModified(filename) == true);
+    assert(contents() == saved + "marker");
+    
+    // Any change through the shared store marks both tables modified
+    directory.removeByPhone("555-3");
+    assert(usernames.isModifiedSince(filename) == true);
+    assert(directory.getPhoneTable().isModifiedSince(filename) == true);
+    assert(usernames.saveIfModified(filename) == true);
+    assert(reloaded.loadFromFile(filename) == 0);  // All 999 already present
+    HashTable fresh(7, "username");
+    assert(fresh.loadFromFile(filename) == 999);
+    
+    // A save that cannot be written leaves the previous file untouched
+    directory.insert(Record("New", "555-new", ""));
+    std::remove(filename);
+    assert(usernames.isModifiedSince(filename) == true);  // Missing file
+    assert(usernames.saveToFile(filename) == true);
+    saved = contents();
+    directory.removeByUsername("New");
+    assert(usernames.saveToFile("missing_directory/test_atomic.txt") == false);
+    assert(contents() == saved);
+    
+    // Record lists are written the same way
+    std::vector<Record> records = {Record("A", "1", "x"), Record("B", "2", "y, z")};
+    assert(FileHandler::writeRecordsToFile(records, filename) == true);
+    assert(contents() == "A,1,x\nB,2,y, z\n");
+    std::remove(filename);
+    std::cout.clear();
+    std::cerr.clear();
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testSingleRecordFile() {
+    std::cout << "Test 30: Single Record File and Legacy Drift... ";
+    
+    std::cout.setstate(std::ios::failbit);  // Silence the load messages and duplicate errors
+    std::cerr.setstate(std::ios::failbit);
+    
+    // Both indexes are built together, accepting what one insert per record would
+    std::vector<Record> batch;
+    for (int i = 0; i < 40000; i++) {
+        batch.push_back(Record("User" + std::to_string(i), "555-" + std::to_string(i), ""));
+    }
+    batch.push_back(Record("Taken", "555-7", ""));    // Phone already used
+    batch.push_back(Record("Taken", "555-free", ""));  // Username freed by the rejected record above
+    batch.push_back(Record("User9", "555-x", ""));    // Username already used
+    PhoneDirectory directory(7);
+    assert(directory.bulkInsert(batch) == 40001);
+    assert(directory.searchByUsername("Taken")->phoneNumber == "555-free");
+    assert(directory.searchByPhone("555-x") == std::nullopt);
+    assert(directory.searchByPhone("555-7")->username == "User7");
+    assert(directory.getUsernameTable().getStats().tombstones == 0);
+    assert(directory.getPhoneTable().getStats().tombstones == 0);
+    assert(directory.checkConsistency().isConsistent());
+    
+    // A legacy dataset whose two files have drifted apart
+    {
+        std::ofstream usernames("test_legacy_username.txt");
+        usernames << "Alice,555-01,1 Main\nBob,555-02,2 Main\nCarol,555-03,3 Main\nDave,555-04,4 Main\n";
+        std::ofstream phones("test_legacy_phone.txt");
+        phones << "Bob,555-02,2 Elm\nAlice,555-01,1 Main\nCarol,555-33,3 Main\nEve,555-05,5 Main\n";
+    }
+    PhoneDirectory legacy(7);
+    DriftReport drift;
+    assert(legacy.loadLegacyFiles("test_legacy_username.txt", "test_legacy_phone.txt", drift) == 5);
+    assert(drift.usernameFileRecords == 4 && drift.phoneFileRecords == 4);
+    assert(drift.matching == 1);            // Alice
+    assert(drift.conflicting == 2);         // Bob's address, Carol's phone
+    assert(drift.onlyInPhoneFile == 1);     // Eve
+    assert(drift.onlyInUsernameFile == 1);  // Dave
+    assert(drift.hasDrift());
+    assert(legacy.searchByUsername("Bob")->address == "2 Main");
+    assert(legacy.searchByPhone("555-33") == std::nullopt);
+    assert(legacy.searchByUsername("Eve") != std::nullopt);
+    assert(legacy.checkConsistency().isConsistent());
+    
+    // Files holding the same records in another order have not drifted
+    {
+        std::ofstream phones("test_legacy_phone.txt");
+        phones << "Dave,555-04,4 Main\nBob,555-02,2 Main\nAlice,555-01,1 Main\nCarol,555-03,3 Main\n";
+    }
+    PhoneDirectory agreeing(7);
+    assert(agreeing.loadLegacyFiles("test_legacy_username.txt", "test_legacy_phone.txt", drift) == 4);
+    assert(drift.matching == 4 && !drift.hasDrift());
+    
+    // One file alone still loads
+    std::remove("test_legacy_username.txt");
+    PhoneDirectory single(7);
+    assert(single.loadLegacyFiles("test_legacy_username.txt", "test_legacy_phone.txt", drift) == 4);
+    assert(!drift.hasDrift());
+    std::remove("test_legacy_phone.txt");
+    std::cout.clear();
+    std::cerr.clear();
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+/**
+ * @brief Hash sending every key to slot 0, so probe distances grow long
+ */
+struct CollidingHash {
+    uint64_t operator()(uint64_t) const { return 0; }
+};
+
+/**
+ * @brief Check a table's maintained statistics against probing every key
+ */
+template <class Table>
+void checkProbeStats(const Table& ht) {
+    long long totalDistance = 0;
+    int maxDistance = 0;
+    int tombstones = 0;
+    std::vector<int> histogram(Table::DISTANCE_BUCKETS, 0);
+    for (int i = 0; i < ht.getSlotCount(); i++) {
+        tombstones += ht.isTombstone(i);
+        if (ht.isOccupied(i)) {
+            int distance = ht.getSearchLength(ht.getKeyOf()(ht.valueAt(i))) - 1;
+            totalDistance += distance;
+            maxDistance = std::max(maxDistance, distance);
+            histogram[std::min(distance, Table::DISTANCE_BUCKETS - 1)]++;
+        }
+    }
+    assert(ht.getTombstoneCount() == tombstones);
+    assert(ht.getMaxProbeDistance() == maxDistance);
+    assert(std::equal(histogram.begin(), histogram.end(), ht.getDistanceHistogram().begin()));
+    double expected = ht.getCount() > 0 ? static_cast<double>(totalDistance) / ht.getCount() + 1.0 : 0.0;
+    double difference = ht.getAverageSearchLength() - expected;
+    assert(difference < 1e-9 && difference > -1e-9);
+}
+
+void testMaintainedStats() {
+    std::cout << "Test 31: Maintained Probe Statistics... ";
+    
+    const ProbeStrategy strategies[] = {
+        ProbeStrategy::Linear, ProbeStrategy::Quadratic,
+        ProbeStrategy::DoubleHashing, ProbeStrategy::RobinHood
+    };
+    
+    for (ProbeStrategy strategy : strategies) {
+        BasicHashTable<uint64_t, NumericEntry, NumericPhoneKey> ht(17, 0.9, strategy);
+        for (uint64_t i = 0; i < 5000; i++) {
+            ht.insert(NumericEntry{i * 7919, ""});
+            if (i % 3 == 0) {
+                ht.remove((i / 2) * 7919);
+            }
+        }
+        
+        // Mid-resize, values of both tables are counted
+        const auto& histogram = ht.getDistanceHistogram();
+        long long counted = 0;
+        for (int bucketCount : histogram) {
+            counted += bucketCount;
+        }
+        assert(counted == ht.getCount());
+        
+        ht.reserve(ht.getCount());  // Finishes any migration
+        checkProbeStats(ht);
+        for (uint64_t i = 5000; i < 6000; i++) {
+            ht.insertHashed(ht.hashOf(i * 7919), NumericEntry{i * 7919, ""});
+        }
+        checkProbeStats(ht);
+        
+        ht.clear();
+        assert(ht.getAverageSearchLength() == 0.0 && ht.getMaxProbeDistance() == 0);
+        assert(ht.getTombstoneCount() == 0);
+    }
+    
+    // Distances past the histogram's last bucket: removing the farthest
+    // value recounts the largest distance
+    for (ProbeStrategy strategy : {ProbeStrategy::Linear, ProbeStrategy::RobinHood}) {
+        BasicHashTable<uint64_t, NumericEntry, NumericPhoneKey, CollidingHash> chain(257, 0.9, strategy);
+        for (uint64_t i = 0; i < 60; i++) {
+            chain.insert(NumericEntry{i, ""});
+        }
+        assert(chain.getMaxProbeDistance() == 59);
+        assert(chain.getDistanceHistogram()[decltype(chain)::DISTANCE_BUCKETS - 1] == 29);
+        chain.remove(59);
+        chain.remove(10);
+        checkProbeStats(chain);
+        assert(chain.getMaxProbeDistance() == 58 - (strategy == ProbeStrategy::RobinHood));
+    }
+    
+    // The directory's tables report the same numbers through TableStats,
+    // and a snapshot restores them without probing
+    std::cout.setstate(std::ios::failbit);
+    PhoneDirectory directory(7);
+    for (int i = 0; i < 3000; i++) {
+        directory.insert(Record("User" + std::to_string(i), "555-" + std::to_string(i), ""));
+    }
+    for (int i = 0; i < 3000; i += 4) {
+        directory.removeByPhone("555-" + std::to_string(i));
+    }
+    TableStats stats = directory.getPhoneTable().getStats();
+    assert(stats.count == 2250 && stats.tombstones > 0);
+    assert(stats.averageSearchLength >= 1.0 && stats.maxProbeDistance >= 0);
+    std::vector<double> shares = stats.probeLengthShares(5);
+    double total = 0.0;
+    for (double share : shares) {
+        total += share;
+    }
+    assert(total > 0.999 && total < 1.001);
+    
+    assert(directory.saveSnapshot("test_stats.bin") == true);
+    PhoneDirectory restored(7);
+    assert(restored.loadSnapshot("test_stats.bin") == true);
+    TableStats restoredStats = restored.getPhoneTable().getStats();
+    assert(restoredStats.averageSearchLength == stats.averageSearchLength);
+    assert(restoredStats.maxProbeDistance == stats.maxProbeDistance);
+    assert(restoredStats.tombstones == stats.tombstones);
+    assert(restoredStats.distanceHistogram == stats.distanceHistogram);
+    std::remove("test_stats.bin");
+    std::cout.clear();
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testCompaction() {
+    std::cout << "Test 32: Tombstone Compaction... ";
+    
+    const ProbeStrategy strategies[] = {
+        ProbeStrategy::Linear, ProbeStrategy::Quadratic, ProbeStrategy::DoubleHashing
+    };
+    
+    for (ProbeStrategy strategy : strategies) {
+        // Churn with compaction off: tombstones pile up and misses lengthen
+        BasicHashTable<uint64_t, NumericEntry, NumericPhoneKey> ht(17, 0.75, strategy);
+        ht.setMaxTombstoneRatio(1.0);
+        uint64_t next = 0;
+        for (; next < 2000; next++) {
+            ht.insert(NumericEntry{next, ""});
+        }
+        int size = ht.getSize();
+        double freshMiss = ht.getMissSearchLength();
+        for (int round = 0; round < 20; round++) {
+            for (uint64_t i = next - 2000; i < next - 1800; i++) {
+                assert(ht.remove(i) == true);
+            }
+            for (int i = 0; i < 200; i++, next++) {
+                assert(ht.insert(NumericEntry{next, ""}) == true);
+            }
+        }
+        assert(ht.getSize() == size && ht.getCompactionCount() == 0);
+        assert(ht.getTombstoneCount() > 0);
+        double churnedMiss = ht.getMissSearchLength();
+        assert(churnedMiss > freshMiss);
+        
+        // Compacting in place drops every tombstone and keeps every value
+        ht.compact();
+        assert(ht.getSize() == size && ht.getCount() == 2000);
+        assert(ht.getTombstoneCount() == 0 && ht.getCompactionCount() == 1);
+        assert(ht.getMissSearchLength() < churnedMiss);
+        for (uint64_t i = 0; i < next; i++) {
+            assert(ht.contains(i) == (i >= next - 2000));
+        }
+        checkProbeStats(ht);
+        
+        // With a threshold set, inserts compact on their own
+        ht.setMaxTombstoneRatio(0.25);
+        for (int round = 0; round < 20; round++) {
+            for (uint64_t i = next - 2000; i < next - 1800; i++) {
+                ht.remove(i);
+            }
+            for (int i = 0; i < 200; i++, next++) {
+                ht.insert(NumericEntry{next, ""});
+                assert(ht.getTombstoneCount() <= 0.25 * (ht.getSize() - ht.getCount()) + 1);
+            }
+        }
+        assert(ht.getCompactionCount() > 1 && ht.getSize() == size);
+        for (uint64_t i = next - 2000; i < next; i++) {
+            assert(ht.contains(i));
+        }
+        checkProbeStats(ht);
+    }
+    
+    // Robin Hood leaves no tombstones, so there is nothing to compact
+    BasicHashTable<uint64_t, NumericEntry, NumericPhoneKey> robin(17, 0.75, ProbeStrategy::RobinHood);
+    for (uint64_t i = 0; i < 500; i++) {
+        robin.insert(NumericEntry{i, ""});
+    }
+    for (uint64_t i = 0; i < 500; i += 2) {
+        robin.remove(i);
+    }
+    robin.compact();
+    assert(robin.getCompactionCount() == 0 && robin.getCount() == 250);
+    
+    // A directory under churn keeps both indexes consistent through compactions
+    PhoneDirectory directory(7);
+    for (int i = 0; i < 1000; i++) {
+        directory.insert(Record("User" + std::to_string(i), "555-" + std::to_string(i), ""));
+    }
+    for (int i = 1000; i < 5000; i++) {
+        directory.removeByUsername("User" + std::to_string(i - 1000));
+        directory.insert(Record("User" + std::to_string(i), "555-" + std::to_string(i), ""));
+    }
+    TableStats stats = directory.getUsernameTable().getStats();
+    assert(stats.count == 1000 && stats.compactions > 0);
+    assert(directory.getUsernameTable().getSampledStats().missSearchLength >= 1.0);
+    assert(directory.searchByPhone("555-4999")->username == "User4999");
+    assert(directory.checkConsistency().isConsistent());
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testLookupFilter() {
+    std::cout << "Test 33: Lookup Filter... ";
+    
+    const ProbeStrategy strategies[] = {
+        ProbeStrategy::Linear, ProbeStrategy::Quadratic,
+        ProbeStrategy::DoubleHashing, ProbeStrategy::RobinHood
+    };
+    
+    for (ProbeStrategy strategy : strategies) {
+        // No false negatives while growing, removing and compacting
+        BasicHashTable<uint64_t, NumericEntry, NumericPhoneKey> ht(17, 0.75, strategy);
+        ht.setFilterBits(BloomFilter::DEFAULT_BITS_PER_KEY);
+        assert(ht.getFilterBits() == BloomFilter::DEFAULT_BITS_PER_KEY && ht.getFilterBytes() > 0);
+        ht.setMaxTombstoneRatio(0.25);
+        bool sawResize = false;
+        for (uint64_t i = 0; i < 4000; i++) {
+            assert(ht.insert(NumericEntry{i, ""}) == true);
+            assert(ht.insert(NumericEntry{i, ""}) == false);  // Duplicates still caught
+            sawResize = sawResize || ht.isResizing();
+            if (i % 3 == 2) {
+                assert(ht.remove(i - 1) == true);
+            }
+        }
+        assert(sawResize);
+        for (uint64_t i = 4000; i < 12000; i++) {
+            ht.remove(i - 4000);
+            ht.insert(NumericEntry{i, ""});
+        }
+        assert(strategy == ProbeStrategy::RobinHood || ht.getCompactionCount() > 0);
+        for (uint64_t i = 0; i < 16000; i++) {
+            assert(ht.contains(i) == (i >= 8000 && i < 12000));
+        }
+        
+        // Batches skip the keys the filter rejects and find the rest
+        std::vector<uint64_t> keys;
+        for (uint64_t i = 7000; i < 13000; i++) {
+            keys.push_back(i);
+        }
+        std::vector<int> indices(keys.size());
+        ht.findBatch(keys.data(), static_cast<int>(keys.size()), indices.data());
+        for (size_t i = 0; i < keys.size(); i++) {
+            assert((indices[i] != -1) == ht.contains(keys[i]));
+        }
+        
+        // Most absent keys are rejected without probing
+        double falsePositives = ht.getFilterFalsePositiveRate();
+        assert(falsePositives > 0.0 && falsePositives < 0.02);
+        int probed = 0;
+        for (uint64_t i = 20000; i < 30000; i++) {
+            int searchLength = 0;
+            assert(ht.findIndex(i, searchLength) == -1);
+            probed += (searchLength > 0);
+        }
+        assert(probed < 300);
+        
+        // Without a filter every miss probes
+        ht.setFilterBits(0);
+        assert(ht.getFilterBits() == 0 && ht.getFilterBytes() == 0 && ht.getFilterFalsePositiveRate() == 0.0);
+        int searchLength = 0;
+        assert(ht.findIndex(uint64_t(20000), searchLength) == -1 && searchLength > 0);
+        assert(ht.contains(uint64_t(9000)));
+    }
+    
+    // Legacy hashers of short keys leave the high bits clear; absent keys
+    // are still rejected, and the estimate sees what lookups see
+    {
+        RecordTable ht(17, 0.75, ProbeStrategy::Linear, StringHash(HashAlgorithm::Polynomial));
+        ht.setFilterBits(BloomFilter::DEFAULT_BITS_PER_KEY);
+        for (int i = 0; i < 20000; i++) {
+            assert(ht.insert(Record("a" + std::to_string(i), "", "")) == true);
+        }
+        int accepted = 0;
+        for (int i = 0; i < 20000; i++) {
+            std::string absent = "b" + std::to_string(i);
+            assert(ht.hashOf(absent) < (uint64_t(1) << 32));
+            int searchLength = 0;
+            assert(ht.findIndex(absent, searchLength) == -1);
+            accepted += (searchLength > 0);
+        }
+        assert(accepted < 400);
+        assert(ht.getFilterFalsePositiveRate() < 0.02);
+        
+        // Sums of short keys collide too often for any filter; the estimate says so
+        RecordTable summed(17, 0.75, ProbeStrategy::Linear, StringHash(HashAlgorithm::Sum));
+        summed.setFilterBits(BloomFilter::DEFAULT_BITS_PER_KEY);
+        for (int i = 0; i < 20000; i++) {
+            summed.insert(Record("a" + std::to_string(i), "", ""));
+        }
+        assert(summed.getFilterFalsePositiveRate() > 0.1);
+    }
+
+    // A directory's filters travel with its snapshot
+    std::cout.setstate(std::ios::failbit);
+    PhoneDirectory directory(7);
+    directory.setLookupFilter(BloomFilter::DEFAULT_BITS_PER_KEY);
+    for (int i = 0; i < 2000; i++) {
+        directory.insert(Record("User" + std::to_string(i), "555-" + std::to_string(i), ""));
+    }
+    assert(directory.saveSnapshot("test_filter.bin") == true);
+    
+    PhoneDirectory filtered(7);
+    filtered.setLookupFilter(BloomFilter::DEFAULT_BITS_PER_KEY);
+    assert(filtered.loadSnapshot("test_filter.bin") == true);
+    assert(filtered.getPhoneTable().getStats().filterBytes == directory.getPhoneTable().getStats().filterBytes);
+    assert(filtered.searchByUsername("User1999")->phoneNumber == "555-1999");
+    assert(filtered.searchByPhone("555-2000") == std::nullopt);
+    
+    // A directory set up without filters drops the snapshot's
+    PhoneDirectory plain(7);
+    assert(plain.loadSnapshot("test_filter.bin") == true);
+    assert(plain.getUsernameTable().getFilterBits() == 0);
+    assert(plain.searchByPhone("555-0")->username == "User0");
+    std::cout.clear();
+    std::remove("test_filter.bin");
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testCuckooHashing() {
+    std::cout << "Test 34: Cuckoo Hashing... ";
+    
+    // Filled to 95%: every key is found within its two buckets or the stash
+    CuckooHashTable<uint64_t, NumericEntry, NumericPhoneKey> ht(4096, 0.95);
+    int size = ht.getSize();
+    assert(size == 4096);
+    int target = static_cast<int>(0.95 * size);
+    for (uint64_t i = 0; i < static_cast<uint64_t>(target); i++) {
+        assert(ht.insert(NumericEntry{i, "User" + std::to_string(i)}) == true);
+        assert(ht.insert(NumericEntry{i, "Dup"}) == false);
+    }
+    assert(ht.getCount() == target && ht.getLoadFactor() > 0.94);
+    for (uint64_t i = 0; i < static_cast<uint64_t>(target); i++) {
+        int searchLength = ht.getSearchLength(i);
+        assert(searchLength >= 1 && searchLength <= 3);
+        assert(ht.search(i)->username == "User" + std::to_string(i));
+    }
+    assert(ht.getMaxProbeDistance() <= 2 && ht.getTombstoneCount() == 0);
+    checkProbeStats(ht);
+    
+    // Misses read both buckets, and the stash only when it is in use
+    int searchLength = 0;
+    assert(ht.findIndex(uint64_t(1) << 40, searchLength) == -1);
+    assert(searchLength == (ht.getStashCount() > 0 ? 3 : 2));
+    assert(ht.getMissSearchLength() == searchLength);
+    
+    // Removal frees the slot outright; the freed room is reused without growing
+    for (uint64_t i = 0; i < static_cast<uint64_t>(target); i += 2) {
+        assert(ht.remove(i) == true);
+    }
+    for (uint64_t i = 0; i < static_cast<uint64_t>(target); i += 2) {
+        assert(ht.insert(NumericEntry{i + 100000, ""}) == true);
+    }
+    assert(ht.getSize() == size && ht.getCount() == target);
+    for (uint64_t i = 0; i < static_cast<uint64_t>(target); i++) {
+        assert(ht.contains(i) == (i % 2 == 1));
+        assert(ht.contains(i + 100000) == (i % 2 == 0));
+    }
+    checkProbeStats(ht);
+    
+    // Growth past the load threshold rebuilds and keeps every key
+    for (uint64_t i = 200000; i < 210000; i++) {
+        assert(ht.insert(NumericEntry{i, ""}) == true);
+    }
+    assert(ht.getSize() > size && ht.getLoadFactor() <= 0.95);
+    assert(ht.contains(uint64_t(1)) && ht.contains(uint64_t(209999)));
+    checkProbeStats(ht);
+    
+    // Keys sharing one hash overflow the stash; the table still holds them all
+    CuckooHashTable<uint64_t, NumericEntry, NumericPhoneKey, CollidingHash> colliding(16, 0.9);
+    for (uint64_t i = 0; i < 40; i++) {
+        assert(colliding.insert(NumericEntry{i, ""}) == true);
+    }
+    assert(colliding.getRehashCount() > 0 && colliding.getStashCount() > 0);
+    for (uint64_t i = 0; i < 40; i++) {
+        assert(colliding.contains(i));
+        assert(colliding.remove(i) == true);
+    }
+    assert(colliding.getCount() == 0 && colliding.getStashCount() == 0);
+    
+    // Polynomial hashes of short keys stay below 2^32 yet still get two real choices
+    HashTable legacy(7, "username", 0.9, HashAlgorithm::Polynomial, ProbeStrategy::Cuckoo);
+    HashTable mixed(7, "username", 0.9, HashAlgorithm::WyHash, ProbeStrategy::Cuckoo);
+    for (int i = 0; i < 5000; i++) {
+        char name[16];
+        std::snprintf(name, sizeof(name), "u%05d", i);
+        assert(legacy.insert(Record(name, "555-" + std::to_string(i), "")) == true);
+        assert(mixed.insert(Record(name, "555-" + std::to_string(i), "")) == true);
+    }
+    assert(legacy.getSize() <= mixed.getSize());
+    assert(legacy.getMaxProbeDistance() <= 2);
+    
+    // Selected on HashTable: batches, slot access and snapshots work as for open addressing
+    HashTable table(7, "phone", 0.9, HashAlgorithm::WyHash, ProbeStrategy::Cuckoo);
+    assert(table.getProbeStrategy() == ProbeStrategy::Cuckoo);
+    std::vector<std::string> keys;
+    for (int i = 0; i < 3000; i++) {
+        keys.push_back("555-" + std::to_string(i));
+        assert(table.insert(Record("User" + std::to_string(i), keys.back(), "")) == true);
+    }
+    for (int i = 0; i < 3000; i += 3) {
+        assert(table.remove(keys[i]) == true);
+    }
+    std::vector<std::string_view> views(keys.begin(), keys.end());
+    std::vector<std::optional<RecordView>> results(views.size());
+    table.searchBatch(views.data(), static_cast<int>(views.size()), results.data());
+    for (int i = 0; i < 3000; i++) {
+        assert(results[i].has_value() == (i % 3 != 0));
+    }
+    int listed = 0;
+    for (int i = 0; i < table.getSlotCount(); i++) {
+        listed += !table.getRecordAt(i)->isEmpty;
+    }
+    assert(listed == 2000);
+    TableStats stats = table.getStats();
+    assert(stats.maxProbeDistance <= 2 && stats.averageSearchLength <= 2.0);
+    
+    std::cout.setstate(std::ios::failbit);
+    PhoneDirectory directory(7, 0.9, HashAlgorithm::WyHash, ProbeStrategy::Cuckoo);
+    for (int i = 0; i < 2000; i++) {
+        directory.insert(Record("User" + std::to_string(i), "555-" + std::to_string(i), ""));
+    }
+    assert(directory.saveSnapshot("test_cuckoo.bin") == true);
+    PhoneDirectory restored(7, 0.9, HashAlgorithm::WyHash, ProbeStrategy::Cuckoo);
+    assert(restored.loadSnapshot("test_cuckoo.bin") == true);
+    PhoneDirectory linear(7, 0.9);
+    std::cerr.setstate(std::ios::failbit);
+    assert(linear.loadSnapshot("test_cuckoo.bin") == false);  // Written by another engine
+    std::cerr.clear();
+    std::cout.clear();
+    std::remove("test_cuckoo.bin");
+    assert(restored.getCount() == 2000);
+    assert(restored.searchByUsername("User1999")->phoneNumber == "555-1999");
+    assert(restored.checkConsistency().isConsistent());
+    assert(restored.removeByPhone("555-0") == true && restored.insert(Record("New", "555-new", "")));
+    assert(restored.checkConsistency().isConsistent());
+    
+    std::cout << "PASSED" << std::endl;
+}
+
+void testSeparateChaining() {
+    std::cout << "Test 35: Separate Chaining... ";
+    
+    // Load factors above 1: 3000 keys share 1024 buckets before growing
+    ChainedHashTable<uint64_t, NumericEntry, NumericPhoneKey> ht(1024, 3.0);
+    assert(ht.getMaxLoadFactor() == 3.0);
+    std::vector<const NumericEntry*> addresses;
+    std::vector<int> indices;
+    for (uint64_t i = 0; i < 3000; i++) {
+        assert(ht.insert(NumericEntry{i, "User" + std::to_string(i)}) == true);
+        assert(ht.insert(NumericEntry{i, "Dup"}) == false);
+        int searchLength = 0;
+        indices.push_back(ht.findIndex(i, searchLength));
+        addresses.push_back(ht.search(i));
+    }
+    assert(ht.getSize() == 1024 && ht.getLoadFactor() > 2.9);
+    assert(ht.getTombstoneCount() == 0 && ht.getMissSearchLength() > 2.0);
+    checkProbeStats(ht);
+    
+    // Growth relinks nodes without moving them: addresses and slot indices hold
+    for (uint64_t i = 3000; i < 20000; i++) {
+        assert(ht.insert(NumericEntry{i, ""}) == true);
+    }
+    assert(ht.getSize() > 1024 && ht.getLoadFactor() <= 3.0);
+    for (uint64_t i = 0; i < 3000; i++) {
+        int searchLength = 0;
+        assert(ht.search(i) == addresses[i] && ht.findIndex(i, searchLength) == indices[i]);
+        assert(addresses[i]->username == "User" + std::to_string(i));
+    }
+    checkProbeStats(ht);
+    
+    // Removal unlinks the node; later inserts reuse it without growing the pool
+    int pooled = ht.getSlotCount();
+    for (uint64_t i = 0; i < 20000; i += 2) {
+        assert(ht.remove(i) == true);
+        assert(ht.remove(i) == false);
+    }
+    assert(ht.getFreeNodeCount() == pooled - 10000);
+    checkProbeStats(ht);
+    for (uint64_t i = 0; i < 20000; i += 2) {
+        assert(ht.insert(NumericEntry{i + 100000, ""}) == true);
+    }
+    assert(ht.getSlotCount() == pooled && ht.getCount() == 20000);
+    assert(ht.search(uint64_t(1)) == addresses[1]);
+    checkProbeStats(ht);
+    
+    // Keys sharing one hash form a single long chain
+    ChainedHashTable<uint64_t, NumericEntry, NumericPhoneKey, CollidingHash> colliding(16, 0.75);
+    for (uint64_t i = 0; i < 40; i++) {
+        assert(colliding.insert(NumericEntry{i, ""}) == true);
+    }
+    assert(colliding.getMaxProbeDistance() == 39 && colliding.getSearchLength(uint64_t(39)) == 40);
+    checkProbeStats(colliding);
+    for (uint64_t i = 0; i < 40; i += 3) {
+        assert(colliding.remove(i) == true);
+    }
+    checkProbeStats(colliding);
+    
+    // Legacy hashes below 2^32 still spread over the buckets
+    for (HashAlgorithm algorithm : {HashAlgorithm::Sum, HashAlgorithm::Polynomial}) {
+        HashTable legacy(7, "username", 0.75, algorithm, ProbeStrategy::Chaining);
+        for (int i = 0; i < 5000; i++) {
+            char name[16];
+            std::snprintf(name, sizeof(name), "u%05d", i);
+            assert(legacy.insert(Record(name, "555-" + std::to_string(i), "")) == true);
+        }
+        assert(legacy.getMaxProbeDistance() < 5000 / 4);
+        if (algorithm == HashAlgorithm::Polynomial) {
+            assert(legacy.getAverageSearchLength() < 2.0);
+        }
+    }
+    
+    // Selected on HashTable: batches, slot access and snapshots work as for open addressing
+    HashTable table(7, "username", 2.0, HashAlgorithm::WyHash, ProbeStrategy::Chaining);
+    assert(table.getProbeStrategy() == ProbeStrategy::Chaining && table.getMaxLoadFactor() == 2.0);
+    std::vector<std::string> keys;
+    for (int i = 0; i < 3000; i++) {
+        keys.push_back("User" + std::to_string(i));
+        assert(table.insert(Record(keys.back(), "555-" + std::to_string(i), "")) == true);
+    }
+    assert(table.getLoadFactor() > 1.0);
+    for (int i = 0; i < 3000; i += 3) {
+        assert(table.remove(keys[i]) == true);
+    }
+    std::vector<std::string_view> views(keys.begin(), keys.end());
+    std::vector<std::optional<RecordView>> results(views.size());
+    table.searchBatch(views.data(), static_cast<int>(views.size()), results.data());
+    for (int i = 0; i < 3000; i++) {
+        assert(results[i].has_value() == (i % 3 != 0));
+    }
+    int listed = 0;
+    for (int i = 0; i < table.getSlotCount(); i++) {
+        listed += !table.getRecordAt(i)->isEmpty;
+    }
+    assert(listed == 2000);
+    
+    std::cout.setstate(std::ios::failbit);
+    PhoneDirectory directory(7, 1.5, HashAlgorithm::WyHash, ProbeStrategy::Chaining);
+    for (int i = 0; i < 2000; i++) {
+        directory.insert(Record("User" + std::to_string(i), "555-" + std::to_string(i), ""));
+    }
+    assert(directory.saveSnapshot("test_chaining.bin") == true);
+    PhoneDirectory restored(7, 1.5, HashAlgorithm::WyHash, ProbeStrategy::Chaining);
+    assert(restored.loadSnapshot("test_chaining.bin") == true);
+    PhoneDirectory cuckoo(7, 0.9, HashAlgorithm::WyHash, ProbeStrategy::Cuckoo);
+    std::cerr.setstate(std::ios::failbit);
+    assert(cuckoo.loadSnapshot("test_chaining.bin") == false);  // Written by another engine
+    std::cerr.clear();
+    std::cout.clear();
+    std::remove("test_chaining.bin");
+    assert(restored.getCount() == 2000);
+    assert(restored.searchByPhone("555-1999")->username == "User1999");
+    assert(restored.checkConsistency().isConsistent());
+    assert(restored.removeByUsername("User0") == true && restored.insert(Record("New", "555-new", "")));
+    assert(restored.checkConsistency().isConsistent());
     
     std::cout << "PASSED" << std::endl;
 }
@@ -260,6 +2382,31 @@ int main() {
         testFileOperations();
         testPhoneNumberKey();
         testLargeDataset();
+        testIncrementalResize();
+        testHashFunctions();
+        testSlotLayout();
+        testGroupProbeEngines();
+        testProbeStrategies();
+        testTemplateKeys();
+        testHeterogeneousLookup();
+        testStringArena();
+        testPhoneDirectory();
+        testAtomicDirectoryWrites();
+        testConcurrentHashTable();
+        testEpochReclamation();
+        testShardedDirectory();
+        testBatchSearch();
+        testBulkInsert();
+        testMappedLoader();
+        testSnapshot();
+        testWriteAheadLog();
+        testAtomicSave();
+        testSingleRecordFile();
+        testMaintainedStats();
+        testCompaction();
+        testLookupFilter();
+        testCuckooHashing();
+        testSeparateChaining();
         
         std::cout << "\n" << std::string(60, '=') << std::endl;
         std::cout << "  ALL TESTS PASSED! ✓" << std::endl;